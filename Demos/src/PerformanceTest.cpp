@@ -17,9 +17,12 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 
+#include <atomic>
+#include <cstdlib>
 #include <iostream>
 #include <iomanip>
 #include <limits>
+#include <new>
 #include <tuple>
 
 #include "config.h"
@@ -73,6 +76,34 @@
 // See http://wiki.openstreetmap.org/wiki/Slippy_map_tilenames for details about
 // coordinate transformation
 
+#if defined(PERFORMANCETEST_COUNT_ALLOCATIONS)
+// Number of heap allocations done via operator new (in all threads)
+static std::atomic<size_t> heapAllocationCount(0);
+
+void* operator new(size_t size)
+{
+  heapAllocationCount++;
+
+  void* p=std::malloc(size>0 ? size : 1);
+
+  if (p==nullptr) {
+    throw std::bad_alloc();
+  }
+
+  return p;
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, size_t /*size*/) noexcept
+{
+  std::free(p);
+}
+#endif
+
 struct Arguments {
   bool help{false};
   bool debug{false};
@@ -89,6 +120,7 @@ struct Arguments {
   size_t loadRepeat{1};
   bool flushCache{false};
   bool flushDiskCache{false};
+  bool queryArena{false};
 
 #if defined(HAVE_LIB_GPERFTOOLS)
   bool heapProfile{false};
@@ -141,6 +173,8 @@ struct LevelStats
   double allocMax;
   double allocSum;
 
+  size_t allocCount;
+
   size_t nodeCount;
   size_t wayCount;
   size_t areaCount;
@@ -157,6 +191,7 @@ struct LevelStats
     drawTotalTime(0.0),
     allocMax(0.0),
     allocSum(0.0),
+    allocCount(0),
     nodeCount(0),
     wayCount(0),
     areaCount(0),
@@ -520,6 +555,12 @@ int main(int argc, char* argv[])
                       "Flush system disk caches after each data load, default: " + std::to_string(args.flushDiskCache) +
                       " (It work just on Linux with admin rights.)",
                       false);
+  argParser.AddOption(osmscout::CmdLineFlag([&args](const bool& value) {
+                        args.queryArena=value;
+                      }),
+                      "query-arena",
+                      "Allocate the objects of a tile in a query arena, default: " + std::to_string(args.queryArena),
+                      false);
 
   argParser.AddOption(osmscout::CmdLineUIntOption([&databaseParameter](const unsigned int& value) {
                         databaseParameter.SetNodeDataCacheSize(value);
@@ -619,6 +660,7 @@ int main(int argc, char* argv[])
   // TODO: Use some way to find a valid font on the system (Agg display a ton of messages otherwise)
   drawParameter.SetFontName("/usr/share/fonts/TTF/DejaVuSans.ttf");
   searchParameter.SetUseMultithreading(true);
+  searchParameter.SetUseQueryArena(args.queryArena);
 
   for (osmscout::MagnificationLevel level=osmscout::MagnificationLevel(std::min(args.startZoom,args.endZoom));
        level<=osmscout::MagnificationLevel(std::max(args.startZoom,args.endZoom));
@@ -675,6 +717,9 @@ int main(int argc, char* argv[])
         data.areas.clear();
 
         osmscout::StopClock dbTimer;
+#if defined(PERFORMANCETEST_COUNT_ALLOCATIONS)
+        size_t              allocCountBefore=heapAllocationCount;
+#endif
 
         osmscout::GeoBox dataBoundingBox(tileBox.GetBoundingBox(magnification));
 
@@ -688,6 +733,10 @@ int main(int argc, char* argv[])
         mapService->LoadMissingTileData(searchParameter, *styleConfig, tiles);
         mapService->AddTileDataToMapData(tiles, data);
 
+#if defined(PERFORMANCETEST_COUNT_ALLOCATIONS)
+        stats.allocCount+=heapAllocationCount-allocCountBefore;
+#endif
+
 #if defined(HAVE_LIB_GPERFTOOLS)
         if (args.heapProfile) {
           std::ostringstream buff;
@@ -775,6 +824,15 @@ int main(int argc, char* argv[])
 
   std::cout << "==========" << std::endl;
 
+  double openTotalTime=0.0;
+
+  std::cout << "Open:" << std::endl;
+  for (const auto& openTime : database->GetOpenTimes()) {
+    std::cout << " " << openTime.name << ": " << openTime.duration << std::endl;
+    openTotalTime+=openTime.duration;
+  }
+  std::cout << " total: " << openTotalTime << std::endl;
+
   for (const auto& stats : statistics) {
     std::cout << "Level: " << stats.level << std::endl;
     std::cout << "Tiles: " << stats.tileCount << " (load " << args.loadRepeat << "x, drawn " << args.drawRepeat << "x)" << std::endl;
@@ -785,6 +843,15 @@ int main(int argc, char* argv[])
     std::cout << "avg: " << formatAlloc(stats.allocSum / (stats.tileCount * args.loadRepeat)) << std::endl;
 #endif
 
+#if defined(PERFORMANCETEST_COUNT_ALLOCATIONS)
+    std::cout << " Allocations: ";
+    std::cout << "total: " << stats.allocCount << " ";
+    if (stats.tileCount>0) {
+      std::cout << "avg: " << stats.allocCount/(stats.tileCount * args.loadRepeat);
+    }
+    std::cout << std::endl;
+#endif
+
     std::cout << " Tot. data  : ";
     std::cout << "nodes: " << stats.nodeCount << " ";
     std::cout << "way: " << stats.wayCount << " ";
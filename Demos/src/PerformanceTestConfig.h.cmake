@@ -18,6 +18,9 @@
 /* Gperftools detected */
 #cmakedefine HAVE_LIB_GPERFTOOLS 1
 
+/* Count heap allocations by replacing the global operator new/delete */
+#cmakedefine PERFORMANCETEST_COUNT_ALLOCATIONS 1
+
 /* pango detected */
 #cmakedefine OSMSCOUT_MAP_CAIRO_HAVE_LIB_PANGO 1
 
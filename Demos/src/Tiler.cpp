@@ -17,12 +17,14 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 
+#include <algorithm>
 #include <iostream>
-#include <iomanip>
-#include <limits>
+#include <thread>
+#include <vector>
 
 #include <osmscout/Database.h>
 #include <osmscout/MapService.h>
+#include <osmscout/TileBatchRenderer.h>
 
 #include <osmscout/MapPainterAgg.h>
 
@@ -31,9 +33,14 @@
 
 /*
   Example for the nordrhein-westfalen.osm (to be executed in the Demos top
-  level directory), drawing the "Ruhrgebiet":
+  level directory), drawing the "Ruhrgebiet" using 4 threads:
 
-  src/Tiler ../maps/nordrhein-westfalen ../stylesheets/standard.oss 51.2 6.5 51.7 8 10 13
+  src/Tiler ../maps/nordrhein-westfalen ../stylesheets/standard.oss 51.2 6.5 51.7 8 10 13 . 4
+
+  Tiles are written as <zoom>_<x>_<y>.ppm into the given output directory
+  (default: the current directory). Tiles already existing in the output
+  directory are skipped, so an interrupted run can be resumed by starting
+  it again.
 */
 
 static const unsigned int tileWidth=256;
@@ -41,26 +48,22 @@ static const unsigned int tileHeight=256;
 static const double       DPI=96.0;
 static const int          tileRingSize=1;
 
-bool write_ppm(const agg::rendering_buffer& buffer,
-               const char* file_name)
+std::string EncodePPM(const agg::rendering_buffer& buffer)
 {
-  FILE* fd=fopen(file_name, "wb");
-
-  if (fd) {
-    fprintf(fd,"P6 %d %d 255\n", buffer.width(),buffer.height());
+  std::string header="P6 "+std::to_string(buffer.width())+" "+std::to_string(buffer.height())+" 255\n";
+  std::string result;
 
-    for (size_t y=0; y<buffer.height();y++)
-    {
-      const unsigned char* row=buffer.row_ptr(y);
+  result.reserve(header.length()+buffer.width()*buffer.height()*3);
+  result.append(header);
 
-      fwrite(row,1,buffer.width()*3,fd);
-    }
+  for (size_t y=0; y<buffer.height();y++)
+  {
+    const unsigned char* row=buffer.row_ptr(y);
 
-    fclose(fd);
-    return true;
+    result.append(reinterpret_cast<const char*>(row),buffer.width()*3);
   }
 
-  return false;
+  return result;
 }
 
 void MergeTilesToMapData(const std::list<osmscout::TileRef>& centerTiles,
@@ -175,6 +178,165 @@ void MergeTilesToMapData(const std::list<osmscout::TileRef>& centerTiles,
   }
 }
 
+/**
+ * Return the types of objects, that might have labels at the given magnification
+ */
+osmscout::MapService::TypeDefinition GetLabelTypeDefinition(const osmscout::TypeConfig& typeConfig,
+                                                            const osmscout::StyleConfig& styleConfig,
+                                                            const osmscout::AreaSearchParameter& searchParameter,
+                                                            const osmscout::Magnification& magnification)
+{
+  osmscout::MapService::TypeDefinition typeDefinition;
+
+  for (const auto& type : typeConfig.GetTypes()) {
+    if (type->CanBeNode()) {
+      if (styleConfig.HasNodeTextStyles(type,
+                                        magnification)) {
+        typeDefinition.nodeTypes.Set(type);
+      }
+    }
+
+    if (type->CanBeArea()) {
+      if (styleConfig.HasAreaTextStyles(type,
+                                        magnification)) {
+        if (type->GetOptimizeLowZoom() && searchParameter.GetUseLowZoomOptimization()) {
+          typeDefinition.optimizedAreaTypes.Set(type);
+        }
+        else {
+          typeDefinition.areaTypes.Set(type);
+        }
+      }
+    }
+  }
+
+  return typeDefinition;
+}
+
+/**
+ * Renders tiles into its own bitmap using its own MapPainterAgg, so each
+ * render thread gets one instance.
+ *
+ * To get accurate label drawing at tile borders, objects with labels of the
+ * ring of tiles around the current tile are drawn, too.
+ */
+class AggTilePainter : public osmscout::TileBatchPainter
+{
+private:
+  osmscout::MapServiceRef              mapService;
+  osmscout::StyleConfigRef             styleConfig;
+  const osmscout::MapParameter&        drawParameter;
+  const osmscout::AreaSearchParameter& searchParameter;
+  osmscout::MapPainterAgg              painter;
+  std::vector<unsigned char>           buffer;
+  agg::rendering_buffer                rbuf;
+  bool                                 hasTypeDefinition;
+  osmscout::Magnification              typeDefinitionMagnification;
+  osmscout::MapService::TypeDefinition typeDefinition;
+
+public:
+  AggTilePainter(const osmscout::MapServiceRef& mapService,
+                 const osmscout::StyleConfigRef& styleConfig,
+                 const osmscout::MapParameter& drawParameter,
+                 const osmscout::AreaSearchParameter& searchParameter)
+  : mapService(mapService),
+    styleConfig(styleConfig),
+    drawParameter(drawParameter),
+    searchParameter(searchParameter),
+    painter(styleConfig),
+    buffer(tileWidth*tileHeight*3),
+    rbuf(buffer.data(),
+         tileWidth,
+         tileHeight,
+         tileWidth*3),
+    hasTypeDefinition(false)
+  {
+    // no code
+  }
+
+  bool RenderTile(const osmscout::OSMTileId& tileId,
+                  const osmscout::TileProjection& projection,
+                  const osmscout::MapData& tileData,
+                  std::string& output) override
+  {
+    osmscout::Magnification magnification=projection.GetMagnification();
+
+    if (!hasTypeDefinition ||
+        typeDefinitionMagnification!=magnification) {
+      typeDefinition=GetLabelTypeDefinition(*styleConfig->GetTypeConfig(),
+                                            *styleConfig,
+                                            searchParameter,
+                                            magnification);
+      typeDefinitionMagnification=magnification;
+      hasTypeDefinition=true;
+    }
+
+    std::list<osmscout::TileRef> centerTiles;
+
+    mapService->LookupTiles(magnification,
+                            tileId.GetBoundingBox(magnification),
+                            centerTiles);
+
+    std::map<osmscout::TileKey,osmscout::TileRef> ringTileMap;
+
+    for (uint32_t ringY=tileId.GetY()-tileRingSize; ringY<=tileId.GetY()+tileRingSize; ringY++) {
+      for (uint32_t ringX=tileId.GetX()-tileRingSize; ringX<=tileId.GetX()+tileRingSize; ringX++) {
+        if (ringX==tileId.GetX() && ringY==tileId.GetY()) {
+          continue;
+        }
+
+        osmscout::GeoBox boundingBox(osmscout::OSMTileId(ringX,ringY).GetBoundingBox(magnification));
+
+        std::list<osmscout::TileRef> tiles;
+
+        mapService->LookupTiles(magnification,
+                                boundingBox,
+                                tiles);
+
+        for (const auto& tile : tiles) {
+          ringTileMap[tile->GetKey()]=tile;
+        }
+      }
+    }
+
+    std::list<osmscout::TileRef> ringTiles;
+
+    for (const auto& tileEntry : ringTileMap) {
+      ringTiles.push_back(tileEntry.second);
+    }
+
+    if (!mapService->LoadMissingTileData(searchParameter,
+                                         magnification,
+                                         typeDefinition,
+                                         ringTiles)) {
+      return false;
+    }
+
+    osmscout::MapData data;
+
+    MergeTilesToMapData(centerTiles,
+                        typeDefinition,
+                        ringTiles,
+                        data);
+
+    data.groundTiles=tileData.groundTiles;
+
+    std::fill(buffer.begin(),buffer.end(),0);
+
+    agg::pixfmt_rgb24 pf(rbuf);
+
+    if (!painter.DrawMap(projection,
+                         drawParameter,
+                         data,
+                         &pf)) {
+      return false;
+    }
+
+    output=EncodePPM(rbuf);
+
+    return true;
+  }
+};
+
 int main(int argc, char* argv[])
 {
   std::string  map;
@@ -182,13 +344,15 @@ int main(int argc, char* argv[])
   double       latTop,latBottom,lonLeft,lonRight;
   unsigned int startLevel;
   unsigned int endLevel;
+  std::string  outputDirectory=".";
+  unsigned int threadCount=std::max(1u,std::thread::hardware_concurrency());
 
-  if (argc!=9) {
-    std::cerr << "DrawMap ";
+  if (argc<9 || argc>11) {
+    std::cerr << "Tiler ";
     std::cerr << "<map directory> <style-file> ";
     std::cerr << "<lat_top> <lon_left> <lat_bottom> <lon_right> ";
-    std::cerr << "<start_zoom>" << std::endl;
-    std::cerr << "<end_zoom>" << std::endl;
+    std::cerr << "<start_zoom> <end_zoom> ";
+    std::cerr << "[<output directory> [<threads>]]" << std::endl;
     return 1;
   }
 
@@ -196,22 +360,22 @@ int main(int argc, char* argv[])
   style=argv[2];
 
   if (sscanf(argv[3],"%lf",&latTop)!=1) {
-    std::cerr << "lon is not numeric!" << std::endl;
+    std::cerr << "lat is not numeric!" << std::endl;
     return 1;
   }
 
   if (sscanf(argv[4],"%lf",&lonLeft)!=1) {
-    std::cerr << "lat is not numeric!" << std::endl;
+    std::cerr << "lon is not numeric!" << std::endl;
     return 1;
   }
 
   if (sscanf(argv[5],"%lf",&latBottom)!=1) {
-    std::cerr << "lon is not numeric!" << std::endl;
+    std::cerr << "lat is not numeric!" << std::endl;
     return 1;
   }
 
   if (sscanf(argv[6],"%lf",&lonRight)!=1) {
-    std::cerr << "lat is not numeric!" << std::endl;
+    std::cerr << "lon is not numeric!" << std::endl;
     return 1;
   }
 
@@ -225,6 +389,17 @@ int main(int argc, char* argv[])
     return 1;
   }
 
+  if (argc>9) {
+    outputDirectory=argv[9];
+  }
+
+  if (argc>10 &&
+      (sscanf(argv[10],"%u",&threadCount)!=1 ||
+       threadCount==0)) {
+    std::cerr << "thread count is not a positive number!" << std::endl;
+    return 1;
+  }
+
   osmscout::DatabaseParameter databaseParameter;
   osmscout::DatabaseRef       database=std::make_shared<osmscout::Database>(databaseParameter);
   osmscout::MapServiceRef     mapService=std::make_shared<osmscout::MapService>(database);
@@ -241,7 +416,6 @@ int main(int argc, char* argv[])
     std::cerr << "Cannot open style" << std::endl;
   }
 
-  osmscout::TileProjection      projection;
   osmscout::MapParameter        drawParameter;
   osmscout::AreaSearchParameter searchParameter;
 
@@ -258,185 +432,45 @@ int main(int argc, char* argv[])
   searchParameter.SetUseLowZoomOptimization(true);
   searchParameter.SetMaximumAreaLevel(3);
 
-  osmscout::MapPainterAgg painter(styleConfig);
-
-  for (osmscout::MagnificationLevel level=osmscout::MagnificationLevel(std::min(startLevel,endLevel));
-       level<=osmscout::MagnificationLevel(std::max(startLevel,endLevel));
-       level++) {
-    osmscout::Magnification magnification(level);
-
-    osmscout::OSMTileId     tileA(osmscout::OSMTileId::GetOSMTile(magnification,
-                                                                  osmscout::GeoCoord(latBottom,lonLeft)));
-    osmscout::OSMTileId     tileB(osmscout::OSMTileId::GetOSMTile(magnification,
-                                                                  osmscout::GeoCoord(latTop,lonRight)));
-    uint32_t                xTileStart=std::min(tileA.GetX(),tileB.GetX());
-    uint32_t                xTileEnd=std::max(tileA.GetX(),tileB.GetX());
-    uint32_t                xTileCount=xTileEnd-xTileStart+1;
-    uint32_t                yTileStart=std::min(tileA.GetY(),tileB.GetY());
-    uint32_t                yTileEnd=std::max(tileA.GetY(),tileB.GetY());
-    uint32_t                yTileCount=yTileEnd-yTileStart+1;
-
-    std::cout << "Drawing zoom " << level << ", " << (xTileCount)*(yTileCount) << " tiles [" << xTileStart << "," << yTileStart << " - " <<  xTileEnd << "," << yTileEnd << "]" << std::endl;
-
-    unsigned long bitmapSize=tileWidth*tileHeight*3*xTileCount*yTileCount;
-    unsigned char *buffer=new unsigned char[bitmapSize];
-
-
-    memset(buffer,0,bitmapSize);
-
-    agg::rendering_buffer rbuf(buffer,
-                               tileWidth*xTileCount,
-                               tileHeight*yTileCount,
-                               tileWidth*xTileCount*3);
-
-    double minTime=std::numeric_limits<double>::max();
-    double maxTime=0.0;
-    double totalTime=0.0;
-
-    osmscout::MapService::TypeDefinition typeDefinition;
-
-    for (const auto& type : database->GetTypeConfig()->GetTypes()) {
-      bool hasLabel=false;
-
-      if (type->CanBeNode()) {
-        if (styleConfig->HasNodeTextStyles(type,
-                                           magnification)) {
-          typeDefinition.nodeTypes.Set(type);
-          hasLabel=true;
-        }
-      }
-
-      if (type->CanBeArea()) {
-        if (styleConfig->HasAreaTextStyles(type,
-                                           magnification)) {
-          if (type->GetOptimizeLowZoom() && searchParameter.GetUseLowZoomOptimization()) {
-            typeDefinition.optimizedAreaTypes.Set(type);
-          }
-          else {
-            typeDefinition.areaTypes.Set(type);
-          }
-
-          hasLabel=true;
-        }
-      }
-
-      if (hasLabel) {
-        std::cout << "TYPE " << type->GetName() << " might have labels" << std::endl;
-      }
-    }
-
-    for (uint32_t y=yTileStart; y<=yTileEnd; y++) {
-      for (uint32_t x=xTileStart; x<=xTileEnd; x++) {
-        agg::pixfmt_rgb24   pf(rbuf);
-        osmscout::StopClock timer;
-        osmscout::GeoBox    boundingBox;
-        osmscout::MapData   data;
-
-        projection.Set(osmscout::OSMTileId(x,y),
-                       magnification,
-                       DPI,
-                       tileWidth,
-                       tileHeight);
-
-        projection.GetDimensions(boundingBox);
-
-        std::cout << "Drawing tile " << level << "." << y << "." << x << " " << boundingBox.GetDisplayText() << std::endl;
-
-
-        std::list<osmscout::TileRef> centerTiles;
-
-        mapService->LookupTiles(magnification,
-                                boundingBox,
-                                centerTiles);
-
-        mapService->LoadMissingTileData(searchParameter,
-                                        *styleConfig,
-                                        centerTiles);
-
-        std::map<osmscout::TileKey,osmscout::TileRef> ringTileMap;
-
-        for (uint32_t ringY=y-tileRingSize; ringY<=y+tileRingSize; ringY++) {
-          for (uint32_t ringX=x-tileRingSize; ringX<=x+tileRingSize; ringX++) {
-            if (ringX==x && ringY==y) {
-              continue;
-            }
-
-            osmscout::GeoBox boundingBox(osmscout::OSMTileId(ringX,ringY).GetBoundingBox(magnification));
-
-
-            std::list<osmscout::TileRef> tiles;
-
-            mapService->LookupTiles(magnification,
-                                    boundingBox,
-                                    tiles);
-
-            for (const auto& tile : tiles) {
-              ringTileMap[tile->GetKey()]=tile;
-            }
-          }
-        }
-
-        std::list<osmscout::TileRef> ringTiles;
-
-        for (const auto& tileEntry : ringTileMap) {
-          ringTiles.push_back(tileEntry.second);
-        }
-
-        mapService->LoadMissingTileData(searchParameter,
-                                        magnification,
-                                        typeDefinition,
-                                        ringTiles);
-
-        MergeTilesToMapData(centerTiles,
-                            typeDefinition,
-                            ringTiles,
-                            data);
-
-        size_t bufferOffset=xTileCount*tileWidth*3*(y-yTileStart)*tileHeight+
-                            (x-xTileStart)*tileWidth*3;
-
-        rbuf.attach(buffer+bufferOffset,
-                    tileWidth,tileHeight,
-                    tileWidth*xTileCount*3);
-
-        painter.DrawMap(projection,
-                        drawParameter,
-                        data,
-                        &pf);
-
-        timer.Stop();
-
-        double time=timer.GetMilliseconds();
-
-        minTime=std::min(minTime,time);
-        maxTime=std::max(maxTime,time);
-        totalTime+=time;
-
-        std::string output=std::to_string(level.Get())+"_"+std::to_string(x)+"_"+std::to_string(y)+".ppm";
-
-        write_ppm(rbuf,output.c_str());
-      }
-    }
-
-    rbuf.attach(buffer,
-                tileWidth*xTileCount,
-                tileHeight*yTileCount,
-                tileWidth*xTileCount*3);
-
-    std::string output=std::to_string(level.Get())+"_full_map.ppm";
-
-    write_ppm(rbuf,output.c_str());
-
-    delete[] buffer;
-
-    std::cout << "=> Time: ";
-    std::cout << "total: " << totalTime << " msec ";
-    std::cout << "min: " << minTime << " msec ";
-    std::cout << "avg: " << totalTime/(xTileCount*yTileCount) << " msec ";
-    std::cout << "max: " << maxTime << " msec" << std::endl;
-  }
+  osmscout::TileBatchParameter  parameter;
+  osmscout::FileTileBatchSink   sink(outputDirectory,"ppm");
+  osmscout::TileBatchStatistics statistics;
+
+  parameter.SetThreadCount(threadCount);
+  parameter.SetTileSize(tileWidth,tileHeight);
+  parameter.SetDPI(DPI);
+  parameter.SetSearchParameter(searchParameter);
+
+  osmscout::TileBatchRenderer renderer(mapService,
+                                       styleConfig,
+                                       parameter);
+
+  bool success=renderer.Render(osmscout::GeoBox(osmscout::GeoCoord(latTop,lonLeft),
+                                                osmscout::GeoCoord(latBottom,lonRight)),
+                               osmscout::MagnificationLevel(std::min(startLevel,endLevel)),
+                               osmscout::MagnificationLevel(std::max(startLevel,endLevel)),
+                               [&mapService,&styleConfig,&drawParameter,&searchParameter]() {
+                                 return std::make_shared<AggTilePainter>(mapService,
+                                                                         styleConfig,
+                                                                         drawParameter,
+                                                                         searchParameter);
+                               },
+                               sink,
+                               statistics);
+
+  std::cout << "=> " << statistics.tileCount << " tiles written, ";
+  std::cout << statistics.skippedTileCount << " skipped, ";
+  std::cout << statistics.failedTileCount << " failed" << std::endl;
+  std::cout << "=> " << statistics.GetTilesPerSecond() << " tiles/s, ";
+  std::cout << "data tile hit rate: " << statistics.GetDataTileHitRate()*100.0 << "%" << std::endl;
+  std::cout << "=> Time: ";
+  std::cout << "total: " << statistics.totalTime << " msec ";
+  std::cout << "load: " << statistics.loadTime << " msec ";
+  std::cout << "merge: " << statistics.mergeTime << " msec ";
+  std::cout << "render: " << statistics.renderTime << " msec ";
+  std::cout << "write: " << statistics.writeTime << " msec" << std::endl;
 
   database->Close();
 
-  return 0;
+  return success ? 0 : 1;
 }
@@ -0,0 +1,181 @@
+/*
+  VectorTiler - a demo program for libosmscout
+  Copyright (C) 2019  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <iostream>
+
+#include <osmscout/Database.h>
+#include <osmscout/MapService.h>
+#include <osmscout/TileBatchRenderer.h>
+#include <osmscout/VectorTile.h>
+
+/*
+  Example for the nordrhein-westfalen.osm (to be executed in the Demos top
+  level directory), exporting the "Ruhrgebiet" as vector tiles using 4 threads:
+
+  src/VectorTiler ../maps/nordrhein-westfalen ../stylesheets/standard.oss 51.2 6.5 51.7 8 10 13 . 4
+
+  Tiles are written as <zoom>_<x>_<y>.mvt into the given output directory.
+  Tiles already existing in the output directory are skipped, so an
+  interrupted export can be resumed by starting it again.
+*/
+
+class VectorTilePainter : public osmscout::TileBatchPainter
+{
+private:
+  const osmscout::VectorTileBuilder& builder;
+
+public:
+  explicit VectorTilePainter(const osmscout::VectorTileBuilder& builder)
+  : builder(builder)
+  {
+    // no code
+  }
+
+  bool RenderTile(const osmscout::OSMTileId& tileId,
+                  const osmscout::TileProjection& projection,
+                  const osmscout::MapData& data,
+                  std::string& output) override
+  {
+    osmscout::VectorTile tile(builder.GetExtent());
+
+    builder.Build(tileId,
+                  projection.GetMagnification(),
+                  data,
+                  tile);
+
+    output=tile.Encode();
+
+    return true;
+  }
+};
+
+int main(int argc, char* argv[])
+{
+  std::string  map;
+  std::string  style;
+  double       latTop,latBottom,lonLeft,lonRight;
+  unsigned int startLevel;
+  unsigned int endLevel;
+  std::string  outputDirectory;
+  unsigned int threadCount;
+
+  if (argc!=11) {
+    std::cerr << "VectorTiler ";
+    std::cerr << "<map directory> <style-file> ";
+    std::cerr << "<lat_top> <lon_left> <lat_bottom> <lon_right> ";
+    std::cerr << "<start_zoom> <end_zoom> ";
+    std::cerr << "<output directory> <threads>" << std::endl;
+    return 1;
+  }
+
+  map=argv[1];
+  style=argv[2];
+
+  if (sscanf(argv[3],"%lf",&latTop)!=1) {
+    std::cerr << "lat is not numeric!" << std::endl;
+    return 1;
+  }
+
+  if (sscanf(argv[4],"%lf",&lonLeft)!=1) {
+    std::cerr << "lon is not numeric!" << std::endl;
+    return 1;
+  }
+
+  if (sscanf(argv[5],"%lf",&latBottom)!=1) {
+    std::cerr << "lat is not numeric!" << std::endl;
+    return 1;
+  }
+
+  if (sscanf(argv[6],"%lf",&lonRight)!=1) {
+    std::cerr << "lon is not numeric!" << std::endl;
+    return 1;
+  }
+
+  if (sscanf(argv[7],"%u",&startLevel)!=1) {
+    std::cerr << "start zoom is not numeric!" << std::endl;
+    return 1;
+  }
+
+  if (sscanf(argv[8],"%u",&endLevel)!=1) {
+    std::cerr << "end zoom is not numeric!" << std::endl;
+    return 1;
+  }
+
+  outputDirectory=argv[9];
+
+  if (sscanf(argv[10],"%u",&threadCount)!=1 ||
+      threadCount==0) {
+    std::cerr << "thread count is not a positive number!" << std::endl;
+    return 1;
+  }
+
+  osmscout::DatabaseParameter databaseParameter;
+  osmscout::DatabaseRef       database=std::make_shared<osmscout::Database>(databaseParameter);
+  osmscout::MapServiceRef     mapService=std::make_shared<osmscout::MapService>(database);
+
+  if (!database->Open(map)) {
+    std::cerr << "Cannot open database" << std::endl;
+
+    return 1;
+  }
+
+  osmscout::StyleConfigRef styleConfig=std::make_shared<osmscout::StyleConfig>(database->GetTypeConfig());
+
+  if (!styleConfig->Load(style)) {
+    std::cerr << "Cannot open style" << std::endl;
+    return 1;
+  }
+
+  osmscout::VectorTileBuilder   builder(*database->GetTypeConfig());
+  osmscout::TileBatchParameter  parameter;
+  osmscout::FileTileBatchSink   sink(outputDirectory,"mvt");
+  osmscout::TileBatchStatistics statistics;
+
+  parameter.SetThreadCount(threadCount);
+
+  osmscout::TileBatchRenderer renderer(mapService,
+                                       styleConfig,
+                                       parameter);
+
+  bool success=renderer.Render(osmscout::GeoBox(osmscout::GeoCoord(latTop,lonLeft),
+                                                osmscout::GeoCoord(latBottom,lonRight)),
+                               osmscout::MagnificationLevel(startLevel),
+                               osmscout::MagnificationLevel(endLevel),
+                               [&builder]() {
+                                 return std::make_shared<VectorTilePainter>(builder);
+                               },
+                               sink,
+                               statistics);
+
+  std::cout << "=> " << statistics.tileCount << " tiles written, ";
+  std::cout << statistics.skippedTileCount << " skipped, ";
+  std::cout << statistics.failedTileCount << " failed" << std::endl;
+  std::cout << "=> " << statistics.GetTilesPerSecond() << " tiles/s, ";
+  std::cout << "data tile hit rate: " << statistics.GetDataTileHitRate()*100.0 << "%" << std::endl;
+  std::cout << "=> Time: ";
+  std::cout << "total: " << statistics.totalTime << " msec ";
+  std::cout << "load: " << statistics.loadTime << " msec ";
+  std::cout << "merge: " << statistics.mergeTime << " msec ";
+  std::cout << "render: " << statistics.renderTime << " msec ";
+  std::cout << "write: " << statistics.writeTime << " msec" << std::endl;
+
+  database->Close();
+
+  return success ? 0 : 1;
+}
@@ -17,6 +17,7 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 
+#include <algorithm>
 #include <cstring>
 #include <cstdio>
 
@@ -62,6 +63,8 @@ static std::string VehcileMaskToString(osmscout::VehicleMask vehicleMask)
 void DumpHelp(osmscout::ImportParameter& parameter)
 {
   std::cout << "Import -h -d -s <start step> -e <end step> [*.osm|*.pbf]..." << std::endl;
+  std::cout << "Import -h -d [*.osc]..." << std::endl;
+  std::cout << "  (applies node changes of OSM change files to the existing database in the destination directory)" << std::endl;
   std::cout << " -h|--help                            show this help and exit" << std::endl;
   std::cout << " --data-version                       print output data version and exit" << std::endl;
   std::cout << " -d                                   show debug output during import" << std::endl;
@@ -79,6 +82,7 @@ void DumpHelp(osmscout::ImportParameter& parameter)
   std::cout << " --strictAreas true|false             assure that areas are simple (default: " << osmscout::BoolToString(parameter.GetStrictAreas()) << ")" << std::endl;
 
   std::cout << " --processingQueueSize <number>       size of of the processing worker queues (default: " << parameter.GetProcessingQueueSize() << ")" << std::endl;
+  std::cout << " --maxParallelModules <number>        number of independent import steps executed in parallel (default: " << parameter.GetMaxParallelModules() << ")" << std::endl;
   std::cout << std::endl;
 
   std::cout << " --numericIndexPageSize <number>      size of an numeric index page in bytes (default: " << parameter.GetNumericIndexPageSize() << ")" << std::endl;
@@ -91,11 +95,13 @@ void DumpHelp(osmscout::ImportParameter& parameter)
   std::cout << " --rawWayDataMemoryMaped true|false   memory maped raw way data file access (default: " << osmscout::BoolToString(parameter.GetRawWayDataMemoryMaped()) << ")" << std::endl;
   std::cout << " --rawWayIndexCacheSize <number>      raw way index cache size (default: " << parameter.GetRawWayIndexCacheSize() << ")" << std::endl;
   std::cout << " --rawWayBlockSize <number>           number of raw ways resolved in block (default: " << parameter.GetRawWayBlockSize() << ")" << std::endl;
+  std::cout << " --rawRelationBlockSize <number>      number of raw relations resolved in block (default: " << parameter.GetRawRelationBlockSize() << ")" << std::endl;
 
   std::cout << " --noSort                             do not sort objects" << std::endl;
   std::cout << " --sortBlockSize <number>             size of one data block during sorting (default: " << parameter.GetSortBlockSize() << ")" << std::endl;
 
   std::cout << " --coordDataMemoryMaped true|false    memory maped coord data file access (default: " << osmscout::BoolToString(parameter.GetCoordDataMemoryMaped()) << ")" << std::endl;
+  std::cout << " --coordDataDense true|false          store coords in a dense array indexed by node id (default: " << osmscout::BoolToString(parameter.GetCoordDataDense()) << ")" << std::endl;
   std::cout << " --coordIndexCacheSize <number>       coord index cache size (default: " << parameter.GetCoordIndexCacheSize() << ")" << std::endl;
   std::cout << " --coordBlockSize <number>            number of coords resolved in block (default: " << parameter.GetCoordBlockSize() << ")" << std::endl;
 
@@ -108,6 +114,11 @@ void DumpHelp(osmscout::ImportParameter& parameter)
   std::cout << " --wayDataMemoryMaped true|false      memory maped way data file access (default: " << osmscout::BoolToString(parameter.GetWayDataMemoryMaped()) << ")" << std::endl;
   std::cout << " --wayDataCacheSize <number>          way data cache size (default: " << parameter.GetWayDataCacheSize() << ")" << std::endl;
 
+  std::cout << " --compressDataFiles true|false       store node, way, area and routing data block compressed (default: " << osmscout::BoolToString(parameter.GetCompressDataFiles()) << ")" << std::endl;
+  std::cout << " --compressionBlockSize <number>      uncompressed size of a compressed block (default: " << parameter.GetCompressionBlockSize() << ")" << std::endl;
+  std::cout << std::endl;
+  std::cout << " --objectBoxIndex true|false          generate bounding box index files for ways and areas (default: " << osmscout::BoolToString(parameter.GetObjectBoxIndex()) << ")" << std::endl;
+
   std::cout << " --routeNodeBlockSize <number>        number of route nodes resolved in block (default: " << parameter.GetRouteNodeBlockSize() << ")" << std::endl;
   std::cout << std::endl;
   std::cout << " --langOrder <#|lang1[,#|lang2]..>    language order when parsing lang[:language] and place_name[:language] tags" << std::endl
@@ -266,6 +277,9 @@ static void DumpParameter(const osmscout::ImportParameter& parameter,
   progress.Info(std::string("ProcessingQueueSize: ")+
                 std::to_string(parameter.GetProcessingQueueSize()));
 
+  progress.Info(std::string("MaxParallelModules: ")+
+                std::to_string(parameter.GetMaxParallelModules()));
+
   progress.Info(std::string("NumericIndexPageSize: ")+
                 std::to_string(parameter.GetNumericIndexPageSize()));
 
@@ -283,6 +297,8 @@ static void DumpParameter(const osmscout::ImportParameter& parameter,
                 std::to_string(parameter.GetRawWayIndexCacheSize()));
   progress.Info(std::string("RawWayBlockSize: ")+
                 std::to_string(parameter.GetRawWayBlockSize()));
+  progress.Info(std::string("RawRelationBlockSize: ")+
+                std::to_string(parameter.GetRawRelationBlockSize()));
 
 
   progress.Info(std::string("SortObjects: ")+
@@ -292,6 +308,8 @@ static void DumpParameter(const osmscout::ImportParameter& parameter,
 
   progress.Info(std::string("CoordDataMemoryMaped: ")+
                 (parameter.GetCoordDataMemoryMaped() ? "true" : "false"));
+  progress.Info(std::string("CoordDataDense: ")+
+                (parameter.GetCoordDataDense() ? "true" : "false"));
   progress.Info(std::string("CoordIndexCacheSize: ")+
                 std::to_string(parameter.GetCoordIndexCacheSize()));
   progress.Info(std::string("CoordBlockSize: ")+
@@ -307,6 +325,14 @@ static void DumpParameter(const osmscout::ImportParameter& parameter,
   progress.Info(std::string("WayDataCacheSize: ")+
                 std::to_string(parameter.GetWayDataCacheSize()));
 
+  progress.Info(std::string("CompressDataFiles: ")+
+                (parameter.GetCompressDataFiles() ? "true" : "false"));
+  progress.Info(std::string("CompressionBlockSize: ")+
+                std::to_string(parameter.GetCompressionBlockSize()));
+
+  progress.Info(std::string("ObjectBoxIndex: ")+
+                (parameter.GetObjectBoxIndex() ? "true" : "false"));
+
   progress.Info("AreaNodeGridMag: "+
                 std::to_string(parameter.GetAreaNodeGridMag().Get()));
   progress.Info("AreaNodeSimpleListLimit: "+
@@ -559,6 +585,19 @@ int main(int argc, char* argv[])
         parameterError=true;
       }
     }
+    else if (strcmp(argv[i],"--maxParallelModules")==0) {
+      size_t maxParallelModules;
+
+      if (osmscout::ParseSizeTArgument(argc,
+                                       argv,
+                                       i,
+                                       maxParallelModules)) {
+        parameter.SetMaxParallelModules(maxParallelModules);
+      }
+      else {
+        parameterError=true;
+      }
+    }
     else if (strcmp(argv[i],"--numericIndexPageSize")==0) {
       size_t numericIndexPageSize;
 
@@ -650,6 +689,19 @@ int main(int argc, char* argv[])
         parameterError=true;
       }
     }
+    else if (strcmp(argv[i],"--rawRelationBlockSize")==0) {
+      size_t rawRelationBlockSize;
+
+      if (osmscout::ParseSizeTArgument(argc,
+                                       argv,
+                                       i,
+                                       rawRelationBlockSize)) {
+        parameter.SetRawRelationBlockSize(rawRelationBlockSize);
+      }
+      else {
+        parameterError=true;
+      }
+    }
     else if (strcmp(argv[i],"-noSort")==0) {
       parameter.SetSortObjects(false);
 
@@ -681,6 +733,19 @@ int main(int argc, char* argv[])
         parameterError=true;
       }
     }
+    else if (strcmp(argv[i],"--coordDataDense")==0) {
+      bool coordDataDense;
+
+      if (osmscout::ParseBoolArgument(argc,
+                                      argv,
+                                      i,
+                                      coordDataDense)) {
+        parameter.SetCoordDataDense(coordDataDense);
+      }
+      else {
+        parameterError=true;
+      }
+    }
     else if (strcmp(argv[i],"--coordIndexCacheSize")==0) {
       size_t coordIndexCacheSize;
 
@@ -785,6 +850,45 @@ int main(int argc, char* argv[])
         parameterError=true;
       }
     }
+    else if (strcmp(argv[i],"--compressDataFiles")==0) {
+      bool compressDataFiles;
+
+      if (osmscout::ParseBoolArgument(argc,
+                                      argv,
+                                      i,
+                                      compressDataFiles)) {
+        parameter.SetCompressDataFiles(compressDataFiles);
+      }
+      else {
+        parameterError=true;
+      }
+    }
+    else if (strcmp(argv[i],"--compressionBlockSize")==0) {
+      size_t compressionBlockSize;
+
+      if (osmscout::ParseSizeTArgument(argc,
+                                       argv,
+                                       i,
+                                       compressionBlockSize)) {
+        parameter.SetCompressionBlockSize(compressionBlockSize);
+      }
+      else {
+        parameterError=true;
+      }
+    }
+    else if (strcmp(argv[i],"--objectBoxIndex")==0) {
+      bool objectBoxIndex;
+
+      if (osmscout::ParseBoolArgument(argc,
+                                      argv,
+                                      i,
+                                      objectBoxIndex)) {
+        parameter.SetObjectBoxIndex(objectBoxIndex);
+      }
+      else {
+        parameterError=true;
+      }
+    }
     else if (strcmp(argv[i],"--routeNodeBlockSize")==0) {
       size_t routeNodeBlockSize;
 
@@ -932,9 +1036,44 @@ int main(int argc, char* argv[])
     // we ignore this exception, since it is likely a "not implemented" exception
   }
 
+  size_t changeFileCount=std::count_if(mapfiles.begin(),
+                                       mapfiles.end(),
+                                       [](const std::string& mapfile) {
+                                         return mapfile.length()>=4 &&
+                                                mapfile.substr(mapfile.length()-4)==".osc";
+                                       });
+
+  if (changeFileCount>0 &&
+      changeFileCount!=mapfiles.size()) {
+    progress.Error("Change files (*.osc) cannot be mixed with other input files!");
+    return 1;
+  }
+
   parameter.SetMapfiles(mapfiles);
   parameter.SetOptimizationWayMethod(osmscout::TransPolygon::quality);
 
+  if (changeFileCount>0) {
+    int exitCode=0;
+
+    try {
+      osmscout::Importer importer(parameter);
+
+      if (importer.Update(progress)) {
+        progress.Info("Update OK!");
+      }
+      else {
+        progress.Error("Update failed!");
+        exitCode=1;
+      }
+    }
+    catch (osmscout::IOException& e) {
+      progress.Error("Update failed: "+e.GetDescription());
+      exitCode=1;
+    }
+
+    return exitCode;
+  }
+
   DumpParameter(parameter,
                 progress);
 
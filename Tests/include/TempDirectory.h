@@ -0,0 +1,115 @@
+#ifndef TEMP_DIRECTORY_H
+#define TEMP_DIRECTORY_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <cstdlib>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__WIN32__) || defined(WIN32)
+#include <direct.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <osmscout/util/File.h>
+
+/**
+ * Uniquely named directory for the files written by a test. All files
+ * requested via GetFile() and the directory itself are removed, when the
+ * instance is destroyed.
+ */
+class TempDirectory
+{
+private:
+  std::string           path;
+  std::set<std::string> files;
+
+public:
+  TempDirectory()
+  {
+#if defined(__WIN32__) || defined(WIN32)
+    const char* tmp=std::getenv("TEMP");
+    std::string pattern=std::string(tmp!=nullptr ? tmp : ".")+"\\osmscout-test-XXXXXX";
+    std::vector<char> name(pattern.begin(),pattern.end());
+
+    name.push_back('\0');
+
+    if (_mktemp_s(name.data(),name.size())!=0 ||
+        _mkdir(name.data())!=0) {
+      throw std::runtime_error("Cannot create temporary directory");
+    }
+#else
+    const char* tmp=std::getenv("TMPDIR");
+    std::string pattern=std::string(tmp!=nullptr ? tmp : "/tmp")+"/osmscout-test-XXXXXX";
+    std::vector<char> name(pattern.begin(),pattern.end());
+
+    name.push_back('\0');
+
+    if (mkdtemp(name.data())==nullptr) {
+      throw std::runtime_error("Cannot create temporary directory");
+    }
+#endif
+
+    path=name.data();
+  }
+
+  TempDirectory(const TempDirectory&) = delete;
+  TempDirectory& operator=(const TempDirectory&) = delete;
+
+  ~TempDirectory()
+  {
+    for (const auto& file : files) {
+      if (osmscout::ExistsInFilesystem(file)) {
+        osmscout::RemoveFile(file);
+      }
+    }
+
+#if defined(__WIN32__) || defined(WIN32)
+    _rmdir(path.c_str());
+#else
+    rmdir(path.c_str());
+#endif
+  }
+
+  const std::string& GetPath() const
+  {
+    return path;
+  }
+
+  /**
+   * Return the full path of the given file in the directory and remember
+   * it for removal
+   */
+  std::string GetFile(const std::string& filename)
+  {
+    std::string file=osmscout::AppendFileToDir(path,filename);
+
+    files.insert(file);
+
+    return file;
+  }
+};
+
+#endif
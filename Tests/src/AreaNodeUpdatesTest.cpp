@@ -0,0 +1,83 @@
+#include <vector>
+
+#include <osmscout/AreaNodeUpdates.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+using namespace osmscout;
+
+static const std::string directory=".";
+
+TEST_CASE("Entries are replaced and erased by OSM id")
+{
+  AreaNodeUpdates updates;
+
+  REQUIRE(updates.IsEmpty());
+
+  updates.Set(AreaNodeUpdates::Entry{20,1,GeoCoord(50.0,7.0),1000});
+  updates.Set(AreaNodeUpdates::Entry{10,1,GeoCoord(50.1,7.1),1100});
+  updates.Set(AreaNodeUpdates::Entry{20,2,GeoCoord(50.2,7.2),1200});
+
+  REQUIRE(updates.GetEntries().size()==2);
+  REQUIRE(updates.GetEntries()[0].id==10);
+  REQUIRE(updates.Find(20)!=nullptr);
+  REQUIRE(updates.Find(20)->type==2);
+  REQUIRE(updates.Find(20)->fileOffset==1200);
+  REQUIRE(updates.Find(30)==nullptr);
+
+  REQUIRE(updates.Erase(10));
+  REQUIRE_FALSE(updates.Erase(10));
+  REQUIRE(updates.Find(10)==nullptr);
+}
+
+TEST_CASE("Removed offsets are filtered and added nodes are appended")
+{
+  AreaNodeUpdates         updates;
+  std::vector<FileOffset> offsets={1,2,3,4};
+
+  updates.Remove(3);
+  updates.Remove(2);
+  updates.Remove(3);
+
+  REQUIRE(updates.GetRemovedCount()==2);
+  REQUIRE(updates.IsRemoved(2));
+  REQUIRE_FALSE(updates.IsRemoved(4));
+
+  updates.Set(AreaNodeUpdates::Entry{1,5,GeoCoord(50.0,7.0),100});
+  updates.Set(AreaNodeUpdates::Entry{2,5,GeoCoord(60.0,7.0),200});
+  updates.Set(AreaNodeUpdates::Entry{3,6,GeoCoord(50.0,7.0),300});
+
+  GeoBox boundingBox(GeoCoord(49.0,6.0),GeoCoord(51.0,8.0));
+
+  // Offsets before the start index belong to another type and are not touched
+  REQUIRE(updates.Apply(5,boundingBox,2,offsets));
+  REQUIRE(offsets==std::vector<FileOffset>({1,2,4,100}));
+
+  REQUIRE_FALSE(updates.Apply(7,boundingBox,4,offsets));
+  REQUIRE(offsets.size()==4);
+}
+
+TEST_CASE("Updates survive storing and loading")
+{
+  AreaNodeUpdates updates;
+  AreaNodeUpdates loaded;
+
+  updates.Remove(42);
+  updates.Set(AreaNodeUpdates::Entry{-7,3,GeoCoord(50.5,7.5),4711});
+
+  REQUIRE(updates.Store(directory));
+  REQUIRE(loaded.Load(directory));
+
+  REQUIRE(loaded.IsRemoved(42));
+  REQUIRE(loaded.GetEntries().size()==1);
+  REQUIRE(loaded.Find(-7)!=nullptr);
+  REQUIRE(loaded.Find(-7)->type==3);
+  REQUIRE(loaded.Find(-7)->fileOffset==4711);
+  REQUIRE(loaded.Find(-7)->coord.GetLat()==Approx(50.5));
+
+  // Storing no updates removes the file
+  REQUIRE(AreaNodeUpdates().Store(directory));
+  REQUIRE(loaded.Load(directory));
+  REQUIRE(loaded.IsEmpty());
+}
@@ -0,0 +1,137 @@
+#include <string>
+#include <vector>
+
+#include <osmscout/util/BlockCompression.h>
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+using namespace osmscout;
+
+static const std::string filename="BlockCompressionTest.dat";
+
+static const uint32_t blockSize=256;
+static const uint32_t valueCount=1000;
+
+/**
+ * Write a file with variable length numbers and strings, crossing block
+ * boundaries, and return the offset of each value and the end offset.
+ */
+static std::vector<FileOffset> WriteTestFile()
+{
+  std::vector<FileOffset> offsets;
+  FileWriter              writer;
+
+  writer.Open(filename);
+
+  for (uint32_t i=0; i<valueCount; i++) {
+    offsets.push_back(writer.GetPos());
+    writer.WriteNumber(i*i);
+    writer.Write("value "+std::to_string(i));
+  }
+
+  offsets.push_back(writer.GetPos());
+
+  writer.Close();
+
+  return offsets;
+}
+
+static void CheckValue(FileScanner& scanner,
+                       uint32_t i)
+{
+  uint32_t    number;
+  std::string text;
+
+  scanner.ReadNumber(number);
+  scanner.Read(text);
+
+  REQUIRE(number==i*i);
+  REQUIRE(text=="value "+std::to_string(i));
+}
+
+TEST_CASE("Compressed files are read sequentially like the original")
+{
+  if (!IsBlockCompressionSupported()) {
+    return;
+  }
+
+  WriteTestFile();
+
+  FileOffset uncompressedSize=GetFileSize(filename);
+
+  REQUIRE_FALSE(IsBlockCompressedFile(filename));
+
+  CompressFile(filename,blockSize,6);
+
+  REQUIRE(IsBlockCompressedFile(filename));
+
+  // Compressing again is a no-op
+  CompressFile(filename,blockSize,6);
+
+  FileScanner scanner;
+
+  scanner.Open(filename,FileScanner::Sequential,true);
+
+  REQUIRE(scanner.IsCompressed());
+
+  for (uint32_t i=0; i<valueCount; i++) {
+    CheckValue(scanner,i);
+  }
+
+  REQUIRE(scanner.GetPos()==uncompressedSize);
+  REQUIRE(scanner.IsEOF());
+
+  scanner.Close();
+
+  REQUIRE(RemoveFile(filename));
+}
+
+TEST_CASE("Offsets of the original file are valid for random access")
+{
+  if (!IsBlockCompressionSupported()) {
+    return;
+  }
+
+  std::vector<FileOffset> offsets=WriteTestFile();
+
+  CompressFile(filename,blockSize,6);
+
+  FileScanner scanner;
+
+  scanner.Open(filename,FileScanner::LowMemRandom,false);
+
+  // Jump back and forth, so that blocks are evicted from and found in the cache
+  for (uint32_t step=0; step<valueCount; step++) {
+    uint32_t i=(step*337)%valueCount;
+
+    scanner.SetPos(offsets[i]);
+    CheckValue(scanner,i);
+    REQUIRE(scanner.GetPos()==offsets[i+1]);
+  }
+
+  scanner.Close();
+
+  REQUIRE(RemoveFile(filename));
+}
+
+TEST_CASE("Uncompressed files are not affected")
+{
+  std::vector<FileOffset> offsets=WriteTestFile();
+
+  FileScanner scanner;
+
+  scanner.Open(filename,FileScanner::LowMemRandom,false);
+
+  REQUIRE_FALSE(scanner.IsCompressed());
+
+  scanner.SetPos(offsets[valueCount/2]);
+  CheckValue(scanner,valueCount/2);
+
+  scanner.Close();
+
+  REQUIRE(RemoveFile(filename));
+}
@@ -0,0 +1,100 @@
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <osmscout/import/ExternalSort.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+using namespace osmscout;
+
+static std::vector<uint64_t> GetRandomValues(size_t count)
+{
+  std::mt19937_64       generator(4711);
+  std::vector<uint64_t> values;
+
+  values.reserve(count);
+
+  for (size_t i=0; i<count; i++) {
+    values.push_back(generator()%(count/2));
+  }
+
+  return values;
+}
+
+static void CheckSort(size_t count,
+                      size_t runSize,
+                      size_t threadCount,
+                      size_t expectedRunCount)
+{
+  std::vector<uint64_t>    values=GetRandomValues(count);
+  ExternalSorter<uint64_t> sorter(".","ExternalSortTest",runSize,threadCount);
+
+  for (const auto value : values) {
+    sorter.Add(value);
+  }
+
+  sorter.Sort();
+
+  REQUIRE(sorter.GetCount()==count);
+  REQUIRE(sorter.GetRunCount()==expectedRunCount);
+
+  std::sort(values.begin(),values.end());
+
+  uint64_t value;
+  size_t   index=0;
+
+  while (sorter.Next(value)) {
+    REQUIRE(index<values.size());
+    REQUIRE(value==values[index]);
+    index++;
+  }
+
+  REQUIRE(index==count);
+
+  sorter.Close();
+
+  REQUIRE_FALSE(ExistsInFilesystem("ExternalSortTest_0.tmp"));
+}
+
+TEST_CASE("Sort empty input")
+{
+  CheckSort(0,1000,1,0);
+}
+
+TEST_CASE("Sort in memory")
+{
+  CheckSort(1000000,2000000,4,0);
+}
+
+TEST_CASE("Sort using multiple runs")
+{
+  CheckSort(1000000,300000,4,4);
+}
+
+TEST_CASE("Sort using many small runs")
+{
+  CheckSort(10000,7,1,1429+11);
+}
+
+TEST_CASE("Sort with custom order")
+{
+  ExternalSorter<uint32_t,std::greater<uint32_t>> sorter(".","ExternalSortTest",10,2);
+
+  for (uint32_t i=0; i<100; i++) {
+    sorter.Add(i);
+  }
+
+  sorter.Sort();
+
+  uint32_t expected=99;
+  uint32_t value;
+
+  while (sorter.Next(value)) {
+    REQUIRE(value==expected);
+    expected--;
+  }
+
+  REQUIRE(expected==std::numeric_limits<uint32_t>::max());
+}
@@ -0,0 +1,228 @@
+#include <string>
+#include <utility>
+
+#include <osmscout/TypeConfig.h>
+#include <osmscout/TypeFeatures.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+using namespace osmscout;
+
+/**
+ * Simple feature without value, only used to give types an arbitrary number
+ * of feature bits
+ */
+class FlagFeature : public Feature
+{
+private:
+  std::string name;
+
+public:
+  explicit FlagFeature(const std::string& name)
+  : name(name)
+  {
+    // no code
+  }
+
+  void Initialize(TagRegistry& /*tagRegistry*/) override
+  {
+    // no code
+  }
+
+  std::string GetName() const override
+  {
+    return name;
+  }
+
+  void Parse(TagErrorReporter& /*reporter*/,
+             const TagRegistry& /*tagRegistry*/,
+             const FeatureInstance& /*feature*/,
+             const ObjectOSMRef& /*object*/,
+             const TagMap& /*tags*/,
+             FeatureValueBuffer& /*buffer*/) const override
+  {
+    // no code
+  }
+};
+
+/**
+ * Return a type with a name feature (with value) followed by the given
+ * number of flag features
+ */
+static TypeInfoRef CreateType(const std::string& name,
+                              size_t flagCount)
+{
+  TypeInfoRef type=std::make_shared<TypeInfo>(name);
+
+  type->AddFeature(std::make_shared<NameFeature>());
+
+  for (size_t i=0; i<flagCount; i++) {
+    type->AddFeature(std::make_shared<FlagFeature>(name+"_flag"+std::to_string(i)));
+  }
+
+  return type;
+}
+
+/**
+ * Set the name and every third flag of the buffer
+ */
+static void Fill(FeatureValueBuffer& buffer,
+                 const std::string& name)
+{
+  auto* value=dynamic_cast<NameFeatureValue*>(buffer.AllocateValue(0));
+
+  REQUIRE(value!=nullptr);
+
+  value->SetName(name);
+
+  for (size_t idx=1; idx<buffer.GetFeatureCount(); idx+=3) {
+    buffer.AllocateValue(idx);
+  }
+}
+
+static void Check(const FeatureValueBuffer& buffer,
+                  const TypeInfoRef& type,
+                  const std::string& name)
+{
+  REQUIRE(buffer.GetType()==type);
+  REQUIRE(buffer.HasFeature(0));
+
+  auto* value=dynamic_cast<NameFeatureValue*>(buffer.GetValue(0));
+
+  REQUIRE(value!=nullptr);
+  REQUIRE(value->GetName()==name);
+
+  for (size_t idx=1; idx<buffer.GetFeatureCount(); idx++) {
+    REQUIRE(buffer.HasFeature(idx)==((idx-1)%3==0));
+  }
+}
+
+TEST_CASE("Feature masks are stored inline or on the heap depending on size")
+{
+  TypeInfoRef inlineType=CreateType("inline",10);
+  TypeInfoRef heapType=CreateType("heap",100);
+
+  REQUIRE(inlineType->GetFeatureMaskBytes()<=FeatureValueBuffer::INLINE_FEATURE_MASK_BYTES);
+  REQUIRE(heapType->GetFeatureMaskBytes()>FeatureValueBuffer::INLINE_FEATURE_MASK_BYTES);
+
+  FeatureValueBuffer inlineBuffer;
+  FeatureValueBuffer heapBuffer;
+
+  inlineBuffer.SetType(inlineType);
+  heapBuffer.SetType(heapType);
+
+  Fill(inlineBuffer,"inline");
+  Fill(heapBuffer,"heap");
+
+  SECTION("Copy construction of an inline mask") {
+    FeatureValueBuffer copy(inlineBuffer);
+
+    Check(copy,inlineType,"inline");
+    REQUIRE(copy==inlineBuffer);
+
+    // The copy must not share the mask of the original
+    copy.FreeValue(1);
+    REQUIRE_FALSE(copy.HasFeature(1));
+    REQUIRE(inlineBuffer.HasFeature(1));
+  }
+
+  SECTION("Copy construction of a heap mask") {
+    FeatureValueBuffer copy(heapBuffer);
+
+    Check(copy,heapType,"heap");
+    REQUIRE(copy==heapBuffer);
+
+    copy.FreeValue(100);
+    REQUIRE_FALSE(copy.HasFeature(100));
+    REQUIRE(heapBuffer.HasFeature(100));
+  }
+
+  SECTION("Assignment between buffers of the same kind") {
+    FeatureValueBuffer inlineCopy;
+    FeatureValueBuffer heapCopy;
+
+    inlineCopy.SetType(inlineType);
+    heapCopy.SetType(heapType);
+
+    inlineCopy=inlineBuffer;
+    heapCopy=heapBuffer;
+
+    Check(inlineCopy,inlineType,"inline");
+    Check(heapCopy,heapType,"heap");
+  }
+
+  SECTION("Assignment from a heap mask to an inline mask and back") {
+    FeatureValueBuffer buffer(inlineBuffer);
+
+    buffer=heapBuffer;
+    Check(buffer,heapType,"heap");
+
+    buffer=inlineBuffer;
+    Check(buffer,inlineType,"inline");
+
+    buffer=heapBuffer;
+    Check(buffer,heapType,"heap");
+  }
+
+  SECTION("Self assignment keeps the values") {
+    FeatureValueBuffer& inlineAlias=inlineBuffer;
+    FeatureValueBuffer& heapAlias=heapBuffer;
+
+    inlineBuffer=inlineAlias;
+    heapBuffer=heapAlias;
+
+    Check(inlineBuffer,inlineType,"inline");
+    Check(heapBuffer,heapType,"heap");
+  }
+
+  // Original buffers are unchanged by any of the operations above
+  Check(inlineBuffer,inlineType,"inline");
+  Check(heapBuffer,heapType,"heap");
+}
+
+TEST_CASE("Moving a buffer takes over the mask and the values")
+{
+  TypeInfoRef inlineType=CreateType("inline",10);
+  TypeInfoRef heapType=CreateType("heap",100);
+
+  FeatureValueBuffer inlineBuffer;
+  FeatureValueBuffer heapBuffer;
+
+  inlineBuffer.SetType(inlineType);
+  heapBuffer.SetType(heapType);
+
+  Fill(inlineBuffer,"inline");
+  Fill(heapBuffer,"heap");
+
+  SECTION("Move construction") {
+    FeatureValueBuffer inlineMoved(std::move(inlineBuffer));
+    FeatureValueBuffer heapMoved(std::move(heapBuffer));
+
+    Check(inlineMoved,inlineType,"inline");
+    Check(heapMoved,heapType,"heap");
+    REQUIRE(!inlineBuffer.GetType());
+    REQUIRE(!heapBuffer.GetType());
+  }
+
+  SECTION("Move assignment replaces the previous values") {
+    FeatureValueBuffer buffer(inlineBuffer);
+
+    buffer=std::move(heapBuffer);
+    Check(buffer,heapType,"heap");
+    REQUIRE(!heapBuffer.GetType());
+
+    buffer=std::move(inlineBuffer);
+    Check(buffer,inlineType,"inline");
+    REQUIRE(!inlineBuffer.GetType());
+  }
+
+  SECTION("A moved from buffer can be used again") {
+    FeatureValueBuffer moved(std::move(inlineBuffer));
+
+    inlineBuffer.SetType(heapType);
+    Fill(inlineBuffer,"reused");
+    Check(inlineBuffer,heapType,"reused");
+    Check(moved,inlineType,"inline");
+  }
+}
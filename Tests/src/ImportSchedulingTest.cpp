@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <osmscout/TypeConfig.h>
+
+#include <osmscout/import/Import.h>
+
+#include <osmscout/util/Progress.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+using namespace osmscout;
+
+/**
+ * Shared state of all test modules of an import run
+ */
+struct ExecutionLog
+{
+  std::mutex              mutex;
+  std::condition_variable condition;
+  std::vector<std::string> started;
+  std::vector<std::string> finished;
+  size_t                  running=0;
+  size_t                  maxRunning=0;
+
+  bool IsStarted(const std::string& name) const
+  {
+    return std::find(started.begin(),started.end(),name)!=started.end();
+  }
+
+  bool IsFinished(const std::string& name) const
+  {
+    return std::find(finished.begin(),finished.end(),name)!=finished.end();
+  }
+
+  size_t GetStartIndex(const std::string& name) const
+  {
+    return std::find(started.begin(),started.end(),name)-started.begin();
+  }
+
+  size_t GetFinishIndex(const std::string& name) const
+  {
+    return std::find(finished.begin(),finished.end(),name)-finished.begin();
+  }
+};
+
+class TestModule : public ImportModule
+{
+private:
+  ExecutionLog&            log;
+  std::string              name;
+  std::vector<std::string> requiredFiles;
+  std::string              waitFor;  //!< Module that must start while this module is running
+  bool                     fail;
+
+public:
+  TestModule(ExecutionLog& log,
+             const std::string& name,
+             const std::vector<std::string>& requiredFiles,
+             const std::string& waitFor="",
+             bool fail=false)
+  : log(log),
+    name(name),
+    requiredFiles(requiredFiles),
+    waitFor(waitFor),
+    fail(fail)
+  {
+    // no code
+  }
+
+  void GetDescription(const ImportParameter& /*parameter*/,
+                      ImportModuleDescription& description) const override
+  {
+    description.SetName(name);
+    description.SetDescription("Test module "+name);
+
+    for (const auto& file : requiredFiles) {
+      description.AddRequiredFile(file);
+    }
+
+    description.AddProvidedFile(name+".dat");
+  }
+
+  bool Import(const TypeConfigRef& /*typeConfig*/,
+              const ImportParameter& /*parameter*/,
+              Progress& /*progress*/) override
+  {
+    std::unique_lock<std::mutex> lock(log.mutex);
+
+    log.started.push_back(name);
+    log.running++;
+    log.maxRunning=std::max(log.maxRunning,log.running);
+    log.condition.notify_all();
+
+    if (!waitFor.empty()) {
+      log.condition.wait_for(lock,
+                             std::chrono::seconds(30),
+                             [this]() {
+                               return log.IsStarted(waitFor);
+                             });
+    }
+
+    log.running--;
+    log.finished.push_back(name);
+    log.condition.notify_all();
+
+    return !fail;
+  }
+};
+
+/**
+ * Modules "a" and "b" are independent, "c" requires both, "d" only "a"
+ */
+static std::vector<ImportModuleRef> GetModules(ExecutionLog& log,
+                                               bool waitForEachOther,
+                                               bool failA)
+{
+  return {
+    std::make_shared<TestModule>(log,"a",std::vector<std::string>(),waitForEachOther ? "b" : "",failA),
+    std::make_shared<TestModule>(log,"b",std::vector<std::string>(),waitForEachOther ? "a" : ""),
+    std::make_shared<TestModule>(log,"c",std::vector<std::string>{"a.dat","b.dat"}),
+    std::make_shared<TestModule>(log,"d",std::vector<std::string>{"a.dat"})
+  };
+}
+
+static bool Execute(const std::vector<ImportModuleRef>& modules,
+                    size_t maxParallelModules)
+{
+  ImportParameter parameter;
+  SilentProgress  progress;
+
+  parameter.SetMaxParallelModules(maxParallelModules);
+
+  Importer importer(parameter,
+                    modules);
+
+  return importer.ExecuteModules(std::make_shared<TypeConfig>(),
+                                 progress);
+}
+
+TEST_CASE("Sequential execution keeps the module order")
+{
+  ExecutionLog log;
+
+  REQUIRE(Execute(GetModules(log,false,false),1));
+  REQUIRE(log.started==std::vector<std::string>({"a","b","c","d"}));
+  REQUIRE(log.maxRunning==1);
+}
+
+TEST_CASE("Independent modules run in parallel, dependent modules wait")
+{
+  ExecutionLog log;
+
+  // "a" and "b" only finish after the other one has started
+  REQUIRE(Execute(GetModules(log,true,false),2));
+
+  REQUIRE(log.finished.size()==4);
+  REQUIRE(log.maxRunning==2);
+
+  // Dependencies have finished before a module starts
+  REQUIRE(log.GetStartIndex("c")>=2);
+  REQUIRE(log.GetStartIndex("d")>=2);
+  REQUIRE(log.GetFinishIndex("a")<log.GetFinishIndex("c"));
+  REQUIRE(log.GetFinishIndex("b")<log.GetFinishIndex("c"));
+  REQUIRE(log.GetFinishIndex("a")<log.GetFinishIndex("d"));
+}
+
+TEST_CASE("Modules depending on a failed module are not started")
+{
+  ExecutionLog log;
+
+  REQUIRE_FALSE(Execute(GetModules(log,false,true),2));
+
+  REQUIRE(log.IsFinished("a"));
+  REQUIRE_FALSE(log.IsStarted("c"));
+  REQUIRE_FALSE(log.IsStarted("d"));
+}
+
+TEST_CASE("Nested parallel processing respects the worker budget")
+{
+  WorkerBudget        budget(2);
+  std::mutex          mutex;
+  std::map<size_t,size_t> processed;
+  std::atomic<size_t> running(0);
+  std::atomic<size_t> maxRunning(0);
+  std::vector<size_t> items{0,1,2,3,4,5,6,7};
+
+  ProcessInParallel(budget,items,[&](size_t outer) {
+    ProcessInParallel(budget,items,[&](size_t inner) {
+      size_t current=++running;
+      size_t max=maxRunning;
+
+      while (current>max &&
+             !maxRunning.compare_exchange_weak(max,current)) {
+        // retry
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        processed[outer*items.size()+inner]++;
+      }
+
+      running--;
+    });
+  });
+
+  // The calling thread plus at most two workers
+  REQUIRE(maxRunning<=3);
+  REQUIRE(processed.size()==items.size()*items.size());
+  REQUIRE(std::all_of(processed.begin(),processed.end(),[](const std::pair<const size_t,size_t>& entry) {
+    return entry.second==1;
+  }));
+  REQUIRE(budget.GetAvailable()==2);
+
+  // Workers are returned to the budget, even if processing fails
+  REQUIRE_THROWS_AS(ProcessInParallel(budget,items,[](size_t item) {
+                      if (item==3) {
+                        throw std::runtime_error("failure");
+                      }
+                    }),
+                    std::runtime_error);
+  REQUIRE(budget.GetAvailable()==2);
+}
@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <list>
+#include <vector>
+
+#include <osmscout/DataTileCache.h>
+#include <osmscout/IncrementalMapData.h>
+#include <osmscout/TypeConfig.h>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+
+#include <TempDirectory.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+using namespace osmscout;
+
+/**
+ * Objects only get a file offset (their identity in IncrementalMapData)
+ * when read from a file, so write and read back a number of nodes and ways
+ */
+struct TestData
+{
+  TypeConfig           typeConfig;
+  std::vector<NodeRef> nodes;
+  std::vector<WayRef>  ways;
+
+  explicit TestData(TempDirectory& directory)
+  {
+    TypeInfoRef nodeType=std::make_shared<TypeInfo>("node");
+    TypeInfoRef wayType=std::make_shared<TypeInfo>("way");
+
+    nodeType->CanBeNode(true);
+    wayType->CanBeWay(true);
+
+    typeConfig.RegisterType(nodeType);
+    typeConfig.RegisterType(wayType);
+
+    std::string filename=directory.GetFile("objects.dat");
+    FileWriter  writer;
+
+    writer.Open(filename);
+
+    for (size_t i=0; i<4; i++) {
+      Node node;
+
+      node.SetType(nodeType);
+      node.SetCoords(GeoCoord(50.0+i*0.01,10.0));
+      node.Write(typeConfig,writer);
+    }
+
+    for (size_t i=0; i<2; i++) {
+      Way way;
+
+      way.SetType(wayType);
+      way.nodes.emplace_back(0,GeoCoord(50.0+i*0.01,10.0));
+      way.nodes.emplace_back(0,GeoCoord(50.0+i*0.01,10.01));
+      way.Write(typeConfig,writer);
+    }
+
+    writer.Close();
+
+    FileScanner scanner;
+
+    scanner.Open(filename,FileScanner::Sequential,false);
+
+    for (size_t i=0; i<4; i++) {
+      NodeRef node=std::make_shared<Node>();
+
+      node->Read(typeConfig,scanner);
+      nodes.push_back(node);
+    }
+
+    for (size_t i=0; i<2; i++) {
+      WayRef way=std::make_shared<Way>();
+
+      way->Read(typeConfig,scanner);
+      ways.push_back(way);
+    }
+
+    scanner.Close();
+  }
+};
+
+static TileRef GetTile(DataTileCache& cache,
+                       uint32_t x)
+{
+  return cache.GetTile(TileKey(Magnification(MagnificationLevel(10)),
+                               TileId(x,0)));
+}
+
+static void SetNodes(const TileRef& tile,
+                     const std::vector<NodeRef>& nodes)
+{
+  tile->GetNodeData().SetData(TypeInfoSet(),nodes);
+}
+
+static bool ContainsExactly(const std::vector<NodeRef>& data,
+                            const std::vector<NodeRef>& expected)
+{
+  if (data.size()!=expected.size()) {
+    return false;
+  }
+
+  for (const auto& node : expected) {
+    if (std::count(data.begin(),data.end(),node)!=1) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+TEST_CASE("Objects shared by tiles stay until the last tile is removed")
+{
+  TempDirectory      directory;
+  TestData           testData(directory);
+  DataTileCache      cache(10);
+  IncrementalMapData mapData;
+
+  const auto& n=testData.nodes;
+
+  TileRef tile1=GetTile(cache,0);
+  TileRef tile2=GetTile(cache,1);
+
+  SetNodes(tile1,{n[0],n[1]});
+  SetNodes(tile2,{n[1],n[2]});
+
+  REQUIRE(mapData.Update({tile1,tile2}));
+  REQUIRE(mapData.GetAddedTileCount()==2);
+  REQUIRE(mapData.GetRemovedTileCount()==0);
+  REQUIRE(mapData.GetTileCount()==2);
+  REQUIRE(ContainsExactly(mapData.GetMapData()->nodes,{n[0],n[1],n[2]}));
+
+  // n[1] is still referenced by tile2
+  REQUIRE(mapData.Update({tile2}));
+  REQUIRE(mapData.GetAddedTileCount()==0);
+  REQUIRE(mapData.GetRemovedTileCount()==1);
+  REQUIRE(ContainsExactly(mapData.GetMapData()->nodes,{n[1],n[2]}));
+
+  // Re-adding tile1 again references n[1] twice
+  REQUIRE(mapData.Update({tile1,tile2}));
+  REQUIRE(mapData.GetAddedTileCount()==1);
+  REQUIRE(ContainsExactly(mapData.GetMapData()->nodes,{n[0],n[1],n[2]}));
+
+  REQUIRE(mapData.Update({tile1}));
+  REQUIRE(ContainsExactly(mapData.GetMapData()->nodes,{n[0],n[1]}));
+
+  REQUIRE(mapData.Update({}));
+  REQUIRE(mapData.GetRemovedTileCount()==1);
+  REQUIRE(mapData.GetTileCount()==0);
+  REQUIRE(mapData.GetMapData()->nodes.empty());
+}
+
+TEST_CASE("Tiles are only copied again if their generation changes")
+{
+  TempDirectory      directory;
+  TestData           testData(directory);
+  DataTileCache      cache(10);
+  IncrementalMapData mapData;
+
+  const auto& n=testData.nodes;
+
+  TileRef tile1=GetTile(cache,0);
+  TileRef tile2=GetTile(cache,1);
+
+  SetNodes(tile1,{n[0],n[1]});
+  SetNodes(tile2,{n[2]});
+
+  REQUIRE(mapData.Update({tile1,tile2}));
+
+  // Nothing changed
+  REQUIRE_FALSE(mapData.Update({tile2,tile1}));
+  REQUIRE(mapData.GetAddedTileCount()==0);
+  REQUIRE(mapData.GetRemovedTileCount()==0);
+
+  // Replacing the data of a tile increments its generation
+  size_t generation=tile1->GetGeneration();
+
+  SetNodes(tile1,{n[1],n[3]});
+
+  REQUIRE(tile1->GetGeneration()!=generation);
+  REQUIRE(mapData.Update({tile1,tile2}));
+  REQUIRE(mapData.GetAddedTileCount()==1);
+  REQUIRE(mapData.GetRemovedTileCount()==0);
+  REQUIRE(ContainsExactly(mapData.GetMapData()->nodes,{n[1],n[2],n[3]}));
+
+  // Adding data increments the generation, too
+  tile2->GetNodeData().AddData(TypeInfoSet(),{n[0]});
+
+  REQUIRE(mapData.Update({tile1,tile2}));
+  REQUIRE(mapData.GetAddedTileCount()==1);
+  REQUIRE(ContainsExactly(mapData.GetMapData()->nodes,{n[0],n[1],n[2],n[3]}));
+
+  // A different tile instance for the same key is copied, too
+  DataTileCache otherCache(10);
+  TileRef       newTile1=GetTile(otherCache,0);
+
+  SetNodes(newTile1,{n[0]});
+
+  REQUIRE(mapData.Update({newTile1,tile2}));
+  REQUIRE(mapData.GetAddedTileCount()==1);
+  REQUIRE(ContainsExactly(mapData.GetMapData()->nodes,{n[0],n[2]}));
+
+  mapData.Clear();
+
+  REQUIRE(mapData.GetTileCount()==0);
+  REQUIRE(mapData.GetMapData()->nodes.empty());
+}
+
+TEST_CASE("Optimized and regular ways with the same offset are distinct")
+{
+  TempDirectory      directory;
+  TestData           testData(directory);
+  DataTileCache      cache(10);
+  IncrementalMapData mapData;
+
+  const auto& w=testData.ways;
+
+  TileRef tile=GetTile(cache,0);
+
+  tile->GetWayData().SetData(TypeInfoSet(),{w[0],w[1]});
+  tile->GetOptimizedWayData().SetData(TypeInfoSet(),{w[0]});
+
+  REQUIRE(mapData.Update({tile}));
+  REQUIRE(mapData.GetMapData()->ways.size()==3);
+
+  tile->GetOptimizedWayData().SetData(TypeInfoSet(),{});
+
+  REQUIRE(mapData.Update({tile}));
+  REQUIRE(mapData.GetMapData()->ways.size()==2);
+
+  REQUIRE(mapData.Update({}));
+  REQUIRE(mapData.GetMapData()->ways.empty());
+}
@@ -0,0 +1,216 @@
+#include <string>
+#include <vector>
+
+#include <osmscout/MapStyleCache.h>
+#include <osmscout/StyleConfig.h>
+#include <osmscout/TypeConfig.h>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+#include <osmscout/util/Projection.h>
+
+#include <TempDirectory.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+using namespace osmscout;
+
+static const Magnification magnification(MagnificationLevel(14));
+static const double        dpi=96.0;
+
+static MercatorProjection GetProjection(double lat)
+{
+  MercatorProjection projection;
+
+  projection.Set(GeoCoord(lat,10.0),
+                 magnification,
+                 dpi,
+                 800,600);
+
+  return projection;
+}
+
+/**
+ * Type config with a single way type and a number of ways with file offsets
+ * (written and read back, since only reading assigns the file offset). Like
+ * the data files of a database, the file starts with the number of objects,
+ * so no object has file offset 0.
+ */
+struct TestData
+{
+  TypeConfigRef       typeConfig=std::make_shared<TypeConfig>();
+  std::vector<WayRef> ways;
+  std::string         filename;
+
+  explicit TestData(TempDirectory& directory)
+  : filename(directory.GetFile("ways.dat"))
+  {
+    TypeInfoRef type=std::make_shared<TypeInfo>("river");
+
+    type->CanBeWay(true);
+    typeConfig->RegisterType(type);
+
+    FileWriter writer;
+
+    writer.Open(filename);
+    writer.Write((uint32_t)3);
+
+    for (size_t i=0; i<3; i++) {
+      Way way;
+
+      way.SetType(type);
+      way.nodes.emplace_back(0,GeoCoord(50.0+i*0.01,10.0));
+      way.nodes.emplace_back(0,GeoCoord(50.0+i*0.01,10.01));
+      way.Write(*typeConfig,writer);
+    }
+
+    writer.Close();
+
+    FileScanner scanner;
+
+    scanner.Open(filename,FileScanner::Sequential,false);
+    scanner.SetPos(sizeof(uint32_t));
+
+    for (size_t i=0; i<3; i++) {
+      WayRef way=std::make_shared<Way>();
+
+      way->Read(*typeConfig,scanner);
+      ways.push_back(way);
+    }
+
+    scanner.Close();
+  }
+};
+
+/**
+ * Style sheet with a size condition, that is false at the equator and true
+ * at 70 degree north at the test magnification
+ */
+static StyleConfigRef CreateStyleConfig(const TypeConfigRef& typeConfig)
+{
+  double         minPx=(GetProjection(0.0).GetMeterInPixel()+
+                        GetProjection(70.0).GetMeterInPixel())/2.0;
+  StyleConfigRef styleConfig=std::make_shared<StyleConfig>(typeConfig);
+  std::string    content="OSS\n"
+                         "STYLE\n"
+                         "  [TYPE river] {\n"
+                         "    WAY {color: #0000ff; displayWidth: 0.5mm;}\n"
+                         "    [SIZE 1m :"+std::to_string(minPx)+"px<] WAY#wide {color: #0000ff; width: 1m;}\n"
+                         "  }\n"
+                         "END\n";
+
+  REQUIRE(styleConfig->LoadContent(content));
+  REQUIRE(styleConfig->GetSizeConditions().size()==1);
+
+  return styleConfig;
+}
+
+static size_t GetLineStyleCount(MapStyleCache& cache,
+                                const StyleConfig& styleConfig,
+                                const Projection& projection,
+                                const WayRef& way)
+{
+  return cache.GetWayStyles(styleConfig,projection,way).lineStyles.size();
+}
+
+TEST_CASE("Styles stay cached while panning north and south")
+{
+  TempDirectory  directory;
+  TestData       testData(directory);
+  StyleConfigRef styleConfig=CreateStyleConfig(testData.typeConfig);
+  MapStyleCache  cache;
+
+  MercatorProjection projection=GetProjection(10.0);
+
+  cache.StartRenderPass(*styleConfig,projection);
+
+  for (const auto& way : testData.ways) {
+    REQUIRE(GetLineStyleCount(cache,*styleConfig,projection,way)==1);
+  }
+
+  REQUIRE(cache.GetResolveCount()==3);
+  REQUIRE(cache.GetSize()==3);
+
+  for (double lat : {10.01,9.99,11.0,20.0,5.0}) {
+    MercatorProjection panned=GetProjection(lat);
+
+    // Meter in pixel depends on the latitude of the center
+    REQUIRE(panned.GetMeterInPixel()!=projection.GetMeterInPixel());
+
+    cache.StartRenderPass(*styleConfig,panned);
+
+    for (const auto& way : testData.ways) {
+      REQUIRE(GetLineStyleCount(cache,*styleConfig,panned,way)==1);
+    }
+
+    REQUIRE(cache.GetResolveCount()==3);
+  }
+
+  // The size condition changes its result, styles are resolved again
+  MercatorProjection north=GetProjection(70.0);
+
+  cache.StartRenderPass(*styleConfig,north);
+
+  for (const auto& way : testData.ways) {
+    REQUIRE(GetLineStyleCount(cache,*styleConfig,north,way)==2);
+  }
+
+  REQUIRE(cache.GetResolveCount()==6);
+
+  // A different magnification level drops the cache, too
+  MercatorProjection zoomed;
+
+  zoomed.Set(GeoCoord(70.0,10.0),
+             Magnification(MagnificationLevel(15)),
+             dpi,
+             800,600);
+
+  cache.StartRenderPass(*styleConfig,zoomed);
+  GetLineStyleCount(cache,*styleConfig,zoomed,testData.ways.front());
+
+  REQUIRE(cache.GetResolveCount()==7);
+  REQUIRE(cache.GetSize()==1);
+}
+
+TEST_CASE("A different object at the same address is resolved again")
+{
+  TempDirectory  directory;
+  TestData       testData(directory);
+  StyleConfigRef styleConfig=CreateStyleConfig(testData.typeConfig);
+  MapStyleCache  cache;
+
+  MercatorProjection projection=GetProjection(10.0);
+  WayRef             way=testData.ways.front();
+
+  cache.StartRenderPass(*styleConfig,projection);
+  GetLineStyleCount(cache,*styleConfig,projection,way);
+
+  REQUIRE(cache.GetResolveCount()==1);
+
+  // Re-reading the object with a different file offset simulates reuse of the
+  // address by another object
+  FileScanner scanner;
+
+  scanner.Open(testData.filename,FileScanner::Sequential,false);
+  scanner.SetPos(testData.ways[1]->GetFileOffset());
+  way->Read(*testData.typeConfig,scanner);
+  scanner.Close();
+
+  cache.StartRenderPass(*styleConfig,projection);
+  GetLineStyleCount(cache,*styleConfig,projection,way);
+
+  REQUIRE(cache.GetResolveCount()==2);
+  REQUIRE(cache.GetSize()==1);
+
+  // Objects without file offset are never cached
+  WayRef newWay=std::make_shared<Way>();
+
+  newWay->SetType(testData.ways[1]->GetType());
+
+  GetLineStyleCount(cache,*styleConfig,projection,newWay);
+  GetLineStyleCount(cache,*styleConfig,projection,newWay);
+
+  REQUIRE(cache.GetResolveCount()==4);
+  REQUIRE(cache.GetSize()==1);
+}
@@ -1,5 +1,6 @@
 #include <iostream>
 
+#include <osmscout/util/NodeUseMap.h>
 #include <osmscout/util/NumberSet.h>
 
 int errors=0;
@@ -48,6 +49,100 @@ int main()
     }
   }
 
+  if (set.GetNodeUsedCount()!=256*256-256+2) {
+    std::cerr << "Wrong number of ids in set: " << set.GetNodeUsedCount() << std::endl;
+    errors++;
+  }
+
+  // Huge, sparse ids
+
+  for (osmscout::Id i=0; i<1000; i++) {
+    set.Set(10000000000+i*100000);
+  }
+
+  for (osmscout::Id i=0; i<1000; i++) {
+    if (!set.IsSet(10000000000+i*100000)) {
+      std::cerr << 10000000000+i*100000 << " not found in set!" << std::endl;
+      errors++;
+    }
+
+    if (set.IsSet(10000000000+i*100000+1)) {
+      std::cerr << 10000000000+i*100000+1 << " found in set!" << std::endl;
+      errors++;
+    }
+  }
+
+  // Compaction must not change the content of the set
+
+  set.Optimize();
+
+  for (size_t i=256; i<256*256; i++) {
+    if (!set.IsSet(i)) {
+      std::cerr << i << " not found in optimized set!" << std::endl;
+      errors++;
+    }
+  }
+
+  if (set.IsSet(256*256) ||
+      set.IsSet(0) ||
+      !set.IsSet(1) ||
+      !set.IsSet(10000000000)) {
+    std::cerr << "Optimized set has wrong content!" << std::endl;
+    errors++;
+  }
+
+  // Setting values in an optimized set
+
+  set.Set(256*256);
+  set.Set(0);
+
+  if (!set.IsSet(256*256) ||
+      !set.IsSet(0) ||
+      !set.IsSet(256*256-1)) {
+    std::cerr << "Set values after optimization not found!" << std::endl;
+    errors++;
+  }
+
+  if (set.GetNodeUsedCount()!=256*256-256+2+1000+2) {
+    std::cerr << "Wrong number of ids in set: " << set.GetNodeUsedCount() << std::endl;
+    errors++;
+  }
+
+  // Every third value, so that neither runs nor arrays are compact
+
+  osmscout::NumberSet bitmapSet;
+
+  for (size_t i=0; i<3*65536; i+=3) {
+    bitmapSet.Set(i);
+  }
+
+  bitmapSet.Optimize();
+
+  for (size_t i=0; i<3*65536; i++) {
+    if (bitmapSet.IsSet(i)!=(i%3==0)) {
+      std::cerr << i << " has wrong state in set!" << std::endl;
+      errors++;
+    }
+  }
+
+  osmscout::NodeUseMap nodeUseMap;
+
+  nodeUseMap.SetNodeUsed(1);
+  nodeUseMap.SetNodeUsed(2);
+  nodeUseMap.SetNodeUsed(2);
+  nodeUseMap.SetNodeUsed(10000000000);
+  nodeUseMap.SetNodeUsed(10000000000);
+  nodeUseMap.SetNodeUsed(10000000000);
+
+  if (nodeUseMap.IsNodeUsedAtLeastTwice(1) ||
+      !nodeUseMap.IsNodeUsedAtLeastTwice(2) ||
+      !nodeUseMap.IsNodeUsedAtLeastTwice(10000000000) ||
+      nodeUseMap.GetNodeUsedCount()!=3 ||
+      nodeUseMap.GetDuplicateCount()!=2) {
+    std::cerr << "NodeUseMap has wrong content!" << std::endl;
+    errors++;
+  }
+
   if (errors!=0) {
     return 1;
   }
@@ -21,37 +21,34 @@
 #include <limits>
 #include <random>
 #include <set>
+#include <string>
 #include <unordered_set>
 #include <vector>
 
 #include <osmscout/TypeConfig.h>
 
+#include <osmscout/util/NodeUseMap.h>
 #include <osmscout/util/NumberSet.h>
 #include <osmscout/util/StopClock.h>
+#include <osmscout/util/String.h>
 
 /**
-  Generate a number of random potential node ids in the range 0...max(long)
-  and check the performance of std::set<unsigned long> against NumberSet.
+  Check the performance of std::set<unsigned long> and std::unordered_set<unsigned long>
+  against NumberSet for different distributions of ids:
+  * Random ids from a small range (many duplicates)
+  * Consecutive ids (like the node ids of an extract)
+  * Random ids from a huge range (like OSM node ids of the complete planet)
 */
 
-size_t       ID_COUNT=50000000; // Number of insert/find tests bases on random numbers
-osmscout::Id UPPER_LIMIT=100000;//std::numeric_limits<osmscout::Id>::max(); // upper range for test values
+size_t       ID_COUNT=50000000;        // Number of insert/find tests bases on random numbers
+size_t       LARGE_ID_COUNT=10000000;  // Number of insert/find tests for sequential and sparse ids
+osmscout::Id UPPER_LIMIT=100000;       // upper range for dense test values
+osmscout::Id PLANET_LIMIT=12000000000; // upper range for sparse test values
 
-int main(int /*argc*/, char* /*argv*/[])
+static void Benchmark(const std::string& name,
+                      const std::vector<osmscout::Id>& ids)
 {
-  std::vector<osmscout::Id> ids;
-
-  ids.resize(ID_COUNT);
-
-  std::random_device               rd;  //Will be used to obtain a seed for the random number engine
-  std::mt19937                     gen(rd()); //Standard mersenne_twister_engine seeded with rd()
-  std::uniform_real_distribution<> dis(1, UPPER_LIMIT);
-
-  std::cout << "Generate random ids..." << std::endl;
-
-  for (auto& id : ids) {
-    id=(osmscout::Id)dis(gen);
-  }
+  std::cout << "### " << name << std::endl;
 
   std::cout << "Inserting into std::set..." << std::endl;
 
@@ -89,6 +86,28 @@ int main(int /*argc*/, char* /*argv*/[])
 
   insertnsetTimer.Stop();
 
+  size_t nsetMemory=nset.GetMemory();
+
+  osmscout::StopClock optimizensetTimer;
+
+  nset.Optimize();
+
+  optimizensetTimer.Stop();
+
+  size_t nsetOptimizedMemory=nset.GetMemory();
+
+  std::cout << "Inserting into NodeUseMap..." << std::endl;
+
+  osmscout::StopClock insertnodeUseMapTimer;
+
+  osmscout::NodeUseMap nodeUseMap;
+
+  for (auto id : ids) {
+    nodeUseMap.SetNodeUsed(id);
+  }
+
+  insertnodeUseMapTimer.Stop();
+
   std::cout << "Searching in std::set..." << std::endl;
 
   osmscout::StopClock stestsetTimer;
@@ -125,12 +144,68 @@ int main(int /*argc*/, char* /*argv*/[])
 
   stestnsetTimer.Stop();
 
-  std::cout << "Inserting " << ID_COUNT << " ids into std::set took " << insertsetTimer << std::endl;
-  std::cout << "Inserting " << ID_COUNT << " ids into std::unordered_set took " << insertusetTimer << std::endl;
-  std::cout << "Inserting " << ID_COUNT << " ids into NumberSet took " << insertnsetTimer << std::endl;
-  std::cout << "Testing " << ID_COUNT << " ids in std::set took " << stestsetTimer << std::endl;
-  std::cout << "Testing " << ID_COUNT << " ids in std::unordered_set took " << stestusetTimer << std::endl;
-  std::cout << "Testing " << ID_COUNT << " ids in NumberSet took " << stestnsetTimer << std::endl;
+  // Rough estimation of the memory of the standard containers: one tree node (three pointers,
+  // color and value) per entry for std::set, one list node (pointer and value) per entry and
+  // one pointer per bucket for std::unordered_set
+  size_t setMemory=set.size()*(3*sizeof(void*)+2*sizeof(osmscout::Id));
+  size_t usetMemory=uset.size()*(sizeof(void*)+sizeof(osmscout::Id))+uset.bucket_count()*sizeof(void*);
+
+  std::cout << "Inserting " << ids.size() << " ids into std::set took " << insertsetTimer << std::endl;
+  std::cout << "Inserting " << ids.size() << " ids into std::unordered_set took " << insertusetTimer << std::endl;
+  std::cout << "Inserting " << ids.size() << " ids into NumberSet took " << insertnsetTimer << std::endl;
+  std::cout << "Optimizing NumberSet took " << optimizensetTimer << std::endl;
+  std::cout << "Inserting " << ids.size() << " ids into NodeUseMap took " << insertnodeUseMapTimer << std::endl;
+  std::cout << "Testing " << ids.size() << " ids in std::set took " << stestsetTimer << std::endl;
+  std::cout << "Testing " << ids.size() << " ids in std::unordered_set took " << stestusetTimer << std::endl;
+  std::cout << "Testing " << ids.size() << " ids in NumberSet took " << stestnsetTimer << std::endl;
+  std::cout << set.size() << " distinct ids" << std::endl;
+  std::cout << "Memory std::set (estimated): " << osmscout::ByteSizeToString(setMemory) << std::endl;
+  std::cout << "Memory std::unordered_set (estimated): " << osmscout::ByteSizeToString(usetMemory) << std::endl;
+  std::cout << "Memory NumberSet: " << osmscout::ByteSizeToString(nsetMemory) << ", optimized " << osmscout::ByteSizeToString(nsetOptimizedMemory) << std::endl;
+  std::cout << "Memory NodeUseMap: " << osmscout::ByteSizeToString(nodeUseMap.GetMemory()) << std::endl;
+}
+
+int main(int /*argc*/, char* /*argv*/[])
+{
+  std::vector<osmscout::Id> ids;
+
+  std::random_device               rd;  //Will be used to obtain a seed for the random number engine
+  std::mt19937                     gen(rd()); //Standard mersenne_twister_engine seeded with rd()
+
+  std::cout << "Generate random ids..." << std::endl;
+
+  std::uniform_real_distribution<> dis(1, UPPER_LIMIT);
+
+  ids.resize(ID_COUNT);
+
+  for (auto& id : ids) {
+    id=(osmscout::Id)dis(gen);
+  }
+
+  Benchmark("Random ids in range [1,"+std::to_string(UPPER_LIMIT)+"]",
+            ids);
+
+  std::cout << "Generate sequential ids..." << std::endl;
+
+  ids.resize(LARGE_ID_COUNT);
+
+  for (size_t i=0; i<ids.size(); i++) {
+    ids[i]=1000000000+i;
+  }
+
+  Benchmark("Sequential ids",
+            ids);
+
+  std::cout << "Generate sparse ids..." << std::endl;
+
+  std::uniform_int_distribution<osmscout::Id> planetDis(1, PLANET_LIMIT);
+
+  for (auto& id : ids) {
+    id=planetDis(gen);
+  }
+
+  Benchmark("Random ids in range [1,"+std::to_string(PLANET_LIMIT)+"]",
+            ids);
 
   return 0;
 }
@@ -0,0 +1,173 @@
+#include <string>
+#include <vector>
+
+#include <osmscout/ObjectBoxIndex.h>
+#include <osmscout/ObjectView.h>
+#include <osmscout/TypeConfig.h>
+#include <osmscout/WayDataFile.h>
+
+#include <osmscout/util/FileWriter.h>
+
+#include <osmscout/import/GenObjectBoxIndex.h>
+
+#include <TempDirectory.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+using namespace osmscout;
+
+static const size_t wayCount=100;
+
+/**
+ * Write a ways.dat with a grid of short ways, each in its own 0.1 degree cell
+ * and return the name of the matching index file
+ */
+static std::string WriteWays(TempDirectory& directory,
+                             const TypeConfig& typeConfig,
+                             const TypeInfoRef& type,
+                             std::vector<FileOffset>& offsets,
+                             std::vector<GeoBox>& boxes)
+{
+  FileWriter writer;
+
+  writer.Open(directory.GetFile(WayDataFile::WAYS_DAT));
+  writer.Write((uint32_t)wayCount);
+
+  for (size_t i=0; i<wayCount; i++) {
+    Way    way;
+    double lat=50.0+(i/10)*0.1;
+    double lon=10.0+(i%10)*0.1;
+
+    way.SetType(type);
+    way.nodes.emplace_back(0,GeoCoord(lat+0.01,lon+0.01));
+    way.nodes.emplace_back(0,GeoCoord(lat+0.02,lon+0.05));
+    way.nodes.emplace_back(0,GeoCoord(lat+0.05,lon+0.02));
+
+    offsets.push_back(writer.GetPos());
+    boxes.push_back(way.GetBoundingBox());
+
+    way.Write(typeConfig,writer);
+  }
+
+  writer.Close();
+
+  return directory.GetFile(ObjectBoxIndex::GetIndexFilename(WayDataFile::WAYS_DAT));
+}
+
+TEST_CASE("Object boxes are found by file offset")
+{
+  TempDirectory           directory;
+  TypeConfigRef           typeConfig=std::make_shared<TypeConfig>();
+  TypeInfoRef             type=std::make_shared<TypeInfo>("way");
+  std::vector<FileOffset> offsets;
+  std::vector<GeoBox>     boxes;
+
+  type->CanBeWay(true);
+  typeConfig->RegisterType(type);
+
+  std::string indexFilename=WriteWays(directory,*typeConfig,type,offsets,boxes);
+
+  REQUIRE(ObjectBoxIndex::GetIndexFilename(WayDataFile::WAYS_DAT)=="ways.box");
+
+  ObjectBoxIndexGenerator::WriteIndex(indexFilename,
+                                      offsets,
+                                      boxes);
+
+  ObjectBoxIndex index;
+
+  REQUIRE(index.Open(indexFilename));
+  REQUIRE(index.GetEntryCount()==wayCount);
+
+  for (size_t i=0; i<wayCount; i++) {
+    GeoBox box;
+
+    // The index stores the box with the precision of the data file
+    REQUIRE(index.GetBoundingBox(offsets[i],box));
+    REQUIRE(box.GetMinLat()==Approx(boxes[i].GetMinLat()).margin(0.00001));
+    REQUIRE(box.GetMinLon()==Approx(boxes[i].GetMinLon()).margin(0.00001));
+    REQUIRE(box.GetMaxLat()==Approx(boxes[i].GetMaxLat()).margin(0.00001));
+    REQUIRE(box.GetMaxLon()==Approx(boxes[i].GetMaxLon()).margin(0.00001));
+  }
+
+  GeoBox box;
+
+  REQUIRE_FALSE(index.GetBoundingBox(offsets[0]+1,box));
+
+  size_t entryIndex;
+
+  REQUIRE(index.GetEntryIndex(offsets[5],entryIndex));
+  REQUIRE(entryIndex==5);
+  REQUIRE(index.GetOffset(entryIndex)==offsets[5]);
+  REQUIRE_FALSE(index.GetEntryIndex(offsets[0]+1,entryIndex));
+
+  REQUIRE(index.Close());
+}
+
+TEST_CASE("Data file drops objects outside of the query box using the index")
+{
+  TempDirectory           directory;
+  TypeConfigRef           typeConfig=std::make_shared<TypeConfig>();
+  TypeInfoRef             type=std::make_shared<TypeInfo>("way");
+  std::vector<FileOffset> offsets;
+  std::vector<GeoBox>     boxes;
+
+  type->CanBeWay(true);
+  typeConfig->RegisterType(type);
+
+  std::string indexFilename=WriteWays(directory,*typeConfig,type,offsets,boxes);
+
+  // Query box covers the cells of the first two rows
+  GeoBox queryBox(GeoCoord(49.99,9.99),GeoCoord(50.19,11.0));
+
+  // Move the box of way 0 out of the query box in the index, to make sure
+  // that the index (and not the object) is checked
+  boxes[0]=GeoBox(GeoCoord(0.0,0.0),GeoCoord(0.1,0.1));
+
+  ObjectBoxIndexGenerator::WriteIndex(indexFilename,
+                                      offsets,
+                                      boxes);
+
+  WayDataFile dataFile(1000);
+
+  REQUIRE(dataFile.Open(typeConfig,directory.GetPath(),true));
+
+  SECTION("Lookup by offset") {
+    std::vector<WayRef> ways;
+
+    REQUIRE(dataFile.GetIntersectingByOffset<WayView>(offsets.begin(),
+                                                      offsets.end(),
+                                                      offsets.size(),
+                                                      queryBox,
+                                                      ways));
+
+    REQUIRE(ways.size()==19);
+
+    for (const auto& way : ways) {
+      REQUIRE(way->GetFileOffset()!=offsets[0]);
+      REQUIRE(way->Intersects(queryBox));
+    }
+  }
+
+  SECTION("Lookup by block span") {
+    std::vector<DataBlockSpan> spans(1);
+    std::vector<WayRef>        ways;
+
+    spans[0].startOffset=offsets[0];
+    spans[0].count=(uint32_t)wayCount;
+
+    REQUIRE(dataFile.GetIntersectingByBlockSpans<WayView>(spans.begin(),
+                                                          spans.end(),
+                                                          queryBox,
+                                                          ways));
+
+    REQUIRE(ways.size()==19);
+
+    for (const auto& way : ways) {
+      REQUIRE(way->GetFileOffset()!=offsets[0]);
+      REQUIRE(way->Intersects(queryBox));
+    }
+  }
+
+  REQUIRE(dataFile.Close());
+}
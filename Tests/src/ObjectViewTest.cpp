@@ -0,0 +1,224 @@
+#include <string>
+#include <vector>
+
+#include <osmscout/Area.h>
+#include <osmscout/ObjectView.h>
+#include <osmscout/TypeConfig.h>
+#include <osmscout/Way.h>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+
+#include <TempDirectory.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+using namespace osmscout;
+
+static void CheckBox(const GeoBox& a,
+                     const GeoBox& b)
+{
+  REQUIRE(a.IsValid()==b.IsValid());
+
+  if (a.IsValid()) {
+    REQUIRE(a.GetMinCoord()==b.GetMinCoord());
+    REQUIRE(a.GetMaxCoord()==b.GetMaxCoord());
+  }
+}
+
+/**
+ * Return a list of nodes, whose deltas require the given number of bytes
+ * per coordinate pair (2, 4 or 6) for encoding
+ */
+static std::vector<Point> CreateNodes(double start,
+                                      double step,
+                                      size_t count)
+{
+  std::vector<Point> nodes;
+
+  for (size_t i=0; i<count; i++) {
+    double offset=step*i*(i%2==0 ? 1.0 : -0.5);
+
+    nodes.emplace_back(i%3==0 ? 0 : (uint8_t)i,
+                       GeoCoord(start+offset,start-offset/2));
+  }
+
+  return nodes;
+}
+
+TEST_CASE("Way views have the bounding box and size of the way")
+{
+  TypeConfig  typeConfig;
+  TypeInfoRef routableType=std::make_shared<TypeInfo>("routable");
+  TypeInfoRef simpleType=std::make_shared<TypeInfo>("simple");
+
+  routableType->CanBeWay(true);
+  routableType->CanRouteCar(true);
+  simpleType->CanBeWay(true);
+
+  typeConfig.RegisterType(routableType);
+  typeConfig.RegisterType(simpleType);
+
+  std::vector<Way> ways;
+
+  for (double step : {0.000001,0.001,0.1}) {
+    for (const auto& type : {routableType,simpleType}) {
+      Way way;
+
+      way.SetType(type);
+      way.nodes=CreateNodes(10.0,step,25);
+
+      ways.push_back(way);
+    }
+  }
+
+  TempDirectory directory;
+  std::string   filename=directory.GetFile("objects.dat");
+  FileWriter    writer;
+
+  writer.Open(filename);
+
+  for (const auto& way : ways) {
+    way.Write(typeConfig,writer);
+  }
+
+  writer.Close();
+
+  FileScanner scanner;
+
+  scanner.Open(filename,FileScanner::Sequential,true);
+
+  for (const auto& written : ways) {
+    WayView view;
+    Way     way;
+
+    view.Read(typeConfig,scanner);
+
+    REQUIRE(view.GetType()==written.GetType());
+
+    view.Materialize(typeConfig,scanner,way);
+
+    REQUIRE(scanner.GetPos()==view.GetNextFileOffset());
+    REQUIRE(way.GetFileOffset()==view.GetFileOffset());
+    REQUIRE(way.GetNextFileOffset()==view.GetNextFileOffset());
+    REQUIRE(way.GetType()==written.GetType());
+    REQUIRE(way.nodes.size()==written.nodes.size());
+
+    CheckBox(view.GetBoundingBox(),way.GetBoundingBox());
+
+    std::vector<Point> nodes;
+
+    view.ReadNodes(scanner,nodes);
+
+    REQUIRE(nodes.size()==way.nodes.size());
+
+    for (size_t i=0; i<nodes.size(); i++) {
+      REQUIRE(nodes[i].GetCoord()==way.nodes[i].GetCoord());
+      REQUIRE(nodes[i].GetSerial()==way.nodes[i].GetSerial());
+    }
+
+    REQUIRE(scanner.GetPos()==view.GetNextFileOffset());
+  }
+
+  scanner.Close();
+}
+
+TEST_CASE("Area views have the bounding box of the outer rings")
+{
+  TypeConfig  typeConfig;
+  TypeInfoRef areaType=std::make_shared<TypeInfo>("area");
+
+  areaType->CanBeArea(true);
+
+  typeConfig.RegisterType(areaType);
+
+  std::vector<Area> areas;
+
+  // Simple area
+  {
+    Area       area;
+    Area::Ring ring;
+
+    ring.SetType(areaType);
+    ring.MarkAsOuterRing();
+    ring.nodes=CreateNodes(20.0,0.001,10);
+
+    area.rings.push_back(ring);
+    areas.push_back(area);
+  }
+
+  // Multipolygon with master ring, two outer rings and one inner ring
+  {
+    Area       area;
+    Area::Ring master;
+    Area::Ring outer1;
+    Area::Ring outer2;
+    Area::Ring inner;
+
+    master.SetType(areaType);
+    master.MarkAsMasterRing();
+
+    outer1.SetType(typeConfig.typeInfoIgnore);
+    outer1.MarkAsOuterRing();
+    outer1.nodes=CreateNodes(30.0,0.01,10);
+
+    inner.SetType(typeConfig.typeInfoIgnore);
+    inner.SetRing(Area::outerRingId+1);
+    inner.nodes=CreateNodes(30.0,0.001,10);
+
+    outer2.SetType(typeConfig.typeInfoIgnore);
+    outer2.MarkAsOuterRing();
+    outer2.nodes=CreateNodes(35.0,0.1,10);
+
+    area.rings.push_back(master);
+    area.rings.push_back(outer1);
+    area.rings.push_back(inner);
+    area.rings.push_back(outer2);
+    areas.push_back(area);
+  }
+
+  TempDirectory directory;
+  std::string   filename=directory.GetFile("objects.dat");
+  FileWriter    writer;
+
+  writer.Open(filename);
+
+  for (const auto& area : areas) {
+    area.Write(typeConfig,writer);
+  }
+
+  writer.Close();
+
+  FileScanner scanner;
+
+  scanner.Open(filename,FileScanner::Sequential,true);
+
+  for (const auto& written : areas) {
+    AreaView view;
+    Area     area;
+
+    view.Read(typeConfig,scanner);
+
+    REQUIRE(view.GetType()==areaType);
+    REQUIRE(view.GetRingCount()==written.rings.size());
+
+    view.Materialize(typeConfig,scanner,area);
+
+    REQUIRE(scanner.GetPos()==view.GetNextFileOffset());
+    REQUIRE(area.GetFileOffset()==view.GetFileOffset());
+    REQUIRE(area.GetNextFileOffset()==view.GetNextFileOffset());
+    REQUIRE(area.GetType()==areaType);
+    REQUIRE(area.rings.size()==written.rings.size());
+
+    for (size_t r=0; r<area.rings.size(); r++) {
+      REQUIRE(area.rings[r].GetType()==written.rings[r].GetType());
+      REQUIRE(area.rings[r].GetRing()==written.rings[r].GetRing());
+      REQUIRE(area.rings[r].nodes.size()==written.rings[r].nodes.size());
+    }
+
+    CheckBox(view.GetBoundingBox(),area.GetBoundingBox());
+  }
+
+  scanner.Close();
+}
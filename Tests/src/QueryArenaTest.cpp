@@ -0,0 +1,142 @@
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <osmscout/DataFile.h>
+#include <osmscout/TypeConfig.h>
+#include <osmscout/Way.h>
+
+#include <osmscout/util/FileWriter.h>
+#include <osmscout/util/QueryArena.h>
+
+#include <TempDirectory.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+using namespace osmscout;
+
+TEST_CASE("Allocations are aligned and served from few blocks")
+{
+  QueryArena arena(1024);
+
+  for (size_t i=0; i<100; i++) {
+    void* p=arena.Allocate(1+i%7,8);
+
+    REQUIRE(reinterpret_cast<uintptr_t>(p)%8==0);
+  }
+
+  REQUIRE(arena.GetAllocationCount()==100);
+  REQUIRE(arena.GetBlockCount()==1);
+
+  // Requests bigger than the block size get their own block
+  arena.Allocate(4096,8);
+
+  REQUIRE(arena.GetBlockCount()==2);
+  REQUIRE(arena.GetMemoryUsage()==1024+4096);
+}
+
+TEST_CASE("Objects keep the arena alive")
+{
+  std::weak_ptr<QueryArena> weakArena;
+  std::vector<WayRef>       ways;
+
+  {
+    QueryArenaRef arena=std::make_shared<QueryArena>();
+
+    weakArena=arena;
+
+    for (size_t i=0; i<10; i++) {
+      WayRef way=MakeShared<Way>(arena);
+
+      way->nodes.resize(i);
+      ways.push_back(way);
+    }
+
+    REQUIRE(arena->GetAllocationCount()==10);
+    REQUIRE(arena->GetBlockCount()==1);
+  }
+
+  REQUIRE_FALSE(weakArena.expired());
+
+  for (size_t i=0; i<ways.size(); i++) {
+    REQUIRE(ways[i]->nodes.size()==i);
+  }
+
+  ways.clear();
+
+  REQUIRE(weakArena.expired());
+}
+
+TEST_CASE("Without arena objects are allocated on the heap")
+{
+  WayRef way=MakeShared<Way>(QueryArenaRef());
+
+  REQUIRE(way);
+  REQUIRE(way.use_count()==1);
+}
+
+TEST_CASE("Objects loaded into an arena are not cached")
+{
+  TempDirectory           directory;
+  TypeConfigRef           typeConfig=std::make_shared<TypeConfig>();
+  TypeInfoRef             type=std::make_shared<TypeInfo>("way");
+  std::vector<FileOffset> offsets;
+  FileWriter              writer;
+
+  type->CanBeWay(true);
+  typeConfig->RegisterType(type);
+
+  writer.Open(directory.GetFile("ways.dat"));
+  writer.Write((uint32_t)2);
+
+  for (size_t i=0; i<2; i++) {
+    Way way;
+
+    way.SetType(type);
+    way.nodes.emplace_back(0,GeoCoord(50.0+i*0.01,10.0));
+    way.nodes.emplace_back(0,GeoCoord(50.0+i*0.01,10.01));
+
+    offsets.push_back(writer.GetPos());
+    way.Write(*typeConfig,writer);
+  }
+
+  writer.Close();
+
+  DataFile<Way> dataFile("ways.dat",10);
+
+  REQUIRE(dataFile.Open(typeConfig,directory.GetPath(),false));
+
+  std::weak_ptr<QueryArena> weakArena;
+  std::vector<WayRef>       ways;
+
+  {
+    QueryArenaRef arena=std::make_shared<QueryArena>();
+
+    weakArena=arena;
+
+    REQUIRE(dataFile.GetByOffset(offsets.begin(),offsets.end(),offsets.size(),ways,arena));
+    REQUIRE(arena->GetAllocationCount()==2);
+  }
+
+  REQUIRE(ways.size()==2);
+  REQUIRE(ways[1]->GetFileOffset()==offsets[1]);
+
+  // Only the result references the arena
+  ways.clear();
+
+  REQUIRE(weakArena.expired());
+
+  // Objects loaded without arena are cached and returned from the cache afterwards
+  std::vector<WayRef> cachedWays;
+
+  REQUIRE(dataFile.GetByOffset(offsets.begin(),offsets.end(),offsets.size(),cachedWays));
+
+  QueryArenaRef arena=std::make_shared<QueryArena>();
+
+  REQUIRE(dataFile.GetByOffset(offsets.begin(),offsets.end(),offsets.size(),ways,arena));
+  REQUIRE(arena->GetAllocationCount()==0);
+  REQUIRE(ways==cachedWays);
+
+  REQUIRE(dataFile.Close());
+}
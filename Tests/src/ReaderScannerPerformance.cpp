@@ -17,46 +17,55 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <random>
 
 #include <osmscout/Way.h>
 
+#include <osmscout/util/BlockCompression.h>
+#include <osmscout/util/File.h>
 #include <osmscout/util/FileScanner.h>
 #include <osmscout/util/StopClock.h>
+#include <osmscout/util/String.h>
 
 /**
-  Sequentially read the ways.dat file in the current directory first using
-  FileReader and then using FileScanner and compare execution time.
+  Sequentially read the ways.dat file in the current directory using
+  FileScanner with and without mmap and compare execution time.
+
+  Afterwards a block compressed copy of the file is created and the size
+  and the time for sequential and random access are compared to the
+  uncompressed file.
 
   Call this program repeately to avoid different timing because of OS file caching.
 */
 
-int main(int /*argc*/, char* /*argv*/[])
+static bool ReadWays(const osmscout::TypeConfig& typeConfig,
+                     const std::string& wayFilename,
+                     bool useMmap,
+                     std::vector<osmscout::FileOffset>& offsets)
 {
-  std::string           wayFilename="ways.dat";
-
   osmscout::StopClock   scannerTimer;
-
-  osmscout::TypeConfig  typeConfig;
   osmscout::FileScanner scanner;
 
-  if (!typeConfig.LoadFromDataFile(".")) {
-    std::cerr << "Cannot open type configuration!" << std::endl;
-    return 1;
-  }
-
   try {
-    scanner.Open(wayFilename,osmscout::FileScanner::Sequential,true);
+    scanner.Open(wayFilename,osmscout::FileScanner::Sequential,useMmap);
 
-    std::cout << "Start reading files using FileScanner..." << std::endl;
+    std::cout << "Start reading files using FileScanner (" << (useMmap ? "mmap" : "buffered") << ")..." << std::endl;
 
     uint32_t wayCount;
 
     scanner.Read(wayCount);
 
+    offsets.clear();
+    offsets.reserve(wayCount);
+
     for (size_t w=1; w<=wayCount; w++) {
       osmscout::Way way;
 
+      offsets.push_back(scanner.GetPos());
+
       way.Read(typeConfig,
                scanner);
     }
@@ -65,10 +74,113 @@ int main(int /*argc*/, char* /*argv*/[])
 
     scannerTimer.Stop();
 
-    std::cout << "Reading " << wayCount << " ways via FileScanner took " << scannerTimer << std::endl;
+    std::cout << "Reading " << wayCount << " ways via FileScanner (" << (useMmap ? "mmap" : "buffered") << ") took " << scannerTimer << std::endl;
+  }
+  catch (osmscout::IOException& e) {
+    std::cerr << e.GetDescription() << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+static bool ReadWaysRandom(const osmscout::TypeConfig& typeConfig,
+                           const std::string& wayFilename,
+                           const std::vector<osmscout::FileOffset>& offsets)
+{
+  osmscout::StopClock   scannerTimer;
+  osmscout::FileScanner scanner;
+
+  try {
+    scanner.Open(wayFilename,osmscout::FileScanner::LowMemRandom,false);
+
+    for (const auto offset : offsets) {
+      osmscout::Way way;
+
+      scanner.SetPos(offset);
+      way.Read(typeConfig,
+               scanner);
+    }
+
+    scanner.Close();
+
+    scannerTimer.Stop();
+
+    std::cout << "Reading " << offsets.size() << " ways in random order from '" << wayFilename << "' took " << scannerTimer;
+    std::cout << " (" << scannerTimer.GetMilliseconds()*1000.0/std::max(offsets.size(),(size_t)1) << " us/way)" << std::endl;
+  }
+  catch (osmscout::IOException& e) {
+    std::cerr << e.GetDescription() << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+static bool CompareCompressed(const osmscout::TypeConfig& typeConfig,
+                              const std::string& wayFilename,
+                              const std::vector<osmscout::FileOffset>& offsets)
+{
+  std::string compressedFilename=wayFilename+".compressed";
+
+  try {
+    {
+      std::ifstream source(wayFilename,std::ios::binary);
+      std::ofstream destination(compressedFilename,std::ios::binary);
+
+      destination << source.rdbuf();
+    }
+
+    osmscout::StopClock compressionTimer;
+
+    osmscout::CompressFile(compressedFilename,16*1024,6);
+
+    compressionTimer.Stop();
+
+    std::cout << "Compressing '" << wayFilename << "' from " << osmscout::ByteSizeToString(osmscout::GetFileSize(wayFilename));
+    std::cout << " to " << osmscout::ByteSizeToString(osmscout::GetFileSize(compressedFilename));
+    std::cout << " took " << compressionTimer << std::endl;
   }
   catch (osmscout::IOException& e) {
     std::cerr << e.GetDescription() << std::endl;
+    osmscout::RemoveFile(compressedFilename);
+    return false;
+  }
+
+  std::vector<osmscout::FileOffset> compressedOffsets;
+  std::vector<osmscout::FileOffset> randomOffsets(offsets);
+
+  std::shuffle(randomOffsets.begin(),randomOffsets.end(),std::mt19937(42));
+
+  bool result=ReadWays(typeConfig,compressedFilename,false,compressedOffsets) &&
+              ReadWaysRandom(typeConfig,wayFilename,randomOffsets) &&
+              ReadWaysRandom(typeConfig,compressedFilename,randomOffsets);
+
+  osmscout::RemoveFile(compressedFilename);
+
+  return result;
+}
+
+int main(int /*argc*/, char* /*argv*/[])
+{
+  std::string          wayFilename="ways.dat";
+  osmscout::TypeConfig typeConfig;
+
+  if (!typeConfig.LoadFromDataFile(".")) {
+    std::cerr << "Cannot open type configuration!" << std::endl;
+    return 1;
+  }
+
+  std::vector<osmscout::FileOffset> offsets;
+
+  if (!ReadWays(typeConfig,wayFilename,true,offsets) ||
+      !ReadWays(typeConfig,wayFilename,false,offsets)) {
+    return 1;
+  }
+
+  if (osmscout::IsBlockCompressionSupported() &&
+      !osmscout::IsBlockCompressedFile(wayFilename) &&
+      !CompareCompressed(typeConfig,wayFilename,offsets)) {
     return 1;
   }
 
@@ -0,0 +1,123 @@
+#include <string>
+#include <vector>
+
+#include <osmscout/TypeConfig.h>
+
+#include <osmscout/routing/RouteNodeDataFile.h>
+
+#include <osmscout/util/FileWriter.h>
+#include <osmscout/util/TileId.h>
+
+#include <TempDirectory.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+using namespace osmscout;
+
+static const std::string filename="RouteNodeDataFileTest.dat";
+
+static const MagnificationLevel tileMag(13);
+
+struct Cell
+{
+  Pixel              cell;
+  FileOffset         fileOffset;
+  std::vector<Point> points;
+};
+
+/**
+ * Write a route node data file with three cells, each holding a few route
+ * nodes. The index is written in reverse cell order to make sure, that the
+ * reader does not depend on the order of the index entries.
+ */
+static std::vector<Cell> WriteRouteNodes(TempDirectory& directory)
+{
+  Magnification     magnification(tileMag);
+  std::vector<Cell> cells;
+
+  for (double lat : {10.0,10.1,11.0}) {
+    Cell cell;
+
+    cell.cell=TileId::GetTile(magnification,GeoCoord(lat,20.0)).AsPixel();
+
+    for (size_t i=0; i<3; i++) {
+      cell.points.emplace_back(1,GeoCoord(lat+i*0.001,20.0+i*0.001));
+    }
+
+    cells.push_back(cell);
+  }
+
+  FileWriter writer;
+  uint32_t   nodeCount=0;
+
+  writer.Open(directory.GetFile(filename));
+
+  writer.Write((FileOffset)0);
+  writer.Write(nodeCount);
+  writer.Write((uint32_t)tileMag.Get());
+
+  for (auto& cell : cells) {
+    cell.fileOffset=writer.GetPos();
+
+    for (const auto& point : cell.points) {
+      RouteNode node;
+
+      node.Initialize(writer.GetPos(),point);
+      node.Write(writer);
+
+      nodeCount++;
+    }
+  }
+
+  FileOffset indexFileOffset=writer.GetPos();
+
+  writer.SetPos(0);
+  writer.WriteFileOffset(indexFileOffset);
+  writer.Write(nodeCount);
+
+  writer.SetPos(indexFileOffset);
+
+  writer.Write((uint32_t)cells.size());
+  for (auto cell=cells.rbegin(); cell!=cells.rend(); ++cell) {
+    writer.Write(cell->cell.x);
+    writer.Write(cell->cell.y);
+    writer.WriteFileOffset(cell->fileOffset);
+    writer.Write((uint32_t)cell->points.size());
+  }
+
+  writer.Close();
+
+  return cells;
+}
+
+TEST_CASE("Route nodes are found by id")
+{
+  TempDirectory     directory;
+  TypeConfigRef     typeConfig=std::make_shared<TypeConfig>();
+  std::vector<Cell> cells=WriteRouteNodes(directory);
+  RouteNodeDataFile dataFile(filename,10);
+
+  REQUIRE(dataFile.Open(typeConfig,directory.GetPath(),true));
+
+  for (const auto& cell : cells) {
+    REQUIRE(dataFile.IsCovered(cell.cell));
+
+    for (const auto& point : cell.points) {
+      RouteNodeRef node;
+
+      REQUIRE(dataFile.IsCovered(point.GetCoord()));
+      REQUIRE(dataFile.Get(point.GetId(),node));
+      REQUIRE(node->GetId()==point.GetId());
+    }
+  }
+
+  Point        unknown(1,GeoCoord(-10.0,-20.0));
+  RouteNodeRef node;
+
+  REQUIRE_FALSE(dataFile.IsCovered(unknown.GetCoord()));
+  REQUIRE_FALSE(dataFile.Get(unknown.GetId(),node));
+
+  REQUIRE(dataFile.Close());
+  REQUIRE_FALSE(dataFile.IsCovered(cells.front().cell));
+}
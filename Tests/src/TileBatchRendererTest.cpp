@@ -0,0 +1,348 @@
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <tuple>
+
+#include <osmscout/Database.h>
+#include <osmscout/MapService.h>
+#include <osmscout/StyleConfig.h>
+#include <osmscout/TileBatchRenderer.h>
+#include <osmscout/TypeConfig.h>
+
+#include <osmscout/util/Tiling.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+using namespace osmscout;
+
+static const MagnificationLevel level(10);
+static const Magnification      magnification(level);
+
+// 5x3 tiles, partitioned into 3x2 meta tiles of size 2
+static const OSMTileIdBox tileBox(OSMTileId(540,340),
+                                  OSMTileId(544,342));
+
+typedef std::tuple<uint32_t,uint32_t,uint32_t> TileKeyTuple;
+
+static TileKeyTuple GetKey(const Magnification& magnification,
+                           const OSMTileId& tileId)
+{
+  return TileKeyTuple(magnification.GetLevel(),tileId.GetX(),tileId.GetY());
+}
+
+/**
+ * Records which painter rendered which tile. Every painter has its own id,
+ * and since the renderer creates one painter per thread, the id also
+ * identifies the thread.
+ */
+struct RenderLog
+{
+  std::mutex                     mutex;
+  std::map<TileKeyTuple,size_t>  painterByTile;
+  size_t                         renderCount=0;
+  size_t                         painterCount=0;
+  std::set<TileKeyTuple>         failingTiles;
+};
+
+class TestPainter : public TileBatchPainter
+{
+private:
+  RenderLog& log;
+  size_t     id;
+
+public:
+  TestPainter(RenderLog& log,
+              size_t id)
+  : log(log),
+    id(id)
+  {
+    // no code
+  }
+
+  bool RenderTile(const OSMTileId& tileId,
+                  const TileProjection& projection,
+                  const MapData& /*data*/,
+                  std::string& output) override
+  {
+    std::lock_guard<std::mutex> guard(log.mutex);
+    TileKeyTuple                key=GetKey(projection.GetMagnification(),tileId);
+
+    log.renderCount++;
+    log.painterByTile[key]=id;
+
+    if (log.failingTiles.find(key)!=log.failingTiles.end()) {
+      return false;
+    }
+
+    output="rendered "+tileId.GetDisplayText();
+
+    return true;
+  }
+};
+
+class TestSink : public TileBatchSink
+{
+public:
+  std::mutex                          mutex;
+  std::map<TileKeyTuple,std::string>  tiles;
+
+public:
+  bool HasTile(const Magnification& magnification,
+               const OSMTileId& tileId) override
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+
+    return tiles.find(GetKey(magnification,tileId))!=tiles.end();
+  }
+
+  bool WriteTile(const Magnification& magnification,
+                 const OSMTileId& tileId,
+                 const std::string& data) override
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+
+    tiles[GetKey(magnification,tileId)]=data;
+
+    return true;
+  }
+};
+
+/**
+ * Renderer on top of a MapService with an empty (not opened) database. All
+ * data tiles of the test region are marked as complete up front, so the
+ * renderer never has to load data from the database.
+ */
+struct TestRenderer
+{
+  DatabaseRef        database=std::make_shared<Database>(DatabaseParameter());
+  MapServiceRef      mapService=std::make_shared<MapService>(database);
+  StyleConfigRef     styleConfig=std::make_shared<StyleConfig>(std::make_shared<TypeConfig>());
+  std::list<TileRef> dataTiles;
+  RenderLog          renderLog;
+
+  TestRenderer()
+  {
+    GeoBox boundingBox=tileBox.GetBoundingBox(magnification);
+
+    // Include neighbouring data tiles touched by the borders of the region
+    boundingBox=GeoBox(GeoCoord(boundingBox.GetMinLat()-0.5,boundingBox.GetMinLon()-0.5),
+                       GeoCoord(boundingBox.GetMaxLat()+0.5,boundingBox.GetMaxLon()+0.5));
+
+    mapService->LookupTiles(magnification,
+                            boundingBox,
+                            dataTiles);
+
+    for (const auto& tile : dataTiles) {
+      tile->GetNodeData().SetComplete();
+      tile->GetWayData().SetComplete();
+      tile->GetAreaData().SetComplete();
+      tile->GetOptimizedWayData().SetComplete();
+      tile->GetOptimizedAreaData().SetComplete();
+    }
+  }
+
+  TileBatchRenderer::PainterFactory GetPainterFactory()
+  {
+    return [this]() {
+      std::lock_guard<std::mutex> guard(renderLog.mutex);
+
+      return std::make_shared<TestPainter>(renderLog,
+                                           renderLog.painterCount++);
+    };
+  }
+
+  static TileBatchParameter GetParameter()
+  {
+    TileBatchParameter parameter;
+
+    parameter.SetThreadCount(3);
+    parameter.SetMetaTileSize(2);
+
+    return parameter;
+  }
+
+  /**
+   * Return the geographic region of the test tiles, slightly shrunk so that
+   * it does not touch neighbouring tiles
+   */
+  static GeoBox GetRegion()
+  {
+    return GeoBox(tileBox.GetMin().GetBoundingBox(magnification).GetCenter(),
+                  tileBox.GetMax().GetBoundingBox(magnification).GetCenter());
+  }
+};
+
+TEST_CASE("Every tile is rendered once and meta tiles stay on one thread")
+{
+  TestRenderer        testRenderer;
+  TestSink            sink;
+  TileBatchStatistics statistics;
+  TileBatchRenderer   renderer(testRenderer.mapService,
+                               testRenderer.styleConfig,
+                               TestRenderer::GetParameter());
+
+  REQUIRE(renderer.Render(TestRenderer::GetRegion(),
+                          level,
+                          level,
+                          testRenderer.GetPainterFactory(),
+                          sink,
+                          statistics));
+
+  REQUIRE(testRenderer.renderLog.painterCount==3);
+  REQUIRE(testRenderer.renderLog.renderCount==tileBox.GetCount());
+  REQUIRE(sink.tiles.size()==tileBox.GetCount());
+
+  std::map<std::pair<uint32_t,uint32_t>,size_t> painterByMetaTile;
+
+  for (const auto& tileId : tileBox) {
+    TileKeyTuple key=GetKey(magnification,tileId);
+
+    REQUIRE(sink.tiles[key]=="rendered "+tileId.GetDisplayText());
+
+    // All tiles of a meta tile are rendered by the same painter
+    std::pair<uint32_t,uint32_t> metaTile((tileId.GetX()-tileBox.GetMinX())/2,
+                                          (tileId.GetY()-tileBox.GetMinY())/2);
+    size_t                       painter=testRenderer.renderLog.painterByTile[key];
+
+    auto entry=painterByMetaTile.insert(std::make_pair(metaTile,painter));
+
+    REQUIRE(entry.first->second==painter);
+  }
+
+  REQUIRE(painterByMetaTile.size()==6);
+
+  REQUIRE(statistics.tileCount==tileBox.GetCount());
+  REQUIRE(statistics.skippedTileCount==0);
+  REQUIRE(statistics.failedTileCount==0);
+  REQUIRE(statistics.dataTileHits>0);
+  REQUIRE(statistics.dataTileMisses==0);
+  REQUIRE(statistics.GetDataTileHitRate()==1.0);
+}
+
+TEST_CASE("Resuming skips tiles already existing in the sink")
+{
+  TestRenderer        testRenderer;
+  TestSink            sink;
+  TileBatchStatistics statistics;
+  TileBatchParameter  parameter=TestRenderer::GetParameter();
+
+  TileKeyTuple first=GetKey(magnification,tileBox.GetMin());
+  TileKeyTuple last=GetKey(magnification,tileBox.GetMax());
+
+  sink.tiles[first]="existing";
+  sink.tiles[last]="existing";
+
+  SECTION("Skip existing tiles") {
+    TileBatchRenderer renderer(testRenderer.mapService,
+                               testRenderer.styleConfig,
+                               parameter);
+
+    REQUIRE(renderer.Render(TestRenderer::GetRegion(),
+                            level,
+                            level,
+                            testRenderer.GetPainterFactory(),
+                            sink,
+                            statistics));
+
+    REQUIRE(testRenderer.renderLog.renderCount==tileBox.GetCount()-2);
+    REQUIRE(testRenderer.renderLog.painterByTile.count(first)==0);
+    REQUIRE(testRenderer.renderLog.painterByTile.count(last)==0);
+    REQUIRE(sink.tiles[first]=="existing");
+    REQUIRE(sink.tiles[last]=="existing");
+    REQUIRE(statistics.tileCount==tileBox.GetCount()-2);
+    REQUIRE(statistics.skippedTileCount==2);
+  }
+
+  SECTION("Render existing tiles again") {
+    parameter.SetSkipExisting(false);
+
+    TileBatchRenderer renderer(testRenderer.mapService,
+                               testRenderer.styleConfig,
+                               parameter);
+
+    REQUIRE(renderer.Render(TestRenderer::GetRegion(),
+                            level,
+                            level,
+                            testRenderer.GetPainterFactory(),
+                            sink,
+                            statistics));
+
+    REQUIRE(testRenderer.renderLog.renderCount==tileBox.GetCount());
+    REQUIRE(sink.tiles[first]!="existing");
+    REQUIRE(statistics.tileCount==tileBox.GetCount());
+    REQUIRE(statistics.skippedTileCount==0);
+  }
+}
+
+TEST_CASE("Failed tiles are counted and fail the run")
+{
+  TestRenderer        testRenderer;
+  TestSink            sink;
+  TileBatchStatistics statistics;
+  TileBatchRenderer   renderer(testRenderer.mapService,
+                               testRenderer.styleConfig,
+                               TestRenderer::GetParameter());
+
+  testRenderer.renderLog.failingTiles.insert(GetKey(magnification,tileBox.GetMin()));
+
+  REQUIRE_FALSE(renderer.Render(TestRenderer::GetRegion(),
+                                level,
+                                level,
+                                testRenderer.GetPainterFactory(),
+                                sink,
+                                statistics));
+
+  REQUIRE(statistics.tileCount==tileBox.GetCount()-1);
+  REQUIRE(statistics.failedTileCount==1);
+  REQUIRE(sink.tiles.size()==tileBox.GetCount()-1);
+
+  // Statistics of further runs are added
+  testRenderer.renderLog.failingTiles.clear();
+
+  REQUIRE(renderer.Render(TestRenderer::GetRegion(),
+                          level,
+                          level,
+                          testRenderer.GetPainterFactory(),
+                          sink,
+                          statistics));
+
+  REQUIRE(statistics.tileCount==tileBox.GetCount());
+  REQUIRE(statistics.skippedTileCount==tileBox.GetCount()-1);
+  REQUIRE(statistics.failedTileCount==1);
+  REQUIRE(statistics.totalTime>0.0);
+  REQUIRE(statistics.GetTilesPerSecond()>0.0);
+}
+
+TEST_CASE("Abort before Render stops the run and is reset afterwards")
+{
+  TestRenderer        testRenderer;
+  TestSink            sink;
+  TileBatchStatistics statistics;
+  TileBatchRenderer   renderer(testRenderer.mapService,
+                               testRenderer.styleConfig,
+                               TestRenderer::GetParameter());
+
+  renderer.Abort();
+
+  REQUIRE_FALSE(renderer.Render(TestRenderer::GetRegion(),
+                                level,
+                                level,
+                                testRenderer.GetPainterFactory(),
+                                sink,
+                                statistics));
+
+  REQUIRE(testRenderer.renderLog.renderCount==0);
+  REQUIRE(sink.tiles.empty());
+
+  REQUIRE(renderer.Render(TestRenderer::GetRegion(),
+                          level,
+                          level,
+                          testRenderer.GetPainterFactory(),
+                          sink,
+                          statistics));
+
+  REQUIRE(sink.tiles.size()==tileBox.GetCount());
+}
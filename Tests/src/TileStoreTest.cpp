@@ -0,0 +1,133 @@
+#include <string>
+
+#include <osmscout/TileStore.h>
+
+#include <TempDirectory.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+using namespace osmscout;
+
+/**
+ * Register all files of a tile store in the given directory for removal and
+ * return the directory path
+ */
+static std::string GetStoreDirectory(TempDirectory& directory)
+{
+  directory.GetFile("tiles.idx");
+  directory.GetFile("tiles.dat");
+  directory.GetFile("tiles.dat.new");
+
+  return directory.GetPath();
+}
+
+TEST_CASE("Store and retrieve tiles")
+{
+  TempDirectory tempDirectory;
+  std::string   directory=GetStoreDirectory(tempDirectory);
+  TileStore     store;
+  uint64_t      space=TileStore::GetNamespace("style-a");
+  std::string   data;
+
+  REQUIRE(store.Open(directory,0));
+
+  REQUIRE(store.Put(space,MagnificationLevel(10),OSMTileId(1,2),"tile-1-2"));
+  REQUIRE(store.Put(space,MagnificationLevel(10),OSMTileId(2,1),"tile-2-1"));
+
+  REQUIRE(store.GetTileCount()==2);
+  REQUIRE(store.Contains(space,MagnificationLevel(10),OSMTileId(1,2)));
+  REQUIRE_FALSE(store.Contains(space,MagnificationLevel(11),OSMTileId(1,2)));
+  REQUIRE_FALSE(store.Contains(TileStore::GetNamespace("style-b"),MagnificationLevel(10),OSMTileId(1,2)));
+
+  REQUIRE(store.Get(space,MagnificationLevel(10),OSMTileId(2,1),data));
+  REQUIRE(data=="tile-2-1");
+
+  // Replace existing tile
+  REQUIRE(store.Put(space,MagnificationLevel(10),OSMTileId(2,1),"new-tile-2-1"));
+  REQUIRE(store.GetTileCount()==2);
+  REQUIRE(store.Get(space,MagnificationLevel(10),OSMTileId(2,1),data));
+  REQUIRE(data=="new-tile-2-1");
+
+  store.Close();
+}
+
+TEST_CASE("Tiles survive reopening")
+{
+  TempDirectory tempDirectory;
+  std::string   directory=GetStoreDirectory(tempDirectory);
+  TileStore     store;
+  uint64_t      space=TileStore::GetNamespace("style-a");
+  std::string   data;
+
+  REQUIRE(store.Open(directory,0));
+  REQUIRE(store.Put(space,MagnificationLevel(5),OSMTileId(3,4),"persistent"));
+  store.Close();
+
+  REQUIRE(store.Open(directory,0));
+  REQUIRE(store.Get(space,MagnificationLevel(5),OSMTileId(3,4),data));
+  REQUIRE(data=="persistent");
+  store.Close();
+}
+
+TEST_CASE("Index grows")
+{
+  TempDirectory tempDirectory;
+  std::string   directory=GetStoreDirectory(tempDirectory);
+  TileStore     store;
+  uint64_t      space=TileStore::GetNamespace("style-a");
+  std::string   data;
+
+  REQUIRE(store.Open(directory,0));
+
+  for (uint32_t x=0; x<100; x++) {
+    for (uint32_t y=0; y<100; y++) {
+      REQUIRE(store.Put(space,MagnificationLevel(14),OSMTileId(x,y),std::to_string(x)+"/"+std::to_string(y)));
+    }
+  }
+
+  REQUIRE(store.GetTileCount()==10000);
+
+  for (uint32_t x=0; x<100; x++) {
+    for (uint32_t y=0; y<100; y++) {
+      REQUIRE(store.Get(space,MagnificationLevel(14),OSMTileId(x,y),data));
+      REQUIRE(data==std::to_string(x)+"/"+std::to_string(y));
+    }
+  }
+
+  store.Close();
+}
+
+TEST_CASE("Compaction keeps recently used tiles")
+{
+  TempDirectory tempDirectory;
+  std::string   directory=GetStoreDirectory(tempDirectory);
+  TileStore     store;
+  uint64_t      space=TileStore::GetNamespace("style-a");
+  std::string tile(100,'x');
+  std::string   data;
+
+  REQUIRE(store.Open(directory,1000));
+
+  for (uint32_t x=0; x<10; x++) {
+    REQUIRE(store.Put(space,MagnificationLevel(10),OSMTileId(x,0),tile));
+  }
+
+  // Touch the first tile, so that it is the most recently used one
+  REQUIRE(store.Get(space,MagnificationLevel(10),OSMTileId(0,0),data));
+
+  // Exceeds the maximum size and triggers compaction down to 750 bytes
+  REQUIRE(store.Put(space,MagnificationLevel(10),OSMTileId(10,0),tile));
+
+  REQUIRE(store.GetTileCount()==7);
+  REQUIRE(store.GetDataSize()==700);
+  REQUIRE(store.Contains(space,MagnificationLevel(10),OSMTileId(0,0)));
+  REQUIRE(store.Contains(space,MagnificationLevel(10),OSMTileId(10,0)));
+  REQUIRE_FALSE(store.Contains(space,MagnificationLevel(10),OSMTileId(1,0)));
+
+  REQUIRE(store.Get(space,MagnificationLevel(10),OSMTileId(10,0),data));
+  REQUIRE(data==tile);
+
+  REQUIRE(store.Clear());
+  store.Close();
+}
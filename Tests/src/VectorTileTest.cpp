@@ -0,0 +1,133 @@
+#include <string>
+#include <vector>
+
+#include <osmscout/VectorTile.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+using namespace osmscout;
+
+TEST_CASE("Encode layer with single point")
+{
+  VectorTile                  tile;
+  VectorTileLayer::Properties properties;
+
+  properties.emplace_back("type","x");
+
+  tile.GetLayer("nodes").AddPoint(1,
+                                  properties,
+                                  VectorTilePoint(25,17));
+
+  // Empty layers are not encoded
+  tile.GetLayer("ways");
+
+  const unsigned char expected[]={
+    0x1a,0x26,                               // tile.layers
+    0x78,0x02,                               // layer.version
+    0x0a,0x05,'n','o','d','e','s',           // layer.name
+    0x12,0x0d,                               // layer.features
+    0x08,0x01,                               // feature.id
+    0x12,0x02,0x00,0x00,                     // feature.tags
+    0x18,0x01,                               // feature.type
+    0x22,0x03,0x09,0x32,0x22,                // feature.geometry
+    0x1a,0x04,'t','y','p','e',               // layer.keys
+    0x22,0x03,0x0a,0x01,'x',                 // layer.values
+    0x28,0x80,0x20                           // layer.extent
+  };
+
+  REQUIRE(tile.GetFeatureCount()==1);
+  REQUIRE(tile.Encode()==std::string(reinterpret_cast<const char*>(expected),sizeof(expected)));
+}
+
+TEST_CASE("Line without points is not added")
+{
+  VectorTile tile;
+
+  tile.GetLayer("ways").AddLineStrings(1,
+                                       VectorTileLayer::Properties(),
+                                       {{VectorTilePoint(1,1)}});
+
+  REQUIRE(tile.GetFeatureCount()==0);
+  REQUIRE(tile.Encode().empty());
+}
+
+TEST_CASE("Clip line leaving and reentering the tile")
+{
+  std::vector<VectorTileBuilder::Vertex>              line={{-10,5},{5,5},{5,20},{8,20},{8,5},{20,5}};
+  std::vector<std::vector<VectorTileBuilder::Vertex>> parts;
+
+  VectorTileBuilder::ClipLine(line,
+                              0,0,
+                              10,10,
+                              parts);
+
+  REQUIRE(parts.size()==2);
+
+  REQUIRE(parts[0].size()==3);
+  REQUIRE(parts[0][0].x==0.0);
+  REQUIRE(parts[0][0].y==5.0);
+  REQUIRE(parts[0][2].x==5.0);
+  REQUIRE(parts[0][2].y==10.0);
+
+  REQUIRE(parts[1].size()==3);
+  REQUIRE(parts[1][0].x==8.0);
+  REQUIRE(parts[1][0].y==10.0);
+  REQUIRE(parts[1][2].x==10.0);
+  REQUIRE(parts[1][2].y==5.0);
+}
+
+TEST_CASE("Clip line completely outside")
+{
+  std::vector<VectorTileBuilder::Vertex>              line={{-10,-5},{20,-5}};
+  std::vector<std::vector<VectorTileBuilder::Vertex>> parts;
+
+  VectorTileBuilder::ClipLine(line,
+                              0,0,
+                              10,10,
+                              parts);
+
+  REQUIRE(parts.empty());
+}
+
+TEST_CASE("Clip ring")
+{
+  std::vector<VectorTileBuilder::Vertex> ring={{-5,-5},{5,-5},{5,5},{-5,5}};
+  std::vector<VectorTileBuilder::Vertex> result;
+
+  VectorTileBuilder::ClipRing(ring,
+                              0,0,
+                              10,10,
+                              result);
+
+  double minX=result.front().x;
+  double maxX=result.front().x;
+  double minY=result.front().y;
+  double maxY=result.front().y;
+
+  for (const auto& vertex : result) {
+    minX=std::min(minX,vertex.x);
+    maxX=std::max(maxX,vertex.x);
+    minY=std::min(minY,vertex.y);
+    maxY=std::max(maxY,vertex.y);
+  }
+
+  REQUIRE(minX==0.0);
+  REQUIRE(maxX==5.0);
+  REQUIRE(minY==0.0);
+  REQUIRE(maxY==5.0);
+}
+
+TEST_CASE("Simplify drops points within tolerance")
+{
+  std::vector<VectorTilePoint> points={{0,0},{5,1},{10,0},{15,8},{20,0}};
+
+  VectorTileBuilder::Simplify(points,
+                              2.0);
+
+  REQUIRE(points.size()==4);
+  REQUIRE(points[0]==VectorTilePoint(0,0));
+  REQUIRE(points[1]==VectorTilePoint(10,0));
+  REQUIRE(points[2]==VectorTilePoint(15,8));
+  REQUIRE(points[3]==VectorTilePoint(20,0));
+}
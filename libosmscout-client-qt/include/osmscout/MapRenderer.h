@@ -25,6 +25,7 @@
 #include <QSettings>
 
 #include <osmscout/DataTileCache.h>
+#include <osmscout/IncrementalMapData.h>
 #include <osmscout/DBThread.h>
 
 #include <osmscout/ClientQtImportExport.h>
@@ -46,6 +47,7 @@ private:
   bool drawCanvasBackground;
   bool renderBasemap;
   std::vector<OverlayObjectRef> overlayObjects;
+  QMap<QString,osmscout::IncrementalMapDataRef> *incrementalData;
 
 public:
   DBRenderJob(osmscout::MercatorProjection renderProjection,
@@ -54,7 +56,8 @@ public:
               QPainter *p,
               std::vector<OverlayObjectRef> overlayObjects,
               bool drawCanvasBackground=true,
-              bool renderBasemap=true);
+              bool renderBasemap=true,
+              QMap<QString,osmscout::IncrementalMapDataRef> *incrementalData=nullptr);
   virtual ~DBRenderJob();
 
   virtual void Run(const osmscout::BasemapDatabaseRef& basemapDatabase,
@@ -43,6 +43,7 @@ private:
   MapViewStruct              lastRequest;
 
   DBLoadJob                     *loadJob;
+  QMap<QString,osmscout::IncrementalMapDataRef> incrementalData; // map data of last rendering, per database
 
   QTime                         lastRendering;
   QTimer                        pendingRenderingTimer;
@@ -27,6 +27,7 @@
 #include <osmscout/DataTileCache.h>
 #include <osmscout/DBThread.h>
 #include <osmscout/MapRenderer.h>
+#include <osmscout/TileStore.h>
 
 #include <osmscout/ClientQtImportExport.h>
 
@@ -56,6 +57,12 @@ private:
   TileCache                     onlineTileCache;
   TileCache                     offlineTileCache;
 
+  // Rendered offline tiles are persisted on disk, so they survive restarts.
+  // The namespace is derived from all rendering parameters and databases,
+  // so that outdated tiles are not used (and evicted later by compaction).
+  TileStoreRef                  persistentTileStore;
+  uint64_t                      persistentTileSpace; // guarded by tileCacheMutex
+
   OsmTileDownloader             *tileDownloader;
 
   std::atomic_bool              onlineTilesEnabled;
@@ -96,6 +103,9 @@ private:
 
   DatabaseCoverage databaseCoverageOfTile(uint32_t zoomLevel, uint32_t xtile, uint32_t ytile);
 
+  void UpdatePersistentTileSpace();
+  bool LoadPersistentTile(uint32_t zoomLevel, uint32_t xtile, uint32_t ytile);
+
 public:
   TiledMapRenderer(QThread *thread,
                    SettingsRef settings,
@@ -20,6 +20,8 @@
 
 #include <osmscout/MapRenderer.h>
 
+#include <algorithm>
+
 namespace osmscout {
 
 MapRenderer::MapRenderer(QThread *thread,
@@ -207,7 +209,8 @@ DBRenderJob::DBRenderJob(osmscout::MercatorProjection renderProjection,
                          QPainter *p,
                          std::vector<OverlayObjectRef> overlayObjects,
                          bool drawCanvasBackground,
-                         bool renderBasemap):
+                         bool renderBasemap,
+                         QMap<QString,osmscout::IncrementalMapDataRef> *incrementalData):
   renderProjection(renderProjection),
   tiles(tiles),
   drawParameter(drawParameter),
@@ -215,7 +218,8 @@ DBRenderJob::DBRenderJob(osmscout::MercatorProjection renderProjection,
   success(false),
   drawCanvasBackground(drawCanvasBackground),
   renderBasemap(renderBasemap),
-  overlayObjects(overlayObjects)
+  overlayObjects(overlayObjects),
+  incrementalData(incrementalData)
 {
 }
 
@@ -287,6 +291,20 @@ void DBRenderJob::Run(const osmscout::BasemapDatabaseRef& basemapDatabase,
     }
   }
 
+  // drop data of databases that were closed or removed since the last rendering
+  if (incrementalData!=nullptr){
+    for (auto it=incrementalData->begin(); it!=incrementalData->end();){
+      bool open=std::any_of(databases.begin(),databases.end(),[&it](const DBInstanceRef &db){
+        return db->path==it.key();
+      });
+      if (open){
+        ++it;
+      }else{
+        it=incrementalData->erase(it);
+      }
+    }
+  }
+
   // prepare data for batch
   osmscout::MapPainterBatchQt batch(databases.size());
   size_t i=0;
@@ -306,8 +324,23 @@ void DBRenderJob::Run(const osmscout::BasemapDatabaseRef& basemapDatabase,
       }
     }
 
-    osmscout::MapDataRef data=std::make_shared<osmscout::MapData>();
-    db->mapService->AddTileDataToMapData(tileList,*data);
+    osmscout::MapDataRef data;
+    if (incrementalData!=nullptr){
+      // reuse data of tiles that were already visible during the last rendering
+      osmscout::IncrementalMapDataRef &dbData=(*incrementalData)[db->path];
+      if (!dbData){
+        dbData=std::make_shared<osmscout::IncrementalMapData>();
+      }
+      dbData->Update(tileList);
+      data=dbData->GetMapData();
+      data->poiNodes.clear();
+      data->poiWays.clear();
+      data->poiAreas.clear();
+      data->groundTiles.clear();
+    }else{
+      data=std::make_shared<osmscout::MapData>();
+      db->mapService->AddTileDataToMapData(tileList,*data);
+    }
     if (last){
       osmscout::TypeConfigRef typeConfig=db->database->GetTypeConfig();
       for (auto const &o:overlayObjects){
@@ -390,7 +390,9 @@ void PlaneMapRenderer::DrawMap()
                       &drawParameter,
                       &p,
                       overlayObjects,
-                      /*drawCanvasBackground*/ true);
+                      /*drawCanvasBackground*/ true,
+                      /*renderBasemap*/ true,
+                      &incrementalData);
       dbThread->RunJob(&job);
       success=job.IsSuccess();
     }
@@ -20,13 +20,23 @@
 
 #include <osmscout/TiledMapRenderer.h>
 
+#include <utility>
+#include <vector>
+
 #include <osmscout/OSMTile.h>
 #include <osmscout/TiledRenderingHelper.h>
 
 #include <osmscout/system/Math.h>
 #include <osmscout/util/Logger.h>
 
+#include <QBuffer>
+#include <QDir>
+#include <QFileInfo>
+
 namespace osmscout {
+
+static const uint64_t PersistentTileStoreSize=512*1024*1024;
+
 TiledMapRenderer::TiledMapRenderer(QThread *thread,
                                    SettingsRef settings,
                                    DBThreadRef dbThread,
@@ -38,6 +48,7 @@ TiledMapRenderer::TiledMapRenderer(QThread *thread,
   tileCacheDirectory(tileCacheDirectory),
   onlineTileCache(onlineTileCacheSize), // online tiles can be loaded from disk cache easily
   offlineTileCache(offlineTileCacheSize), // render offline tile is expensive
+  persistentTileSpace(0),
   tileDownloader(nullptr), // it will be created in different thread
   loadJob(nullptr),
   unknownColor(QColor::fromRgbF(1.0,1.0,1.0)) // white
@@ -50,6 +61,15 @@ TiledMapRenderer::TiledMapRenderer(QThread *thread,
   onlineTilesEnabled = settings->GetOnlineTilesEnabled();
   offlineTilesEnabled = settings->GetOfflineMap();
 
+  QString persistentTileDirectory=QDir(tileCacheDirectory).filePath("offline");
+  persistentTileStore=std::make_shared<TileStore>();
+  if (!QDir().mkpath(persistentTileDirectory) ||
+      !persistentTileStore->Open(persistentTileDirectory.toLocal8Bit().data(),
+                                 PersistentTileStoreSize)){
+    qWarning() << "Cannot open persistent tile store in" << persistentTileDirectory;
+    persistentTileStore.reset();
+  }
+
   connect(settings.get(), &Settings::OnlineTileProviderIdChanged,
           this, &TiledMapRenderer::onlineTileProviderChanged,
           Qt::QueuedConnection);
@@ -86,6 +106,9 @@ TiledMapRenderer::~TiledMapRenderer()
   if (loadJob!=nullptr){
     delete loadJob;
   }
+  if (persistentTileStore){
+    persistentTileStore->Close();
+  }
 }
 
 void TiledMapRenderer::Initialize()
@@ -150,6 +173,8 @@ void TiledMapRenderer::onStylesheetFilenameChanged()
 
 void TiledMapRenderer::InvalidateVisualCache()
 {
+  UpdatePersistentTileSpace();
+
   // invalidate tile cache and emit Redraw
   {
     QMutexLocker locker(&tileCacheMutex);
@@ -204,8 +229,100 @@ DatabaseCoverage TiledMapRenderer::databaseCoverageOfTile(uint32_t zoomLevel, ui
   return state;
 }
 
+void TiledMapRenderer::UpdatePersistentTileSpace()
+{
+  if (!persistentTileStore){
+    return;
+  }
+
+  QStringList description;
+
+  QString stylesheetFilename=dbThread->GetStylesheetFilename();
+  description << stylesheetFilename
+              << QFileInfo(stylesheetFilename).lastModified().toString(Qt::ISODate);
+
+  QMap<QString,bool> styleFlags=dbThread->GetStyleFlags();
+  for (auto it=styleFlags.begin(); it!=styleFlags.end(); ++it){
+    description << it.key()+"="+(it.value() ? "1" : "0");
+  }
+
+  {
+    QMutexLocker locker(&lock);
+    description << QString::number(mapDpi)
+                << QString::number(renderSea)
+                << fontName
+                << QString::number(fontSize)
+                << QString::number(showAltLanguage)
+                << QString::number(onlineTilesEnabled);
+  }
+
+  dbThread->RunSynchronousJob(
+    [&description](const std::list<DBInstanceRef>& databases) {
+      // updates (like applied change files) rewrite single data and index
+      // files, so take the state of all of them into account
+      for (auto &db:databases){
+        description << db->path;
+        QFileInfoList files=QDir(db->path).entryInfoList(QStringList() << "*.dat" << "*.idx" << "*.upd" << "*.box",
+                                                         QDir::Files,
+                                                         QDir::Name);
+        for (const QFileInfo &file:files){
+          description << file.fileName()
+                      << QString::number(file.size())
+                      << QString::number(file.lastModified().toMSecsSinceEpoch());
+        }
+      }
+    }
+  );
+
+  uint64_t space=TileStore::GetNamespace(description.join("\n").toStdString());
+
+  QMutexLocker locker(&tileCacheMutex);
+  persistentTileSpace=space;
+}
+
+/**
+ * Try to fill the offline tile cache from the persistent tile store.
+ * Tiles intersecting overlay objects are never persisted, so they are not looked up.
+ * @return true if the tile was found
+ */
+bool TiledMapRenderer::LoadPersistentTile(uint32_t zoomLevel, uint32_t xtile, uint32_t ytile)
+{
+  if (!persistentTileStore ||
+      overlayObjectsBox().Intersects(OSMTile::tileBoundingBox(zoomLevel, xtile, ytile))){
+    return false;
+  }
+
+  uint64_t space;
+  {
+    QMutexLocker locker(&tileCacheMutex);
+    space=persistentTileSpace;
+  }
+
+  std::string data;
+  if (!persistentTileStore->Get(space,MagnificationLevel(zoomLevel),OSMTileId(xtile,ytile),data)){
+    return false;
+  }
+
+  QImage image=QImage::fromData(reinterpret_cast<const uchar*>(data.data()),(int)data.size(),"PNG");
+  if (image.isNull()){
+    return false;
+  }
+
+  {
+    QMutexLocker locker(&tileCacheMutex);
+    offlineTileCache.put(zoomLevel, xtile, ytile,
+                         image.convertToFormat(QImage::Format_ARGB32_Premultiplied),
+                         loadEpoch);
+  }
+
+  emit Redraw();
+  return true;
+}
+
 void TiledMapRenderer::onDatabaseLoaded(osmscout::GeoBox boundingBox)
 {
+  UpdatePersistentTileSpace();
+
   {
     QMutexLocker locker(&tileCacheMutex);
     onlineTileCache.invalidate(boundingBox);
@@ -264,6 +381,9 @@ void TiledMapRenderer::offlineTileRequest(uint32_t zoomLevel, uint32_t xtile, ui
     DatabaseCoverage state = databaseCoverageOfTile(zoomLevel, xtile, ytile);
     // render offline map when area is fully covered by database or online tiles are disabled -> render basemap
     bool render = (state != DatabaseCoverage::Outside) || (!onlineTilesEnabled);
+    if (render && LoadPersistentTile(zoomLevel, xtile, ytile)) {
+        return;
+    }
     if (render) {
         // tile rendering have sub-linear complexity with area size
         // it means that it is advatage to merge more tile requests with same zoom
@@ -491,26 +611,39 @@ void TiledMapRenderer::onLoadJobFinished(QMap<QString,QMap<osmscout::TileKey,osm
 
     p.end();
 
+    // tiles to be persisted, encoded and stored after releasing tileCacheMutex,
+    // so that painting is not blocked by PNG encoding and disk i/o
+    std::vector<std::pair<OSMTileId,QImage>> persistentTiles;
+    MagnificationLevel                       persistentLevel=loadZ;
+    uint64_t                                 persistentSpace=0;
+
     {
         QMutexLocker locker(&tileCacheMutex);
 
+        // tiles with overlay objects or rendered from outdated data are not persisted
+        bool persist = persistentTileStore && overlayObjects.empty();
+
         if (loadEpoch != offlineTileCache.getEpoch()){
           qWarning() << "Rendered from outdated data" << loadEpoch << "!=" << offlineTileCache.getEpoch();
+          persist = false;
         }
 
-        if (width == 1 && height == 1){
-            offlineTileCache.put(loadZ.Get(), loadXFrom, loadYFrom, canvas, loadEpoch);
-        }else{
-            for (uint32_t y = loadYFrom; y <= loadYTo; ++y){
-                for (uint32_t x = loadXFrom; x <= loadXTo; ++x){
+        persistentSpace=persistentTileSpace;
 
-                    QImage tile = canvas.copy(
-                            (double)(x - loadXFrom) * osmTileDimension,
-                            (double)(y - loadYFrom) * osmTileDimension,
-                            osmTileDimension, osmTileDimension
-                            );
+        for (uint32_t y = loadYFrom; y <= loadYTo; ++y){
+            for (uint32_t x = loadXFrom; x <= loadXTo; ++x){
 
-                    offlineTileCache.put(loadZ.Get(), x, y, tile, loadEpoch);
+                QImage tile = (width == 1 && height == 1) ? canvas : canvas.copy(
+                        (double)(x - loadXFrom) * osmTileDimension,
+                        (double)(y - loadYFrom) * osmTileDimension,
+                        osmTileDimension, osmTileDimension
+                        );
+
+                offlineTileCache.put(loadZ.Get(), x, y, tile, loadEpoch);
+
+                if (persist){
+                    // QImage is implicitly shared, this does not copy the pixels
+                    persistentTiles.emplace_back(OSMTileId(x,y), tile);
                 }
             }
         }
@@ -521,6 +654,20 @@ void TiledMapRenderer::onLoadJobFinished(QMap<QString,QMap<osmscout::TileKey,osm
     }
 
     emit Redraw();
+
+    for (const auto &entry : persistentTiles){
+        QByteArray encoded;
+        QBuffer    buffer(&encoded);
+
+        buffer.open(QIODevice::WriteOnly);
+        if (entry.second.save(&buffer, "PNG")){
+            persistentTileStore->Put(persistentSpace,
+                                     persistentLevel,
+                                     entry.first,
+                                     std::string(encoded.constData(),(size_t)encoded.size()));
+        }
+    }
+
     //std::cout << "  put offline: " << loadZ << " xtile: " << xtile << " ytile: " << ytile << std::endl;
 }
 }
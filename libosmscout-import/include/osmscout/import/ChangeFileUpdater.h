@@ -0,0 +1,100 @@
+#ifndef OSMSCOUT_IMPORT_CHANGEFILEUPDATER_H
+#define OSMSCOUT_IMPORT_CHANGEFILEUPDATER_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <string>
+#include <vector>
+
+#include <osmscout/GeoCoord.h>
+#include <osmscout/Tag.h>
+#include <osmscout/TypeConfig.h>
+
+#include <osmscout/util/Progress.h>
+
+#include <osmscout/import/Import.h>
+
+#include <osmscout/system/Compiler.h>
+
+namespace osmscout {
+
+  /**
+   * Applies an OSM change file (*.osc) to an existing database without a
+   * full import.
+   *
+   * Only nodes (POIs) are updated: created and modified nodes are appended
+   * to 'nodes.dat' and deleted or superseded nodes are tombstoned. Both is
+   * recorded in the AreaNodeUpdates ('areanode.upd'), which the AreaNodeIndex
+   * applies on top of the unchanged index. The cost of an update thus scales
+   * with the size of the change file, apart from one sequential scan of the
+   * fixed size records of 'nodes.idmap' to find the offsets of existing nodes.
+   *
+   * Changes of ways and relations (and thus areas, routing and location
+   * data) are counted and reported, but require a full import, which also
+   * compacts the database. If the change file modifies or deletes nodes, that
+   * are not POIs of the database (normally nodes of ways or areas), the update
+   * is refused without changing the database, since the geometry of the
+   * referencing ways and areas would be left stale.
+   */
+  class OSMSCOUT_IMPORT_API ChangeFileUpdater CLASS_FINAL
+  {
+  public:
+    enum class Action
+    {
+      create,
+      modify,
+      remove
+    };
+
+    struct NodeChange
+    {
+      Action   action;
+      OSMId    id;
+      GeoCoord coord;
+      TagMap   tags;
+    };
+
+    struct Statistics
+    {
+      size_t nodesAdded=0;       //!< Number of nodes added to the database (created or modified)
+      size_t nodesRemoved=0;     //!< Number of nodes removed from the database (deleted or modified)
+      size_t nodesIgnored=0;     //!< Number of created or modified nodes without a node type
+      size_t nodesUnresolved=0;  //!< Number of modified or deleted nodes, that are not POIs of the database
+      size_t waysSkipped=0;      //!< Number of way changes, that were not applied
+      size_t relationsSkipped=0; //!< Number of relation changes, that were not applied
+    };
+
+  private:
+    bool ReadChangeFile(const TypeConfig& typeConfig,
+                        Progress& progress,
+                        const std::string& filename,
+                        std::vector<NodeChange>& changes,
+                        Statistics& statistics);
+
+  public:
+    bool Update(const TypeConfigRef& typeConfig,
+                const ImportParameter& parameter,
+                Progress& progress,
+                const std::string& filename,
+                Statistics& statistics);
+  };
+}
+
+#endif
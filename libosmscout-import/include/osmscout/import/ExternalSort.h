@@ -0,0 +1,496 @@
+#ifndef OSMSCOUT_IMPORT_EXTERNALSORT_H
+#define OSMSCOUT_IMPORT_EXTERNALSORT_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <future>
+#include <memory>
+#include <queue>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+
+namespace osmscout {
+
+  /**
+   * Sorts a sequence of fixed size records that may be bigger than main memory.
+   *
+   * Records are collected via Add() into an in-memory run of at most runSize
+   * entries. Full runs are sorted in parallel and written to a temporary file
+   * in the given directory. After Sort() the records can be retrieved in
+   * order via Next(), which does a k-way merge over all runs reading them with
+   * large sequential buffers. If there are too many runs to be merged at once,
+   * they are merged into bigger runs first. If all records fit into one run,
+   * no temporary files are written at all.
+   *
+   * Thus, independent of the size of the input, the data is written once and
+   * read once, instead of rescanning the input once per range of keys.
+   *
+   * T must be trivially copyable, since records are written to disk as is.
+   * The sort is not stable; to get a deterministic order, the comparator
+   * must define a total order (e.g. by including a sequence number).
+   */
+  template<typename T, typename Less=std::less<T>>
+  class ExternalSorter
+  {
+    static_assert(std::is_trivially_copyable<T>::value,"T must be trivially copyable");
+
+  private:
+    static const size_t readBufferSize=1024*1024; //!< Size of the read buffer per run in bytes
+    static const size_t maxMergeWidth=128;        //!< Maximum number of runs merged at once
+
+    struct Run
+    {
+      std::string    filename;
+      FileScanner    scanner;
+      size_t         count;     //!< Number of records in the run
+      size_t         read;      //!< Number of records already read from file
+      std::vector<T> buffer;    //!< Current block of records
+      size_t         pos;       //!< Position of the next record in the buffer
+
+      bool Fill();
+    };
+
+    typedef std::unique_ptr<Run> RunRef;
+
+    struct QueueEntry
+    {
+      T      value;
+      size_t run;
+    };
+
+    class QueueEntryGreater
+    {
+    private:
+      Less less;
+
+    public:
+      explicit QueueEntryGreater(const Less& less)
+      : less(less)
+      {
+        // no code
+      }
+
+      bool operator()(const QueueEntry& a,
+                      const QueueEntry& b) const
+      {
+        return less(b.value,a.value);
+      }
+    };
+
+  private:
+    std::string         directory;
+    std::string         baseName;
+    size_t              runSize;
+    size_t              threadCount;
+    Less                less;
+    std::vector<T>      current;     //!< The run currently collected
+    size_t              currentPos;  //!< Position in current, if it is the only run
+    std::vector<RunRef> runs;
+    size_t              runCount;    //!< Number of runs written
+    size_t              recordCount;
+    bool                sorted;
+
+    std::priority_queue<QueueEntry,std::vector<QueueEntry>,QueueEntryGreater> queue;
+
+  private:
+    void SortCurrent();
+    RunRef CreateRun(size_t count);
+    void WriteCurrent();
+    void StartMerge(size_t end);
+    bool MergeNext(T& value);
+    void MergeRuns();
+
+  public:
+    ExternalSorter(const std::string& directory,
+                   const std::string& baseName,
+                   size_t runSize,
+                   size_t threadCount=std::max((unsigned int)1,std::thread::hardware_concurrency()),
+                   const Less& less=Less());
+    ~ExternalSorter();
+
+    void Add(const T& value);
+    void Sort();
+    bool Next(T& value);
+    void Close();
+
+    /**
+     * Return the number of records added
+     */
+    size_t GetCount() const
+    {
+      return recordCount;
+    }
+
+    /**
+     * Return the number of runs written to disk
+     */
+    size_t GetRunCount() const
+    {
+      return runCount;
+    }
+  };
+
+  /**
+   * Read the next block of records of the run into the buffer
+   *
+   * @throws IOException
+   */
+  template<typename T, typename Less>
+  bool ExternalSorter<T,Less>::Run::Fill()
+  {
+    size_t blockCount=std::min(std::max(readBufferSize/sizeof(T),(size_t)1),
+                               count-read);
+
+    if (blockCount==0) {
+      return false;
+    }
+
+    buffer.resize(blockCount);
+    scanner.Read(reinterpret_cast<char*>(buffer.data()),
+                 blockCount*sizeof(T));
+
+    read+=blockCount;
+    pos=0;
+
+    if (read==count) {
+      scanner.Close();
+      RemoveFile(filename);
+    }
+
+    return true;
+  }
+
+  template<typename T, typename Less>
+  ExternalSorter<T,Less>::ExternalSorter(const std::string& directory,
+                                         const std::string& baseName,
+                                         size_t runSize,
+                                         size_t threadCount,
+                                         const Less& less)
+  : directory(directory),
+    baseName(baseName),
+    runSize(std::max(runSize,(size_t)1)),
+    threadCount(std::max(threadCount,(size_t)1)),
+    less(less),
+    currentPos(0),
+    runCount(0),
+    recordCount(0),
+    sorted(false),
+    queue(QueueEntryGreater(less))
+  {
+    // no code
+  }
+
+  template<typename T, typename Less>
+  ExternalSorter<T,Less>::~ExternalSorter()
+  {
+    Close();
+  }
+
+  /**
+   * Sort the current run in memory. The run is split into one chunk per thread,
+   * the chunks are sorted concurrently and then merged.
+   */
+  template<typename T, typename Less>
+  void ExternalSorter<T,Less>::SortCurrent()
+  {
+    size_t chunkCount=std::min(threadCount,
+                               std::max(current.size()/100000,(size_t)1));
+
+    if (chunkCount==1) {
+      std::sort(current.begin(),current.end(),less);
+      return;
+    }
+
+    std::vector<size_t>            bounds;
+    std::vector<std::future<void>> tasks;
+
+    for (size_t c=0; c<=chunkCount; c++) {
+      bounds.push_back(current.size()*c/chunkCount);
+    }
+
+    for (size_t c=0; c<chunkCount; c++) {
+      auto begin=current.begin()+bounds[c];
+      auto end=current.begin()+bounds[c+1];
+
+      tasks.push_back(std::async(std::launch::async,[this,begin,end]() {
+        std::sort(begin,end,less);
+      }));
+    }
+
+    for (auto& task : tasks) {
+      task.get();
+    }
+
+    // Merge neighbouring chunks pairwise, doubling the chunk size in each round
+    for (size_t width=1; width<chunkCount; width*=2) {
+      tasks.clear();
+
+      for (size_t c=0; c+width<chunkCount; c+=2*width) {
+        auto begin=current.begin()+bounds[c];
+        auto middle=current.begin()+bounds[c+width];
+        auto end=current.begin()+bounds[std::min(c+2*width,chunkCount)];
+
+        tasks.push_back(std::async(std::launch::async,[this,begin,middle,end]() {
+          std::inplace_merge(begin,middle,end,less);
+        }));
+      }
+
+      for (auto& task : tasks) {
+        task.get();
+      }
+    }
+  }
+
+  template<typename T, typename Less>
+  typename ExternalSorter<T,Less>::RunRef ExternalSorter<T,Less>::CreateRun(size_t count)
+  {
+    RunRef run(new Run());
+
+    run->filename=AppendFileToDir(directory,
+                                  baseName+"_"+std::to_string(runCount)+".tmp");
+    run->count=count;
+    run->read=0;
+    run->pos=0;
+
+    runCount++;
+
+    return run;
+  }
+
+  /**
+   * Sort the current run and write it to a temporary file
+   *
+   * @throws IOException
+   */
+  template<typename T, typename Less>
+  void ExternalSorter<T,Less>::WriteCurrent()
+  {
+    SortCurrent();
+
+    RunRef     run=CreateRun(current.size());
+    FileWriter writer;
+
+    writer.Open(run->filename);
+    writer.Write(reinterpret_cast<const char*>(current.data()),
+                 current.size()*sizeof(T));
+    writer.Close();
+
+    runs.push_back(std::move(run));
+
+    current.clear();
+  }
+
+  /**
+   * Open the first end runs and fill the merge queue with their first records
+   *
+   * @throws IOException
+   */
+  template<typename T, typename Less>
+  void ExternalSorter<T,Less>::StartMerge(size_t end)
+  {
+    for (size_t r=0; r<end; r++) {
+      Run& run=*runs[r];
+
+      run.scanner.Open(run.filename,
+                       FileScanner::Sequential,
+                       false);
+
+      if (run.Fill()) {
+        queue.push(QueueEntry{run.buffer[run.pos++],r});
+      }
+    }
+  }
+
+  /**
+   * Return the smallest record of all runs in the merge queue
+   *
+   * @throws IOException
+   */
+  template<typename T, typename Less>
+  bool ExternalSorter<T,Less>::MergeNext(T& value)
+  {
+    if (queue.empty()) {
+      return false;
+    }
+
+    QueueEntry entry=queue.top();
+
+    queue.pop();
+
+    value=entry.value;
+
+    Run& run=*runs[entry.run];
+
+    if (run.pos<run.buffer.size() ||
+        run.Fill()) {
+      queue.push(QueueEntry{run.buffer[run.pos++],entry.run});
+    }
+
+    return true;
+  }
+
+  /**
+   * Merge runs into bigger runs, until they can be merged at once
+   *
+   * @throws IOException
+   */
+  template<typename T, typename Less>
+  void ExternalSorter<T,Less>::MergeRuns()
+  {
+    while (runs.size()>maxMergeWidth) {
+      size_t count=0;
+
+      for (size_t r=0; r<maxMergeWidth; r++) {
+        count+=runs[r]->count;
+      }
+
+      RunRef     run=CreateRun(count);
+      FileWriter writer;
+      T          value;
+
+      writer.Open(run->filename);
+
+      StartMerge(maxMergeWidth);
+
+      while (MergeNext(value)) {
+        writer.Write(reinterpret_cast<const char*>(&value),
+                     sizeof(T));
+      }
+
+      writer.Close();
+
+      // The merged runs have been read completely and their files are already deleted
+      runs.erase(runs.begin(),runs.begin()+maxMergeWidth);
+      runs.push_back(std::move(run));
+    }
+  }
+
+  /**
+   * Add a record
+   *
+   * @throws IOException
+   */
+  template<typename T, typename Less>
+  void ExternalSorter<T,Less>::Add(const T& value)
+  {
+    assert(!sorted);
+
+    if (current.empty()) {
+      current.reserve(runSize);
+    }
+
+    current.push_back(value);
+    recordCount++;
+
+    if (current.size()>=runSize) {
+      WriteCurrent();
+    }
+  }
+
+  /**
+   * Finish adding records and prepare merging
+   *
+   * @throws IOException
+   */
+  template<typename T, typename Less>
+  void ExternalSorter<T,Less>::Sort()
+  {
+    assert(!sorted);
+
+    sorted=true;
+
+    if (runs.empty()) {
+      // Everything fits into memory, no need to merge
+      SortCurrent();
+      currentPos=0;
+      return;
+    }
+
+    if (!current.empty()) {
+      WriteCurrent();
+    }
+
+    current.clear();
+    current.shrink_to_fit();
+
+    MergeRuns();
+    StartMerge(runs.size());
+  }
+
+  /**
+   * Return the next record in sort order. Returns false, if there are no
+   * more records.
+   *
+   * @throws IOException
+   */
+  template<typename T, typename Less>
+  bool ExternalSorter<T,Less>::Next(T& value)
+  {
+    assert(sorted);
+
+    if (runs.empty()) {
+      if (currentPos>=current.size()) {
+        return false;
+      }
+
+      value=current[currentPos++];
+
+      return true;
+    }
+
+    return MergeNext(value);
+  }
+
+  /**
+   * Release all memory and delete all temporary files
+   */
+  template<typename T, typename Less>
+  void ExternalSorter<T,Less>::Close()
+  {
+    for (auto& run : runs) {
+      if (run->scanner.IsOpen()) {
+        run->scanner.CloseFailsafe();
+      }
+
+      if (run->read<run->count) {
+        RemoveFile(run->filename);
+      }
+    }
+
+    runs.clear();
+    current.clear();
+    current.shrink_to_fit();
+
+    while (!queue.empty()) {
+      queue.pop();
+    }
+  }
+}
+
+#endif
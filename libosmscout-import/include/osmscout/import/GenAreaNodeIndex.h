@@ -47,6 +47,8 @@ namespace osmscout {
       IndexTypeList    = uint8_t(2)
     };
 
+    typedef std::vector<std::pair<GeoCoord,FileOffset>> NodeEntryList;
+
     struct DistributionData
     {
       TypeId                  nodeId;        //<! node id of the type
@@ -69,10 +71,27 @@ namespace osmscout {
       }
     };
 
+    /**
+     * The nodes of one type in one tile, to be written either as tile list or as bitmap
+     */
+    struct TileData
+    {
+      TypeId             nodeId;        //<! node id of the type
+      TileId             tileId;        //<! The tile
+      IndexType          indexType;     //<! Type of index used for the tile
+      MagnificationLevel magnification; //<! Magnification of the bitmap cells, if indexType is bitmap
+      NodeEntryList      nodes;         //<! The nodes in the tile in file order
+    };
+
   private:
-    bool AnalyseDistribution(const TypeConfigRef& typeConfig,
-                             const ImportParameter& parameter,
+    bool ReadNodes(const TypeConfigRef& typeConfig,
+                   const ImportParameter& parameter,
+                   Progress& progress,
+                   std::vector<DistributionData>& data,
+                   std::vector<NodeEntryList>& nodesByType);
+    void AnalyseDistribution(const ImportParameter& parameter,
                              Progress& progress,
+                             const std::vector<NodeEntryList>& nodesByType,
                              std::vector<DistributionData>& data);
     void DumpDistribution(Progress& progress,
                           const std::vector<DistributionData>& data);
@@ -91,26 +110,31 @@ namespace osmscout {
 
     void WriteListData(Progress& progress,
                        const std::vector<DistributionData>& data,
-                       const std::vector<std::list<std::pair<GeoCoord,FileOffset>>>& listData,
+                       const std::vector<NodeEntryList>& listData,
                        const std::vector<FileOffset>& listIndexOffsets,
                        FileWriter& writer);
 
     void WriteTileListData(const ImportParameter& parameter,
                            const DistributionData& distributionData,
-                           const std::list<std::pair<GeoCoord,FileOffset>>& tileData,
+                           const NodeEntryList& tileData,
                            const FileOffset& tileIndexOffset,
                            FileWriter& writer);
 
     void WriteBitmapData(const ImportParameter& parameter,
                          const TileId& tileId,
-                         const std::list<std::pair<GeoCoord,FileOffset>>& bitmapData,
+                         const MagnificationLevel& magnification,
+                         const NodeEntryList& bitmapData,
                          const FileOffset& bitmapIndexOffset,
                          FileWriter& writer);
 
-    bool WriteData(const TypeConfigRef& typeConfig,
-                   const ImportParameter& parameter,
+    std::vector<TileData> CollectTileData(const ImportParameter& parameter,
+                                          const std::vector<DistributionData>& data,
+                                          std::vector<NodeEntryList>& nodesByType);
+
+    bool WriteData(const ImportParameter& parameter,
                    Progress& progress,
-                   const std::vector<DistributionData>& data);
+                   const std::vector<DistributionData>& data,
+                   std::vector<NodeEntryList>& nodesByType);
 
   public:
     void GetDescription(const ImportParameter& parameter,
@@ -22,12 +22,13 @@
 
 #include <osmscout/import/Import.h>
 
-#include <list>
 #include <map>
+#include <vector>
 
 #include <osmscout/Pixel.h>
 
 #include <osmscout/util/FileWriter.h>
+#include <osmscout/util/GeoBox.h>
 #include <osmscout/util/Geometry.h>
 
 #include <osmscout/system/Compiler.h>
@@ -37,8 +38,19 @@ namespace osmscout {
   class AreaWayIndexGenerator CLASS_FINAL : public ImportModule
   {
   private:
-    typedef std::map<Pixel,size_t>                 CoordCountMap;
-    typedef std::map<Pixel,std::list<FileOffset> > CoordOffsetsMap;
+    typedef std::map<Pixel,size_t>                   CoordCountMap;
+    typedef std::map<Pixel,std::vector<FileOffset> > CoordOffsetsMap;
+
+    /**
+     * The data of a way needed for indexing
+     */
+    struct WayEntry
+    {
+      GeoBox     boundingBox;
+      FileOffset offset;
+    };
+
+    typedef std::vector<WayEntry> WayEntryList;
 
     struct TypeData
     {
@@ -75,12 +87,28 @@ namespace osmscout {
                              TypeData& typeData,
                              const CoordCountMap& cellFillCount) const;
 
-    bool CalculateDistribution(const TypeConfig& typeConfig,
+    bool ReadWays(const TypeConfig& typeConfig,
+                  const ImportParameter& parameter,
+                  Progress& progress,
+                  std::vector<WayEntryList>& waysByType) const;
+
+    void CalculateTypeDistribution(const ImportParameter& parameter,
+                                   Progress& progress,
+                                   const TypeInfo& typeInfo,
+                                   const WayEntryList& ways,
+                                   TypeData& typeData) const;
+
+    void CalculateDistribution(const TypeConfig& typeConfig,
                                const ImportParameter& parameter,
                                Progress& progress,
+                               const std::vector<WayEntryList>& waysByType,
                                std::vector<TypeData>& wayTypeData,
                                MagnificationLevel& maxLevel) const;
 
+    void CalculateCellOffsets(const TypeData& typeData,
+                              const WayEntryList& ways,
+                              CoordOffsetsMap& cellOffsets) const;
+
     bool WriteBitmap(Progress& progress,
                      FileWriter& writer,
                      const TypeInfo& typeInfo,
@@ -321,19 +321,25 @@ namespace osmscout {
                           RegionRef& rootRegion,
                           const RegionIndex& regionIndex);
 
-    bool AddLocationAreaToRegion(Region& region,
-                                 const Area& area,
-                                 const std::vector<Point>& nodes,
-                                 const std::string& name,
-                                 const std::string& postalCode,
-                                 const GeoBox& boundingBox);
-
-    void AddLocationAreaToRegion(RegionRef& rootRegion,
-                                 const Area& area,
-                                 const Area::Ring& ring,
-                                 const std::string& name,
-                                 const std::string& postalCode,
-                                 const RegionIndex& regionIndex);
+    bool CollectRegionsForArea(Region& region,
+                               const std::vector<Point>& nodes,
+                               const GeoBox& boundingBox,
+                               std::vector<Region*>& regions) const;
+
+    void CollectRegionsForRing(RegionRef& rootRegion,
+                               const Area& area,
+                               const Area::Ring& ring,
+                               const RegionIndex& regionIndex,
+                               std::vector<Region*>& regions) const;
+
+    bool CollectRegionsForWay(Region& region,
+                              const std::vector<Point>& nodes,
+                              const GeoBox& boundingBox,
+                              std::vector<Region*>& regions) const;
+
+    Region& GetEnclosingRegion(Region& region,
+                               const std::vector<Point>& nodes,
+                               const GeoBox& boundingBox) const;
 
     bool IndexLocationAreas(const TypeConfig& typeConfig,
                             const ImportParameter& parameter,
@@ -341,12 +347,6 @@ namespace osmscout {
                             RegionRef& rootRegion,
                             const RegionIndex& regionIndex);
 
-    bool AddLocationWayToRegion(Region& region,
-                                const Way& way,
-                                const std::string& name,
-                                const std::string& postalCode,
-                                const GeoBox& boundingBox);
-
     bool IndexLocationWays(const TypeConfig& typeConfig,
                            const ImportParameter& parameter,
                            Progress& progress,
@@ -362,47 +362,12 @@ namespace osmscout {
                             bool allowDuplicates,
                             bool& added);
 
-    void AddAddressAreaToRegion(Progress& progress,
-                                Region& region,
-                                const FileOffset& fileOffset,
-                                const std::string& location,
-                                const std::string& address,
-                                const std::string &postalCode,
-                                const std::vector<Point>& nodes,
-                                const GeoBox& boundingBox,
-                                bool& added);
-
-    void AddPOIAreaToRegion(Progress& progress,
-                            Region& region,
-                            const FileOffset& fileOffset,
-                            const std::string& name,
-                            const std::vector<Point>& nodes,
-                            const GeoBox& boundingBox,
-                            bool& added);
-
     bool IndexAddressAreas(const TypeConfig& typeConfig,
                            const ImportParameter& parameter,
                            Progress& progress,
                            RegionRef& rootRegion,
                            const RegionIndex& regionIndex);
 
-    bool AddAddressWayToRegion(Progress& progress,
-                               Region& region,
-                               const FileOffset& fileOffset,
-                               const std::string& location,
-                               const std::string& address,
-                               const std::vector<Point>& nodes,
-                               const GeoBox& boundingBox,
-                               bool& added);
-
-    bool AddPOIWayToRegion(Progress& progress,
-                           Region& region,
-                           const FileOffset& fileOffset,
-                           const std::string& name,
-                           const std::vector<Point>& nodes,
-                           const GeoBox& boundingBox,
-                           bool& added);
-
     bool IndexAddressWays(const TypeConfig& typeConfig,
                           const ImportParameter& parameter,
                           Progress& progress,
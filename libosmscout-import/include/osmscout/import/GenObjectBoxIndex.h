@@ -0,0 +1,62 @@
+#ifndef OSMSCOUT_IMPORT_GENOBJECTBOXINDEX_H
+#define OSMSCOUT_IMPORT_GENOBJECTBOXINDEX_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <string>
+#include <vector>
+
+#include <osmscout/util/GeoBox.h>
+
+#include <osmscout/import/Import.h>
+
+#include <osmscout/system/Compiler.h>
+
+namespace osmscout {
+
+  /**
+   * Generator for the ObjectBoxIndex files of ways.dat and areas.dat, that
+   * store the bounding box of each way and area.
+   */
+  class OSMSCOUT_IMPORT_API ObjectBoxIndexGenerator CLASS_FINAL : public ImportModule
+  {
+  private:
+    template<typename V>
+    void ScanDataFile(const TypeConfig& typeConfig,
+                      const std::string& dataFilename,
+                      Progress& progress,
+                      std::vector<FileOffset>& offsets,
+                      std::vector<GeoBox>& boxes) const;
+
+  public:
+    void GetDescription(const ImportParameter& parameter,
+                        ImportModuleDescription& description) const override;
+
+    bool Import(const TypeConfigRef& typeConfig,
+                const ImportParameter& parameter,
+                Progress& progress) override;
+
+    static void WriteIndex(const std::string& filename,
+                           const std::vector<FileOffset>& offsets,
+                           const std::vector<GeoBox>& boxes);
+  };
+}
+
+#endif
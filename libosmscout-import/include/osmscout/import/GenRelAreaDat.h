@@ -22,14 +22,19 @@
 
 #include <osmscout/import/Import.h>
 
+#include <algorithm>
 #include <map>
+#include <memory>
+#include <set>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include <osmscout/Area.h>
 
 #include <osmscout/DataFile.h>
 #include <osmscout/CoordDataFile.h>
+#include <osmscout/TypeInfoSet.h>
 
 #include <osmscout/util/Geometry.h>
 
@@ -54,45 +59,29 @@ namespace osmscout {
     typedef std::unordered_map<OSMId,RawWayRef> IdRawWayMap;
 
   private:
+    /**
+     * Inclusion relation between the rings of a multipolygon. For each ring
+     * the (usually few) rings including it are stored.
+     */
     class GroupingState
     {
     private:
-      size_t rings;
-      bool   *used;
-      bool   *includes;
-      bool   *hasIncludes;
+      std::vector<bool>                used;
+      std::vector<bool>                hasIncludes;
+      std::vector<std::vector<size_t>> includers;
 
     public:
-      GroupingState(size_t rings)
+      explicit GroupingState(size_t rings)
+      : used(rings,false),
+        hasIncludes(rings,false),
+        includers(rings)
       {
-        this->rings=rings;
-
-        used=new bool[rings];
-        for (size_t i=0; i<rings; i++) {
-          used[i]=false;
-        }
-
-        includes=new bool[rings*rings];
-        for (size_t i=0; i<rings*rings; i++) {
-          includes[i]=false;
-        }
-
-        hasIncludes=new bool[rings];
-        for (size_t i=0; i<rings; i++) {
-          hasIncludes[i]=false;
-        }
-      }
-
-      ~GroupingState()
-      {
-        delete [] hasIncludes;
-        delete [] includes;
-        delete [] used;
+        // no code
       }
 
       inline size_t GetRingCount() const
       {
-        return rings;
+        return used.size();
       }
 
       inline void SetUsed(size_t used)
@@ -108,7 +97,7 @@ namespace osmscout {
       inline void SetIncluded(size_t includer, size_t included)
       {
         hasIncludes[includer]=true;
-        includes[included*rings+includer]=true;
+        includers[included].push_back(includer);
       }
 
       inline bool HasIncludes(size_t includer) const
@@ -118,7 +107,14 @@ namespace osmscout {
 
       inline bool Includes(size_t included, size_t includer) const
       {
-        return includes[included*rings+includer];
+        return std::find(includers[included].begin(),
+                         includers[included].end(),
+                         includer)!=includers[included].end();
+      }
+
+      inline const std::vector<size_t>& GetIncluders(size_t included) const
+      {
+        return includers[included];
       }
     };
 
@@ -139,6 +135,65 @@ namespace osmscout {
       }
     };
 
+    /**
+     * A report of a relation for the error reporter
+     */
+    struct RelationReport
+    {
+      TypeInfoRef type;
+      std::string error;
+
+      RelationReport(const TypeInfoRef& type,
+                     const std::string& error)
+      : type(type),
+        error(error)
+      {
+        // no code
+      }
+    };
+
+    /**
+     * A relation together with the ids of all its members
+     */
+    struct RelationJob
+    {
+      RawRelationRef                 rawRelation;
+      std::string                    name;
+      BufferedProgress               progress;
+      std::vector<RelationReport>    reports;     //!< Error reports, buffered like the progress messages
+      std::map<OSMId,RawRelationRef> relationMap; //!< Child relations
+      std::set<OSMId>                wayIds;      //!< Ids of the member ways, including the ways of child relations
+      bool                           valid;       //!< All members could be collected, relation can be resolved
+      Area                           area;        //!< The resolved area
+      std::vector<OSMId>             blacklist;   //!< Ids of ways that are rings of the resolved area
+
+      RelationJob(const RawRelationRef& rawRelation,
+                  const std::string& name,
+                  bool outputDebug)
+      : rawRelation(rawRelation),
+        name(name),
+        progress(outputDebug),
+        valid(true)
+      {
+        // no code
+      }
+    };
+
+    typedef std::unique_ptr<RelationJob> RelationJobRef;
+
+    /**
+     * A block of relations, together with all their member ways and coordinates,
+     * which are loaded in one go
+     */
+    struct RelationBlock
+    {
+      std::vector<RelationJobRef> jobs;
+      IdRawWayMap                 wayMap;
+      CoordDataFile::ResultMap    coordMap;
+    };
+
+    typedef std::shared_ptr<RelationBlock> RelationBlockRef;
+
   private:
     std::list<MultipolygonPart>::const_iterator FindTopLevel(const std::list<MultipolygonPart>& rings,
                                                              const GroupingState& state,
@@ -158,6 +213,7 @@ namespace osmscout {
     bool BuildRings(const TypeConfig& typeConfig,
                     const ImportParameter& parameter,
                     Progress& progress,
+                    std::vector<RelationReport>& reports,
                     OSMId id,
                     const std::string& name,
                     const TypeInfoRef& type,
@@ -166,6 +222,7 @@ namespace osmscout {
     bool ResolveMultipolygon(const TypeConfig& typeConfig,
                              const ImportParameter& parameter,
                              Progress& progress,
+                             std::vector<RelationReport>& reports,
                              OSMId id,
                              const std::string& name,
                              const TypeInfoRef& type,
@@ -190,37 +247,48 @@ namespace osmscout {
                                 IdSet& resolvedRelations,
                                 std::list<MultipolygonPart>& parts);
 
-  bool ResolveMultipolygonMembers(Progress& progress,
-                                  const ImportParameter& parameter,
-                                  const TypeConfig& typeConfig,
-                                  CoordDataFile& coordDataFile,
-                                  RawWayIndexedDataFile& wayDataFile,
-                                  RawRelationIndexedDataFile& relDataFile,
-                                  IdSet& resolvedRelations,
-                                  const Area& relation,
-                                  const std::string& name,
-                                  const RawRelation& rawRelation,
-                                  std::list<MultipolygonPart>& parts);
+    bool CollectRelationMembers(const ImportParameter& parameter,
+                                const TypeInfoSet& boundaryTypes,
+                                RawRelationIndexedDataFile& relDataFile,
+                                RelationJob& job);
+
+    bool LoadRelationMembers(const ImportParameter& parameter,
+                             CoordDataFile& coordDataFile,
+                             RawWayIndexedDataFile& wayDataFile,
+                             RelationBlock& block);
+
+    RelationBlockRef ReadRelationBlock(const ImportParameter& parameter,
+                                       Progress& progress,
+                                       const TypeConfig& typeConfig,
+                                       const TypeInfoSet& boundaryTypes,
+                                       const FeatureRef& featureName,
+                                       CoordDataFile& coordDataFile,
+                                       RawWayIndexedDataFile& wayDataFile,
+                                       RawRelationIndexedDataFile& relDataFile,
+                                       FileScanner& scanner,
+                                       uint32_t rawRelationCount,
+                                       uint32_t& currentRelation);
+
+    void ResolveRelationBlock(const ImportParameter& parameter,
+                              const TypeConfig& typeConfig,
+                              const TypeInfoSet& boundaryTypes,
+                              RelationBlock& block);
 
     bool HandleMultipolygonRelation(const ImportParameter& parameter,
-                                    Progress& progress,
                                     const TypeConfig& typeConfig,
-                                    IdSet& wayAreaIndexBlacklist,
-                                    CoordDataFile& coordDataFile,
-                                    RawWayIndexedDataFile& wayDataFile,
-                                    RawRelationIndexedDataFile& relDataFile,
-                                    RawRelation& rawRelation,
-                                    const std::string& name,
-                                    Area& relation);
+                                    const TypeInfoSet& boundaryTypes,
+                                    const CoordDataFile::ResultMap& coordMap,
+                                    const IdRawWayMap& wayMap,
+                                    RelationJob& job);
 
     std::string ResolveRelationName(const FeatureRef& featureName,
                                     const RawRelation& rawRelation) const;
 
-    TypeInfoRef AutodetectRelationType(const ImportParameter& parameter,
-                                       const TypeConfig& typeConfig,
+    TypeInfoRef AutodetectRelationType(const TypeConfig& typeConfig,
                                        const RawRelation& rawRelation,
                                        std::list<MultipolygonPart>& parts,
-                                       std::list<MultipolygonPart>::iterator& copyPart) const;
+                                       std::list<MultipolygonPart>::iterator& copyPart,
+                                       std::vector<RelationReport>& reports) const;
 
   public:
     void GetDescription(const ImportParameter& parameter,
@@ -92,6 +92,20 @@ namespace osmscout {
       }
     };
 
+    /**
+     * A route node calculated in parallel to other route nodes of the same block.
+     * The objectVariantIndex of its objects refers to the list of variants of the
+     * route node itself and gets mapped to the global object variant index when
+     * writing the route nodes in order.
+     */
+    struct PendingRouteNode
+    {
+      bool                           routable=false; //!< The node is part of the route graph
+      Point                          point;          //!< Coordinate and id of the route node
+      RouteNode                      routeNode;      //!< The route node itself
+      std::vector<ObjectVariantData> variants;       //!< Object variants used by the route node
+    };
+
     typedef std::unordered_map<FileOffset,WayRef>                   FileOffsetWayMap;
     typedef std::unordered_map<FileOffset,AreaRef>                  FileOffsetAreaMap;
     typedef std::unordered_set<Id>                                  RouteNodeIdSet;
@@ -218,8 +232,8 @@ namespace osmscout {
 
     bool GetRouteNodePoint(Progress& progress,
                            const RawRouteNode& node,
-                           FileOffsetWayMap& waysMap,
-                           FileOffsetAreaMap& areasMap,
+                           const FileOffsetWayMap& waysMap,
+                           const FileOffsetAreaMap& areasMap,
                            Point& point) const;
 
     /*
@@ -259,6 +273,15 @@ namespace osmscout {
                                const RawRouteNode& node,
                                const ViaTurnRestrictionMap& restrictions);
 
+    void CalculateRouteNode(Progress& progress,
+                            const RawRouteNode& node,
+                            const FileOffsetWayMap& waysMap,
+                            const FileOffsetAreaMap& areasMap,
+                            const RouteNodeIdSet& routeNodeIdSet,
+                            const ViaTurnRestrictionMap& restrictions,
+                            VehicleMask vehicles,
+                            PendingRouteNode& pending);
+
     bool WriteObjectVariantData(Progress& progress,
                                 const std::string& variantFilename,
                                 const std::map<ObjectVariantData,uint16_t>& routeDataMap);
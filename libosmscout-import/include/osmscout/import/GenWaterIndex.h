@@ -21,6 +21,7 @@
 */
 
 #include <list>
+#include <map>
 
 #include <osmscout/import/Import.h>
 #include <osmscout/import/WaterIndexProcessor.h>
@@ -58,6 +59,15 @@ namespace osmscout {
                     const WaterIndexProcessor& processor,
                     WaterIndexProcessor::StateMap& stateMap);
 
+    void BuildLevel(const TypeConfig& typeConfig,
+                    const ImportParameter& parameter,
+                    Progress& progress,
+                    WaterIndexProcessor& processor,
+                    const std::list<WaterIndexProcessor::CoastRef>& coastlines,
+                    const std::list<WaterIndexProcessor::CoastRef>& boundingPolygons,
+                    WaterIndexProcessor::Level& level,
+                    std::map<Pixel,std::list<GroundTile>>& cellGroundTileMap);
+
   public:
     void GetDescription(const ImportParameter& parameter,
                         ImportModuleDescription& description) const override;
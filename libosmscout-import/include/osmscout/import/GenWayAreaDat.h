@@ -76,7 +76,8 @@ namespace osmscout {
                   const TypeConfig& typeConfig,
                   FileWriter& writer,
                   uint32_t& writtenWayCount,
-                  const CoordDataFile::ResultMap& coordsMap,
+                  const std::vector<OSMId>& nodeIds,
+                  const std::vector<Coord>& coords,
                   const RawWay& rawWay);
 
   public:
@@ -22,8 +22,11 @@
 
 #include <osmscout/import/ImportFeatures.h>
 
+#include <functional>
 #include <map>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 
 #include <osmscout/Way.h>
 
@@ -52,13 +55,12 @@ namespace osmscout {
   private:
     struct RestrictionData
     {
+      mutable std::mutex                      mutex; //!< Types are merged in parallel
       std::multimap<OSMId,TurnRestrictionRef> restrictions;
     };
 
-    typedef std::list<RawWayRef>                     WayList;
-    typedef WayList::iterator                        WayListPtr;
-    typedef std::list<WayListPtr>                    WayListPtrList;
-    typedef std::unordered_map<OSMId,WayListPtrList> WaysByNodeMap;
+    typedef std::vector<RawWayRef>                          WayList;
+    typedef std::unordered_map<OSMId,std::vector<size_t>>   WaysByNodeMap; //!< Indexes of ways in the WayList
 
     bool ReadTurnRestrictions(const ImportParameter& parameter,
                               Progress& progress,
@@ -73,7 +75,7 @@ namespace osmscout {
                  const TypeConfig& typeConfig,
                  TypeInfoSet& types,
                  FileScanner& scanner,
-                 std::vector<std::list<RawWayRef> >& ways);
+                 std::vector<WayList>& ways);
 
     void UpdateRestrictions(RestrictionData& restrictions,
                             OSMId oldId,
@@ -83,13 +85,15 @@ namespace osmscout {
                       OSMId wayId,
                       OSMId nodeId) const;
 
-    bool MergeWays(Progress& progress,
-                   std::list<RawWayRef>& ways,
+    void ProcessTypes(const std::vector<WayList>& waysByType,
+                      const std::function<void(size_t)>& process) const;
+
+    void MergeWays(WayList& ways,
                    RestrictionData& restrictions);
 
-    bool SplitLongWays(Progress& progress,
-                       std::list<RawWayRef>& ways,
-                       CoordDataFile::ResultMap& coordsMap);
+    void SplitLongWays(Progress& progress,
+                       WayList& ways,
+                       const CoordDataFile::ResultMap& coordsMap);
 
     void WriteWay(Progress& progress,
                   const TypeConfig& typeConfig,
@@ -20,9 +20,11 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <functional>
 #include <list>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include <osmscout/import/ImportFeatures.h>
 
@@ -132,6 +134,7 @@ namespace osmscout {
     size_t                       sortTileMag;              //<! Zoom level for individual sorting cells
 
     size_t                       processingQueueSize;      //!< Size of the processing worker queues
+    size_t                       maxParallelModules;       //!< Maximum number of import modules executed in parallel
 
     size_t                       numericIndexPageSize;     //<! Size of an numeric index page in bytes
 
@@ -144,7 +147,10 @@ namespace osmscout {
     size_t                       rawWayIndexCacheSize;     //<! Size of the raw way index cache
     size_t                       rawWayBlockSize;          //<! Number of ways loaded during import until nodes get resolved
 
+    size_t                       rawRelationBlockSize;     //<! Number of relations loaded during import until ways get resolved
+
     bool                         coordDataMemoryMaped;     //<! Use memory mapping for coord data file access
+    bool                         coordDataDense;           //<! Store coordinates in a dense array indexed by node id
     size_t                       coordIndexCacheSize;      //<! Size of the coord index cache
     size_t                       coordBlockSize;           //<! Maximum number of node ids we resolve in one go
 
@@ -157,6 +163,11 @@ namespace osmscout {
     bool                         wayDataMemoryMaped;       //<! Use memory mapping for way data file access
     size_t                       wayDataCacheSize;         //<! Size of the way data cache
 
+    bool                         compressDataFiles;        //<! Store the final data files block compressed
+    size_t                       compressionBlockSize;     //<! Uncompressed size of a block of compressed data files
+
+    bool                         objectBoxIndex;           //<! Generate bounding box index files for ways and areas
+
     size_t                       areaAreaIndexMaxMag;      //<! Maximum depth of the index generated
 
     MagnificationLevel           areaNodeGridMag;          //<! Magnification level for the index grid
@@ -219,6 +230,7 @@ namespace osmscout {
     size_t GetSortTileMag() const;
 
     size_t GetProcessingQueueSize() const;
+    size_t GetMaxParallelModules() const;
 
     size_t GetNumericIndexPageSize() const;
 
@@ -231,7 +243,10 @@ namespace osmscout {
     size_t GetRawWayIndexCacheSize() const;
     size_t GetRawWayBlockSize() const;
 
+    size_t GetRawRelationBlockSize() const;
+
     bool GetCoordDataMemoryMaped() const;
+    bool GetCoordDataDense() const;
     size_t GetCoordIndexCacheSize() const;
 
     size_t GetCoordBlockSize() const;
@@ -245,6 +260,11 @@ namespace osmscout {
     bool GetWayDataMemoryMaped() const;
     size_t GetWayDataCacheSize() const;
 
+    bool GetCompressDataFiles() const;
+    size_t GetCompressionBlockSize() const;
+
+    bool GetObjectBoxIndex() const;
+
     MagnificationLevel GetAreaNodeGridMag() const;
     uint16_t GetAreaNodeSimpleListLimit() const;
     uint16_t GetAreaNodeTileListLimit() const;
@@ -300,6 +320,7 @@ namespace osmscout {
     void SetSortTileMag(size_t sortTileMag);
 
     void SetProcessingQueueSize(size_t processingQueueSize);
+    void SetMaxParallelModules(size_t maxParallelModules);
 
     void SetNumericIndexPageSize(size_t numericIndexPageSize);
 
@@ -312,7 +333,10 @@ namespace osmscout {
     void SetRawWayIndexCacheSize(size_t wayIndexCacheSize);
     void SetRawWayBlockSize(size_t blockSize);
 
+    void SetRawRelationBlockSize(size_t blockSize);
+
     void SetCoordDataMemoryMaped(bool memoryMaped);
+    void SetCoordDataDense(bool coordDataDense);
     void SetCoordIndexCacheSize(size_t coordIndexCacheSize);
 
     void SetCoordBlockSize(size_t coordBlockSize);
@@ -326,6 +350,11 @@ namespace osmscout {
     void SetWayDataMemoryMaped(bool memoryMaped);
     void SetWayDataCacheSize(size_t wayDataCacheSize);
 
+    void SetCompressDataFiles(bool compressDataFiles);
+    void SetCompressionBlockSize(size_t compressionBlockSize);
+
+    void SetObjectBoxIndex(bool objectBoxIndex);
+
     void SetAreaAreaIndexMaxMag(size_t areaAreaIndexMaxMag);
 
     void SetAreaNodeGridMag(MagnificationLevel areaNodeGridMag);
@@ -438,7 +467,10 @@ namespace osmscout {
   /**
     A single import module representing a single import step.
 
-    An import consists of a number of sequentially executed steps. A step normally
+    An import consists of a number of steps, executed in the given order.
+    Steps that do not depend on each other (as declared by the required and
+    provided files of their description) may be executed in parallel, see
+    ImportParameter::SetMaxParallelModules(). A step normally
     works on one object type and generates one output file (though this is just
     an suggestion). Such a step is realized by a ImportModule.
     */
@@ -467,16 +499,64 @@ namespace osmscout {
 
   typedef std::shared_ptr<ImportModule> ImportModuleRef;
 
+  /**
+   * Number of worker threads that may run in addition to the calling threads.
+   *
+   * All calls of ProcessInParallel() (from modules executed in parallel as well
+   * as nested calls) take their workers from the same budget, so that together
+   * they do not start more threads than there are cores. Workers are granted
+   * without blocking. If the budget is exhausted, the calling thread processes
+   * all items on its own.
+   */
+  class OSMSCOUT_IMPORT_API WorkerBudget CLASS_FINAL
+  {
+  private:
+    mutable std::mutex mutex;
+    size_t             available;
+
+  public:
+    explicit WorkerBudget(size_t workerCount);
+
+    size_t Acquire(size_t workerCount);
+    void Release(size_t workerCount);
+
+    size_t GetAvailable() const;
+
+    static WorkerBudget& GetDefault();
+  };
+
+  extern OSMSCOUT_IMPORT_API void ProcessInParallel(WorkerBudget& budget,
+                                                    const std::vector<size_t>& items,
+                                                    const std::function<void(size_t)>& process);
+
+  extern OSMSCOUT_IMPORT_API void ProcessInParallel(const std::vector<size_t>& items,
+                                                    const std::function<void(size_t)>& process);
+
   /**
     Does the import based on the given parameters. Feedback about the import progress
     is given by the indivudal import modules calling the Progress instance as appropriate.
     */
   class OSMSCOUT_IMPORT_API Importer
   {
+  private:
+    /**
+     * Execution state of a module
+     */
+    struct ModuleExecution
+    {
+      size_t              step;            //!< Index of the module in the module list
+      std::vector<size_t> dependencies;    //!< Index of the executions that must be finished before
+      double              startTime=0.0;   //!< Start time in seconds relative to the start of the import
+      double              duration=0.0;    //!< Duration in seconds
+      bool                running=false;
+      bool                finished=false;
+    };
+
   private:
     ImportParameter                      parameter;
     std::vector<ImportModuleRef>         modules;
     std::vector<ImportModuleDescription> moduleDescriptions;
+    std::mutex                           progressMutex; //!< Serializes output of modules running in parallel
 
   private:
     bool ValidateDescription(Progress& progress);
@@ -484,18 +564,37 @@ namespace osmscout {
     void GetModuleList(std::vector<ImportModuleRef>& modules);
     void DumpTypeConfigData(const TypeConfig& typeConfig,
                             Progress& progress);
+    bool LoadTypeConfig(TypeConfig& typeConfig,
+                        Progress& progress);
     void DumpModuleDescription(const ImportModuleDescription& description,
                                Progress& progress);
     bool CleanupTemporaries(size_t currentStep,
+                            const std::vector<bool>& finishedSteps,
                             Progress& progress);
 
-    bool ExecuteModules(const TypeConfigRef& typeConfig,
-                        Progress& progress);
+    std::vector<ModuleExecution> GetModuleExecutions() const;
+    void DumpTimingReport(const std::vector<ModuleExecution>& executions,
+                          double overallTime,
+                          Progress& progress) const;
+
+    bool ExecuteModulesSequential(const TypeConfigRef& typeConfig,
+                                  std::vector<ModuleExecution>& executions,
+                                  Progress& progress);
+    bool ExecuteModulesParallel(const TypeConfigRef& typeConfig,
+                                std::vector<ModuleExecution>& executions,
+                                Progress& progress);
+    bool CompressDataFiles(Progress& progress);
   public:
     explicit Importer(const ImportParameter& parameter);
+    Importer(const ImportParameter& parameter,
+             const std::vector<ImportModuleRef>& modules);
     virtual ~Importer();
 
+    bool ExecuteModules(const TypeConfigRef& typeConfig,
+                        Progress& progress);
+
     bool Import(Progress& progress);
+    bool Update(Progress& progress);
 
     std::list<std::string> GetProvidedFiles() const;
     std::list<std::string> GetProvidedOptionalFiles() const;
@@ -20,9 +20,9 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <atomic>
 #include <future>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include <osmscout/OSMScoutTypes.h>
@@ -43,15 +43,23 @@
 
 namespace osmscout {
 
+  /**
+   * Preprocessor for *.osm.pbf files.
+   *
+   * Parsing is pipelined: The calling thread reads the raw blobs, a number of
+   * decoder threads inflate and parse them into RawBlockData and a handoff
+   * thread passes the results to the PreprocessorCallback in file order.
+   */
   class PreprocessPBF CLASS_FINAL : public Preprocessor
   {
+  private:
+    typedef std::shared_ptr<std::string> BlobRef;
+
   private:
     char                             *buffer;
     google::protobuf::int32          bufferSize;
     PreprocessorCallback&            callback;
-    TagMap                           tagMap;
-    std::vector<OSMId>               nodes;
-    std::vector<RawRelation::Member> members;
+    std::atomic<bool>                handoffError; //!< Set if decoding or processing of a block failed
 
   private:
     bool GetPos(FILE* file,
@@ -69,33 +77,37 @@ namespace osmscout {
                          const OSMPBF::BlobHeader& blockHeader,
                          OSMPBF::HeaderBlock& headerBlock);
 
-    bool ReadPrimitiveBlock(Progress& progress,
-                            FILE* file,
-                            const OSMPBF::BlobHeader& blockHeader,
-                            OSMPBF::PrimitiveBlock& primitiveBlock);
+    bool ReadBlob(Progress& progress,
+                  FILE* file,
+                  const OSMPBF::BlobHeader& blockHeader,
+                  std::string& blob);
 
     void ReadNodes(const TypeConfig& typeConfig,
                    const OSMPBF::PrimitiveBlock& block,
                    const OSMPBF::PrimitiveGroup &group,
-                   PreprocessorCallback::RawBlockData& data);
+                   PreprocessorCallback::RawBlockData& data) const;
 
     void ReadDenseNodes(const TypeConfig& typeConfig,
                         const OSMPBF::PrimitiveBlock& block,
                         const OSMPBF::PrimitiveGroup &group,
-                        PreprocessorCallback::RawBlockData& data);
+                        PreprocessorCallback::RawBlockData& data) const;
 
     void ReadWays(const TypeConfig& typeConfig,
                   const OSMPBF::PrimitiveBlock& block,
                   const OSMPBF::PrimitiveGroup &group,
-                  PreprocessorCallback::RawBlockData& data);
+                  PreprocessorCallback::RawBlockData& data) const;
 
     void ReadRelations(const TypeConfig& typeConfig,
                        const OSMPBF::PrimitiveBlock& block,
                        const OSMPBF::PrimitiveGroup &group,
-                       PreprocessorCallback::RawBlockData& data);
+                       PreprocessorCallback::RawBlockData& data) const;
+
+    PreprocessorCallback::RawBlockDataRef DecodeBlock(const TypeConfigRef& typeConfig,
+                                                      const std::string& filename,
+                                                      const BlobRef& blob) const;
 
-    void ProcessBlock(const TypeConfigRef& typeConfig,
-                      std::unique_ptr<OSMPBF::PrimitiveBlock>&& block);
+    void HandoffBlock(Progress& progress,
+                      std::shared_future<PreprocessorCallback::RawBlockDataRef>& block);
 
   public:
     explicit PreprocessPBF(PreprocessorCallback& callback);
@@ -21,9 +21,10 @@
 */
 
 #include <list>
-#include <map>
 #include <memory>
+#include <vector>
 
+#include <osmscout/import/ExternalSort.h>
 #include <osmscout/import/Import.h>
 
 #include <osmscout/DataFile.h>
@@ -44,31 +45,32 @@ namespace osmscout {
       FileScanner scanner;
     };
 
+    /**
+     * Sort key of an object. Objects are sorted by cell and then by the hash of
+     * their top left coordinate. The sequence number keeps the order of the
+     * sources for objects with equal cell and hash.
+     */
     struct CellEntry
     {
-      uint8_t                              type;
-      Id                                   id;
-      typename std::list<Source>::iterator source;
-      FileOffset                           fileOffset;
-      Id                                   sortId;
-
-      inline CellEntry(uint8_t type,
-                       Id id,
-                       const typename std::list<Source>::iterator source,
-                       FileOffset fileOffset,
-                       Id sortId)
-      : type(type),
-        id(id),
-        source(source),
-        fileOffset(fileOffset),
-        sortId(sortId)
-      {
-        // no code
-      }
+      uint64_t   cellIndex;
+      Id         sortId;
+      uint64_t   sequence;
+      FileOffset fileOffset;
+      Id         id;
+      uint32_t   source;
+      uint8_t    type;
 
       inline bool operator<(const CellEntry& other) const
       {
-        return sortId<other.sortId;
+        if (cellIndex!=other.cellIndex) {
+          return cellIndex<other.cellIndex;
+        }
+
+        if (sortId!=other.sortId) {
+          return sortId<other.sortId;
+        }
+
+        return sequence<other.sequence;
       }
     };
 
@@ -187,9 +189,12 @@ namespace osmscout {
     progress.SetAction("Sorting data");
 
     try {
-      uint32_t overallDataCount=0;
-      uint32_t dataCopiedCount=0;
-      size_t   minIndex=0;
+      uint32_t                  overallDataCount=0;
+      uint32_t                  dataCopiedCount=0;
+      std::vector<Source*>      sourceList;
+      ExternalSorter<CellEntry> sorter(parameter.GetDestinationDirectory(),
+                                       dataFilename,
+                                       parameter.GetSortBlockSize());
 
       for (auto& source : sources) {
         uint32_t dataCount=0;
@@ -204,8 +209,9 @@ namespace osmscout {
         progress.Info(std::to_string(dataCount)+" entries in file '"+source.scanner.GetFilename()+"'");
 
         overallDataCount+=dataCount;
-      }
 
+        sourceList.push_back(&source);
+      }
 
       dataWriter.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
                                       dataFilename));
@@ -217,163 +223,119 @@ namespace osmscout {
 
       mapWriter.Write(overallDataCount);
 
-      while (true) {
-        progress.Info("Reading objects in cell range "+std::to_string(minIndex)+ "-"+std::to_string(maxIndex));
+      //
+      // Collect the sort keys of all objects in one pass over the sources
+      //
 
-        size_t                                 currentEntries=0;
-        std::map<size_t,std::list<CellEntry> > dataByCellMap;
+      uint64_t sequence=0;
 
-        for (typename std::list<Source>::iterator source=sources.begin();
-             source!=sources.end();
-             ++source) {
-          uint32_t dataCount;
-          progress.Info("Reading objects from file '"+source->scanner.GetFilename()+"'");
+      for (uint32_t s=0; s<sourceList.size(); s++) {
+        Source&  source=*sourceList[s];
+        uint32_t dataCount;
 
-          source->scanner.GotoBegin();
+        progress.Info("Reading objects from file '"+source.scanner.GetFilename()+"'");
 
-          source->scanner.Read(dataCount);
+        source.scanner.GotoBegin();
 
-          uint32_t current=1;
+        source.scanner.Read(dataCount);
 
-          while (current<=dataCount) {
-            uint8_t type;
-            Id      id;
-            N       data;
+        for (uint32_t current=1; current<=dataCount; current++) {
+          CellEntry entry;
+          N         data;
 
-            progress.SetProgress(current,dataCount);
+          progress.SetProgress(current,dataCount);
 
-            source->scanner.Read(type);
-            source->scanner.Read(id);
+          source.scanner.Read(entry.type);
+          source.scanner.Read(entry.id);
 
-            data.Read(typeConfig,
-                      source->scanner);
+          data.Read(typeConfig,
+                    source.scanner);
 
-            GeoCoord coord;;
+          GeoCoord coord;
 
-            GetTopLeftCoordinate(data,
-                                 coord);
+          GetTopLeftCoordinate(data,
+                               coord);
 
-            size_t cellY=(size_t)((coord.GetLat()+90.0)/180.0*zoomLevel);
-            size_t cellX=(size_t)((coord.GetLon()+180.0)/360.0*zoomLevel);
-            size_t cellIndex=cellY*zoomLevel+cellX;
+          size_t cellY=(size_t)((coord.GetLat()+90.0)/180.0*zoomLevel);
+          size_t cellX=(size_t)((coord.GetLon()+180.0)/360.0*zoomLevel);
 
-            if (cellIndex>=minIndex &&
-                cellIndex<=maxIndex) {
-              dataByCellMap[cellIndex].push_back(CellEntry(type,
-                                                           id,
-                                                           source,
-                                                           data.GetFileOffset(),
-                                                           coord.GetHash()));
-              currentEntries++;
-            }
+          entry.cellIndex=std::min(cellY*zoomLevel+cellX,maxIndex);
+          entry.sortId=coord.GetHash();
+          entry.sequence=sequence++;
+          entry.fileOffset=data.GetFileOffset();
+          entry.source=s;
 
-            // Reduce cell interval, deleting all already stored nodes beyond the new
-            // cell range end.
-            if (currentEntries>parameter.GetSortBlockSize() &&
-                dataByCellMap.size()>1) {
-              size_t                                                    count=0;
-              size_t                                                    cutLimit=parameter.GetSortBlockSize()*9/10;
-              typename std::map<size_t,std::list<CellEntry> >::iterator cutOff=dataByCellMap.end();
-
-              for (typename std::map<size_t,std::list<CellEntry> >::iterator iter=dataByCellMap.begin();
-                   iter!=dataByCellMap.end();
-                   ++iter) {
-                if (count<=cutLimit &&
-                    count+iter->second.size()>cutLimit) {
-                  cutOff=iter;
-                  break;
-                }
-                else {
-                  maxIndex=iter->first;
-                  count+=iter->second.size();
-                }
-              }
-
-              assert(cutOff!=dataByCellMap.end());
-
-              currentEntries=count;
-              dataByCellMap.erase(cutOff,dataByCellMap.end());
-            }
-
-            current++;
-          }
+          sorter.Add(entry);
         }
+      }
 
-        if (maxIndex<cellCount-1) {
-          progress.Info("Cell range was reduced to "+std::to_string(minIndex)+ "-"+std::to_string(maxIndex));
-        }
+      progress.Info("Sorting "+std::to_string(sorter.GetCount())+" entries");
 
-        progress.Info(std::string("Copy renumbered data to '")+dataWriter.GetFilename()+"'");
+      sorter.Sort();
 
-        size_t copyCount=0;
-        for (typename std::map<size_t,std::list<CellEntry> >::iterator iter=dataByCellMap.begin();
-             iter!=dataByCellMap.end();
-             ++iter) {
+      if (sorter.GetRunCount()>0) {
+        progress.Info("Merging "+std::to_string(sorter.GetRunCount())+" sorted runs");
+      }
 
-          iter->second.sort();
+      //
+      // Copy the objects in sort order
+      //
 
-          for (auto& entry : iter->second) {
-            progress.SetProgress(copyCount,currentEntries);
+      progress.Info(std::string("Copy renumbered data to '")+dataWriter.GetFilename()+"'");
 
-            copyCount++;
+      size_t    copyCount=0;
+      CellEntry entry;
 
-            N data;
+      while (sorter.Next(entry)) {
+        progress.SetProgress(copyCount,sorter.GetCount());
 
-            entry.source->scanner.SetPos(entry.fileOffset);
+        copyCount++;
 
-            data.Read(typeConfig,
-                      entry.source->scanner);
+        N       data;
+        Source& source=*sourceList[entry.source];
 
-            FileOffset fileOffset;
-            bool       save=true;
+        source.scanner.SetPos(entry.fileOffset);
 
-            fileOffset=dataWriter.GetPos();
+        data.Read(typeConfig,
+                  source.scanner);
 
-            for (const auto& filter : filters) {
-              if (!filter->Process(progress,
-                                   fileOffset,
-                                   data,
-                                   save)) {
-                progress.Error(std::string("Error while processing data entry to file '")+
-                               dataWriter.GetFilename()+"'");
+        FileOffset fileOffset;
+        bool       save=true;
 
-                return false;
-              }
+        fileOffset=dataWriter.GetPos();
 
-              if (!save) {
-                break;
-              }
-            }
+        for (const auto& filter : filters) {
+          if (!filter->Process(progress,
+                               fileOffset,
+                               data,
+                               save)) {
+            progress.Error(std::string("Error while processing data entry to file '")+
+                           dataWriter.GetFilename()+"'");
 
-            if (!save) {
-              continue;
-            }
-
-            data.Write(typeConfig,
-                       dataWriter);
-
-            mapWriter.Write(entry.id);
-            mapWriter.Write(entry.type);
-            mapWriter.WriteFileOffset(fileOffset);
+            return false;
+          }
 
-            dataCopiedCount++;
+          if (!save) {
+            break;
           }
         }
 
-        if (currentEntries==0) {
-          progress.Info("No more entries found");
-          break;
+        if (!save) {
+          continue;
         }
 
-        if (maxIndex==cellCount-1) {
-          // We are finished
-          break;
-        }
+        data.Write(typeConfig,
+                   dataWriter);
+
+        mapWriter.Write(entry.id);
+        mapWriter.Write(entry.type);
+        mapWriter.WriteFileOffset(fileOffset);
 
-        minIndex=maxIndex+1;
-        maxIndex=cellCount-1;
+        dataCopiedCount++;
       }
 
+      sorter.Close();
+
       assert(overallDataCount>=dataCopiedCount);
 
       for (auto& source : sources) {
@@ -106,6 +106,10 @@ namespace osmscout {
    *    -- FillLand - Marks all still 'unknown' cells between 'coast' or 'land' and 'land' cells as 'land', too
    *    -- CalculateHasCellData - lookup if level contains some cells, setup `level.hasCellData` in such case
    *    -- WriteTiles - write data to index file
+   *
+   * The processor holds no state, so levels can be calculated concurrently, as long as
+   * each level uses its own StateMap and cell map. Within a level, coastline transformation,
+   * cell intersection and handling of cells crossed by coastlines run in parallel, too.
    */
   class OSMSCOUT_IMPORT_API WaterIndexProcessor CLASS_FINAL
   {
@@ -238,6 +242,8 @@ namespace osmscout {
                  y-cellYStart,
                  state);
       }
+
+      void Release();
     };
 
     /**
@@ -545,7 +551,7 @@ namespace osmscout {
                           const CellBoundaries &cellBoundaries,
                           IntersectionRef &pathStart,
                           IntersectionRef &pathEnd,
-                          Data &data,
+                          const Data &data,
                           const std::list<IntersectionRef> &intersectionsCW,
                           const std::vector<size_t> &containingPaths);
 
@@ -571,7 +577,7 @@ namespace osmscout {
                         const std::list<IntersectionRef> &intersectionsCW,
                         std::set<IntersectionRef> &visitedIntersections,
                         const CellBoundaries &cellBoundaries,
-                        Data& data,
+                        const Data& data,
                         const std::vector<size_t> &containingPaths);
 
     /**
@@ -597,8 +603,8 @@ namespace osmscout {
                              const Pixel &cell,
                              const std::list<size_t>& intersectCoastlines,
                              const StateMap& stateMap,
-                             std::map<Pixel,std::list<GroundTile> >& cellGroundTileMap,
-                             Data& data);
+                             std::list<GroundTile>& groundTiles,
+                             const Data& data);
 
 public:
     /**
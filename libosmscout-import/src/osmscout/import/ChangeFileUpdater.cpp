@@ -0,0 +1,487 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/ChangeFileUpdater.h>
+
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+#include <osmscout/AreaNodeUpdates.h>
+#include <osmscout/Node.h>
+#include <osmscout/NodeDataFile.h>
+
+#include <osmscout/util/BlockCompression.h>
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+#include <osmscout/util/String.h>
+#include <osmscout/util/TagErrorReporter.h>
+
+#include <osmscout/private/Config.h>
+#include <osmscout/import/ImportFeatures.h>
+
+#if defined(HAVE_LIB_XML) || defined(OSMSCOUT_IMPORT_HAVE_XML_SUPPORT)
+  #include <libxml/parser.h>
+#endif
+
+namespace osmscout {
+
+#if defined(HAVE_LIB_XML) || defined(OSMSCOUT_IMPORT_HAVE_XML_SUPPORT)
+  /**
+   * SAX parser for OSM change files. Node changes are collected, way and
+   * relation changes are only counted.
+   */
+  class ChangeFileParser
+  {
+  private:
+    const TypeConfig&                          typeConfig;
+    std::vector<ChangeFileUpdater::NodeChange>& changes;
+    ChangeFileUpdater::Statistics&             statistics;
+    ChangeFileUpdater::Action                  action;
+    bool                                       inNode;
+    ChangeFileUpdater::NodeChange              change;
+
+  public:
+    ChangeFileParser(const TypeConfig& typeConfig,
+                     std::vector<ChangeFileUpdater::NodeChange>& changes,
+                     ChangeFileUpdater::Statistics& statistics)
+    : typeConfig(typeConfig),
+      changes(changes),
+      statistics(statistics),
+      action(ChangeFileUpdater::Action::modify),
+      inNode(false)
+    {
+      // no code
+    }
+
+    void StartElement(const xmlChar *name, const xmlChar **atts)
+    {
+      if (strcmp((const char*)name,"create")==0) {
+        action=ChangeFileUpdater::Action::create;
+      }
+      else if (strcmp((const char*)name,"modify")==0) {
+        action=ChangeFileUpdater::Action::modify;
+      }
+      else if (strcmp((const char*)name,"delete")==0) {
+        action=ChangeFileUpdater::Action::remove;
+      }
+      else if (strcmp((const char*)name,"node")==0) {
+        const xmlChar *idValue=nullptr;
+        const xmlChar *latValue=nullptr;
+        const xmlChar *lonValue=nullptr;
+        double        lat=0.0;
+        double        lon=0.0;
+
+        for (size_t i=0; atts!=nullptr && atts[i]!=nullptr && atts[i+1]!=nullptr; i+=2) {
+          if (strcmp((const char*)atts[i],"id")==0) {
+            idValue=atts[i+1];
+          }
+          else if (strcmp((const char*)atts[i],"lat")==0) {
+            latValue=atts[i+1];
+          }
+          else if (strcmp((const char*)atts[i],"lon")==0) {
+            lonValue=atts[i+1];
+          }
+        }
+
+        change.action=action;
+        change.tags.clear();
+
+        if (idValue==nullptr ||
+            !StringToNumber((const char*)idValue,change.id)) {
+          std::cerr << "Cannot parse node id, skipping..." << std::endl;
+          return;
+        }
+
+        // Deleted nodes do not need to have a coordinate
+        if (action!=ChangeFileUpdater::Action::remove &&
+            (latValue==nullptr ||
+             lonValue==nullptr ||
+             !StringToNumber((const char*)latValue,lat) ||
+             !StringToNumber((const char*)lonValue,lon))) {
+          std::cerr << "Cannot parse coordinate of node " << change.id << ", skipping..." << std::endl;
+          return;
+        }
+
+        change.coord.Set(lat,lon);
+        inNode=true;
+      }
+      else if (strcmp((const char*)name,"tag")==0) {
+        if (!inNode) {
+          return;
+        }
+
+        const xmlChar *keyValue=nullptr;
+        const xmlChar *valueValue=nullptr;
+
+        for (size_t i=0; atts!=nullptr && atts[i]!=nullptr && atts[i+1]!=nullptr; i+=2) {
+          if (strcmp((const char*)atts[i],"k")==0) {
+            keyValue=atts[i+1];
+          }
+          else if (strcmp((const char*)atts[i],"v")==0) {
+            valueValue=atts[i+1];
+          }
+        }
+
+        if (keyValue==nullptr || valueValue==nullptr) {
+          std::cerr << "Cannot parse tag, skipping..." << std::endl;
+          return;
+        }
+
+        TagId id=typeConfig.GetTagRegistry().GetTagId((const char*)keyValue);
+
+        if (id!=tagIgnore) {
+          change.tags[id]=(const char*)valueValue;
+        }
+      }
+      else if (strcmp((const char*)name,"way")==0) {
+        statistics.waysSkipped++;
+      }
+      else if (strcmp((const char*)name,"relation")==0) {
+        statistics.relationsSkipped++;
+      }
+    }
+
+    void EndElement(const xmlChar *name)
+    {
+      if (strcmp((const char*)name,"node")==0 &&
+          inNode) {
+        changes.push_back(std::move(change));
+        inNode=false;
+      }
+    }
+  };
+
+  static void StartElement(void *data, const xmlChar *name, const xmlChar **atts)
+  {
+    auto* parser=static_cast<ChangeFileParser*>(data);
+
+    parser->StartElement(name,atts);
+  }
+
+  static void EndElement(void *data, const xmlChar *name)
+  {
+    auto* parser=static_cast<ChangeFileParser*>(data);
+
+    parser->EndElement(name);
+  }
+
+  static xmlEntityPtr GetEntity(void* /*data*/, const xmlChar *name)
+  {
+    return xmlGetPredefinedEntity(name);
+  }
+
+  static void StructuredErrorHandler(void* /*data*/, xmlErrorPtr error)
+  {
+    std::cerr << "XML error, line " << error->line << ": " << error->message << std::endl;
+  }
+
+  static void WarningHandler(void* /*data*/, const char* msg,...)
+  {
+    std::cerr << "XML warning:" << msg << std::endl;
+  }
+
+  static void ErrorHandler(void* /*data*/, const char* msg,...)
+  {
+    std::cerr << "XML error:" << msg << std::endl;
+  }
+
+  bool ChangeFileUpdater::ReadChangeFile(const TypeConfig& typeConfig,
+                                         Progress& progress,
+                                         const std::string& filename,
+                                         std::vector<NodeChange>& changes,
+                                         Statistics& statistics)
+  {
+    progress.SetAction(std::string("Parsing *.osc file '")+filename+"'");
+
+    ChangeFileParser parser(typeConfig,
+                            changes,
+                            statistics);
+    FILE             *file;
+    xmlSAXHandler    saxParser;
+    xmlParserCtxtPtr ctxt;
+
+    memset(&saxParser,0,sizeof(xmlSAXHandler));
+    saxParser.initialized=XML_SAX2_MAGIC;
+
+    saxParser.getEntity=GetEntity;
+    saxParser.startElement=StartElement;
+    saxParser.endElement=EndElement;
+    saxParser.warning=WarningHandler;
+    saxParser.error=ErrorHandler;
+    saxParser.fatalError=ErrorHandler;
+    saxParser.serror=StructuredErrorHandler;
+
+    file=fopen(filename.c_str(),"rb");
+
+    if (file==nullptr) {
+      progress.Error("Cannot open '"+filename+"'");
+      return false;
+    }
+
+    char chars[1024];
+
+    int res=fread(chars,1,4,file);
+    if (res!=4) {
+      fclose(file);
+      return false;
+    }
+
+    ctxt=xmlCreatePushParserCtxt(&saxParser,&parser,chars,res,nullptr);
+
+    // Resolve entities, do not do any network communication, use the SAX1
+    // callbacks (newer libxml2 versions otherwise only call the SAX2 callbacks)
+    xmlCtxtUseOptions(ctxt,XML_PARSE_NOENT|XML_PARSE_NONET|XML_PARSE_SAX1);
+
+    while ((res=fread(chars,1,sizeof(chars),file))>0) {
+      if (xmlParseChunk(ctxt,chars,res,0)!=0) {
+        xmlParserError(ctxt,"xmlParseChunk");
+        xmlFreeParserCtxt(ctxt);
+        fclose(file);
+
+        return false;
+      }
+    }
+
+    if (xmlParseChunk(ctxt,chars,0,1)!=0) {
+      xmlParserError(ctxt,"xmlParseChunk");
+      xmlFreeParserCtxt(ctxt);
+      fclose(file);
+
+      return false;
+    }
+
+    xmlFreeParserCtxt(ctxt);
+    fclose(file);
+
+    return true;
+  }
+#else
+  bool ChangeFileUpdater::ReadChangeFile(const TypeConfig& /*typeConfig*/,
+                                         Progress& progress,
+                                         const std::string& /*filename*/,
+                                         std::vector<NodeChange>& /*changes*/,
+                                         Statistics& /*statistics*/)
+  {
+    progress.Error("Support for the OSM file format is not enabled!");
+
+    return false;
+  }
+#endif
+
+  /**
+   * Apply the given change file to the database in the destination directory
+   * of the parameter. The type configuration must be the one the database
+   * was imported with.
+   */
+  bool ChangeFileUpdater::Update(const TypeConfigRef& typeConfig,
+                                 const ImportParameter& parameter,
+                                 Progress& progress,
+                                 const std::string& filename,
+                                 Statistics& statistics)
+  {
+    std::vector<NodeChange> changes;
+
+    if (!ReadChangeFile(*typeConfig,
+                        progress,
+                        filename,
+                        changes,
+                        statistics)) {
+      return false;
+    }
+
+    progress.Info(std::to_string(changes.size())+" node change(s), "+
+                  std::to_string(statistics.waysSkipped)+" way change(s), "+
+                  std::to_string(statistics.relationsSkipped)+" relation change(s)");
+
+    std::string nodeDataFilename=AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                 NodeDataFile::NODES_DAT);
+
+    try {
+      if (IsBlockCompressedFile(nodeDataFilename)) {
+        progress.Error("'"+nodeDataFilename+"' is block compressed, updates require an uncompressed import");
+        return false;
+      }
+    }
+    catch (IOException& e) {
+      progress.Error(e.GetDescription());
+      return false;
+    }
+
+    AreaNodeUpdates updates;
+
+    if (!updates.Load(parameter.GetDestinationDirectory())) {
+      progress.Error("Cannot load existing node updates");
+      return false;
+    }
+
+    FileScanner idMapScanner;
+    FileWriter  nodeWriter;
+
+    try {
+      // Offsets of the nodes in the imported data, that are modified or deleted.
+      // Nodes already added by a previous update are handled by the updates themselves.
+      std::unordered_map<OSMId,FileOffset> nodeOffsets;
+
+      for (const auto& change : changes) {
+        if (change.action!=Action::create &&
+            updates.Find(change.id)==nullptr) {
+          nodeOffsets[change.id]=0;
+        }
+      }
+
+      std::string idMapFilename=AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                NodeDataFile::NODES_IDMAP);
+
+      if (!nodeOffsets.empty()) {
+        if (!ExistsInFilesystem(idMapFilename)) {
+          progress.Error("'"+idMapFilename+"' does not exist, imported nodes cannot be modified or deleted");
+          return false;
+        }
+        else {
+          progress.SetAction("Resolving offsets of changed nodes");
+
+          idMapScanner.Open(idMapFilename,
+                            FileScanner::Sequential,
+                            false);
+
+          uint32_t entryCount;
+
+          idMapScanner.Read(entryCount);
+
+          for (uint32_t e=1; e<=entryCount; e++) {
+            Id         id;
+            uint8_t    type;
+            FileOffset fileOffset;
+
+            idMapScanner.Read(id);
+            idMapScanner.Read(type);
+            idMapScanner.ReadFileOffset(fileOffset);
+
+            auto entry=nodeOffsets.find((OSMId)id);
+
+            if (entry!=nodeOffsets.end()) {
+              entry->second=fileOffset;
+            }
+          }
+
+          idMapScanner.Close();
+        }
+      }
+
+      // Nodes without an offset are not POIs of the database. They are most likely
+      // nodes of ways or areas, whose geometry cannot be updated incrementally.
+      for (const auto& nodeOffset : nodeOffsets) {
+        if (nodeOffset.second==0) {
+          statistics.nodesUnresolved++;
+        }
+      }
+
+      if (statistics.nodesUnresolved>0) {
+        progress.Error(std::to_string(statistics.nodesUnresolved)+" modified or deleted node(s) are not part of the node data, "
+                       "they may belong to ways or areas, which require a full import");
+        return false;
+      }
+
+      progress.SetAction("Applying node changes");
+
+      nodeWriter.OpenForAppend(nodeDataFilename);
+
+      SilentTagErrorReporter errorReporter;
+
+      for (const auto& change : changes) {
+        bool removed=updates.Erase(change.id);
+        auto nodeOffset=nodeOffsets.find(change.id);
+
+        if (nodeOffset!=nodeOffsets.end() &&
+            nodeOffset->second!=0) {
+          updates.Remove(nodeOffset->second);
+          nodeOffset->second=0;
+          removed=true;
+        }
+
+        if (removed) {
+          statistics.nodesRemoved++;
+        }
+
+        if (change.action==Action::remove) {
+          continue;
+        }
+
+        TypeInfoRef type=typeConfig->GetNodeType(change.tags);
+
+        if (type->GetIgnore()) {
+          statistics.nodesIgnored++;
+          continue;
+        }
+
+        FeatureValueBuffer featureValueBuffer;
+        Node               node;
+
+        featureValueBuffer.SetType(type);
+        featureValueBuffer.Parse(errorReporter,
+                                 typeConfig->GetTagRegistry(),
+                                 ObjectOSMRef(change.id,osmRefNode),
+                                 change.tags);
+
+        node.SetFeatures(featureValueBuffer);
+        node.SetCoords(change.coord);
+
+        FileOffset fileOffset=nodeWriter.GetPos();
+
+        node.Write(*typeConfig,
+                   nodeWriter);
+
+        updates.Set(AreaNodeUpdates::Entry{change.id,
+                                           type->GetNodeId(),
+                                           change.coord,
+                                           fileOffset});
+
+        statistics.nodesAdded++;
+      }
+
+      // Nodes must be written completely, before the updates reference them
+      nodeWriter.Close();
+    }
+    catch (IOException& e) {
+      progress.Error(e.GetDescription());
+      idMapScanner.CloseFailsafe();
+      nodeWriter.CloseFailsafe();
+
+      return false;
+    }
+
+    if (!updates.Store(parameter.GetDestinationDirectory())) {
+      progress.Error("Cannot store node updates");
+      return false;
+    }
+
+    progress.Info(std::to_string(statistics.nodesAdded)+" node(s) added, "+
+                  std::to_string(statistics.nodesRemoved)+" node(s) removed, "+
+                  std::to_string(statistics.nodesIgnored)+" node(s) without type ignored");
+
+    if (statistics.waysSkipped>0 ||
+        statistics.relationsSkipped>0) {
+      progress.Warning("Changes of ways and relations are not applied, they require a full import");
+    }
+
+    return true;
+  }
+}
@@ -19,12 +19,14 @@
 
 #include <osmscout/import/GenAreaNodeIndex.h>
 
+#include <algorithm>
 #include <numeric>
 
 #include <osmscout/Node.h>
 #include <osmscout/Pixel.h>
 
 #include <osmscout/AreaNodeIndex.h>
+#include <osmscout/AreaNodeUpdates.h>
 #include <osmscout/NodeDataFile.h>
 
 #include <osmscout/system/Assert.h>
@@ -100,7 +102,7 @@ namespace osmscout {
   }
 
   static MagnificationLevel GetBitmapZoomLevel(const ImportParameter& parameter,
-                                               const std::list<std::pair<GeoCoord,FileOffset>>& data)
+                                               const AreaNodeIndexGenerator::NodeEntryList& data)
   {
     MagnificationLevel magnification=parameter.GetAreaNodeGridMag();
 
@@ -109,18 +111,16 @@ namespace osmscout {
 
     // That is our maximum magnification, beyond that we trade disk size in favour of performance
     while (magnification<parameter.GetAreaNodeBitmapMaxMag()) {
-      std::map<TileId,std::list<FileOffset>> bitmapData;
+      std::map<TileId,size_t> cellFillCount;
 
       for (const auto& entry : data) {
-        TileId dataTileId=TileId::GetTile(magnification,entry.first);
-
-        bitmapData[dataTileId].push_back(entry.second);
+        cellFillCount[TileId::GetTile(magnification,entry.first)]++;
       }
 
-      if (std::all_of(bitmapData.begin(),
-                      bitmapData.end(),
-                      [&parameter](const std::pair<TileId,std::list<FileOffset>>& entry) {
-                        return entry.second.size()<=parameter.GetAreaNodeBitmapLimit();
+      if (std::all_of(cellFillCount.begin(),
+                      cellFillCount.end(),
+                      [&parameter](const std::pair<const TileId,size_t>& entry) {
+                        return entry.second<=parameter.GetAreaNodeBitmapLimit();
       })) {
         return magnification;
       }
@@ -142,25 +142,27 @@ namespace osmscout {
     description.AddProvidedFile(AreaNodeIndex::AREA_NODE_IDX);
   }
 
-  bool AreaNodeIndexGenerator::AnalyseDistribution(const TypeConfigRef& typeConfig,
-                                                   const ImportParameter& parameter,
-                                                   Progress& progress,
-                                                   std::vector<DistributionData>& data)
+  /**
+   * Scan the node data file once and collect coordinates and file offsets of all nodes
+   * grouped by their type.
+   */
+  bool AreaNodeIndexGenerator::ReadNodes(const TypeConfigRef& typeConfig,
+                                         const ImportParameter& parameter,
+                                         Progress& progress,
+                                         std::vector<DistributionData>& data,
+                                         std::vector<NodeEntryList>& nodesByType)
   {
     data.resize(typeConfig->GetNodeTypes().size()+1);
+    nodesByType.resize(data.size());
 
     try {
-      FileScanner        nodeScanner;
+      FileScanner nodeScanner;
 
       nodeScanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
                                        NodeDataFile::NODES_DAT),
                        FileScanner::Sequential,
                        true);
 
-      //
-      // Scanning distribution
-      //
-
       progress.SetAction("Scanning distribution of node types");
 
       uint32_t dataCount=0;
@@ -179,39 +181,11 @@ namespace osmscout {
 
         data[typeId].type=node.GetType();
         data[typeId].nodeId=typeId;
-        data[typeId].boundingBox.Include(node.GetCoords());
-        data[typeId].tileFillCount[TileId::GetTile(parameter.GetAreaNodeGridMag(),node.GetCoords())]++;
+        nodesByType[typeId].emplace_back(node.GetCoords(),
+                                         node.GetFileOffset());
       }
 
       nodeScanner.Close();
-
-      progress.SetAction("Analysing distribution of node types");
-
-      for (auto& entry : data) {
-        entry.fillCount=std::accumulate(entry.tileFillCount.begin(),
-                                        entry.tileFillCount.end(),
-                                        (size_t)0,
-                                        [](size_t sum, std::pair<const osmscout::TileId,size_t> current) {
-                                          return sum+current.second;
-                                        });
-
-        if (entry.fillCount>parameter.GetAreaNodeSimpleListLimit()) {
-          entry.isComplex=true;
-          std::for_each(entry.tileFillCount.begin(),
-                        entry.tileFillCount.end(),
-                        [&entry,&parameter](const std::pair<TileId,size_t>& tileData) {
-                          if (tileData.second<=parameter.GetAreaNodeTileListLimit()) {
-                            entry.listTiles.insert(tileData.first);
-                          }
-                          else {
-                            entry.bitmapTiles.insert(tileData.first);
-                          }
-          });
-        }
-        else {
-          entry.isComplex=false;
-        }
-      }
     }
     catch (IOException& e) {
       progress.Error(e.GetDescription());
@@ -221,6 +195,53 @@ namespace osmscout {
     return true;
   }
 
+  /**
+   * Calculate bounding box and tile distribution of each type and decide about the
+   * type of index. Types are independent of each other and are analysed in parallel.
+   */
+  void AreaNodeIndexGenerator::AnalyseDistribution(const ImportParameter& parameter,
+                                                   Progress& progress,
+                                                   const std::vector<NodeEntryList>& nodesByType,
+                                                   std::vector<DistributionData>& data)
+  {
+    progress.SetAction("Analysing distribution of node types");
+
+    std::vector<size_t> types(data.size());
+
+    std::iota(types.begin(),
+              types.end(),
+              0);
+
+    ProcessInParallel(types,
+                      [&parameter,&nodesByType,&data](size_t typeId) {
+      DistributionData& entry=data[typeId];
+
+      for (const auto& node : nodesByType[typeId]) {
+        entry.boundingBox.Include(node.first);
+        entry.tileFillCount[TileId::GetTile(parameter.GetAreaNodeGridMag(),node.first)]++;
+      }
+
+      entry.fillCount=nodesByType[typeId].size();
+
+      if (entry.fillCount>parameter.GetAreaNodeSimpleListLimit()) {
+        entry.isComplex=true;
+        std::for_each(entry.tileFillCount.begin(),
+                      entry.tileFillCount.end(),
+                      [&entry,&parameter](const std::pair<TileId,size_t>& tileData) {
+                        if (tileData.second<=parameter.GetAreaNodeTileListLimit()) {
+                          entry.listTiles.insert(tileData.first);
+                        }
+                        else {
+                          entry.bitmapTiles.insert(tileData.first);
+                        }
+        });
+      }
+      else {
+        entry.isComplex=false;
+      }
+    });
+  }
+
   void AreaNodeIndexGenerator::DumpDistribution(Progress& progress,
                                                 const std::vector<DistributionData>& data)
   {
@@ -369,7 +390,7 @@ namespace osmscout {
 
   void AreaNodeIndexGenerator::WriteListData(Progress& progress,
                                              const std::vector<DistributionData>& data,
-                                             const std::vector<std::list<std::pair<GeoCoord,FileOffset>>>& listData,
+                                             const std::vector<NodeEntryList>& listData,
                                              const std::vector<FileOffset>& listIndexOffsets,
                                              FileWriter& writer)
   {
@@ -406,7 +427,7 @@ namespace osmscout {
 
   void AreaNodeIndexGenerator::WriteTileListData(const ImportParameter& parameter,
                                                  const DistributionData& distributionData,
-                                                 const std::list<std::pair<GeoCoord,FileOffset>>& tileData,
+                                                 const NodeEntryList& tileData,
                                                  const FileOffset& tileIndexOffset,
                                                  FileWriter& writer)
   {
@@ -433,7 +454,8 @@ namespace osmscout {
 
   void AreaNodeIndexGenerator::WriteBitmapData(const ImportParameter& parameter,
                                                const TileId& tileId,
-                                               const std::list<std::pair<GeoCoord,FileOffset>>& data,
+                                               const MagnificationLevel& magnification,
+                                               const NodeEntryList& data,
                                                const FileOffset& bitmapIndexOffset,
                                                FileWriter& writer)
   {
@@ -441,7 +463,6 @@ namespace osmscout {
     size_t                                 indexEntries=0;
     size_t                                 dataSize=0;
     char                                   buffer[10];
-    MagnificationLevel                     magnification=GetBitmapZoomLevel(parameter,data);
 
     for (const auto& entry : data) {
       TileId dataTileId=TileId::GetTile(magnification,entry.first);
@@ -522,22 +543,88 @@ namespace osmscout {
     }
   }
 
-  bool AreaNodeIndexGenerator::WriteData(const TypeConfigRef& typeConfig,
-                                         const ImportParameter& parameter,
+  /**
+   * Group the nodes of all complex types by tile and calculate the bitmap magnification
+   * of the bitmap tiles. Types are processed in parallel.
+   *
+   * The result is ordered by the file offset of the last node in each tile, which
+   * is the order the tiles were written in when scanning the node data file.
+   * The nodes of complex types are moved out of nodesByType.
+   */
+  std::vector<AreaNodeIndexGenerator::TileData> AreaNodeIndexGenerator::CollectTileData(const ImportParameter& parameter,
+                                                                                        const std::vector<DistributionData>& data,
+                                                                                        std::vector<NodeEntryList>& nodesByType)
+  {
+    std::vector<std::vector<TileData>> tileDataByType(data.size());
+    std::vector<size_t>                types;
+
+    for (const auto& entry : data) {
+      if (entry.IsComplexIndex() &&
+          !entry.HasNoData()) {
+        types.push_back(entry.nodeId);
+      }
+    }
+
+    std::stable_sort(types.begin(),
+                     types.end(),
+                     [&data](size_t a, size_t b) {
+      return data[a].fillCount>data[b].fillCount;
+    });
+
+    ProcessInParallel(types,
+                      [&parameter,&data,&nodesByType,&tileDataByType](size_t typeId) {
+      std::map<TileId,NodeEntryList> nodesByTile;
+
+      for (const auto& node : nodesByType[typeId]) {
+        nodesByTile[TileId::GetTile(parameter.GetAreaNodeGridMag(),node.first)].push_back(node);
+      }
+
+      nodesByType[typeId].clear();
+      nodesByType[typeId].shrink_to_fit();
+
+      for (auto& tile : nodesByTile) {
+        TileData tileData{(TypeId)typeId,
+                          tile.first,
+                          IndexType::IndexTypeList,
+                          MagnificationLevel(0),
+                          std::move(tile.second)};
+
+        if (data[typeId].bitmapTiles.find(tileData.tileId)!=data[typeId].bitmapTiles.end()) {
+          tileData.indexType=IndexType::IndexTypeBitmap;
+          tileData.magnification=GetBitmapZoomLevel(parameter,
+                                                    tileData.nodes);
+        }
+
+        tileDataByType[typeId].push_back(std::move(tileData));
+      }
+    });
+
+    std::vector<TileData> result;
+
+    for (auto& typeTiles : tileDataByType) {
+      for (auto& tileData : typeTiles) {
+        result.push_back(std::move(tileData));
+      }
+    }
+
+    std::sort(result.begin(),
+              result.end(),
+              [](const TileData& a, const TileData& b) {
+      return a.nodes.back().second<b.nodes.back().second;
+    });
+
+    return result;
+  }
+
+  bool AreaNodeIndexGenerator::WriteData(const ImportParameter& parameter,
                                          Progress& progress,
-                                         const std::vector<DistributionData>& data)
+                                         const std::vector<DistributionData>& data,
+                                         std::vector<NodeEntryList>& nodesByType)
   {
     progress.SetAction("Generating 'areanode.idx'");
 
     try {
-      FileScanner nodeScanner;
-      FileWriter  writer;
-      auto        level=parameter.GetAreaNodeGridMag();
-
-      nodeScanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
-                                       NodeDataFile::NODES_DAT),
-                       FileScanner::Sequential,
-                       true);
+      FileWriter writer;
 
       writer.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
                                   AreaNodeIndex::AREA_NODE_IDX));
@@ -562,114 +649,50 @@ namespace osmscout {
 
       std::vector<std::map<TileId,FileOffset>> bitmapIndexOffsets=WriteBitmapIndex(progress,data,writer);
 
-      uint32_t nodeCount;
-
-      //
-      // Read list index data
-      //
-
-      std::vector<std::list<std::pair<GeoCoord,FileOffset>>> listData(data.size());
-
-      nodeScanner.GotoBegin();
-      nodeScanner.Read(nodeCount);
-
-      //
-      // Collect all node offsets for each bitmap cell for all current types
-      //
-      for (uint32_t n=1; n<=nodeCount; n++) {
-        progress.SetProgress(n,nodeCount);
-
-        Node node;
-
-        node.Read(*typeConfig,
-                  nodeScanner);
-
-        auto typeId=node.GetType()->GetNodeId();
-
-        if (!data[typeId].IsComplexIndex()) {
-          listData[typeId].push_back(std::make_pair(node.GetCoords(),node.GetFileOffset()));
-        }
-      }
-
       //
       // Write list data
       //
 
       WriteListData(progress,
                     data,
-                    listData,
+                    nodesByType,
                     listIndexOffsets,
                     writer);
 
       listIndexOffsets.clear();
-      listData.clear();
 
       //
-      // Read tile list and bitmap index data
+      // Write tile list and bitmap index data
       //
 
       progress.Info("Writing tile list and bitmap index data");
 
-      std::vector<std::map<TileId,std::list<std::pair<GeoCoord,FileOffset>>>> tileData(data.size());
-
-      nodeScanner.GotoBegin();
-      nodeScanner.Read(nodeCount);
-
-      //
-      // Collect all node offsets for each tile for all current types
-      //
-      for (uint32_t n=1; n<=nodeCount; n++) {
-        progress.SetProgress(n,nodeCount);
-
-        Node node;
-
-        node.Read(*typeConfig,
-                  nodeScanner);
-
-        auto typeId=node.GetType()->GetNodeId();
-
-        if (!data[typeId].IsComplexIndex()) {
-          continue;
-        }
+      std::vector<TileData> tileData=CollectTileData(parameter,
+                                                     data,
+                                                     nodesByType);
 
-        auto tileId=TileId::GetTile(level,node.GetCoords());
+      for (size_t t=0; t<tileData.size(); t++) {
+        const TileData& tile=tileData[t];
 
-        IndexType indexType;
+        progress.SetProgress(t,tileData.size());
 
-        if (data[typeId].listTiles.find(tileId)!=data[typeId].listTiles.end()) {
-          indexType=IndexType::IndexTypeList;
-        }
-        else if (data[typeId].bitmapTiles.find(tileId)!=data[typeId].bitmapTiles.end()) {
-          indexType=IndexType::IndexTypeBitmap;
+        if (tile.indexType==IndexType::IndexTypeList) {
+          WriteTileListData(parameter,
+                            data[tile.nodeId],
+                            tile.nodes,
+                            tileIndexOffsets[tile.nodeId][tile.tileId],
+                            writer);
         }
         else {
-          continue;
-        }
-
-        tileData[typeId][tileId].push_back(std::make_pair(node.GetCoords(),
-                                                          node.GetFileOffset()));
-
-        if (tileData[typeId][tileId].size()==data[typeId].tileFillCount.find(tileId)->second) {
-          if (indexType==IndexType::IndexTypeList) {
-            WriteTileListData(parameter,
-                              data[typeId],
-                              tileData[typeId][tileId],
-                              tileIndexOffsets[typeId][tileId],
-                              writer);
-          }
-          else {
-            WriteBitmapData(parameter,
-                            tileId,
-                            tileData[typeId][tileId],
-                            bitmapIndexOffsets[typeId][tileId],
-                            writer);
-          }
-
-          tileData[typeId][tileId].clear();
+          WriteBitmapData(parameter,
+                          tile.tileId,
+                          tile.magnification,
+                          tile.nodes,
+                          bitmapIndexOffsets[tile.nodeId][tile.tileId],
+                          writer);
         }
       }
 
-      nodeScanner.Close();
       writer.Close();
     }
     catch (IOException& e) {
@@ -685,21 +708,34 @@ namespace osmscout {
                                       Progress& progress)
   {
     std::vector<DistributionData> distributionData;
+    std::vector<NodeEntryList>    nodesByType;
 
-    if (!AnalyseDistribution(typeConfig,
-                             parameter,
-                             progress,
-                             distributionData)) {
+    // Updates of a previous database refer to the old 'nodes.dat' and are
+    // obsolete after a full import
+    if (!AreaNodeUpdates().Store(parameter.GetDestinationDirectory())) {
+      progress.Error("Cannot remove obsolete node updates");
       return false;
     }
 
+    if (!ReadNodes(typeConfig,
+                   parameter,
+                   progress,
+                   distributionData,
+                   nodesByType)) {
+      return false;
+    }
+
+    AnalyseDistribution(parameter,
+                        progress,
+                        nodesByType,
+                        distributionData);
+
     DumpDistribution(progress,
                      distributionData);
 
-
-    return WriteData(typeConfig,
-                     parameter,
+    return WriteData(parameter,
                      progress,
-                     distributionData);
+                     distributionData,
+                     nodesByType);
   }
 }
@@ -19,6 +19,8 @@
 
 #include <osmscout/import/GenAreaWayIndex.h>
 
+#include <algorithm>
+#include <memory>
 #include <vector>
 
 #include <osmscout/Way.h>
@@ -174,104 +176,171 @@ namespace osmscout {
     typeData.cellYCount=typeData.cellYEnd-typeData.cellYStart+1;
   }
 
-  bool AreaWayIndexGenerator::CalculateDistribution(const TypeConfig& typeConfig,
-                                                    const ImportParameter& parameter,
-                                                    Progress& progress,
-                                                    std::vector<TypeData>& wayTypeData,
-                                                    MagnificationLevel& maxLevel) const
+  /**
+   * Scan the way data file once and collect the bounding box and file offset
+   * of all ways, grouped by type. All further work is done on this data.
+   */
+  bool AreaWayIndexGenerator::ReadWays(const TypeConfig& typeConfig,
+                                       const ImportParameter& parameter,
+                                       Progress& progress,
+                                       std::vector<WayEntryList>& waysByType) const
   {
-    FileScanner        wayScanner;
-    TypeInfoSet        remainingWayTypes;
-    MagnificationLevel level=parameter.GetAreaWayMinMag();
+    FileScanner wayScanner;
 
-    maxLevel=MagnificationLevel(0);
-    wayTypeData.resize(typeConfig.GetTypeCount());
+    waysByType.resize(typeConfig.GetTypeCount());
 
     try {
+      uint32_t wayCount=0;
+
       wayScanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
                                       WayDataFile::WAYS_DAT),
                       FileScanner::Sequential,
                       parameter.GetWayDataMemoryMaped());
 
-      remainingWayTypes.Set(typeConfig.GetWayTypes());
-
-      while (!remainingWayTypes.Empty() &&
-             level<=parameter.GetAreaWayIndexMaxLevel()) {
-        Magnification              magnification(level);
-        uint32_t                   wayCount=0;
-        TypeInfoSet                currentWayTypes(remainingWayTypes);
-        std::vector<CoordCountMap> cellFillCount(typeConfig.GetTypeCount());
+      wayScanner.Read(wayCount);
 
-        progress.Info("Scanning Level "+level+" ("+std::to_string(remainingWayTypes.Size())+" types remaining)");
+      Way way;
 
-        wayScanner.GotoBegin();
+      for (uint32_t w=1; w<=wayCount; w++) {
+        progress.SetProgress(w,wayCount);
 
-        wayScanner.Read(wayCount);
+        FileOffset offset=wayScanner.GetPos();
 
-        Way way;
+        way.Read(typeConfig,
+                 wayScanner);
 
-        for (uint32_t w=1; w<=wayCount; w++) {
-          progress.SetProgress(w,wayCount);
-
-          way.Read(typeConfig,
-                   wayScanner);
-
-          // Count number of entries per current type and coordinate
-          if (!currentWayTypes.IsSet(way.GetType())) {
-            continue;
-          }
+        waysByType[way.GetType()->GetIndex()].push_back(WayEntry{way.GetBoundingBox(),
+                                                                 offset});
+      }
 
-          GeoBox boundingBox=way.GetBoundingBox();
+      wayScanner.Close();
+    }
+    catch (IOException& e) {
+      progress.Error(e.GetDescription());
+      wayScanner.CloseFailsafe();
+      return false;
+    }
 
-          TileIdBox box(TileId::GetTile(magnification,boundingBox.GetMinCoord()),
-                        TileId::GetTile(magnification,boundingBox.GetMaxCoord()));
+    return true;
+  }
 
-          for (const auto& tileId : box) {
-            cellFillCount[way.GetType()->GetIndex()][tileId.AsPixel()]++;
-          }
+  /**
+   * Find the index level for the given type, starting with the minimum level and
+   * stopping at the first level that fits the index criteria
+   */
+  void AreaWayIndexGenerator::CalculateTypeDistribution(const ImportParameter& parameter,
+                                                        Progress& progress,
+                                                        const TypeInfo& typeInfo,
+                                                        const WayEntryList& ways,
+                                                        TypeData& typeData) const
+  {
+    for (MagnificationLevel level=parameter.GetAreaWayMinMag();
+         level<=parameter.GetAreaWayIndexMaxLevel();
+         level++) {
+      Magnification magnification(level);
+      CoordCountMap cellFillCount;
+
+      // Count number of entries per coordinate
+      for (const auto& way : ways) {
+        TileIdBox box(TileId::GetTile(magnification,way.boundingBox.GetMinCoord()),
+                      TileId::GetTile(magnification,way.boundingBox.GetMaxCoord()));
+
+        for (const auto& tileId : box) {
+          cellFillCount[tileId.AsPixel()]++;
         }
+      }
 
-        // Check if cell fill for current type is in defined limits
-        for (auto &type : currentWayTypes) {
-          size_t i=type->GetIndex();
-
-          CalculateStatistics(level,
-                              wayTypeData[i],
-                              cellFillCount[i]);
-
-          if (!FitsIndexCriteria(parameter,
-                                 progress,
-                                 *typeConfig.GetTypeInfo(i),
-                                 wayTypeData[i],
-                                 cellFillCount[i])) {
-            if (level<parameter.GetAreaWayIndexMaxLevel()) {
-              currentWayTypes.Remove(type);
-            }
-            else {
-              progress.Warning(typeConfig.GetTypeInfo(i)->GetName()+" has too many index cells, that area filled over the limit");
-            }
-          }
+      // Check if cell fill is in defined limits
+      CalculateStatistics(level,
+                          typeData,
+                          cellFillCount);
+
+      if (!FitsIndexCriteria(parameter,
+                             progress,
+                             typeInfo,
+                             typeData,
+                             cellFillCount)) {
+        if (level<parameter.GetAreaWayIndexMaxLevel()) {
+          continue;
         }
 
-        for (const auto &type : currentWayTypes) {
-          maxLevel=std::max(maxLevel,level);
+        progress.Warning(typeInfo.GetName()+" has too many index cells, that area filled over the limit");
+      }
 
-          progress.Info("Type "+type->GetName()+", "+std::to_string(wayTypeData[type->GetIndex()].indexCells)+" cells, "+std::to_string(wayTypeData[type->GetIndex()].indexEntries)+" objects");
+      progress.Info("Type "+typeInfo.GetName()+", level "+level+", "+std::to_string(typeData.indexCells)+" cells, "+std::to_string(typeData.indexEntries)+" objects");
 
-          remainingWayTypes.Remove(type);
-        }
+      return;
+    }
+  }
 
-        level++;
-      }
+  /**
+   * Calculate the index level of all way types. Types are independent of each other,
+   * so they are handled in parallel.
+   */
+  void AreaWayIndexGenerator::CalculateDistribution(const TypeConfig& typeConfig,
+                                                    const ImportParameter& parameter,
+                                                    Progress& progress,
+                                                    const std::vector<WayEntryList>& waysByType,
+                                                    std::vector<TypeData>& wayTypeData,
+                                                    MagnificationLevel& maxLevel) const
+  {
+    std::vector<size_t>                            typeIndexes;
+    std::vector<std::unique_ptr<BufferedProgress>> typeProgress(typeConfig.GetTypeCount());
 
-      wayScanner.Close();
+    maxLevel=MagnificationLevel(0);
+    wayTypeData.resize(typeConfig.GetTypeCount());
+
+    if (parameter.GetAreaWayMinMag()>parameter.GetAreaWayIndexMaxLevel()) {
+      return;
     }
-    catch (IOException& e) {
-      progress.Error(e.GetDescription());
-      return false;
+
+    for (const auto& type : typeConfig.GetWayTypes()) {
+      typeIndexes.push_back(type->GetIndex());
+      typeProgress[type->GetIndex()].reset(new BufferedProgress(progress.OutputDebug()));
     }
 
-    return true;
+    // Types with more ways first, for better load balancing
+    std::stable_sort(typeIndexes.begin(),
+                     typeIndexes.end(),
+                     [&waysByType](size_t a, size_t b) {
+      return waysByType[a].size()>waysByType[b].size();
+    });
+
+    ProcessInParallel(typeIndexes,
+                      [this,&typeConfig,&parameter,&waysByType,&wayTypeData,&typeProgress](size_t i) {
+      CalculateTypeDistribution(parameter,
+                                *typeProgress[i],
+                                *typeConfig.GetTypeInfo(i),
+                                waysByType[i],
+                                wayTypeData[i]);
+    });
+
+    for (const auto& type : typeConfig.GetWayTypes()) {
+      size_t i=type->GetIndex();
+
+      typeProgress[i]->Flush(progress);
+
+      maxLevel=std::max(maxLevel,wayTypeData[i].indexLevel);
+    }
+  }
+
+  /**
+   * Collect the offsets of all ways of a type for each cell of its index level
+   */
+  void AreaWayIndexGenerator::CalculateCellOffsets(const TypeData& typeData,
+                                                   const WayEntryList& ways,
+                                                   CoordOffsetsMap& cellOffsets) const
+  {
+    Magnification magnification(typeData.indexLevel);
+
+    for (const auto& way : ways) {
+      TileIdBox box(TileId::GetTile(magnification,way.boundingBox.GetMinCoord()),
+                    TileId::GetTile(magnification,way.boundingBox.GetMaxCoord()));
+
+      for (const auto& tileId : box) {
+        cellOffsets[tileId.AsPixel()].push_back(way.offset);
+      }
+    }
   }
 
   /**
@@ -391,27 +460,39 @@ namespace osmscout {
                                      const ImportParameter& parameter,
                                      Progress& progress)
   {
-    FileScanner           wayScanner;
-    FileWriter            writer;
-    std::vector<TypeData> wayTypeData;
-    MagnificationLevel    maxLevel;
+    FileWriter                writer;
+    std::vector<WayEntryList> waysByType;
+    std::vector<TypeData>     wayTypeData;
+    MagnificationLevel        maxLevel;
 
     progress.Info("Minimum magnification: "+parameter.GetAreaWayMinMag());
 
     //
-    // Scanning distribution
+    // Reading ways
     //
 
-    progress.SetAction("Scanning level distribution of way types");
+    progress.SetAction("Reading ways");
 
-    if (!CalculateDistribution(*typeConfig,
-                               parameter,
-                               progress,
-                               wayTypeData,
-                               maxLevel)) {
+    if (!ReadWays(*typeConfig,
+                  parameter,
+                  progress,
+                  waysByType)) {
       return false;
     }
 
+    //
+    // Scanning distribution
+    //
+
+    progress.SetAction("Scanning level distribution of way types");
+
+    CalculateDistribution(*typeConfig,
+                          parameter,
+                          progress,
+                          waysByType,
+                          wayTypeData,
+                          maxLevel);
+
     // Calculate number of types which have data
 
     uint32_t indexEntries=0;
@@ -457,17 +538,9 @@ namespace osmscout {
         }
       }
 
-      wayScanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
-                                      WayDataFile::WAYS_DAT),
-                      FileScanner::Sequential,
-                      parameter.GetWayDataMemoryMaped());
-
       for (MagnificationLevel l=parameter.GetAreaWayMinMag(); l<=maxLevel; l++) {
-        Magnification magnification(l);
-        TypeInfoSet   indexTypes(*typeConfig);
-        uint32_t      wayCount;
-
-        wayScanner.GotoBegin();
+        TypeInfoSet         indexTypes(*typeConfig);
+        std::vector<size_t> typeIndexes;
 
         for (const auto &type : typeConfig->GetWayTypes()) {
           if (wayTypeData[type->GetIndex()].HasEntries() &&
@@ -480,38 +553,21 @@ namespace osmscout {
           continue;
         }
 
-        progress.Info("Scanning ways for index level "+l);
+        progress.Info("Calculating cells for index level "+l);
 
         std::vector<CoordOffsetsMap> typeCellOffsets(typeConfig->GetTypeCount());
 
-        wayScanner.Read(wayCount);
-
-        Way way;
-
-        for (uint32_t w=1; w<=wayCount; w++) {
-          progress.SetProgress(w,wayCount);
-
-          FileOffset offset;
-
-          offset=wayScanner.GetPos();
-
-          way.Read(*typeConfig,
-                   wayScanner);
-
-          if (!indexTypes.IsSet(way.GetType())) {
-            continue;
-          }
-
-          GeoBox boundingBox=way.GetBoundingBox();
-
-          TileIdBox box(TileId::GetTile(magnification,boundingBox.GetMinCoord()),
-                        TileId::GetTile(magnification,boundingBox.GetMaxCoord()));
-
-          for (const auto& tileId : box) {
-            typeCellOffsets[way.GetType()->GetIndex()][tileId.AsPixel()].push_back(offset);
-          }
+        for (const auto &type : indexTypes) {
+          typeIndexes.push_back(type->GetIndex());
         }
 
+        ProcessInParallel(typeIndexes,
+                          [this,&wayTypeData,&waysByType,&typeCellOffsets](size_t i) {
+          CalculateCellOffsets(wayTypeData[i],
+                               waysByType[i],
+                               typeCellOffsets[i]);
+        });
+
         for (const auto &type : indexTypes) {
           size_t index=type->GetIndex();
 
@@ -522,16 +578,19 @@ namespace osmscout {
                            typeCellOffsets[index])) {
             return false;
           }
+
+          // Release memory as early as possible
+          typeCellOffsets[index].clear();
+          waysByType[index].clear();
+          waysByType[index].shrink_to_fit();
         }
       }
 
-      wayScanner.Close();
       writer.Close();
     }
     catch (IOException& e) {
       progress.Error(e.GetDescription());
 
-      wayScanner.CloseFailsafe();
       writer.CloseFailsafe();
 
       return false;
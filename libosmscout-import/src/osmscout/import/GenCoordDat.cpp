@@ -20,11 +20,11 @@
 #include <osmscout/import/GenCoordDat.h>
 
 #include <limits>
-#include <map>
 
 #include <osmscout/Coord.h>
 #include <osmscout/CoordDataFile.h>
 
+#include <osmscout/import/ExternalSort.h>
 #include <osmscout/import/Preprocess.h>
 #include <osmscout/import/RawCoord.h>
 
@@ -36,10 +36,26 @@ namespace osmscout {
   static uint32_t coordDiskPageSize=64;
   static uint32_t coordDiskSize=8;
 
-  static inline bool SortCoordsByOSMId(const RawCoord& a, const RawCoord& b)
+  /**
+   * A coordinate with its OSM id, sorted by the id.
+   * Stores plain values, since it is written to disk as is.
+   */
+  struct CoordEntry
   {
-    return a.GetOSMId()<b.GetOSMId();
-  }
+    OSMId  id;
+    double lat;
+    double lon;
+
+    inline GeoCoord GetCoord() const
+    {
+      return GeoCoord(lat,lon);
+    }
+
+    inline bool operator<(const CoordEntry& other) const
+    {
+      return id<other.id;
+    }
+  };
 
   CoordDataGenerator::CoordDataGenerator()
   {
@@ -53,120 +69,66 @@ namespace osmscout {
   {
     progress.SetAction("Searching for duplicate coordinates");
 
-    Id          maxId=GeoCoord(90.0,180.0).GetId();
-    Id          currentLowerLimit=0;
-    Id          currentUpperLimit=maxId/coordSortPageSize;
     FileScanner scanner;
 
     try {
-      uint32_t    loadedCoordCount=0;
+      ExternalSorter<Id> sorter(parameter.GetDestinationDirectory(),
+                                "coordids",
+                                parameter.GetRawCoordBlockSize());
 
       scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
                                    Preprocess::RAWCOORDS_DAT),
                    FileScanner::Sequential,
                    true);
 
-      scanner.GotoBegin();
-
       uint32_t coordCount;
 
       scanner.Read(coordCount);
 
-      while (loadedCoordCount<coordCount) {
-        std::map<Id,std::vector<Id>> coordPages;
-        uint32_t                     currentCoordCount=0;
-
-        progress.Info("Searching for coordinates with page id >= "+std::to_string(currentLowerLimit));
+      RawCoord coord;
 
-        scanner.GotoBegin();
+      for (uint32_t i=1; i<=coordCount; i++) {
+        progress.SetProgress(i,coordCount);
 
-        scanner.Read(coordCount);
-
-        RawCoord coord;
-
-        for (uint32_t i=1; i<=coordCount; i++) {
-          progress.SetProgress(i,coordCount);
-
-          coord.Read(typeConfig,scanner);
-
-          Id id=coord.GetCoord().GetId();
-          Id pageId=id/coordSortPageSize;
+        coord.Read(typeConfig,scanner);
 
+        sorter.Add(coord.GetCoord().GetId());
+      }
 
-          if (pageId<currentLowerLimit || pageId>currentUpperLimit) {
-            continue;
-          }
+      scanner.Close();
 
-          coordPages[pageId].push_back(id);
-          currentCoordCount++;
-          loadedCoordCount++;
+      progress.Info("Sorting coordinates");
 
-          if (loadedCoordCount==coordCount) {
-            break;
-          }
+      sorter.Sort();
 
-          if (currentCoordCount>parameter.GetRawCoordBlockSize()
-              && coordPages.size()>1) {
-            Id oldUpperLimit=currentUpperLimit;
+      progress.Info("Detect duplicates");
 
-            while (currentCoordCount>parameter.GetRawCoordBlockSize()
-                   && coordPages.size()>1) {
-              auto pageEntry=coordPages.rbegin();
-              Id highestPageId=pageEntry->first;
+      // We currently assume that coordinates are ordered by increasing id
+      // So if we have to nodes with the same coordinate we can expect them
+      // to have the same serial, as long as above is true and nodes
+      // for a coordinate are either all part of the import file - or all are left out.
 
-              currentCoordCount-=(uint32_t)pageEntry->second.size();
-              loadedCoordCount-=(uint32_t)pageEntry->second.size();
-              coordPages.erase(highestPageId);
-              currentUpperLimit=highestPageId-1;
-            }
+      Id   lastId=std::numeric_limits<Id>::max();
+      bool flaged=false;
+      Id   id;
 
-            assert(currentUpperLimit<oldUpperLimit);
-            unused(oldUpperLimit);
+      while (sorter.Next(id)) {
+        if (id==lastId) {
+          if (!flaged) {
+            duplicates[id]=1;
+            flaged=true;
           }
         }
-
-        progress.Info("Sorting coordinates");
-
-        // TODO: Sort in parallel, no side effect!
-        for (auto& entry : coordPages) {
-          std::sort(entry.second.begin(),entry.second.end());
+        else {
+          flaged=false;
         }
 
-        progress.Info("Detect duplicates");
-
-        // We currently assume that coordinates are ordered by increasing id
-        // So if we have to nodes with the same coordinate we can expect them
-        // to have the same serial, as long as above is true and nodes
-        // for a coordinate are either all part of the import file - or all are left out.
-
-        for (auto& entry : coordPages) {
-          Id lastId=std::numeric_limits<Id>::max();
-
-          bool flaged=false;
-          for (auto& id : entry.second) {
-            if (id==lastId) {
-              if (!flaged) {
-                duplicates[id]=1;
-                flaged=true;
-              }
-            }
-            else {
-              flaged=false;
-            }
-
-            lastId=id;
-          }
-        }
-
-        progress.Info("Loaded "+std::to_string(currentCoordCount)+" coords (" +std::to_string(loadedCoordCount)+"/"+std::to_string(coordCount)+")");
-
-        currentLowerLimit=currentUpperLimit+1;
-        currentUpperLimit=maxId/coordSortPageSize;
+        lastId=id;
       }
 
-      progress.Info("Found "+std::to_string(duplicates.size())+" duplicate cordinates");
+      sorter.Close();
 
-      scanner.Close();
+      progress.Info("Found "+std::to_string(duplicates.size())+" duplicate cordinates");
     }
     catch (IOException& e) {
       progress.Error(e.GetDescription());
@@ -217,12 +179,9 @@ namespace osmscout {
   {
     progress.SetAction("Storing coordinates");
 
-    OSMId              maxId=std::numeric_limits<OSMId>::max();
-    OSMId              currentLowerLimit=std::numeric_limits<OSMId>::min()/coordSortPageSize;
-    OSMId              currentUpperLimit=maxId/coordSortPageSize;
     FileScanner        scanner;
     FileWriter         writer;
-    uint32_t           loadedCoordCount=0;
+    bool               dense=parameter.GetCoordDataDense();
 
     PageId             currentPageId=0;
     std::vector<bool>  isSetInPage(coordDiskPageSize,false);
@@ -230,140 +189,150 @@ namespace osmscout {
 
     std::unordered_map<OSMId,FileOffset> pageIndex;
 
+    OSMId              firstId=0;
+    OSMId              lastId=0;
+    FileOffset         dataOffset=0;
+    FileOffset         writerPos=0;
+
     try {
+      ExternalSorter<CoordEntry> sorter(parameter.GetDestinationDirectory(),
+                                        "coords",
+                                        parameter.GetRawCoordBlockSize());
+
       writer.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
                                   CoordDataFile::COORD_DAT));
 
-      writer.WriteFileOffset(0);
-      writer.Write(coordDiskPageSize);
-      writer.FlushCurrentBlockWithZeros(coordSortPageSize*coordDiskSize);
+      if (dense) {
+        // A page size of 0 marks the dense layout, first id and id count are written at the end
+        writer.WriteFileOffset(0);
+        writer.Write((uint32_t)0);
+        writer.Write(firstId);
+        writer.Write((uint64_t)0);
+
+        dataOffset=writer.GetPos();
+        writerPos=dataOffset;
+      }
+      else {
+        writer.WriteFileOffset(0);
+        writer.Write(coordDiskPageSize);
+        writer.FlushCurrentBlockWithZeros(coordSortPageSize*coordDiskSize);
+      }
 
       scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
                                    Preprocess::RAWCOORDS_DAT),
                    FileScanner::Sequential,
                    true);
 
-      scanner.GotoBegin();
-
       uint32_t coordCount;
 
       scanner.Read(coordCount);
 
-      while (loadedCoordCount<coordCount) {
-        std::map<Id,std::vector<RawCoord>> coordPages;
-        uint32_t                           currentCoordCount=0;
+      RawCoord coord;
 
-        progress.Info("Search for coordinates with page id >= "+std::to_string(currentLowerLimit));
+      for (uint32_t i=1; i<=coordCount; i++) {
+        progress.SetProgress(i,coordCount);
 
-        scanner.GotoBegin();
+        coord.Read(typeConfig,scanner);
 
-        scanner.Read(coordCount);
+        sorter.Add(CoordEntry{coord.GetOSMId(),
+                              coord.GetCoord().GetLat(),
+                              coord.GetCoord().GetLon()});
+      }
 
-        RawCoord coord;
+      scanner.Close();
 
-        for (uint32_t i=1; i<=coordCount; i++) {
-          progress.SetProgress(i,coordCount);
+      progress.Info("Sorting coordinates");
 
-          coord.Read(typeConfig,scanner);
+      sorter.Sort();
 
-          OSMId id=coord.GetOSMId();
-          OSMId pageId=id/coordSortPageSize;
+      progress.Info("Write coordinates");
 
-          if (pageId<currentLowerLimit || pageId>currentUpperLimit) {
-            continue;
-          }
+      CoordEntry osmCoord;
 
-          coordPages[pageId].push_back(coord);
-          currentCoordCount++;
-          loadedCoordCount++;
+      while (sorter.Next(osmCoord)) {
+        uint8_t serial=1;
+        auto    duplicateEntry=duplicates.find(osmCoord.GetCoord().GetId());
 
-          if (loadedCoordCount==coordCount) {
-            break;
+        if (duplicateEntry!=duplicates.end()) {
+          serial=duplicateEntry->second;
+
+          if (serial==255) {
+            progress.Error("Coordinate "+std::to_string(osmCoord.id)+" "+osmCoord.GetCoord().GetDisplayText()+" has more than 256 nodes");
+            continue;
           }
 
-          if (currentCoordCount>parameter.GetRawCoordBlockSize()
-              && coordPages.size()>1) {
-            OSMId oldUpperLimit=currentUpperLimit;
+          duplicateEntry->second++;
+        }
 
-            while (currentCoordCount>parameter.GetRawCoordBlockSize()
-                   && coordPages.size()>1) {
-              auto pageEntry=coordPages.rbegin();
-              OSMId highestPageId=pageEntry->first;
+        if (dense) {
+          if (writerPos==dataOffset) {
+            firstId=osmCoord.id;
+          }
 
-              currentCoordCount-=(uint32_t)pageEntry->second.size();
-              loadedCoordCount-=(uint32_t)pageEntry->second.size();
-              coordPages.erase(highestPageId);
-              currentUpperLimit=highestPageId-1;
-            }
+          // Skipping ids leaves holes in the file, which read as unused entries
+          FileOffset entryOffset=dataOffset+(FileOffset)(osmCoord.id-firstId)*(coordByteSize+1);
 
-            assert(currentUpperLimit<oldUpperLimit);
-            unused(oldUpperLimit);
+          if (entryOffset!=writerPos) {
+            writer.SetPos(entryOffset);
           }
-        }
 
-        progress.Info("Sorting coordinates");
+          writer.Write(serial);
+          writer.WriteCoord(osmCoord.GetCoord());
 
-        // TODO: Sort in parallel, no side effect!
-        for (auto& entry : coordPages) {
-          std::sort(entry.second.begin(),
-                    entry.second.end(),
-                    SortCoordsByOSMId);
+          writerPos=entryOffset+coordByteSize+1;
+          lastId=osmCoord.id;
+
+          continue;
         }
 
-        progress.Info("Write coordinates");
+        PageId relatedId=osmCoord.id+std::numeric_limits<OSMId>::min();
+        PageId pageId=relatedId/coordDiskPageSize;
 
-        for (auto& entry : coordPages) {
-          for (auto& osmCoord : entry.second) {
-            uint8_t serial=1;
-            auto    duplicateEntry=duplicates.find(osmCoord.GetCoord().GetId());
+        if (currentPageId!=pageId) {
+          FileOffset pageOffset=writer.GetPos();
 
-            if (duplicateEntry!=duplicates.end()) {
-              serial=duplicateEntry->second;
+          if (DumpCurrentPage(writer,
+                              isSetInPage,
+                              page)) {
+            pageIndex[currentPageId]=pageOffset;
+          }
 
-              if (serial==255) {
-                progress.Error("Coordinate "+std::to_string(osmCoord.GetOSMId())+" "+osmCoord.GetCoord().GetDisplayText()+" has more than 256 nodes");
-                continue;
-              }
+          isSetInPage.assign(coordDiskPageSize,false);
+          currentPageId=pageId;
+        }
 
-              duplicateEntry->second++;
-            }
+        size_t pageIndex=relatedId%coordDiskPageSize;
 
-            PageId relatedId=osmCoord.GetOSMId()+std::numeric_limits<OSMId>::min();
-            PageId pageId=relatedId/coordDiskPageSize;
+        isSetInPage[pageIndex]=true;
+        page[pageIndex]=Coord(serial,
+                              osmCoord.GetCoord());
+      }
 
-            if (currentPageId!=pageId) {
-              FileOffset pageOffset=writer.GetPos();
+      sorter.Close();
 
-              if (DumpCurrentPage(writer,
-                                  isSetInPage,
-                                  page)) {
-                pageIndex[currentPageId]=pageOffset;
-              }
+      progress.Info("Processed "+std::to_string(sorter.GetCount())+" coords");
 
-              isSetInPage.assign(coordDiskPageSize,false);
-              currentPageId=pageId;
-            }
+      if (dense) {
+        uint64_t idCount=writerPos==dataOffset ? 0 : (uint64_t)(lastId-firstId)+1;
 
-            size_t pageIndex=relatedId%coordDiskPageSize;
+        progress.Info("Dense coordinate array holds "+std::to_string(idCount)+" entries");
 
-            isSetInPage[pageIndex]=true;
-            page[pageIndex]=Coord(serial,
-                                  osmCoord.GetCoord());
-          }
-        }
-
-        FileOffset pageOffset=writer.GetPos();
+        writer.GotoBegin();
+        writer.WriteFileOffset(0);
+        writer.Write((uint32_t)0);
+        writer.Write(firstId);
+        writer.Write(idCount);
+        writer.Close();
 
-        if (DumpCurrentPage(writer,
-                            isSetInPage,
-                            page)) {
-          pageIndex[currentPageId]=pageOffset;
-        }
+        return true;
+      }
 
-        progress.Info("Loaded "+std::to_string(currentCoordCount)+" coords (" +std::to_string(loadedCoordCount)+"/"+std::to_string(coordCount)+")");
+      FileOffset pageOffset=writer.GetPos();
 
-        currentLowerLimit=currentUpperLimit+1;
-        currentUpperLimit=maxId/coordSortPageSize;
+      if (DumpCurrentPage(writer,
+                          isSetInPage,
+                          page)) {
+        pageIndex[currentPageId]=pageOffset;
       }
 
       FileOffset indexStartOffset=writer.GetPos();
@@ -378,8 +347,6 @@ namespace osmscout {
       }
 
 
-      scanner.Close();
-
       writer.GotoBegin();
       writer.WriteFileOffset(indexStartOffset);
       writer.Close();
@@ -26,6 +26,7 @@
 #include <locale>
 #include <list>
 #include <map>
+#include <numeric>
 #include <set>
 
 #include <osmscout/Pixel.h>
@@ -61,6 +62,26 @@
 namespace osmscout {
 
   static const size_t REGION_INDEX_LEVEL=14;
+  static const size_t INDEX_BATCH_SIZE=10000; //!< Number of objects assigned to regions in parallel
+
+  /**
+   * Call process for each entry of the batch, distributing the entries over all cores
+   */
+  template<typename Entry, typename Process>
+  static void ProcessBatch(std::vector<Entry>& batch,
+                           const Process& process)
+  {
+    std::vector<size_t> indexes(batch.size());
+
+    std::iota(indexes.begin(),
+              indexes.end(),
+              0);
+
+    ProcessInParallel(indexes,
+                      [&batch,&process](size_t i) {
+      process(batch[i]);
+    });
+  }
 
   const char* const LocationIndexGenerator::FILENAME_LOCATION_REGION_TXT  = "location_region.txt";
   const char* const LocationIndexGenerator::FILENAME_LOCATION_FULL_TXT    = "location_full.txt";
@@ -1318,12 +1339,20 @@ namespace osmscout {
     return true;
   }
 
-  bool LocationIndexGenerator::AddLocationAreaToRegion(Region& region,
-                                                       const Area& area,
-                                                       const std::vector<Point>& nodes,
-                                                       const std::string& name,
-                                                       const std::string& postalCode,
-                                                       const GeoBox& boundingBox)
+  /**
+    Collect the regions the given location area has to be added to, starting at the
+    given region. Regions are collected in the order, the object has to be added to them.
+
+    The code is designed to minimize the number of "point in area" checks, it assumes that
+    if one point of an object is in a area it is very likely that all points of the object
+    are in the area.
+
+    The region tree is only read, so the method can be called in parallel.
+    */
+  bool LocationIndexGenerator::CollectRegionsForArea(Region& region,
+                                                     const std::vector<Point>& nodes,
+                                                     const GeoBox& boundingBox,
+                                                     std::vector<Region*>& regions) const
   {
     for (const auto& childRegion : region.regions) {
       // Fast check, if the object is in the bounds of the area
@@ -1333,12 +1362,10 @@ namespace osmscout {
           bool match=IsCoordInArea(nodes[0],childRegion->areas[i]);
 
           if (match) {
-            bool completeMatch=AddLocationAreaToRegion(*childRegion,
-                                                       area,
-                                                       nodes,
-                                                       name,
-                                                       postalCode,
-                                                       boundingBox);
+            bool completeMatch=CollectRegionsForArea(*childRegion,
+                                                     nodes,
+                                                     boundingBox,
+                                                     regions);
 
             if (completeMatch) {
               // We are done, the object is completely enclosed by one of our sub areas
@@ -1351,9 +1378,7 @@ namespace osmscout {
 
     // If we (at least partly) contain it, we add it to the area but continue
 
-    region.AddLocationObject(name,
-                             postalCode,
-                             ObjectFileRef(area.GetFileOffset(),refArea));
+    regions.push_back(&region);
 
     for (const auto& childArea : region.areas) {
       if (IsAreaCompletelyInArea(nodes,childArea)) {
@@ -1365,18 +1390,13 @@ namespace osmscout {
   }
 
   /**
-    Add the given location area to the hierarchical area index.
-
-    The code is designed to minimize the number of "point in area" checks, it assumes that
-    if one point of an object is in a area it is very likely that all points of the object
-    are in the area.
+    Collect the regions the given ring of a location area has to be added to.
     */
-  void LocationIndexGenerator::AddLocationAreaToRegion(RegionRef& rootRegion,
-                                                       const Area& area,
-                                                       const Area::Ring& ring,
-                                                       const std::string& name,
-                                                       const std::string& postalCode,
-                                                       const RegionIndex& regionIndex)
+  void LocationIndexGenerator::CollectRegionsForRing(RegionRef& rootRegion,
+                                                     const Area& area,
+                                                     const Area::Ring& ring,
+                                                     const RegionIndex& regionIndex,
+                                                     std::vector<Region*>& regions) const
   {
     if (ring.IsMasterRing() &&
         ring.nodes.empty()) {
@@ -1389,12 +1409,10 @@ namespace osmscout {
           RegionRef region=regionIndex.GetRegionForNode(rootRegion,
                                                         boundingBox.GetCenter());
 
-          AddLocationAreaToRegion(*region,
-                                  area,
-                                  r.nodes,
-                                  name,
-                                  postalCode,
-                                  boundingBox);
+          CollectRegionsForArea(*region,
+                                r.nodes,
+                                boundingBox,
+                                regions);
         }
       }
     }
@@ -1406,12 +1424,10 @@ namespace osmscout {
       RegionRef region=regionIndex.GetRegionForNode(rootRegion,
                                                     boundingBox.GetCenter());
 
-      AddLocationAreaToRegion(*region,
-                              area,
-                              ring.nodes,
-                              name,
-                              postalCode,
-                              boundingBox);
+      CollectRegionsForArea(*region,
+                            ring.nodes,
+                            boundingBox,
+                            regions);
     }
   }
 
@@ -1421,7 +1437,38 @@ namespace osmscout {
                                                   RegionRef& rootRegion,
                                                   const RegionIndex& regionIndex)
   {
-    FileScanner scanner;
+    struct LocationRing
+    {
+      AreaRef              area;
+      size_t               ring;
+      std::string          name;
+      std::string          postalCode;
+      std::vector<Region*> regions;
+    };
+
+    FileScanner               scanner;
+    std::vector<LocationRing> batch;
+
+    auto processBatch=[this,&rootRegion,&regionIndex,&batch]() {
+      ProcessBatch(batch,
+                   [this,&rootRegion,&regionIndex](LocationRing& location) {
+        CollectRegionsForRing(rootRegion,
+                              *location.area,
+                              location.area->rings[location.ring],
+                              regionIndex,
+                              location.regions);
+      });
+
+      for (const auto& location : batch) {
+        for (const auto& region : location.regions) {
+          region->AddLocationObject(location.name,
+                                    location.postalCode,
+                                    ObjectFileRef(location.area->GetFileOffset(),refArea));
+        }
+      }
+
+      batch.clear();
+    };
 
     try {
       uint32_t                     areaCount;
@@ -1439,12 +1486,14 @@ namespace osmscout {
       for (uint32_t w=1; w<=areaCount; w++) {
         progress.SetProgress(w,areaCount);
 
-        Area area;
+        AreaRef area=std::make_shared<Area>();
 
-        area.Read(typeConfig,
-                  scanner);
+        area->Read(typeConfig,
+                   scanner);
+
+        for (size_t r=0; r<area->rings.size(); r++) {
+          const Area::Ring& ring=area->rings[r];
 
-        for (const auto& ring : area.rings) {
           if (!ring.GetType()->GetIgnore() && ring.GetType()->GetIndexAsLocation()) {
             NameFeatureValue *nameValue=nameReader.GetValue(ring.GetFeatureValueBuffer());
 
@@ -1454,18 +1503,23 @@ namespace osmscout {
 
             PostalCodeFeatureValue *postalCodeValue=postalCodeReader.GetValue(ring.GetFeatureValueBuffer());
 
-            AddLocationAreaToRegion(rootRegion,
-                                    area,
-                                    ring,
-                                    nameValue->GetName(),
-                                    postalCodeValue!=nullptr ? postalCodeValue->GetPostalCode() : "",
-                                    regionIndex);
+            batch.push_back(LocationRing{area,
+                                         r,
+                                         nameValue->GetName(),
+                                         postalCodeValue!=nullptr ? postalCodeValue->GetPostalCode() : "",
+                                         std::vector<Region*>()});
 
             areasFound++;
           }
         }
+
+        if (batch.size()>=INDEX_BATCH_SIZE) {
+          processBatch();
+        }
       }
 
+      processBatch();
+
       progress.Info(std::string("Found ")+std::to_string(areasFound)+" locations of type 'area'");
 
       scanner.Close();
@@ -1479,31 +1533,32 @@ namespace osmscout {
   }
 
   /**
-    Add the given location way to the hierarchical area index.
+    Collect the regions the given way has to be added to, starting at the
+    given region. Regions are collected in the order, the object has to be added to them.
 
     The code is designed to minimize the number of "point in area" checks, it assumes that
     if one point of an object is in a area it is very likely that all points of the object
     are in the area.
+
+    The region tree is only read, so the method can be called in parallel.
     */
-  bool LocationIndexGenerator::AddLocationWayToRegion(Region& region,
-                                                      const Way& way,
-                                                      const std::string& name,
-                                                      const std::string& postalCode,
-                                                      const GeoBox& boundingBox)
+  bool LocationIndexGenerator::CollectRegionsForWay(Region& region,
+                                                    const std::vector<Point>& nodes,
+                                                    const GeoBox& boundingBox,
+                                                    std::vector<Region*>& regions) const
   {
     for (const auto& childRegion : region.regions) {
       // Fast check, if the object is in the bounds of the area
       if (childRegion->CouldContain(boundingBox)) {
         // Check if one point is in the area
         for (size_t i=0; i<childRegion->areas.size(); i++) {
-          bool match=IsAreaAtLeastPartlyInArea(way.nodes,childRegion->areas[i]);
+          bool match=IsAreaAtLeastPartlyInArea(nodes,childRegion->areas[i]);
 
           if (match) {
-            bool completeMatch=AddLocationWayToRegion(*childRegion,
-                                                      way,
-                                                      name,
-                                                      postalCode,
-                                                      boundingBox);
+            bool completeMatch=CollectRegionsForWay(*childRegion,
+                                                    nodes,
+                                                    boundingBox,
+                                                    regions);
 
             if (completeMatch) {
               // We are done, the object is completely enclosed by one of our sub areas
@@ -1516,12 +1571,10 @@ namespace osmscout {
 
     // If we (at least partly) contain it, we add it to the area but continue
 
-    region.AddLocationObject(name,
-                             postalCode,
-                             ObjectFileRef(way.GetFileOffset(),refWay));
+    regions.push_back(&region);
 
     for (const auto& area : region.areas) {
-      if (IsAreaCompletelyInArea(way.nodes,area)) {
+      if (IsAreaCompletelyInArea(nodes,area)) {
         return true;
       }
     }
@@ -1535,7 +1588,40 @@ namespace osmscout {
                                                  RegionRef& rootRegion,
                                                  const RegionIndex& regionIndex)
   {
-    FileScanner scanner;
+    struct LocationWay
+    {
+      WayRef               way;
+      std::string          name;
+      std::string          postalCode;
+      std::vector<Region*> regions;
+    };
+
+    FileScanner              scanner;
+    std::vector<LocationWay> batch;
+
+    auto processBatch=[this,&rootRegion,&regionIndex,&batch]() {
+      ProcessBatch(batch,
+                   [this,&rootRegion,&regionIndex](LocationWay& location) {
+        GeoBox    boundingBox=location.way->GetBoundingBox();
+        RegionRef region=regionIndex.GetRegionForNode(rootRegion,
+                                                      boundingBox.GetCenter());
+
+        CollectRegionsForWay(*region,
+                             location.way->nodes,
+                             boundingBox,
+                             location.regions);
+      });
+
+      for (const auto& location : batch) {
+        for (const auto& region : location.regions) {
+          region->AddLocationObject(location.name,
+                                    location.postalCode,
+                                    ObjectFileRef(location.way->GetFileOffset(),refWay));
+        }
+      }
+
+      batch.clear();
+    };
 
     try {
       uint32_t                     wayCount;
@@ -1554,39 +1640,41 @@ namespace osmscout {
       for (uint32_t w=1; w<=wayCount; w++) {
         progress.SetProgress(w,wayCount);
 
-        Way way;
+        WayRef way=std::make_shared<Way>();
 
-        way.Read(typeConfig,
-                 scanner);
+        way->Read(typeConfig,
+                  scanner);
 
-        if (!way.GetType()->GetIndexAsLocation()) {
+        if (!way->GetType()->GetIndexAsLocation()) {
           continue;
         }
 
-        std::string name=nameReader.GetLabel(way.GetFeatureValueBuffer());
+        std::string name=nameReader.GetLabel(way->GetFeatureValueBuffer());
 
         if (name.empty()) {
-          name=refReader.GetLabel(way.GetFeatureValueBuffer());
+          name=refReader.GetLabel(way->GetFeatureValueBuffer());
         }
 
         if (name.empty()) {
           continue;
         }
 
-        PostalCodeFeatureValue *postalCodeValue=postalCodeReader.GetValue(way.GetFeatureValueBuffer());
-        GeoBox                 boundingBox=way.GetBoundingBox();
-        RegionRef              region=regionIndex.GetRegionForNode(rootRegion,
-                                                                   boundingBox.GetCenter());
+        PostalCodeFeatureValue *postalCodeValue=postalCodeReader.GetValue(way->GetFeatureValueBuffer());
 
-        AddLocationWayToRegion(*region,
-                               way,
-                               name,
-                               postalCodeValue!=nullptr ? postalCodeValue->GetPostalCode() : "",
-                               boundingBox);
+        batch.push_back(LocationWay{way,
+                                    name,
+                                    postalCodeValue!=nullptr ? postalCodeValue->GetPostalCode() : "",
+                                    std::vector<Region*>()});
+
+        if (batch.size()>=INDEX_BATCH_SIZE) {
+          processBatch();
+        }
 
         waysFound++;
       }
 
+      processBatch();
+
       progress.Info(std::string("Found ")+std::to_string(waysFound)+" locations of type 'way'");
 
       scanner.Close();
@@ -1682,91 +1770,99 @@ namespace osmscout {
     added=true;
   }
 
-  void LocationIndexGenerator::AddAddressAreaToRegion(Progress& progress,
-                                                      Region& region,
-                                                      const FileOffset& fileOffset,
-                                                      const std::string& location,
-                                                      const std::string& address,
-                                                      const std::string &postalCode,
-                                                      const std::vector<Point>& nodes,
-                                                      const GeoBox& boundingBox,
-                                                      bool& added)
+  /**
+    Return the deepest region below the given region that completely encloses the given object.
+
+    The region tree is only read, so the method can be called in parallel.
+    */
+  LocationIndexGenerator::Region& LocationIndexGenerator::GetEnclosingRegion(Region& region,
+                                                                             const std::vector<Point>& nodes,
+                                                                             const GeoBox& boundingBox) const
   {
     for (const auto& childRegion : region.regions) {
       // Fast check, if the object is in the bounds of the area
       if (childRegion->CouldContain(boundingBox)) {
         for (const auto& area : childRegion->areas) {
           if (IsAreaCompletelyInArea(nodes,area)) {
-            AddAddressAreaToRegion(progress,
-                                   *childRegion,
-                                   fileOffset,
-                                   location,
-                                   address,
-                                   postalCode,
-                                   nodes,
-                                   boundingBox,
-                                   added);
-            return;
+            return GetEnclosingRegion(*childRegion,
+                                      nodes,
+                                      boundingBox);
           }
         }
       }
     }
 
-    AddAddressToRegion(progress,
-                       region,
-                       ObjectFileRef(fileOffset,refArea),
-                       location,
-                       address,
-                       postalCode,
-                       false,
-                       added);
+    return region;
   }
 
-  void LocationIndexGenerator::AddPOIAreaToRegion(Progress& progress,
-                                                  Region& region,
-                                                  const FileOffset& fileOffset,
-                                                  const std::string& name,
-                                                  const std::vector<Point>& nodes,
-                                                  const GeoBox& boundingBox,
-                                                  bool& added)
+  bool LocationIndexGenerator::IndexAddressAreas(const TypeConfig& typeConfig,
+                                                 const ImportParameter& parameter,
+                                                 Progress& progress,
+                                                 RegionRef& rootRegion,
+                                                 const RegionIndex& regionIndex)
   {
-    for (const auto& childRegion : region.regions) {
-      // Fast check, if the object is in the bounds of the area
-      if (childRegion->CouldContain(boundingBox)) {
-        for (size_t i=0; i<childRegion->areas.size(); i++) {
-          if (IsAreaCompletelyInArea(nodes,childRegion->areas[i])) {
-            AddPOIAreaToRegion(progress,
-                               *childRegion,
-                               fileOffset,
-                               name,
-                               nodes,
-                               boundingBox,
-                               added);
-            return;
+    struct AddressArea
+    {
+      FileOffset         fileOffset;
+      std::string        name;
+      std::string        postalCode;
+      std::string        location;
+      std::string        address;
+      std::vector<Point> nodes;
+      GeoBox             boundingBox;
+      bool               isAddress;
+      bool               isPOI;
+      Region*            region;
+    };
+
+    FileScanner              scanner;
+    std::vector<AddressArea> batch;
+    size_t                   addressFound=0;
+    size_t                   poiFound=0;
+
+    auto processBatch=[this,&progress,&rootRegion,&regionIndex,&batch,&addressFound,&poiFound]() {
+      ProcessBatch(batch,
+                   [this,&rootRegion,&regionIndex](AddressArea& entry) {
+        RegionRef region=regionIndex.GetRegionForNode(rootRegion,
+                                                      entry.boundingBox.GetCenter());
+
+        entry.region=&GetEnclosingRegion(*region,
+                                         entry.nodes,
+                                         entry.boundingBox);
+      });
+
+      for (const auto& entry : batch) {
+        if (entry.isAddress) {
+          bool added=false;
+
+          AddAddressToRegion(progress,
+                             *entry.region,
+                             ObjectFileRef(entry.fileOffset,refArea),
+                             entry.location,
+                             entry.address,
+                             entry.postalCode,
+                             false,
+                             added);
+
+          if (added) {
+            addressFound++;
           }
         }
-      }
-    }
 
-    RegionPOI poi(name,ObjectFileRef(fileOffset,refArea));
+        if (entry.isPOI) {
+          RegionPOI poi(entry.name,ObjectFileRef(entry.fileOffset,refArea));
 
-    region.pois.push_back(poi);
+          entry.region->pois.push_back(poi);
 
-    added=true;
-  }
+          poiFound++;
+        }
+      }
 
-  bool LocationIndexGenerator::IndexAddressAreas(const TypeConfig& typeConfig,
-                                                 const ImportParameter& parameter,
-                                                 Progress& progress,
-                                                 RegionRef& rootRegion,
-                                                 const RegionIndex& regionIndex)
-  {
-    FileScanner scanner;
+      batch.clear();
+    };
 
     try {
       uint32_t           areaCount;
-      size_t             addressFound=0;
-      size_t             poiFound=0;
       size_t             postalCodeFound=0;
       FileOffset         fileOffset;
       uint32_t           tmpType;
@@ -1816,44 +1912,24 @@ namespace osmscout {
           continue;
         }
 
-        RegionRef region=regionIndex.GetRegionForNode(rootRegion,
-                                                      boundingBox.GetCenter());
-
-        if (isAddress) {
-          bool added=false;
+        batch.push_back(AddressArea{fileOffset,
+                                    name,
+                                    postalCode,
+                                    location,
+                                    address,
+                                    nodes,
+                                    boundingBox,
+                                    isAddress,
+                                    isPOI,
+                                    nullptr});
 
-          AddAddressAreaToRegion(progress,
-                                 *region,
-                                 fileOffset,
-                                 location,
-                                 address,
-                                 postalCode,
-                                 nodes,
-                                 boundingBox,
-                                 added);
-
-          if (added) {
-            addressFound++;
-          }
-        }
-
-        if (isPOI) {
-          bool added=false;
-
-          AddPOIAreaToRegion(progress,
-                             *region,
-                             fileOffset,
-                             name,
-                             nodes,
-                             boundingBox,
-                             added);
-
-          if (added) {
-            poiFound++;
-          }
+        if (batch.size()>=INDEX_BATCH_SIZE) {
+          processBatch();
         }
       }
 
+      processBatch();
+
       progress.Info(std::to_string(areaCount)+" areas analyzed, "+
                     std::to_string(addressFound)+" addresses founds, "+
                     std::to_string(poiFound)+" POIs founds, "+
@@ -1869,118 +1945,54 @@ namespace osmscout {
     return true;
   }
 
-  bool LocationIndexGenerator::AddAddressWayToRegion(Progress& progress,
-                                                     Region& region,
-                                                     const FileOffset& fileOffset,
-                                                     const std::string& location,
-                                                     const std::string& address,
-                                                     const std::vector<Point>& nodes,
-                                                     const GeoBox& boundingBox,
-                                                     bool& added)
+  bool LocationIndexGenerator::IndexAddressWays(const TypeConfig& typeConfig,
+                                                const ImportParameter& parameter,
+                                                Progress& progress,
+                                                RegionRef& rootRegion,
+                                                const RegionIndex& regionIndex)
   {
-    for (const auto& childRegion : region.regions) {
-      // Fast check, if the object is in the bounds of the area
-      if (childRegion->CouldContain(boundingBox)) {
-        // Check if one point is in the area
-        for (size_t i=0; i<childRegion->areas.size(); i++) {
-          bool match=IsAreaAtLeastPartlyInArea(nodes,childRegion->areas[i]);
-
-          if (match) {
-            bool completeMatch=AddAddressWayToRegion(progress,
-                                                     *childRegion,
-                                                     fileOffset,
-                                                     location,
-                                                     address,
-                                                     nodes,
-                                                     boundingBox,
-                                                     added);
-
-            if (completeMatch) {
-              // We are done, the object is completely enclosed by one of our sub areas
-              return true;
-            }
-          }
-        }
-      }
-    }
-
-    AddAddressToRegion(progress,
-                       region,
-                       ObjectFileRef(fileOffset,refWay),
-                       location,
-                       address,
-                       "",
-                       false,
-                       added);
-
-    for (const auto& area : region.areas) {
-      if (IsAreaCompletelyInArea(nodes,area)) {
-        return true;
-      }
-    }
-
-    return false;
-  }
+    struct POIWay
+    {
+      FileOffset           fileOffset;
+      std::string          name;
+      std::vector<Point>   nodes;
+      GeoBox               boundingBox;
+      std::vector<Region*> regions;
+    };
+
+    FileScanner         scanner;
+    std::vector<POIWay> batch;
+    size_t              poiFound=0;
+
+    auto processBatch=[this,&rootRegion,&regionIndex,&batch,&poiFound]() {
+      ProcessBatch(batch,
+                   [this,&rootRegion,&regionIndex](POIWay& entry) {
+        RegionRef region=regionIndex.GetRegionForNode(rootRegion,
+                                                      entry.boundingBox.GetCenter());
 
-  bool LocationIndexGenerator::AddPOIWayToRegion(Progress& progress,
-                                                 Region& region,
-                                                 const FileOffset& fileOffset,
-                                                 const std::string& name,
-                                                 const std::vector<Point>& nodes,
-                                                 const GeoBox& boundingBox,
-                                                 bool& added)
-  {
-    for (const auto& childRegion : region.regions) {
-      // Fast check, if the object is in the bounds of the area
-      if (childRegion->CouldContain(boundingBox)) {
-        // Check if one point is in the area
-        for (size_t i=0; i<childRegion->areas.size(); i++) {
-          bool match=IsAreaAtLeastPartlyInArea(nodes,childRegion->areas[i]);
+        CollectRegionsForWay(*region,
+                             entry.nodes,
+                             entry.boundingBox,
+                             entry.regions);
+      });
 
-          if (match) {
-            bool completeMatch=AddPOIWayToRegion(progress,
-                                                 *childRegion,
-                                                 fileOffset,
-                                                 name,
-                                                 nodes,
-                                                 boundingBox,
-                                                 added);
+      for (const auto& entry : batch) {
+        for (const auto& region : entry.regions) {
+          RegionPOI poi(entry.name,ObjectFileRef(entry.fileOffset,refWay));
 
-            if (completeMatch) {
-              // We are done, the object is completely enclosed by one of our sub areas
-              return true;
-            }
-          }
+          region->pois.push_back(poi);
         }
-      }
-    }
-
-    RegionPOI poi(name,ObjectFileRef(fileOffset,refWay));
-
-    region.pois.push_back(poi);
-
-    added=true;
 
-    for (const auto& area : region.areas) {
-      if (IsAreaCompletelyInArea(nodes,area)) {
-        return true;
+        if (!entry.regions.empty()) {
+          poiFound++;
+        }
       }
-    }
-
-    return false;
-  }
 
-  bool LocationIndexGenerator::IndexAddressWays(const TypeConfig& typeConfig,
-                                                const ImportParameter& parameter,
-                                                Progress& progress,
-                                                RegionRef& rootRegion,
-                                                const RegionIndex& regionIndex)
-  {
-    FileScanner scanner;
+      batch.clear();
+    };
 
     try {
       uint32_t           wayCount=0;
-      size_t             poiFound=0;
       size_t             postalCodeFound=0;
       FileOffset         fileOffset;
       uint32_t           tmpType;
@@ -2024,26 +2036,19 @@ namespace osmscout {
           continue;
         }
 
-        RegionRef region=regionIndex.GetRegionForNode(rootRegion,
-                                                      boundingBox.GetCenter());
-
-        if (isPOI) {
-          bool added=false;
-
-          AddPOIWayToRegion(progress,
-                            *region,
-                            fileOffset,
-                            name,
-                            nodes,
-                            boundingBox,
-                            added);
+        batch.push_back(POIWay{fileOffset,
+                               name,
+                               nodes,
+                               boundingBox,
+                               std::vector<Region*>()});
 
-          if (added) {
-            poiFound++;
-          }
+        if (batch.size()>=INDEX_BATCH_SIZE) {
+          processBatch();
         }
       }
 
+      processBatch();
+
       progress.Info(std::to_string(wayCount)+" ways analyzed, "+std::to_string(poiFound)+" POIs founds");
 
       progress.Info(std::to_string(wayCount)+" ways analyzed, "+
@@ -2151,12 +2156,69 @@ namespace osmscout {
                                                  RegionRef& rootRegion,
                                                  const RegionIndex& regionIndex)
   {
-    FileScanner scanner;
+    struct AddressNode
+    {
+      FileOffset  fileOffset;
+      std::string name;
+      std::string postalCode;
+      std::string location;
+      std::string address;
+      GeoCoord    coord;
+      bool        isAddress;
+      bool        isPOI;
+      RegionRef   region;
+    };
+
+    FileScanner              scanner;
+    std::vector<AddressNode> batch;
+    size_t                   addressFound=0;
+    size_t                   poiFound=0;
+
+    auto processBatch=[this,&progress,&rootRegion,&regionIndex,&batch,&addressFound,&poiFound]() {
+      ProcessBatch(batch,
+                   [&rootRegion,&regionIndex](AddressNode& entry) {
+        entry.region=regionIndex.GetRegionForNode(rootRegion,
+                                                  entry.coord);
+      });
+
+      for (const auto& entry : batch) {
+        if (!entry.region) {
+          continue;
+        }
+
+        if (entry.isAddress) {
+          bool added=false;
+
+          AddAddressNodeToRegion(progress,
+                                 *entry.region,
+                                 entry.fileOffset,
+                                 entry.location,
+                                 entry.address,
+                                 entry.postalCode,
+                                 added);
+          if (added) {
+            addressFound++;
+          }
+        }
+
+        if (entry.isPOI) {
+          bool added=false;
+
+          AddPOINodeToRegion(*entry.region,
+                             entry.fileOffset,
+                             entry.name,
+                             added);
+          if (added) {
+            poiFound++;
+          }
+        }
+      }
+
+      batch.clear();
+    };
 
     try {
       uint32_t    nodeCount;
-      size_t      addressFound=0;
-      size_t      poiFound=0;
       size_t      postalCodeFound=0;
       FileOffset  fileOffset;
       uint32_t    tmpType;
@@ -2203,41 +2265,23 @@ namespace osmscout {
           continue;
         }
 
-        RegionRef region=regionIndex.GetRegionForNode(rootRegion,
-                                                      coord);
+        batch.push_back(AddressNode{fileOffset,
+                                    name,
+                                    postalCode,
+                                    location,
+                                    address,
+                                    coord,
+                                    isAddress,
+                                    isPOI,
+                                    nullptr});
 
-        if (!region) {
-          continue;
-        }
-
-        if (isAddress) {
-          bool added=false;
-
-          AddAddressNodeToRegion(progress,
-                                 *region,
-                                 fileOffset,
-                                 location,
-                                 address,
-                                 postalCode,
-                                 added);
-          if (added) {
-            addressFound++;
-          }
-        }
-
-        if (isPOI) {
-          bool added=false;
-
-          AddPOINodeToRegion(*region,
-                             fileOffset,
-                             name,
-                             added);
-          if (added) {
-            poiFound++;
-          }
+        if (batch.size()>=INDEX_BATCH_SIZE) {
+          processBatch();
         }
       }
 
+      processBatch();
+
       progress.Info(std::to_string(nodeCount)+" nodes analyzed, "+
                     std::to_string(addressFound)+" addresses founds, "+
                     std::to_string(poiFound)+" POIs founds, "+
@@ -0,0 +1,198 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/GenObjectBoxIndex.h>
+
+#include <cmath>
+#include <limits>
+
+#include <osmscout/AreaDataFile.h>
+#include <osmscout/ObjectBoxIndex.h>
+#include <osmscout/ObjectView.h>
+#include <osmscout/WayDataFile.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+
+namespace osmscout {
+
+  template<typename V>
+  void ObjectBoxIndexGenerator::ScanDataFile(const TypeConfig& typeConfig,
+                                             const std::string& dataFilename,
+                                             Progress& progress,
+                                             std::vector<FileOffset>& offsets,
+                                             std::vector<GeoBox>& boxes) const
+  {
+    FileScanner scanner;
+    uint32_t    dataCount;
+
+    scanner.Open(dataFilename,
+                 FileScanner::Sequential,
+                 true);
+
+    scanner.Read(dataCount);
+
+    offsets.reserve(dataCount);
+    boxes.reserve(dataCount);
+
+    for (uint32_t current=1; current<=dataCount; current++) {
+      progress.SetProgress(current,
+                           dataCount);
+
+      V view;
+
+      view.Read(typeConfig,
+                scanner);
+
+      offsets.push_back(view.GetFileOffset());
+      boxes.push_back(view.GetBoundingBox());
+    }
+
+    scanner.Close();
+  }
+
+  /**
+   * Write the index file for the given objects. Offsets must be sorted in
+   * ascending order.
+   *
+   * @throws IOException
+   */
+  void ObjectBoxIndexGenerator::WriteIndex(const std::string& filename,
+                                           const std::vector<FileOffset>& offsets,
+                                           const std::vector<GeoBox>& boxes)
+  {
+    FileWriter writer;
+
+    writer.Open(filename);
+
+    writer.Write((uint32_t)offsets.size());
+
+    for (const auto& offset : offsets) {
+      writer.Write((uint64_t)offset);
+    }
+
+    for (const auto& box : boxes) {
+      if (box.IsValid()) {
+        writer.Write((uint32_t)round((box.GetMinLat()+90.0)*latConversionFactor));
+        writer.Write((uint32_t)round((box.GetMinLon()+180.0)*lonConversionFactor));
+        writer.Write((uint32_t)round((box.GetMaxLat()+90.0)*latConversionFactor));
+        writer.Write((uint32_t)round((box.GetMaxLon()+180.0)*lonConversionFactor));
+      }
+      else {
+        // min>max marks an invalid box
+        writer.Write(std::numeric_limits<uint32_t>::max());
+        writer.Write(std::numeric_limits<uint32_t>::max());
+        writer.Write((uint32_t)0);
+        writer.Write((uint32_t)0);
+      }
+    }
+
+    writer.Close();
+  }
+
+  void ObjectBoxIndexGenerator::GetDescription(const ImportParameter& /*parameter*/,
+                                               ImportModuleDescription& description) const
+  {
+    description.SetName("ObjectBoxIndexGenerator");
+    description.SetDescription("Index of the bounding boxes of ways and areas");
+
+    description.AddRequiredFile(WayDataFile::WAYS_DAT);
+    description.AddRequiredFile(AreaDataFile::AREAS_DAT);
+
+    description.AddProvidedOptionalFile(ObjectBoxIndex::GetIndexFilename(WayDataFile::WAYS_DAT));
+    description.AddProvidedOptionalFile(ObjectBoxIndex::GetIndexFilename(AreaDataFile::AREAS_DAT));
+  }
+
+  bool ObjectBoxIndexGenerator::Import(const TypeConfigRef& typeConfig,
+                                       const ImportParameter& parameter,
+                                       Progress& progress)
+  {
+    if (!parameter.GetObjectBoxIndex()) {
+      progress.Info("Generation of bounding box index files is disabled");
+
+      // Do not leave index files of a previous import behind, they would not
+      // match the new data files
+      for (const auto& filename : {WayDataFile::WAYS_DAT,
+                                   AreaDataFile::AREAS_DAT}) {
+        std::string indexFilename=AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                  ObjectBoxIndex::GetIndexFilename(filename));
+
+        if (ExistsInFilesystem(indexFilename) &&
+            !RemoveFile(indexFilename)) {
+          progress.Error("Cannot delete file '"+indexFilename+"'");
+
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+    try {
+      std::vector<FileOffset> offsets;
+      std::vector<GeoBox>     boxes;
+      std::string             dataFilename;
+
+      progress.SetAction("Scanning ways");
+
+      dataFilename=AppendFileToDir(parameter.GetDestinationDirectory(),
+                                   WayDataFile::WAYS_DAT);
+
+      ScanDataFile<WayView>(*typeConfig,
+                            dataFilename,
+                            progress,
+                            offsets,
+                            boxes);
+
+      progress.Info(std::to_string(offsets.size())+" way bounding boxes");
+
+      WriteIndex(ObjectBoxIndex::GetIndexFilename(dataFilename),
+                 offsets,
+                 boxes);
+
+      offsets.clear();
+      boxes.clear();
+
+      progress.SetAction("Scanning areas");
+
+      dataFilename=AppendFileToDir(parameter.GetDestinationDirectory(),
+                                   AreaDataFile::AREAS_DAT);
+
+      ScanDataFile<AreaView>(*typeConfig,
+                             dataFilename,
+                             progress,
+                             offsets,
+                             boxes);
+
+      progress.Info(std::to_string(offsets.size())+" area bounding boxes");
+
+      WriteIndex(ObjectBoxIndex::GetIndexFilename(dataFilename),
+                 offsets,
+                 boxes);
+    }
+    catch (IOException& e) {
+      progress.Error(e.GetDescription());
+
+      return false;
+    }
+
+    return true;
+  }
+}
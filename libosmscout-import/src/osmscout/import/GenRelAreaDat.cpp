@@ -20,6 +20,8 @@
 #include <osmscout/import/GenRelAreaDat.h>
 
 #include <algorithm>
+#include <future>
+#include <numeric>
 
 #include <osmscout/TypeFeatures.h>
 #include <osmscout/TypeInfoSet.h>
@@ -54,9 +56,8 @@ namespace osmscout {
       if (!state.IsUsed(i)) {
         bool included=false;
 
-        for (size_t x=0; x<state.GetRingCount(); x++) {
-          if (!state.IsUsed(x) &&
-              state.Includes(i,x)) {
+        for (const auto x : state.GetIncluders(i)) {
+          if (!state.IsUsed(x)) {
             included=true;
             break;
           }
@@ -93,13 +94,10 @@ namespace osmscout {
           state.Includes(i,topIndex)) {
         bool included=false;
 
-        for (size_t x=0; x<state.GetRingCount(); x++) {
+        for (const auto x : state.GetIncluders(i)) {
           if (x!=i && !state.IsUsed(x)) {
-            included=state.Includes(i,x);
-
-            if (included) {
-              break;
-            }
+            included=true;
+            break;
           }
         }
 
@@ -143,6 +141,7 @@ namespace osmscout {
   bool RelAreaDataGenerator::BuildRings(const TypeConfig& typeConfig,
                                         const ImportParameter& parameter,
                                         Progress& progress,
+                                        std::vector<RelationReport>& reports,
                                         OSMId id,
                                         const std::string& name,
                                         const TypeInfoRef& type,
@@ -185,10 +184,9 @@ namespace osmscout {
                        " cannot be joined with any other way of the relation "+
                        std::to_string(id)+" "+name);
 
-        parameter.GetErrorReporter()->ReportRelation(id,
-                                                     type,
-                                                     "Incomplete or broken relation - cannot join path "+
-                                                     std::to_string(entry.second.front()->ways.front()->GetId()));
+        reports.emplace_back(type,
+                             "Incomplete or broken relation - cannot join path "+
+                             std::to_string(entry.second.front()->ways.front()->GetId()));
         return false;
       }
 
@@ -321,6 +319,7 @@ namespace osmscout {
   bool RelAreaDataGenerator::ResolveMultipolygon(const TypeConfig& typeConfig,
                                                  const ImportParameter& parameter,
                                                  Progress& progress,
+                                                 std::vector<RelationReport>& reports,
                                                  OSMId id,
                                                  const std::string& name,
                                                  const TypeInfoRef& type,
@@ -335,6 +334,7 @@ namespace osmscout {
     if (!BuildRings(typeConfig,
                     parameter,
                     progress,
+                    reports,
                     id,
                     name,
                     type,
@@ -346,23 +346,58 @@ namespace osmscout {
     // Ring grouping
     //
 
-    GroupingState state(parts.size());
+    GroupingState                        state(parts.size());
+    std::vector<const MultipolygonPart*> rings;
+    std::vector<GeoBox>                  boxes;
+    std::vector<size_t>                  order;
 
-    size_t ix=0;
-    for (const auto& r1 : parts) {
-      size_t jx=0;
-      for (const auto& r2 : parts) {
-        if (ix!=jx) {
-          if (IsAreaSubOfArea(r2.role.nodes,
-                              r1.role.nodes)) {
-            state.SetIncluded(ix,jx);
-          }
+    rings.reserve(parts.size());
+    boxes.reserve(parts.size());
+    order.reserve(parts.size());
+
+    for (const auto& part : parts) {
+      GeoBox box;
+
+      GetBoundingBox(part.role.nodes,
+                     box);
+
+      order.push_back(rings.size());
+      rings.push_back(&part);
+      boxes.push_back(box);
+    }
+
+    // A ring can only be included by another ring, if their bounding boxes intersect.
+    // We sort the rings by their western border and sweep from west to east, so
+    // that only rings overlapping in longitude get compared.
+    std::sort(order.begin(),
+              order.end(),
+              [&boxes](size_t a, size_t b) {
+                return boxes[a].GetMinLon()<boxes[b].GetMinLon();
+              });
+
+    for (size_t o=0; o<order.size(); o++) {
+      size_t ix=order[o];
+
+      for (size_t p=o+1;
+           p<order.size() &&
+           boxes[order[p]].GetMinLon()<=boxes[ix].GetMaxLon();
+           p++) {
+        size_t jx=order[p];
+
+        if (!boxes[ix].Intersects(boxes[jx],false)) {
+          continue;
         }
 
-        jx++;
-      }
+        if (IsAreaSubOfArea(rings[jx]->role.nodes,
+                            rings[ix]->role.nodes)) {
+          state.SetIncluded(ix,jx);
+        }
 
-      ix++;
+        if (IsAreaSubOfArea(rings[ix]->role.nodes,
+                            rings[jx]->role.nodes)) {
+          state.SetIncluded(jx,ix);
+        }
+      }
     }
 
     //
@@ -582,44 +617,20 @@ namespace osmscout {
     return true;
   }
 
-  bool RelAreaDataGenerator::ResolveMultipolygonMembers(Progress& progress,
-                                                        const ImportParameter& parameter,
-                                                        const TypeConfig& typeConfig,
-                                                        CoordDataFile& coordDataFile,
-                                                        RawWayIndexedDataFile& wayDataFile,
-                                                        RawRelationIndexedDataFile& relDataFile,
-                                                        IdSet& resolvedRelations,
-                                                        const Area& relation,
-                                                        const std::string& name,
-                                                        const RawRelation& rawRelation,
-                                                        std::list<MultipolygonPart>& parts)
+  /**
+   * Collect the ids of all ways of the relation. For boundaries the child relations are
+   * loaded (recursively) and their ways are collected, too.
+   */
+  bool RelAreaDataGenerator::CollectRelationMembers(const ImportParameter& parameter,
+                                                    const TypeInfoSet& boundaryTypes,
+                                                    RawRelationIndexedDataFile& relDataFile,
+                                                    RelationJob& job)
   {
-    TypeInfoSet                    boundaryTypes(typeConfig);
-    TypeInfoRef                    boundaryType;
-    std::set<OSMId>                nodeIds;
-    std::set<OSMId>                wayIds;
-    std::set<OSMId>                pendingRelationIds;
-    std::set<OSMId>                visitedRelationIds;
-
-    CoordDataFile::ResultMap       coordMap;
-    IdRawWayMap                    wayMap;
-    std::map<OSMId,RawRelationRef> relationMap;
-
-    boundaryType=typeConfig.GetTypeInfo("boundary_country");
-    assert(boundaryType);
-    boundaryTypes.Set(boundaryType);
-
-    boundaryType=typeConfig.GetTypeInfo("boundary_state");
-    assert(boundaryType);
-    boundaryTypes.Set(boundaryType);
-
-    boundaryType=typeConfig.GetTypeInfo("boundary_county");
-    assert(boundaryType);
-    boundaryTypes.Set(boundaryType);
-
-    boundaryType=typeConfig.GetTypeInfo("boundary_administrative");
-    assert(boundaryType);
-    boundaryTypes.Set(boundaryType);
+    const RawRelation& rawRelation=*job.rawRelation;
+    const std::string& name=job.name;
+    Progress&          progress=job.progress;
+    std::set<OSMId>    pendingRelationIds;
+    std::set<OSMId>    visitedRelationIds;
 
     visitedRelationIds.insert(rawRelation.GetId());
 
@@ -632,9 +643,9 @@ namespace osmscout {
           (member.role=="inner" ||
            member.role=="outer" ||
            member.role.empty())) {
-        wayIds.insert(member.id);
+        job.wayIds.insert(member.id);
 
-        if (wayIds.size()>parameter.GetRelMaxWays()) {
+        if (job.wayIds.size()>parameter.GetRelMaxWays()) {
           hasMaxWayError = true;
           continue;
         }
@@ -652,14 +663,6 @@ namespace osmscout {
             continue;
           }
 
-          if (resolvedRelations.find(member.id)!=resolvedRelations.end()) {
-            progress.Error("Found self referencing relation "+
-                           std::to_string(member.id)+
-                           " during resolving of members of relation "+
-                           std::to_string(rawRelation.GetId())+" "+name);
-            return false;
-          }
-
           pendingRelationIds.insert(member.id);
         }
         else {
@@ -689,16 +692,16 @@ namespace osmscout {
 
       for (const auto& childRelation : childRelations) {
         visitedRelationIds.insert(childRelation->GetId());
-        relationMap[childRelation->GetId()]=childRelation;
+        job.relationMap[childRelation->GetId()]=childRelation;
 
         for (const auto& member : childRelation->members) {
           if (member.type==RawRelation::memberWay &&
               (member.role=="inner" ||
                member.role=="outer" ||
                member.role.empty())) {
-            wayIds.insert(member.id);
+            job.wayIds.insert(member.id);
 
-            if (wayIds.size()>parameter.GetRelMaxWays()) {
+            if (job.wayIds.size()>parameter.GetRelMaxWays()) {
               hasMaxWayError = true;
               continue;
             }
@@ -713,17 +716,7 @@ namespace osmscout {
                                  std::to_string(member.id)+
                                  " is referenced multiple times within relation "+
                                  std::to_string(rawRelation.GetId())+" "+name);
-                continue;;
-              }
-
-              if (resolvedRelations.find(member.id)!=resolvedRelations.end()) {
-                progress.Error("Found self referencing relation "+
-                               std::to_string(member.id)+
-                               " during resolving of members of relation "+
-                               std::to_string(rawRelation.GetId())+" "+
-                               rawRelation.GetType()->GetName()+" "+
-                               name);
-                return false;
+                continue;
               }
 
               pendingRelationIds.insert(member.id);
@@ -743,11 +736,30 @@ namespace osmscout {
       progress.Error("Relation "+
                       std::to_string(rawRelation.GetId())+" "+name+
                       " references too many ways (" +
-                      std::to_string(wayIds.size())+")");
+                      std::to_string(job.wayIds.size())+")");
       return false;
     }
 
-    // Now load all ways and collect all coordinate ids
+    return true;
+  }
+
+  /**
+   * Load the member ways and their coordinates of all relations of the block in one go.
+   * Relations referencing too many nodes are marked as invalid.
+   */
+  bool RelAreaDataGenerator::LoadRelationMembers(const ImportParameter& parameter,
+                                                 CoordDataFile& coordDataFile,
+                                                 RawWayIndexedDataFile& wayDataFile,
+                                                 RelationBlock& block)
+  {
+    std::set<OSMId> wayIds;
+
+    for (const auto& job : block.jobs) {
+      if (job->valid) {
+        wayIds.insert(job->wayIds.begin(),
+                      job->wayIds.end());
+      }
+    }
 
     std::vector<RawWayRef> ways;
 
@@ -755,70 +767,161 @@ namespace osmscout {
 
     if (!wayDataFile.Get(wayIds,
                          ways)) {
-      progress.Error("Cannot resolve child ways of relation "+
-                     std::to_string(rawRelation.GetId())+" "+
-                     rawRelation.GetType()->GetName()+" "+
-                     name);
       return false;
     }
 
-    wayMap.reserve(ways.size());
+    block.wayMap.reserve(ways.size());
 
     for (const auto& way : ways) {
-      for (const auto& osmId : way->GetNodes()) {
-        nodeIds.insert(osmId);
-      }
-
-      wayMap[way->GetId()]=way;
+      block.wayMap[way->GetId()]=way;
     }
 
     wayIds.clear();
     ways.clear();
 
-    // Now load all node coordinates
+    std::set<OSMId> nodeIds;
 
-    if (nodeIds.size()>parameter.GetRelMaxCoords()) {
-      progress.Error("Relation "+
-                     std::to_string(rawRelation.GetId())+" "+name+
-                     " references too many nodes (" +
-                     std::to_string(nodeIds.size())+")");
-      return false;
-    }
+    for (const auto& job : block.jobs) {
+      if (!job->valid) {
+        continue;
+      }
 
-    if (!coordDataFile.Get(nodeIds,
-                           coordMap)) {
-      progress.Error("Cannot resolve child nodes of relation "+
-                     std::to_string(rawRelation.GetId())+" "+
-                     rawRelation.GetType()->GetName()+" "+
-                     name);
-      return false;
+      std::set<OSMId> relationNodeIds;
+
+      for (const auto& wayId : job->wayIds) {
+        auto way=block.wayMap.find(wayId);
+
+        if (way!=block.wayMap.end()) {
+          relationNodeIds.insert(way->second->GetNodes().begin(),
+                                 way->second->GetNodes().end());
+        }
+      }
+
+      if (relationNodeIds.size()>parameter.GetRelMaxCoords()) {
+        job->progress.Error("Relation "+
+                            std::to_string(job->rawRelation->GetId())+" "+job->name+
+                            " references too many nodes (" +
+                            std::to_string(relationNodeIds.size())+")");
+        job->valid=false;
+        continue;
+      }
+
+      nodeIds.insert(relationNodeIds.begin(),
+                     relationNodeIds.end());
     }
 
-    nodeIds.clear();
+    return coordDataFile.Get(nodeIds,
+                             block.coordMap);
+  }
 
-    // Now build together everything
+  /**
+   * Read the next block of relations and load all their members.
+   *
+   * The block is complete, if it contains GetRawRelationBlockSize() relations or if its
+   * relations reference more than GetRawWayBlockSize() ways. The returned block is empty, if
+   * all relations have been read.
+   *
+   * @throws IOException
+   */
+  RelAreaDataGenerator::RelationBlockRef RelAreaDataGenerator::ReadRelationBlock(const ImportParameter& parameter,
+                                                                                 Progress& progress,
+                                                                                 const TypeConfig& typeConfig,
+                                                                                 const TypeInfoSet& boundaryTypes,
+                                                                                 const FeatureRef& featureName,
+                                                                                 CoordDataFile& coordDataFile,
+                                                                                 RawWayIndexedDataFile& wayDataFile,
+                                                                                 RawRelationIndexedDataFile& relDataFile,
+                                                                                 FileScanner& scanner,
+                                                                                 uint32_t rawRelationCount,
+                                                                                 uint32_t& currentRelation)
+  {
+    RelationBlockRef block=std::make_shared<RelationBlock>();
+    size_t           wayCount=0;
 
-    if (boundaryTypes.IsSet(rawRelation.GetType())) {
-      return ComposeBoundaryMembers(typeConfig,
-                                    progress,
-                                    coordMap,
-                                    wayMap,
-                                    relationMap,
-                                    relation,
-                                    name,
-                                    rawRelation,
-                                    resolvedRelations,
-                                    parts);
+    while (currentRelation<=rawRelationCount &&
+           (block->jobs.empty() ||
+            (block->jobs.size()<parameter.GetRawRelationBlockSize() &&
+             wayCount<parameter.GetRawWayBlockSize()))) {
+      progress.SetProgress(currentRelation,rawRelationCount);
+
+      RawRelationRef rawRel=std::make_shared<RawRelation>();
+
+      rawRel->Read(typeConfig,
+                   scanner);
+
+      currentRelation++;
+
+      // Normally we now also skip an object because of its missing type, but
+      // in case of relations things are a little bit more difficult,
+      // type might be placed at the outer ring and not on the relation
+      // itself, we thus still need to parse the complete relation for
+      // type analysis before we can skip it.
+
+      RelationJobRef job(new RelationJob(rawRel,
+                                         ResolveRelationName(featureName,
+                                                             *rawRel),
+                                         progress.OutputDebug()));
+
+      job->valid=CollectRelationMembers(parameter,
+                                        boundaryTypes,
+                                        relDataFile,
+                                        *job);
+
+      if (job->valid) {
+        wayCount+=job->wayIds.size();
+      }
+
+      block->jobs.push_back(std::move(job));
     }
-    else {
-      return ComposeAreaMembers(typeConfig,
-                                progress,
-                                coordMap,
-                                wayMap,
-                                name,
-                                rawRelation,
-                                parts);
+
+    if (!block->jobs.empty() &&
+        !LoadRelationMembers(parameter,
+                             coordDataFile,
+                             wayDataFile,
+                             *block)) {
+      for (const auto& job : block->jobs) {
+        if (job->valid) {
+          job->progress.Error("Cannot resolve child ways and nodes of relation "+
+                              std::to_string(job->rawRelation->GetId())+" "+
+                              job->rawRelation->GetType()->GetName()+" "+
+                              job->name);
+          job->valid=false;
+        }
+      }
     }
+
+    return block;
+  }
+
+  /**
+   * Resolve all relations of the block in parallel, using workers of the
+   * shared worker budget. The block must already contain all member ways and
+   * coordinates.
+   */
+  void RelAreaDataGenerator::ResolveRelationBlock(const ImportParameter& parameter,
+                                                  const TypeConfig& typeConfig,
+                                                  const TypeInfoSet& boundaryTypes,
+                                                  RelationBlock& block)
+  {
+    std::vector<size_t> jobIndexes(block.jobs.size());
+
+    std::iota(jobIndexes.begin(),
+              jobIndexes.end(),
+              0);
+
+    ProcessInParallel(jobIndexes,
+                      [this,&parameter,&typeConfig,&boundaryTypes,&block](size_t j) {
+      RelationJob& job=*block.jobs[j];
+
+      if (job.valid) {
+        job.valid=HandleMultipolygonRelation(parameter,
+                                             typeConfig,
+                                             boundaryTypes,
+                                             block.coordMap,
+                                             block.wayMap,
+                                             job);
+      }
+    });
   }
 
   /**
@@ -826,8 +929,6 @@ namespace osmscout {
    * outer rings have different types. Takes the type with occurs most. In the case where there is only
    * one outer ring, return it as copyPart to allow calling code to copy attributes from it.
    *
-   * @param parameter
-   *    Parameter object
    * @param typeConfig
    *    Type configuration
    * @param rawRelation
@@ -836,13 +937,15 @@ namespace osmscout {
    *    The list of parts for the raw relation
    * @param copyPart
    *    Optional reference of the part tat defines the outer ring
+   * @param reports
+   *    Reports for the error reporter, passed on after the relation has been resolved
    * @return
    */
-  TypeInfoRef RelAreaDataGenerator::AutodetectRelationType(const ImportParameter& parameter,
-                                                           const TypeConfig& typeConfig,
+  TypeInfoRef RelAreaDataGenerator::AutodetectRelationType(const TypeConfig& typeConfig,
                                                            const RawRelation& rawRelation,
                                                            std::list<MultipolygonPart>& parts,
-                                                           std::list<MultipolygonPart>::iterator& copyPart) const
+                                                           std::list<MultipolygonPart>::iterator& copyPart,
+                                                           std::vector<RelationReport>& reports) const
   {
     std::vector<size_t>                                typeCount(typeConfig.GetTypeCount(),0);
     std::vector<std::list<MultipolygonPart>::iterator> partRef(typeConfig.GetTypeCount(),parts.end());
@@ -878,10 +981,9 @@ namespace osmscout {
 
     if (countTypes>1 &&
         masterType!=typeConfig.typeInfoIgnore) {
-      parameter.GetErrorReporter()->ReportRelation(rawRelation.GetId(),
-                                                   rawRelation.GetType(),
-                                                   "Conflicting types for outer ring (choosen type "+
-                                                   masterType->GetName()+")");
+      reports.emplace_back(rawRelation.GetType(),
+                           "Conflicting types for outer ring (choosen type "+
+                           masterType->GetName()+")");
     }
 
     if (countTypes==1) {
@@ -895,31 +997,41 @@ namespace osmscout {
   }
 
   bool RelAreaDataGenerator::HandleMultipolygonRelation(const ImportParameter& parameter,
-                                                        Progress& progress,
                                                         const TypeConfig& typeConfig,
-                                                        IdSet& wayAreaIndexBlacklist,
-                                                        CoordDataFile& coordDataFile,
-                                                        RawWayIndexedDataFile& wayDataFile,
-                                                        RawRelationIndexedDataFile& relDataFile,
-                                                        RawRelation& rawRelation,
-                                                        const std::string& name,
-                                                        Area& relation)
+                                                        const TypeInfoSet& boundaryTypes,
+                                                        const CoordDataFile::ResultMap& coordMap,
+                                                        const IdRawWayMap& wayMap,
+                                                        RelationJob& job)
   {
-    IdSet resolvedRelations;
+    Progress&          progress=job.progress;
+    RawRelation&       rawRelation=*job.rawRelation;
+    const std::string& name=job.name;
+    Area&              relation=job.area;
+    IdSet              resolvedRelations;
 
     std::list<MultipolygonPart> parts;
 
-    if (!ResolveMultipolygonMembers(progress,
-                                    parameter,
-                                    typeConfig,
-                                    coordDataFile,
-                                    wayDataFile,
-                                    relDataFile,
-                                    resolvedRelations,
-                                    relation,
-                                    name,
-                                    rawRelation,
-                                    parts)) {
+    if (boundaryTypes.IsSet(rawRelation.GetType())) {
+      if (!ComposeBoundaryMembers(typeConfig,
+                                  progress,
+                                  coordMap,
+                                  wayMap,
+                                  job.relationMap,
+                                  relation,
+                                  name,
+                                  rawRelation,
+                                  resolvedRelations,
+                                  parts)) {
+        return false;
+      }
+    }
+    else if (!ComposeAreaMembers(typeConfig,
+                                 progress,
+                                 coordMap,
+                                 wayMap,
+                                 name,
+                                 rawRelation,
+                                 parts)) {
       return false;
     }
 
@@ -929,6 +1041,7 @@ namespace osmscout {
     if (!ResolveMultipolygon(typeConfig,
                              parameter,
                              progress,
+                             job.reports,
                              rawRelation.GetId(),
                              name,
                              rawRelation.GetType(),
@@ -949,11 +1062,10 @@ namespace osmscout {
     for (auto& ring : parts) {
       if (ring.role.GetType()!=typeConfig.typeInfoIgnore &&
           !ring.role.GetType()->CanBeArea()) {
-        parameter.GetErrorReporter()->ReportRelation(rawRelation.GetId(),
-                                                     rawRelation.GetType(),
-                                                     "Has ring of type "+
-                                                     ring.role.GetType()->GetName()+
-                                                     " which is not an area type");
+        job.reports.emplace_back(rawRelation.GetType(),
+                                 "Has ring of type "+
+                                 ring.role.GetType()->GetName()+
+                                 " which is not an area type");
 
         ring.role.SetType(typeConfig.typeInfoIgnore);
       }
@@ -971,11 +1083,11 @@ namespace osmscout {
     if (masterRing.GetType()==typeConfig.typeInfoIgnore) {
       auto copyPart=parts.end();
 
-      TypeInfoRef masterType=AutodetectRelationType(parameter,
-                                                    typeConfig,
+      TypeInfoRef masterType=AutodetectRelationType(typeConfig,
                                                     rawRelation,
                                                     parts,
-                                                    copyPart);
+                                                    copyPart,
+                                                    job.reports);
 
       if (progress.OutputDebug() && masterType!=typeConfig.typeInfoIgnore) {
         progress.Debug("Autodetecting type of multipolygon relation "+
@@ -993,9 +1105,8 @@ namespace osmscout {
     }
 
     if (masterRing.GetType()==typeConfig.typeInfoIgnore) {
-      parameter.GetErrorReporter()->ReportRelation(rawRelation.GetId(),
-                                                   rawRelation.GetType(),
-                                                   "No type");
+      job.reports.emplace_back(rawRelation.GetType(),
+                               "No type");
       return false;
     }
 
@@ -1012,7 +1123,7 @@ namespace osmscout {
         // However because we change the type of area rings to typeIgnore above we need some bookkeeping for this
         // to work here.
         // On the other hand do not fill the blacklist until you are sure that the relation will not be rejected.
-        wayAreaIndexBlacklist.insert(ring.ways.front()->GetId());
+        job.blacklist.push_back(ring.ways.front()->GetId());
       }
     }
 
@@ -1147,6 +1258,24 @@ namespace osmscout {
 
     RawRelationIndexedDataFile relDataFile(parameter.GetRawWayIndexCacheSize(),/*dataCache*/0);
     FeatureRef                 featureName(typeConfig->GetFeature(RefFeature::NAME));
+    TypeInfoSet                boundaryTypes(*typeConfig);
+    TypeInfoRef                boundaryType;
+
+    boundaryType=typeConfig->GetTypeInfo("boundary_country");
+    assert(boundaryType);
+    boundaryTypes.Set(boundaryType);
+
+    boundaryType=typeConfig->GetTypeInfo("boundary_state");
+    assert(boundaryType);
+    boundaryTypes.Set(boundaryType);
+
+    boundaryType=typeConfig->GetTypeInfo("boundary_county");
+    assert(boundaryType);
+    boundaryTypes.Set(boundaryType);
+
+    boundaryType=typeConfig->GetTypeInfo("boundary_administrative");
+    assert(boundaryType);
+    boundaryTypes.Set(boundaryType);
 
     if (!coordDataFile.Open(parameter.GetDestinationDirectory(),
                             parameter.GetCoordDataMemoryMaped())) {
@@ -1186,6 +1315,7 @@ namespace osmscout {
     try {
       uint32_t rawRelationCount=0;
       uint32_t writtenRelationCount=0;
+      uint32_t currentRelation=1;
 
       scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
                                    Preprocess::RAWRELS_DAT),
@@ -1199,101 +1329,133 @@ namespace osmscout {
 
       writer.Write(writtenRelationCount);
 
-      for (uint32_t r=1; r<=rawRelationCount; r++) {
-        progress.SetProgress(r,rawRelationCount);
+      auto writeBlock=[&](const RelationBlock& block) {
+        for (const auto& job : block.jobs) {
+          job->progress.Flush(progress);
 
-        RawRelation rawRel;
-
-        rawRel.Read(*typeConfig,
-                    scanner);
+          for (const auto& report : job->reports) {
+            parameter.GetErrorReporter()->ReportRelation(job->rawRelation->GetId(),
+                                                         report.type,
+                                                         report.error);
+          }
 
-        // Normally we now also skip an object because of its missing type, but
-        // in case of relations things are a little bit more difficult,
-        // type might be placed at the outer ring and not on the relation
-        // itself, we thus still need to parse the complete relation for
-        // type analysis before we can skip it.
+          if (!job->valid) {
+            continue;
+          }
 
-        std::string name=ResolveRelationName(featureName,
-                                             rawRel);
-        Area        rel;
+          for (const auto& id : job->blacklist) {
+            wayAreaIndexBlacklist.insert(id);
+          }
 
-        if (!HandleMultipolygonRelation(parameter,
-                                        progress,
-                                        *typeConfig,
-                                        wayAreaIndexBlacklist,
-                                        coordDataFile,
-                                        wayDataFile,
-                                        relDataFile,
-                                        rawRel,
-                                        name,
-                                        rel)) {
-          continue;
-        }
+          const RawRelation& rawRel=*job->rawRelation;
+          const Area&        rel=job->area;
+          const std::string& name=job->name;
+          bool               valid=true;
+          bool               dense=true;
+          bool               big=false;
+
+          for (const auto& ring : rel.rings) {
+            if (!ring.IsMasterRing()) {
+              if (ring.nodes.size()<3) {
+                valid=false;
+                break;
+              }
 
-        bool valid=true;
-        bool dense=true;
-        bool big=false;
+              if (!IsValidToWrite(ring.nodes)) {
+                dense=false;
+                break;
+              }
 
-        for (const auto& ring : rel.rings) {
-          if (!ring.IsMasterRing()) {
-            if (ring.nodes.size()<3) {
-              valid=false;
-              break;
+              if (ring.nodes.size()>FileWriter::MAX_NODES) {
+                big=true;
+                break;
+              }
             }
+          }
 
-            if (!IsValidToWrite(ring.nodes)) {
-              dense=false;
-              break;
-            }
+          if (!valid) {
+            progress.Warning("Relation "+
+                             std::to_string(rawRel.GetId())+" "+
+                             rel.GetType()->GetName()+" "+
+                             name+" has ring with less than three nodes, skipping");
+            parameter.GetErrorReporter()->ReportRelation(rawRel.GetId(),
+                                                         rel.GetType(),
+                                                         "Ring with less than three nodes (no area)");
+            continue;
+          }
 
-            if (ring.nodes.size()>FileWriter::MAX_NODES) {
-              big=true;
-              break;
+          if (!dense) {
+            progress.Warning("Relation "+
+                             std::to_string(rawRel.GetId())+" "+
+                             rel.GetType()->GetName()+" "+
+                             name+" has ring(s) which nodes are not dense enough to be written, skipping");
+            continue;
+          }
+
+          if (big) {
+            progress.Warning("Relation "+
+                             std::to_string(rawRel.GetId())+" "+
+                             rel.GetType()->GetName()+" "+
+                             name+" has ring(s) with too many nodes, skipping");
+            continue;
+          }
+
+          areaTypeCount[rel.GetType()->GetIndex()]++;
+          for (const auto& ring: rel.rings) {
+            if (ring.IsOuterRing()) {
+              areaNodeTypeCount[rel.GetType()->GetIndex()]+=ring.nodes.size();
             }
           }
-        }
 
-        if (!valid) {
-          progress.Warning("Relation "+
-                           std::to_string(rawRel.GetId())+" "+
-                           rel.GetType()->GetName()+" "+
-                           name+" has ring with less than three nodes, skipping");
-          parameter.GetErrorReporter()->ReportRelation(rawRel.GetId(),
-                                                       rel.GetType(),
-                                                       "Ring with less than three nodes (no area)");
-          continue;
-        }
+          writer.Write((uint8_t)osmRefRelation);
+          writer.Write(rawRel.GetId());
 
-        if (!dense) {
-          progress.Warning("Relation "+
-                           std::to_string(rawRel.GetId())+" "+
-                           rel.GetType()->GetName()+" "+
-                           name+" has ring(s) which nodes are not dense enough to be written, skipping");
-          continue;
-        }
+          rel.WriteImport(*typeConfig,
+                          writer);
 
-        if (big) {
-          progress.Warning("Relation "+
-                           std::to_string(rawRel.GetId())+" "+
-                           rel.GetType()->GetName()+" "+
-                           name+" has ring(s) with too many nodes, skipping");
-          continue;
+          writtenRelationCount++;
         }
-
-        areaTypeCount[rel.GetType()->GetIndex()]++;
-        for (const auto& ring: rel.rings) {
-          if (ring.IsOuterRing()) {
-            areaNodeTypeCount[rel.GetType()->GetIndex()]+=ring.nodes.size();
-          }
+      };
+
+      // While the worker threads resolve the relations of one block, the next
+      // block is read and its members are loaded. Blocks are written in
+      // order, so the result does not depend on the number of threads.
+
+      RelationBlockRef  resolvingBlock;
+      std::future<void> resolving;
+
+      while (true) {
+        RelationBlockRef block=ReadRelationBlock(parameter,
+                                                 progress,
+                                                 *typeConfig,
+                                                 boundaryTypes,
+                                                 featureName,
+                                                 coordDataFile,
+                                                 wayDataFile,
+                                                 relDataFile,
+                                                 scanner,
+                                                 rawRelationCount,
+                                                 currentRelation);
+
+        if (resolving.valid()) {
+          resolving.get();
+
+          writeBlock(*resolvingBlock);
+
+          resolvingBlock.reset();
         }
 
-        writer.Write((uint8_t)osmRefRelation);
-        writer.Write(rawRel.GetId());
-
-        rel.WriteImport(*typeConfig,
-                        writer);
+        if (block->jobs.empty()) {
+          break;
+        }
 
-        writtenRelationCount++;
+        resolvingBlock=block;
+        resolving=std::async(std::launch::async,[this,&parameter,&typeConfig,&boundaryTypes,block]() {
+          ResolveRelationBlock(parameter,
+                               *typeConfig,
+                               boundaryTypes,
+                               *block);
+        });
       }
 
       progress.Info(std::to_string(rawRelationCount)+" relations read"+
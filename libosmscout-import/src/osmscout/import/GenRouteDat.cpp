@@ -22,6 +22,8 @@
 #include <algorithm>
 #include <future>
 #include <iterator>
+#include <memory>
+#include <numeric>
 
 #include <osmscout/ObjectRef.h>
 
@@ -951,21 +953,23 @@ namespace osmscout {
 
   bool RouteDataGenerator::GetRouteNodePoint(Progress& progress,
                                              const RawRouteNode& node,
-                                             std::unordered_map<FileOffset,WayRef>& waysMap,
-                                             std::unordered_map<FileOffset,AreaRef>& areasMap,
+                                             const FileOffsetWayMap& waysMap,
+                                             const FileOffsetAreaMap& areasMap,
                                              Point& point) const
   {
     for (const auto& ref : node.objects) {
       if (ref.GetType()==refWay) {
-        const WayRef& way=waysMap[ref.GetFileOffset()];
+        const auto& wayEntry=waysMap.find(ref.GetFileOffset());
 
-        if (!way) {
+        if (wayEntry==waysMap.end()) {
           progress.Error("Error while loading way at offset "+
                          std::to_string(ref.GetFileOffset()) +
                          " (Internal error?)");
           continue;
         }
 
+        const WayRef& way=wayEntry->second;
+
         size_t currentNode;
 
         if (!way->GetNodeIndexByNodeId(node.id,
@@ -978,15 +982,16 @@ namespace osmscout {
         return true;
       }
       else if (ref.GetType()==refArea) {
-        const AreaRef& area=areasMap[ref.GetFileOffset()];
+        const auto& areaEntry=areasMap.find(ref.GetFileOffset());
 
-        if (!area) {
+        if (areaEntry==areasMap.end()) {
           progress.Error("Error while loading area at offset "+
                          std::to_string(ref.GetFileOffset()) +
                          " (Internal error?)");
           continue;
         }
 
+        const AreaRef&    area=areaEntry->second;
         size_t            currentNode;
         const Area::Ring& ring=area->rings.front();
 
@@ -1383,6 +1388,137 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Calculate the route node for the given raw route node. Only reads shared data,
+   * so it can be called in parallel for different route nodes.
+   */
+  void RouteDataGenerator::CalculateRouteNode(Progress& progress,
+                                              const RawRouteNode& node,
+                                              const FileOffsetWayMap& waysMap,
+                                              const FileOffsetAreaMap& areasMap,
+                                              const RouteNodeIdSet& routeNodeIdSet,
+                                              const ViaTurnRestrictionMap& restrictions,
+                                              VehicleMask vehicles,
+                                              PendingRouteNode& pending)
+  {
+    //
+    // Find out if any of the areas/ways at the intersection is routable
+    // for us for the given vehicle (we already only loaded those objects
+    // that are routable at all).
+    // If none of the objects is routable the complete node is not routable and
+    // we can safely drop this node from the routing graph.
+    //
+
+    if (!IsAnyRoutable(progress,
+                       node,
+                       waysMap,
+                       areasMap,
+                       vehicles)) {
+      return;
+    }
+
+    if (!GetRouteNodePoint(progress,
+                           node,
+                           waysMap,
+                           areasMap,
+                           pending.point)) {
+      return;
+    }
+
+    RouteNode& routeNode=pending.routeNode;
+
+    routeNode.Initialize(0,
+                         pending.point);
+
+    //
+    // Calculate all outgoing paths
+    //
+
+    for (const auto& ref : node.objects) {
+      if (ref.GetType()==refWay) {
+        const auto& wayEntry=waysMap.find(ref.GetFileOffset());
+
+        if (wayEntry==waysMap.end()) {
+          progress.Error("Error while loading way at offset "+
+                         std::to_string(ref.GetFileOffset()) +
+                         " (Internal error?)");
+          continue;
+        }
+
+        const Way& way=*wayEntry->second;
+
+        if (!GetAccess(way).CanRoute(vehicles)) {
+          continue;
+        }
+
+        ObjectVariantData variant;
+
+        variant.type=way.GetType();
+        variant.maxSpeed=GetMaxSpeed(way);
+        variant.grade=GetGrade(way);
+
+        pending.variants.push_back(variant);
+
+        auto objectVariantIndex=(uint16_t)(pending.variants.size()-1);
+
+        if (way.IsCircular()) {
+          // Circular way routing (similar to current area routing, but respecting isOneway())
+          CalculateCircularWayPaths(routeNode,
+                                    way,
+                                    objectVariantIndex,
+                                    routeNodeIdSet);
+        }
+        else {
+          // Normal way routing
+          CalculateWayPaths(routeNode,
+                            way,
+                            objectVariantIndex,
+                            routeNodeIdSet);
+        }
+      }
+      else if (ref.GetType()==refArea) {
+        const auto& areaEntry=areasMap.find(ref.GetFileOffset());
+
+        if (areaEntry==areasMap.end()) {
+          progress.Error("Error while loading area at offset "+
+                         std::to_string(ref.GetFileOffset()) +
+                         " (Internal error?)");
+          continue;
+        }
+
+        const Area& area=*areaEntry->second;
+
+        if (!area.GetType()->CanRoute()) {
+          continue;
+        }
+
+        ObjectVariantData variant;
+
+        variant.type=area.GetType();
+        variant.maxSpeed=0;
+        variant.grade=1;
+
+        pending.variants.push_back(variant);
+
+        auto objectVariantIndex=(uint16_t)(pending.variants.size()-1);
+
+        routeNode.AddObject(ref,
+                            objectVariantIndex);
+
+        CalculateAreaPaths(routeNode,
+                           area,
+                           objectVariantIndex,
+                           routeNodeIdSet);
+      }
+    }
+
+    FillRoutePathExcludes(routeNode,
+                          node,
+                          restrictions);
+
+    pending.routable=true;
+  }
+
   bool RouteDataGenerator::WriteObjectVariantData(Progress& progress,
                                                   const std::string& variantFilename,
                                                   const std::map<ObjectVariantData,uint16_t>& routeDataMap)
@@ -1502,142 +1638,124 @@ namespace osmscout {
         FileOffsetWayMap waysMap=waysMapFuture.get();
         FileOffsetAreaMap areasMap=areasMapFuture.get();
 
-        progress.Info("Storing route nodes");
+        progress.Info("Calculating route nodes");
 
-        for (auto nodeEntry=startOfBlock; nodeEntry!=endOfBlock; nodeEntry++) {
-          auto& node=*nodeEntry;
+        //
+        // Calculate the route nodes of each tile of the block in parallel
+        //
 
-          if (node.cell!=currentCell) {
-            if (currentIndex.count>0) {
-              indexMap[currentCell]=currentIndex;
-            }
+        std::vector<const RawRouteNode*> blockNodes;
+        std::vector<size_t>              tileStarts;
 
-            currentCell=node.cell;
-            currentIndex=IndexEntry(writer.GetPos());
-            currentIndex.count=1;
-          }
-          else {
-            currentIndex.count++;
+        for (auto nodeEntry=startOfBlock; nodeEntry!=endOfBlock; nodeEntry++) {
+          if (blockNodes.empty() ||
+              nodeEntry->cell!=blockNodes.back()->cell) {
+            tileStarts.push_back(blockNodes.size());
           }
 
-          handledRouteNodeCount++;
-          progress.SetProgress(handledRouteNodeCount,
-                               (uint32_t)rawRouteNodes.size());
-
-          //
-          // Find out if any of the areas/ways at the intersection is routable
-          // for us for the given vehicle (we already only loaded those objects
-          // that are routable at all).
-          // If none of the objects is routable the complete node is not routable and
-          // we can safely drop this node from the routing graph.
-          //
-
-          if (!IsAnyRoutable(progress,
-                             node,
-                             waysMap,
-                             areasMap,
-                             vehicles)) {
-            continue;
-          }
+          blockNodes.push_back(&*nodeEntry);
+        }
 
-          Point point;
+        tileStarts.push_back(blockNodes.size());
 
-          if (!GetRouteNodePoint(progress,
-                                 node,
-                                 waysMap,
-                                 areasMap,
-                                 point)) {
-            continue;
+        std::vector<PendingRouteNode>                  pendingNodes(blockNodes.size());
+        std::vector<std::unique_ptr<BufferedProgress>> tileProgress(tileStarts.size()-1);
+        std::vector<size_t>                            tiles(tileStarts.size()-1);
+
+        std::iota(tiles.begin(),
+                  tiles.end(),
+                  0);
+
+        // Largest tiles first, for better load balancing
+        std::stable_sort(tiles.begin(),
+                         tiles.end(),
+                         [&tileStarts](size_t a, size_t b) {
+          return tileStarts[a+1]-tileStarts[a]>tileStarts[b+1]-tileStarts[b];
+        });
+
+        for (auto& tp : tileProgress) {
+          tp.reset(new BufferedProgress(progress.OutputDebug()));
+        }
+
+        ProcessInParallel(tiles,
+                          [&](size_t tile) {
+          for (size_t n=tileStarts[tile]; n<tileStarts[tile+1]; n++) {
+            CalculateRouteNode(*tileProgress[tile],
+                               *blockNodes[n],
+                               waysMap,
+                               areasMap,
+                               routeNodeIdSet,
+                               restrictions,
+                               vehicles,
+                               pendingNodes[n]);
           }
+        });
 
-          RouteNode  routeNode;
+        progress.Info("Storing route nodes");
 
-          routeNode.Initialize(writer.GetPos(),
-                               point);
+        //
+        // Write the route nodes in order, assigning global object variant indexes
+        //
 
-          //
-          // Calculate all outgoing paths
-          //
+        for (size_t tile=0; tile<tileProgress.size(); tile++) {
+          tileProgress[tile]->Flush(progress);
 
-          for (const auto& ref : node.objects) {
-            if (ref.GetType()==refWay) {
-              const WayRef& way=waysMap[ref.GetFileOffset()];
+          for (size_t n=tileStarts[tile]; n<tileStarts[tile+1]; n++) {
+            const RawRouteNode& node=*blockNodes[n];
+            PendingRouteNode&   pending=pendingNodes[n];
 
-              if (!way) {
-                progress.Error("Error while loading way at offset "+
-                               std::to_string(ref.GetFileOffset()) +
-                               " (Internal error?)");
-                continue;
+            if (node.cell!=currentCell) {
+              if (currentIndex.count>0) {
+                indexMap[currentCell]=currentIndex;
               }
 
-              if (!GetAccess(*way).CanRoute(vehicles)) {
-                continue;
-              }
+              currentCell=node.cell;
+              currentIndex=IndexEntry(writer.GetPos());
+              currentIndex.count=1;
+            }
+            else {
+              currentIndex.count++;
+            }
 
-              uint16_t objectVariantIndex=RegisterOrUseObjectVariantData(routeDataMap,
-                                                                         way->GetType(),
-                                                                         GetMaxSpeed(*way),
-                                                                         GetGrade(*way));
-
-              if (way->IsCircular()) {
-                // Circular way routing (similar to current area routing, but respecting isOneway())
-                CalculateCircularWayPaths(routeNode,
-                                          *way,
-                                          objectVariantIndex,
-                                          routeNodeIdSet);
-              }
-              else {
-                // Normal way routing
-                CalculateWayPaths(routeNode,
-                                  *way,
-                                  objectVariantIndex,
-                                  routeNodeIdSet);
-              }
+            handledRouteNodeCount++;
+            progress.SetProgress(handledRouteNodeCount,
+                                 (uint32_t)rawRouteNodes.size());
+
+            if (!pending.routable) {
+              continue;
             }
-            else if (ref.GetType()==refArea) {
-              const AreaRef& area=areasMap[ref.GetFileOffset()];
-
-              if (!area) {
-                progress.Error("Error while loading area at offset "+
-                               std::to_string(ref.GetFileOffset()) +
-                               " (Internal error?)");
-                continue;
-              }
 
-              if (!area->GetType()->CanRoute()) {
-                continue;
-              }
+            RouteNode&            routeNode=pending.routeNode;
+            std::vector<uint16_t> objectVariantIndexes;
 
-              uint16_t objectVariantIndex=RegisterOrUseObjectVariantData(routeDataMap,
-                                                                         area->GetType(),
-                                                                         0,
-                                                                         1);
+            objectVariantIndexes.reserve(pending.variants.size());
 
-              routeNode.AddObject(ref,
-                                  objectVariantIndex);
+            for (const auto& variant : pending.variants) {
+              objectVariantIndexes.push_back(RegisterOrUseObjectVariantData(routeDataMap,
+                                                                            variant.type,
+                                                                            variant.maxSpeed,
+                                                                            variant.grade));
+            }
 
-              CalculateAreaPaths(routeNode,
-                                 *area,
-                                 objectVariantIndex,
-                                 routeNodeIdSet);
+            for (auto& object : routeNode.objects) {
+              object.objectVariantIndex=objectVariantIndexes[object.objectVariantIndex];
             }
-          }
 
-          FillRoutePathExcludes(routeNode,
-                                node,
-                                restrictions);
+            routeNode.Initialize(writer.GetPos(),
+                                 pending.point);
 
-          if (routeNode.paths.size()==1) {
-            simpleNodesCount++;
-          }
+            if (routeNode.paths.size()==1) {
+              simpleNodesCount++;
+            }
 
-          objectCount+=routeNode.objects.size();
-          pathCount+=routeNode.paths.size();
-          excludeCount+=routeNode.excludes.size();
+            objectCount+=routeNode.objects.size();
+            pathCount+=routeNode.paths.size();
+            excludeCount+=routeNode.excludes.size();
 
-          routeNode.Write(writer);
+            routeNode.Write(writer);
 
-          writtenRouteNodeCount++;
+            writtenRouteNodeCount++;
+          }
         }
 
         writer.Flush();
@@ -1737,6 +1855,9 @@ namespace osmscout {
       return false;
     }
 
+    // From now on the map is only read
+    nodeUseMap.Optimize();
+
     //
     // Building a map of endpoint ids and list of objects (ObjectFileRef for ways and areas) having this point as junction point
     //
@@ -17,6 +17,8 @@
  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
  */
 
+#include <future>
+
 #include <osmscout/ObjectRef.h>
 
 #include <osmscout/Node.h>
@@ -43,6 +45,40 @@
 
 namespace osmscout
 {
+  /**
+   * Build the trie for the given keyset and save it to the given file.
+   * Returns an error message on failure, else an empty string.
+   */
+  static std::string BuildTrie(marisa::Keyset& keyset,
+                               const std::string& filename)
+  {
+    marisa::Trie trie;
+
+    try {
+      trie.build(keyset,
+                 MARISA_DEFAULT_NUM_TRIES |
+                 MARISA_BINARY_TAIL |
+                 MARISA_LABEL_ORDER |
+                 MARISA_DEFAULT_CACHE);
+    }
+    catch (const marisa::Exception &ex) {
+      std::string errorMsg="Error building:" +filename;
+      errorMsg.append(ex.what());
+      return errorMsg;
+    }
+
+    try {
+      trie.save(filename.c_str());
+    }
+    catch (const marisa::Exception &ex) {
+      std::string errorMsg="Error saving:" +filename;
+      errorMsg.append(ex.what());
+      return errorMsg;
+    }
+
+    return "";
+  }
+
   TextIndexGenerator::TextIndexGenerator() :
     offsetSizeBytes(4)
   {
@@ -122,38 +158,35 @@ namespace osmscout
     trieFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
                                         TextSearchIndex::TEXT_OTHER_DAT));
 
+    // The tries are independent of each other, so build and save them in parallel
+    std::vector<std::future<std::string>> results;
+
     for(size_t i=0; i < keysets.size(); i++) {
       // add sz_offset to the keyset
       keysets[i]->push_back(offsetSizeBytesStr.c_str(),
                             offsetSizeBytesStr.length());
 
-      marisa::Trie trie;
-      try {
-        trie.build(*(keysets[i]),
-                   MARISA_DEFAULT_NUM_TRIES |
-                   MARISA_BINARY_TAIL |
-                   MARISA_LABEL_ORDER |
-                   MARISA_DEFAULT_CACHE);
-      }
-      catch (const marisa::Exception &ex) {
-        std::string errorMsg="Error building:" +trieFiles[i];
-        errorMsg.append(ex.what());
-        progress.Error(errorMsg);
-        return false;
-      }
+      marisa::Keyset*    keyset=keysets[i];
+      const std::string& trieFile=trieFiles[i];
 
-      try {
-        trie.save(trieFiles[i].c_str());
-      }
-      catch (const marisa::Exception &ex) {
-        std::string errorMsg="Error saving:" +trieFiles[i];
-        errorMsg.append(ex.what());
+      results.push_back(std::async(std::launch::async,[keyset,&trieFile]() {
+        return BuildTrie(*keyset,
+                         trieFile);
+      }));
+    }
+
+    bool success=true;
+
+    for (auto& result : results) {
+      std::string errorMsg=result.get();
+
+      if (!errorMsg.empty()) {
         progress.Error(errorMsg);
-        return false;
+        success=false;
       }
     }
 
-    return true;
+    return success;
   }
 
   bool TextIndexGenerator::SetFileOffsetSize(const ImportParameter &parameter,
@@ -19,6 +19,9 @@
 
 #include <osmscout/import/GenWaterIndex.h>
 
+#include <mutex>
+#include <numeric>
+
 #include <osmscout/Way.h>
 
 #include <osmscout/DataFile.h>
@@ -281,6 +284,92 @@ namespace osmscout {
     return true;
   }
 
+  /**
+   * Calculate the state and the ground tiles of all cells of the given level
+   */
+  void WaterIndexGenerator::BuildLevel(const TypeConfig& typeConfig,
+                                       const ImportParameter& parameter,
+                                       Progress& progress,
+                                       WaterIndexProcessor& processor,
+                                       const std::list<WaterIndexProcessor::CoastRef>& coastlines,
+                                       const std::list<WaterIndexProcessor::CoastRef>& boundingPolygons,
+                                       WaterIndexProcessor::Level& level,
+                                       std::map<Pixel,std::list<GroundTile>>& cellGroundTileMap)
+  {
+    Magnification      magnification(MagnificationLevel(level.level));
+    MercatorProjection projection;
+
+    projection.Set(GeoCoord(0.0,0.0),magnification,72,640,480);
+
+    progress.Info("Building tiles for level "+std::to_string(level.level));
+
+    if (!coastlines.empty()) {
+      WaterIndexProcessor::Data data;
+
+      // Collects, calculates and generates a number of data about a coastline
+      processor.CalculateCoastlineData(progress,
+                                       parameter.GetOptimizationWayMethod(),
+                                       1.0,
+                                       4.0,
+                                       projection,
+                                       level.stateMap,
+                                       coastlines,
+                                       data);
+
+      // Mark cells that intersect a coastline as coast
+      processor.MarkCoastlineCells(progress,
+                                   level.stateMap,
+                                   data);
+
+      // Fills coords information for cells that intersect a coastline
+      processor.HandleCoastlinesPartiallyInACell(progress,
+                                                 level.stateMap,
+                                                 cellGroundTileMap,
+                                                 data);
+
+      // Fills coords information for cells that completely contain a coastline
+      processor.HandleAreaCoastlinesCompletelyInACell(progress,
+                                                      level.stateMap,
+                                                      data,
+                                                      cellGroundTileMap);
+    }
+
+    // Calculate the cell type for cells directly around coast cells
+    processor.CalculateCoastEnvironment(progress,
+                                        level.stateMap,
+                                        cellGroundTileMap);
+
+    if (parameter.GetAssumeLand()==ImportParameter::AssumeLandStrategy::enable ||
+        (parameter.GetAssumeLand()==ImportParameter::AssumeLandStrategy::automatic && boundingPolygons.empty())) {
+      // Assume cell type 'land' for cells that intersect with 'land' object types
+      AssumeLand(parameter,
+                 progress,
+                 typeConfig,
+                 processor,
+                 level.stateMap);
+    }
+
+    if (!coastlines.empty()) {
+      // Marks all still 'unknown' cells neighbouring 'water' cells as 'water', too
+      processor.FillWater(progress,
+                          level,
+                          parameter.GetFillWaterArea(),
+                          boundingPolygons);
+
+      processor.FillWaterAroundIsland(progress,
+                                      level.stateMap,
+                                      cellGroundTileMap,
+                                      boundingPolygons);
+    }
+
+    // Marks all still 'unknown' cells between 'coast' or 'land' and 'land' cells as 'land', too
+    processor.FillLand(progress,
+                       level.stateMap);
+
+    processor.CalculateHasCellData(level,
+                                   cellGroundTileMap);
+  }
+
   void WaterIndexGenerator::GetDescription(const ImportParameter& /*parameter*/,
                                               ImportModuleDescription& description) const
   {
@@ -342,6 +431,11 @@ namespace osmscout {
         WaterIndexProcessor::Level level;
 
         level.level=zoomLevel;
+        level.indexEntryOffset=0;
+        level.hasCellData=false;
+        level.dataOffsetBytes=0;
+        level.defaultCellData=WaterIndexProcessor::unknown;
+        level.indexDataOffset=0;
         level.SetBox(boundingBox,
                      cellWidth,
                      cellHeight);
@@ -393,86 +487,53 @@ namespace osmscout {
                                 levels);
       progress.Info("Generating index for level "+std::to_string(parameter.GetWaterIndexMinMag())+" to "+std::to_string(parameter.GetWaterIndexMaxMag()));
 
-      for (auto& level : levels) {
-        Magnification                          magnification(MagnificationLevel(level.level));
-        MercatorProjection                     projection;
-        std::map<Pixel,std::list<GroundTile> > cellGroundTileMap;
-
-        projection.Set(GeoCoord(0.0,0.0),magnification,72,640,480);
+      // Levels are independent of each other and are calculated in parallel.
+      // The levels are written in order, each one as soon as it and all
+      // levels before it are finished. Afterwards the level is released, so
+      // only the levels currently in work are held in memory. Since levels
+      // are started in the same order, the most detailed level finishes last.
+      std::vector<std::map<Pixel,std::list<GroundTile>>> levelGroundTiles(levels.size());
+      std::vector<std::unique_ptr<BufferedProgress>>     levelProgress(levels.size());
+      std::vector<bool>                                  levelFinished(levels.size(),false);
+      std::vector<size_t>                                levelIndexes(levels.size());
+      std::mutex                                         writeMutex;
+      size_t                                             nextLevelToWrite=0;
 
-        progress.SetAction("Building tiles for level "+std::to_string(level.level));
+      std::iota(levelIndexes.begin(),levelIndexes.end(),0);
 
-        if (!coastlines.empty()) {
-          WaterIndexProcessor::Data data;
+      ProcessInParallel(levelIndexes,[&](size_t l) {
+        levelProgress[l].reset(new BufferedProgress(progress.OutputDebug()));
 
-          // Collects, calculates and generates a number of data about a coastline
-          processor.CalculateCoastlineData(progress,
-                                           parameter.GetOptimizationWayMethod(),
-                                           1.0,
-                                           4.0,
-                                           projection,
-                                           level.stateMap,
-                                           coastlines,
-                                           data);
+        BuildLevel(*typeConfig,
+                   parameter,
+                   *levelProgress[l],
+                   processor,
+                   coastlines,
+                   boundingPolygons,
+                   levels[l],
+                   levelGroundTiles[l]);
 
-          // Mark cells that intersect a coastline as coast
-          processor.MarkCoastlineCells(progress,
-                                       level.stateMap,
-                                       data);
+        std::lock_guard<std::mutex> lock(writeMutex);
 
-          // Fills coords information for cells that intersect a coastline
-          processor.HandleCoastlinesPartiallyInACell(progress,
-                                                     level.stateMap,
-                                                     cellGroundTileMap,
-                                                     data);
-
-          // Fills coords information for cells that completely contain a coastline
-          processor.HandleAreaCoastlinesCompletelyInACell(progress,
-                                                          level.stateMap,
-                                                          data,
-                                                          cellGroundTileMap);
-        }
+        levelFinished[l]=true;
 
-        // Calculate the cell type for cells directly around coast cells
-        processor.CalculateCoastEnvironment(progress,
-                                            level.stateMap,
-                                            cellGroundTileMap);
-
-        if (parameter.GetAssumeLand()==ImportParameter::AssumeLandStrategy::enable ||
-            (parameter.GetAssumeLand()==ImportParameter::AssumeLandStrategy::automatic && boundingPolygons.empty())) {
-          // Assume cell type 'land' for cells that intersect with 'land' object types
-          AssumeLand(parameter,
-                     progress,
-                     *typeConfig,
-                     processor,
-                     level.stateMap);
-        }
+        while (nextLevelToWrite<levels.size() &&
+               levelFinished[nextLevelToWrite]) {
+          size_t w=nextLevelToWrite;
 
-        if (!coastlines.empty()) {
-          // Marks all still 'unknown' cells neighbouring 'water' cells as 'water', too
-          processor.FillWater(progress,
-                              level,
-                              parameter.GetFillWaterArea(),
-                              boundingPolygons);
-
-          processor.FillWaterAroundIsland(progress,
-                                          level.stateMap,
-                                          cellGroundTileMap,
-                                          boundingPolygons);
-        }
+          levelProgress[w]->Flush(progress);
 
-        // Marks all still 'unknown' cells between 'coast' or 'land' and 'land' cells as 'land', too
-        processor.FillLand(progress,
-                           level.stateMap);
+          processor.WriteTiles(progress,
+                               levelGroundTiles[w],
+                               levels[w],
+                               writer);
 
-        processor.CalculateHasCellData(level,
-                                       cellGroundTileMap);
+          levelGroundTiles[w].clear();
+          levels[w].stateMap.Release();
 
-        processor.WriteTiles(progress,
-                             cellGroundTileMap,
-                             level,
-                             writer);
-      }
+          nextLevelToWrite++;
+        }
+      });
 
       coastlines.clear();
 
@@ -178,7 +178,8 @@ namespace osmscout {
                                        const TypeConfig& typeConfig,
                                        FileWriter& writer,
                                        uint32_t& writtenWayCount,
-                                       const CoordDataFile::ResultMap& coordsMap,
+                                       const std::vector<OSMId>& nodeIds,
+                                       const std::vector<Coord>& coords,
                                        const RawWay& rawWay)
   {
     Area       area;
@@ -192,9 +193,13 @@ namespace osmscout {
 
     bool success=true;
     for (size_t n=0; n<rawWay.GetNodeCount(); n++) {
-      auto coord=coordsMap.find(rawWay.GetNodeId(n));
+      auto id=std::lower_bound(nodeIds.begin(),
+                               nodeIds.end(),
+                               rawWay.GetNodeId(n));
 
-      if (coord==coordsMap.end()) {
+      if (id==nodeIds.end() ||
+          *id!=rawWay.GetNodeId(n) ||
+          coords[id-nodeIds.begin()].GetSerial()==0) {
         progress.Error("Cannot resolve node with id "+
                        std::to_string(rawWay.GetNodeId(n))+
                        " for area "+
@@ -203,8 +208,10 @@ namespace osmscout {
         break;
       }
 
-      ring.nodes[n].Set(coord->second.GetSerial(),
-                        coord->second.GetCoord());
+      const Coord& coord=coords[id-nodeIds.begin()];
+
+      ring.nodes[n].Set(coord.GetSerial(),
+                        coord.GetCoord());
     }
 
     if (!success) {
@@ -248,7 +255,8 @@ namespace osmscout {
     FileScanner               scanner;
     uint32_t                  rawWayCount=0;
     std::vector<RawWayRef>    rawWays;
-    std::set<OSMId>           nodeIds;
+    std::vector<OSMId>        nodeIds;
+    std::vector<Coord>        coords;
 
     FileWriter                areaWriter;
     uint32_t                  writtenWayCount=0;
@@ -314,42 +322,45 @@ namespace osmscout {
         }
 
         for (size_t n=0; n<way->GetNodeCount(); n++) {
-          nodeIds.insert(way->GetNodeId(n));
+          nodeIds.push_back(way->GetNodeId(n));
         }
 
         rawWays.push_back(way);
 
         if (rawWays.size()>=parameter.GetRawWayBlockSize() ||
             nodeIds.size()>=parameter.GetCoordBlockSize()) {
-          CoordDataFile::ResultMap coordsMap;
+          // Sorted ids allow sequential reading and lookup by binary search
+          std::sort(nodeIds.begin(),nodeIds.end());
+          nodeIds.erase(std::unique(nodeIds.begin(),nodeIds.end()),nodeIds.end());
 
           if (!coordDataFile.Get(nodeIds,
-                                 coordsMap)) {
+                                 coords)) {
             log.Error() << "Cannot read coordinates!";
             return false;
           }
 
-          nodeIds.clear();
-
           for (const auto& rawWay : rawWays) {
             WriteArea(parameter,
                       progress,
                       *typeConfig,
                       areaWriter,
                       writtenWayCount,
-                      coordsMap,
+                      nodeIds,
+                      coords,
                       *rawWay);
           }
 
+          nodeIds.clear();
           rawWays.clear();
         }
       }
 
       if (!rawWays.empty()) {
-        CoordDataFile::ResultMap coordsMap;
+        std::sort(nodeIds.begin(),nodeIds.end());
+        nodeIds.erase(std::unique(nodeIds.begin(),nodeIds.end()),nodeIds.end());
 
         if (!coordDataFile.Get(nodeIds,
-                               coordsMap)) {
+                               coords)) {
           log.Error() << "Cannot read nodes!";
           return false;
         }
@@ -360,7 +371,8 @@ namespace osmscout {
                     *typeConfig,
                     areaWriter,
                     writtenWayCount,
-                    coordsMap,
+                    nodeIds,
+                    coords,
                     *rawWay);
         }
       }
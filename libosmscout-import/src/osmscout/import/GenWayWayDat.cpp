@@ -20,6 +20,8 @@
 #include <osmscout/import/GenWayWayDat.h>
 
 #include <algorithm>
+#include <list>
+#include <memory>
 
 #include <osmscout/DataFile.h>
 #include <osmscout/TypeDistributionDataFile.h>
@@ -52,6 +54,7 @@ namespace osmscout {
     description.SetDescription("Merge ways into bigger ways");
 
     description.AddRequiredFile(TypeDistributionDataFile::DISTRIBUTION_DAT);
+    description.AddRequiredFile(CoordDataFile::COORD_DAT);
     description.AddRequiredFile(Preprocess::RAWWAYS_DAT);
     description.AddRequiredFile(Preprocess::RAWTURNRESTR_DAT);
 
@@ -139,7 +142,7 @@ namespace osmscout {
                                      const TypeConfig& typeConfig,
                                      TypeInfoSet& types,
                                      FileScanner& scanner,
-                                     std::vector<std::list<RawWayRef> >& ways)
+                                     std::vector<WayList>& ways)
   {
     uint32_t    wayCount=0;
     size_t      collectedWaysCount=0;
@@ -216,6 +219,7 @@ namespace osmscout {
                                                OSMId oldId,
                                                OSMId newId)
   {
+    std::lock_guard<std::mutex>   lock(restrictions.mutex);
     std::list<TurnRestrictionRef> oldRestrictions;
 
     auto hits=restrictions.restrictions.equal_range(oldId);
@@ -246,6 +250,8 @@ namespace osmscout {
     // We have an index entry for turn restriction, where the given way id is
     // "from" or "to" so we can just check for "via" == nodeId
 
+    std::lock_guard<std::mutex> lock(restrictions.mutex);
+
     auto hits=restrictions.restrictions.equal_range(wayId);
 
     for (auto hit=hits.first; hit!=hits.second; ++hit) {
@@ -257,40 +263,65 @@ namespace osmscout {
     return false;
   }
 
-  bool WayWayDataGenerator::MergeWays(Progress& progress,
-                                      std::list<RawWayRef>& ways,
+  /**
+   * Call process for the index of each type that has ways. Types are processed in
+   * parallel using one worker thread per core, types with more ways first to
+   * balance the load.
+   */
+  void WayWayDataGenerator::ProcessTypes(const std::vector<WayList>& waysByType,
+                                         const std::function<void(size_t)>& process) const
+  {
+    std::vector<size_t> typeIndexes;
+
+    for (size_t t=0; t<waysByType.size(); t++) {
+      if (!waysByType[t].empty()) {
+        typeIndexes.push_back(t);
+      }
+    }
+
+    std::stable_sort(typeIndexes.begin(),
+                     typeIndexes.end(),
+                     [&waysByType](size_t a, size_t b) {
+      return waysByType[a].size()>waysByType[b].size();
+    });
+
+    ProcessInParallel(typeIndexes,
+                      process);
+  }
+
+  /**
+   * Merge ways of the same type that share an end node and have the same features.
+   *
+   * Safe to be called in parallel for different types, since ways and
+   * restrictions are only modified for ways of the given list.
+   */
+  void WayWayDataGenerator::MergeWays(WayList& ways,
                                       RestrictionData& restrictions)
   {
-    WaysByNodeMap waysByNode;
+    WaysByNodeMap     waysByNode;
+    std::vector<bool> isMerged(ways.size(),false);
 
     // Sort by decreasing node count to assure that we merge longest ways first
-    ways.sort(WayByNodeCountSorter);
+    std::stable_sort(ways.begin(),ways.end(),WayByNodeCountSorter);
 
     // Index by first node id (if way is not circular)
-    for (auto w=ways.begin();
-        w!=ways.end();
-        ++w) {
-      RawWayRef way(*w);
-      OSMId     firstNodeId=way->GetFirstNodeId();
-      OSMId     lastNodeId=way->GetLastNodeId();
+    for (size_t w=0; w<ways.size(); w++) {
+      OSMId firstNodeId=ways[w]->GetFirstNodeId();
+      OSMId lastNodeId=ways[w]->GetLastNodeId();
 
       if (firstNodeId!=lastNodeId) {
         waysByNode[firstNodeId].push_back(w);
       }
     }
 
-    // Variables for monitoring progress
-    SilentProgress silentProgress;
-    size_t         currentWay;
-    size_t         wayCount=ways.size();
-
-    currentWay=1;
-    for (auto &way : ways) {
-      OSMId lastNodeId=way->GetLastNodeId();
-
-      progress.SetProgress(currentWay,wayCount);
+    for (size_t w=0; w<ways.size(); w++) {
+      // Way has already been appended to another way
+      if (isMerged[w]) {
+        continue;
+      }
 
-      currentWay++;
+      RawWayRef way=ways[w];
+      OSMId     lastNodeId=way->GetLastNodeId();
 
       auto lastNodeCandidate=waysByNode.find(lastNodeId);
 
@@ -310,15 +341,9 @@ namespace osmscout {
       // If restrictions apply to the join point, we cannot merge
       // because the restriction might be broken later (the restriction direction
       // is undefined afterwards)
-      bool restricted=false;
-      {
-#pragma omp critical
-        restricted=IsRestricted(restrictions,
-                                way->GetId(),
-                                lastNodeId);
-      }
-
-      if (restricted) {
+      if (IsRestricted(restrictions,
+                       way->GetId(),
+                       lastNodeId)) {
         continue;
       }
 
@@ -328,7 +353,7 @@ namespace osmscout {
         for (auto c=lastNodeCandidate->second.begin();
              c!=lastNodeCandidate->second.end();
              ++c) {
-          RawWayRef candidate(*(*c));
+          RawWayRef candidate(ways[*c]);
 
           // Can happen if we would close a way (something like A => B => A)
           if (candidate->GetId()==way->GetId()) {
@@ -338,15 +363,9 @@ namespace osmscout {
           // If restrictions apply to the join point, we cannot merge
           // because the restriction might be broken later (the restriction direction
           // is undefined afterwards)
-          bool restricted=false;
-          {
-#pragma omp critical
-            restricted=IsRestricted(restrictions,
-                                    candidate->GetId(),
-                                    lastNodeId);
-          }
-
-          if (restricted) {
+          if (IsRestricted(restrictions,
+                           candidate->GetId(),
+                           lastNodeId)) {
             continue;
           }
 
@@ -355,25 +374,13 @@ namespace osmscout {
             continue;
           }
 
-          /*
-          if (way->GetNodeCount()+candidate->GetNodeCount()>300) {
-            // Do not merge ways that are too big in result.
-            //  If we already had the data, we would get the resulting bounding box
-            // for a better check (different way could be very different in the desitiy
-            // of its nodes and the covered area)
-            continue;
-          }
-           */
-
           // This is a match
           hasMerged=true;
 
-          {
-#pragma omp critical
-            UpdateRestrictions(restrictions,
-                               candidate->GetId(),
-                               way->GetId());
-          }
+          UpdateRestrictions(restrictions,
+                             candidate->GetId(),
+                             way->GetId());
+
           //
           // Append candidate nodes
           //
@@ -392,10 +399,8 @@ namespace osmscout {
           // Cleanup
           //
 
-          WaysByNodeMap::iterator otherEntry;
-
-          // Erase the matched way from the list of ways to process
-          ways.erase(*c);
+          // Mark the matched way as merged, so that it gets dropped
+          isMerged[*c]=true;
 
           // Erase the matched way from the map of ways (entry via the matched node)
           lastNodeCandidate->second.erase(c);
@@ -421,17 +426,26 @@ namespace osmscout {
       }
     }
 
-    return true;
+    // Drop merged ways, keeping the order of the remaining ways
+    size_t remaining=0;
+
+    for (size_t w=0; w<ways.size(); w++) {
+      if (!isMerged[w]) {
+        ways[remaining]=std::move(ways[w]);
+        remaining++;
+      }
+    }
+
+    ways.resize(remaining);
   }
 
-  bool WayWayDataGenerator::SplitLongWays(Progress& progress,
-                     std::list<RawWayRef>& ways,
-                     CoordDataFile::ResultMap& coordsMap)
+  void WayWayDataGenerator::SplitLongWays(Progress& progress,
+                                          WayList& ways,
+                                          const CoordDataFile::ResultMap& coordsMap)
   {
-    std::list<RawWayRef> newWays;
+    WayList newWays;
 
-    size_t currentWay=1;
-    size_t wayCount=ways.size();
+    newWays.reserve(ways.size());
 
     for (const auto& way: ways) {
       //*wayIt;
@@ -457,9 +471,6 @@ namespace osmscout {
         split = length.As<Kilometer>() > 30.0;
       }
 
-      progress.SetProgress(currentWay,wayCount);
-      currentWay++;
-
       if (!split) {
         newWays.push_back(way);
         continue;
@@ -558,13 +569,7 @@ namespace osmscout {
       }
     }
 
-    ways.clear();
-
-    for (const auto& way: newWays) {
-      ways.push_back(way);
-    }
-
-    return true;
+    ways.swap(newWays);
   }
 
   void WayWayDataGenerator::WriteWay(Progress& progress,
@@ -756,7 +761,7 @@ namespace osmscout {
       /* ------ */
 
       while (!wayTypes.Empty()) {
-        std::vector<std::list<RawWayRef> > waysByType(typeConfig->GetTypeCount());
+        std::vector<WayList> waysByType(typeConfig->GetTypeCount());
 
         //
         // Load type data
@@ -773,24 +778,25 @@ namespace osmscout {
           return false;
         }
 
-        // TODO: only print it, if there is something to merge at all
         progress.SetAction("Merging ways");
 
-#pragma omp parallel for
-        for (int64_t typeIdx = 0; typeIdx<(int64_t)typeConfig->GetTypeCount(); typeIdx++) {
-          size_t originalWayCount=waysByType[typeIdx].size();
+        std::vector<size_t> originalWayCounts(waysByType.size());
+
+        for (size_t type=0; type<waysByType.size(); type++) {
+          originalWayCounts[type]=waysByType[type].size();
+        }
 
-          if (originalWayCount>0) {
-            MergeWays(progress,
-                      waysByType[typeIdx],
-                      restrictions);
+        ProcessTypes(waysByType,
+                     [this,&waysByType,&restrictions](size_t type) {
+          MergeWays(waysByType[type],
+                    restrictions);
+        });
 
-#pragma omp critical
-            if (waysByType[typeIdx].size()<originalWayCount) {
-              progress.Info("Reduced ways of '"+typeConfig->GetTypeInfo(typeIdx)->GetName()+"' from "+
-                            std::to_string(originalWayCount)+" to "+std::to_string(waysByType[typeIdx].size())+ " way(s)");
-              mergeCount+=originalWayCount-waysByType[typeIdx].size();
-            }
+        for (size_t type=0; type<waysByType.size(); type++) {
+          if (waysByType[type].size()<originalWayCounts[type]) {
+            progress.Info("Reduced ways of '"+typeConfig->GetTypeInfo(type)->GetName()+"' from "+
+                          std::to_string(originalWayCounts[type])+" to "+std::to_string(waysByType[type].size())+ " way(s)");
+            mergeCount+=originalWayCounts[type]-waysByType[type].size();
           }
         }
 
@@ -820,19 +826,28 @@ namespace osmscout {
 
         // split too long ways again to shorter segments
         progress.SetAction("Splitting too long ways");
-#pragma omp parallel for
-        for (int64_t typeIdx = 0; typeIdx<(int64_t)typeConfig->GetTypeCount(); typeIdx++) {
-          size_t originalWayCount=waysByType[typeIdx].size();
-
-          if (originalWayCount>0) {
-            SplitLongWays(progress, waysByType[typeIdx], coordsMap);
-
-#pragma omp critical
-            if (waysByType[typeIdx].size()>originalWayCount) {
-              progress.Info("Splitted long ways of '"+typeConfig->GetTypeInfo(typeIdx)->GetName()+"' from "+
-                            std::to_string(originalWayCount)+" to "+std::to_string(waysByType[typeIdx].size())+ " way(s)");
-              mergeCount+=originalWayCount-waysByType[typeIdx].size();
-            }
+
+        std::vector<std::unique_ptr<BufferedProgress>> typeProgress(waysByType.size());
+
+        for (size_t type=0; type<waysByType.size(); type++) {
+          originalWayCounts[type]=waysByType[type].size();
+          typeProgress[type].reset(new BufferedProgress(progress.OutputDebug()));
+        }
+
+        ProcessTypes(waysByType,
+                     [this,&waysByType,&typeProgress,&coordsMap](size_t type) {
+          SplitLongWays(*typeProgress[type],
+                        waysByType[type],
+                        coordsMap);
+        });
+
+        for (size_t type=0; type<waysByType.size(); type++) {
+          typeProgress[type]->Flush(progress);
+
+          if (waysByType[type].size()>originalWayCounts[type]) {
+            progress.Info("Splitted long ways of '"+typeConfig->GetTypeInfo(type)->GetName()+"' from "+
+                          std::to_string(originalWayCounts[type])+" to "+std::to_string(waysByType[type].size())+ " way(s)");
+            mergeCount+=originalWayCounts[type]-waysByType[type].size();
           }
         }
 
@@ -20,10 +20,21 @@
 #include <osmscout/import/Import.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <iomanip>
 #include <iostream>
 #include <iterator>
+#include <limits>
+#include <sstream>
+#include <thread>
 
+#include <osmscout/AreaDataFile.h>
+#include <osmscout/NodeDataFile.h>
 #include <osmscout/OSMScoutTypes.h>
+#include <osmscout/WayDataFile.h>
 
 #include <osmscout/routing/RoutingService.h>
 #include <osmscout/routing/RouteNode.h>
@@ -39,6 +50,7 @@
 #include <osmscout/import/GenTypeDat.h>
 
 #include <osmscout/import/Preprocess.h>
+#include <osmscout/import/ChangeFileUpdater.h>
 
 #include <osmscout/import/GenCoordDat.h>
 
@@ -62,6 +74,7 @@
 #include <osmscout/import/GenCoverageIndex.h>
 
 #include <osmscout/import/GenLocationIndex.h>
+#include <osmscout/import/GenObjectBoxIndex.h>
 #include <osmscout/import/GenOptimizeAreaWayIds.h>
 #include <osmscout/import/GenWaterIndex.h>
 
@@ -76,6 +89,8 @@
 #include <osmscout/import/GenTextIndex.h>
 #endif
 
+#include <osmscout/util/BlockCompression.h>
+#include <osmscout/util/File.h>
 #include <osmscout/util/MemoryMonitor.h>
 #include <osmscout/util/Progress.h>
 #include <osmscout/util/StopClock.h>
@@ -84,9 +99,9 @@ namespace osmscout {
 
   static const size_t defaultStartStep=1;
 #if defined(OSMSCOUT_IMPORT_HAVE_LIB_MARISA)
-  static const size_t defaultEndStep=25;
+  static const size_t defaultEndStep=26;
 #else
-  static const size_t defaultEndStep=24;
+  static const size_t defaultEndStep=25;
 #endif
 
   PreprocessorFactory::~PreprocessorFactory()
@@ -112,6 +127,7 @@ namespace osmscout {
      sortBlockSize(40000000),
      sortTileMag(14),
      processingQueueSize(std::max((unsigned int)1,std::thread::hardware_concurrency())),
+     maxParallelModules(1),
      numericIndexPageSize(1024),
      rawCoordBlockSize(60000000),
      rawNodeDataMemoryMaped(false),
@@ -119,7 +135,9 @@ namespace osmscout {
      rawWayDataMemoryMaped(false),
      rawWayIndexCacheSize(10000),
      rawWayBlockSize(500000),
+     rawRelationBlockSize(10000),
      coordDataMemoryMaped(false),
+     coordDataDense(false),
      coordIndexCacheSize(1000000),
      coordBlockSize(250000),
      relMaxWays(1500),
@@ -128,6 +146,9 @@ namespace osmscout {
      areaDataCacheSize(0),
      wayDataMemoryMaped(false),
      wayDataCacheSize(0),
+     compressDataFiles(false),
+     compressionBlockSize(16*1024),
+     objectBoxIndex(true),
      areaAreaIndexMaxMag(17),
      areaNodeGridMag(14),
      areaNodeSimpleListLimit(500),
@@ -231,6 +252,11 @@ namespace osmscout {
     return processingQueueSize;
   }
 
+  size_t ImportParameter::GetMaxParallelModules() const
+  {
+    return maxParallelModules;
+  }
+
   size_t ImportParameter::GetNumericIndexPageSize() const
   {
     return numericIndexPageSize;
@@ -266,11 +292,21 @@ namespace osmscout {
     return rawWayBlockSize;
   }
 
+  size_t ImportParameter::GetRawRelationBlockSize() const
+  {
+    return rawRelationBlockSize;
+  }
+
   bool ImportParameter::GetCoordDataMemoryMaped() const
   {
     return coordDataMemoryMaped;
   }
 
+  bool ImportParameter::GetCoordDataDense() const
+  {
+    return coordDataDense;
+  }
+
   size_t ImportParameter::GetCoordIndexCacheSize() const
   {
     return coordIndexCacheSize;
@@ -306,6 +342,21 @@ namespace osmscout {
     return wayDataCacheSize;
   }
 
+  bool ImportParameter::GetCompressDataFiles() const
+  {
+    return compressDataFiles;
+  }
+
+  size_t ImportParameter::GetCompressionBlockSize() const
+  {
+    return compressionBlockSize;
+  }
+
+  bool ImportParameter::GetObjectBoxIndex() const
+  {
+    return objectBoxIndex;
+  }
+
   bool ImportParameter::GetWayDataMemoryMaped() const
   {
     return wayDataMemoryMaped;
@@ -508,6 +559,11 @@ namespace osmscout {
     this->processingQueueSize=processingQueueSize;
   }
 
+  void ImportParameter::SetMaxParallelModules(size_t maxParallelModules)
+  {
+    this->maxParallelModules=std::max(maxParallelModules,(size_t)1);
+  }
+
   void ImportParameter::SetNumericIndexPageSize(size_t numericIndexPageSize)
   {
     this->numericIndexPageSize=numericIndexPageSize;
@@ -543,11 +599,21 @@ namespace osmscout {
     this->rawWayBlockSize=blockSize;
   }
 
+  void ImportParameter::SetRawRelationBlockSize(size_t blockSize)
+  {
+    this->rawRelationBlockSize=blockSize;
+  }
+
   void ImportParameter::SetCoordDataMemoryMaped(bool memoryMaped)
   {
     this->coordDataMemoryMaped=memoryMaped;
   }
 
+  void ImportParameter::SetCoordDataDense(bool coordDataDense)
+  {
+    this->coordDataDense=coordDataDense;
+  }
+
   void ImportParameter::SetCoordIndexCacheSize(size_t coordIndexCacheSize)
   {
     this->coordIndexCacheSize=coordIndexCacheSize;
@@ -588,6 +654,21 @@ namespace osmscout {
     this->wayDataCacheSize=wayDataCacheSize;
   }
 
+  void ImportParameter::SetCompressDataFiles(bool compressDataFiles)
+  {
+    this->compressDataFiles=compressDataFiles;
+  }
+
+  void ImportParameter::SetCompressionBlockSize(size_t compressionBlockSize)
+  {
+    this->compressionBlockSize=compressionBlockSize;
+  }
+
+  void ImportParameter::SetObjectBoxIndex(bool objectBoxIndex)
+  {
+    this->objectBoxIndex=objectBoxIndex;
+  }
+
   void ImportParameter::SetAreaAreaIndexMaxMag(size_t areaAreaIndexMaxMag)
   {
     this->areaAreaIndexMaxMag=areaAreaIndexMaxMag;
@@ -791,6 +872,110 @@ namespace osmscout {
     // no code
   }
 
+  WorkerBudget::WorkerBudget(size_t workerCount)
+  : available(workerCount)
+  {
+    // no code
+  }
+
+  /**
+   * Take up to the given number of workers from the budget and return the
+   * number of workers actually granted
+   */
+  size_t WorkerBudget::Acquire(size_t workerCount)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    size_t granted=std::min(workerCount,available);
+
+    available-=granted;
+
+    return granted;
+  }
+
+  void WorkerBudget::Release(size_t workerCount)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    available+=workerCount;
+  }
+
+  size_t WorkerBudget::GetAvailable() const
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return available;
+  }
+
+  /**
+   * Return the budget shared by the whole import. The calling thread counts
+   * as one core, so the budget holds one worker less than there are cores.
+   */
+  WorkerBudget& WorkerBudget::GetDefault()
+  {
+    static WorkerBudget budget(std::max((unsigned int)1,std::thread::hardware_concurrency())-1);
+
+    return budget;
+  }
+
+  /**
+   * Call process for each of the given items, using the calling thread and as many
+   * additional worker threads as the given budget grants (at most one per item).
+   * Items are taken in the given order, so expensive items should come first.
+   * Returns after all items have been processed.
+   */
+  void ProcessInParallel(WorkerBudget& budget,
+                         const std::vector<size_t>& items,
+                         const std::function<void(size_t)>& process)
+  {
+    if (items.empty()) {
+      return;
+    }
+
+    std::atomic<size_t>            nextItem(0);
+    std::vector<std::future<void>> workers;
+    size_t                         workerCount=budget.Acquire(items.size()-1);
+
+    auto worker=[&items,&nextItem,&process]() {
+      size_t i;
+
+      while ((i=nextItem++)<items.size()) {
+        process(items[i]);
+      }
+    };
+
+    try {
+      for (size_t w=0; w<workerCount; w++) {
+        workers.push_back(std::async(std::launch::async,worker));
+      }
+
+      worker();
+
+      for (auto& w : workers) {
+        w.get();
+      }
+    }
+    catch (...) {
+      // Futures of std::async wait for their thread on destruction
+      workers.clear();
+      budget.Release(workerCount);
+      throw;
+    }
+
+    budget.Release(workerCount);
+  }
+
+  /**
+   * Call process for each of the given items using the default worker budget
+   */
+  void ProcessInParallel(const std::vector<size_t>& items,
+                         const std::function<void(size_t)>& process)
+  {
+    ProcessInParallel(WorkerBudget::GetDefault(),
+                      items,
+                      process);
+  }
+
   Importer::Importer(const ImportParameter& parameter)
   : parameter(parameter)
   {
@@ -806,6 +991,24 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Importer executing the given modules instead of the default module list
+   */
+  Importer::Importer(const ImportParameter& parameter,
+                     const std::vector<ImportModuleRef>& modules)
+  : parameter(parameter),
+    modules(modules)
+  {
+    for (const auto& module : this->modules) {
+      ImportModuleDescription description;
+
+      module->GetDescription(parameter,
+                             description);
+
+      moduleDescriptions.push_back(description);
+    }
+  }
+
   Importer::~Importer()
   {
     // no code
@@ -851,6 +1054,19 @@ namespace osmscout {
       progress.Error("If eco mode is activated you must run all import steps");
     }
 
+    if (parameter.GetCompressDataFiles()) {
+      if (!IsBlockCompressionSupported()) {
+        progress.Error("Compression of data files is not supported by this build");
+        return false;
+      }
+
+      if (parameter.GetCompressionBlockSize()==0 ||
+          parameter.GetCompressionBlockSize()>std::numeric_limits<uint32_t>::max()) {
+        progress.Error("Compression block size must be > 0 and fit into 32 bit");
+        return false;
+      }
+    }
+
     return true;
   }
 
@@ -926,9 +1142,11 @@ namespace osmscout {
     /* 24 */
     modules.push_back(std::make_shared<IntersectionIndexGenerator>());
 
+    /* 25 */
+    modules.push_back(std::make_shared<ObjectBoxIndexGenerator>());
 
 #if defined(OSMSCOUT_IMPORT_HAVE_LIB_MARISA)
-    /* 25 */
+    /* 26 */
     modules.push_back(std::make_shared<TextIndexGenerator>());
 #endif
   }
@@ -965,7 +1183,125 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Progress of a module executed in parallel with other modules. All
+   * calls are serialized and forwarded to the given progress, prefixed
+   * with the name of the module (if given).
+   */
+  class ModuleProgress CLASS_FINAL : public Progress
+  {
+  private:
+    Progress&   progress;
+    std::mutex& mutex;
+    std::string prefix;
+
+  public:
+    ModuleProgress(Progress& progress,
+                   std::mutex& mutex,
+                   const std::string& name)
+    : progress(progress),
+      mutex(mutex),
+      prefix(name.empty() ? "" : "["+name+"] ")
+    {
+      SetOutputDebug(progress.OutputDebug());
+    }
+
+    void SetStep(const std::string& step) override
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+
+      progress.SetAction(prefix+step);
+    }
+
+    void SetAction(const std::string& action) override
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+
+      progress.SetAction(prefix+action);
+    }
+
+    void SetProgress(double current,
+                     double total) override
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+
+      progress.SetProgress(current,total);
+    }
+
+    void SetProgress(unsigned int current,
+                     unsigned int total) override
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+
+      progress.SetProgress(current,total);
+    }
+
+    void SetProgress(unsigned long current,
+                     unsigned long total) override
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+
+      progress.SetProgress(current,total);
+    }
+
+    void SetProgress(unsigned long long current,
+                     unsigned long long total) override
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+
+      progress.SetProgress(current,total);
+    }
+
+    void Debug(const std::string& text) override
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+
+      progress.Debug(prefix+text);
+    }
+
+    void Info(const std::string& text) override
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+
+      progress.Info(prefix+text);
+    }
+
+    void Warning(const std::string& text) override
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+
+      progress.Warning(prefix+text);
+    }
+
+    void Error(const std::string& text) override
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+
+      progress.Error(prefix+text);
+    }
+  };
+
+  static std::string SecondsToString(double seconds)
+  {
+    std::ostringstream stream;
+
+    stream.imbue(std::locale::classic());
+    stream << std::fixed << std::setprecision(3) << seconds;
+
+    return stream.str();
+  }
+
+  /**
+   * Remove all temporary files required by the given step, that are not
+   * required by any step not yet finished.
+   *
+   * @param currentStep
+   *    The step just finished (1 based)
+   * @param finishedSteps
+   *    Flag for each module, if it has already been executed
+   */
   bool Importer::CleanupTemporaries(size_t currentStep,
+                                    const std::vector<bool>& finishedSteps,
                                     Progress& progress)
   {
     std::set<std::string> allTemporaryFiles;
@@ -986,7 +1322,12 @@ namespace osmscout {
 
     std::set<std::string> inFutureStillRequiredTemporaryFiles;
 
-    for (size_t step=currentStep; step<moduleDescriptions.size(); step++) {
+    for (size_t step=0; step<moduleDescriptions.size(); step++) {
+      if (step==currentStep-1 ||
+          finishedSteps[step]) {
+        continue;
+      }
+
       for (const auto& file : moduleDescriptions[step].GetRequiredFiles()) {
         if (allTemporaryFiles.find(file)!=allTemporaryFiles.end()) {
           inFutureStillRequiredTemporaryFiles.insert(file);
@@ -1014,70 +1355,214 @@ namespace osmscout {
     return true;
   }
 
-  bool Importer::ExecuteModules(const TypeConfigRef& typeConfig,
-                                Progress& progress)
+  /**
+   * Return the list of modules to execute together with their dependencies.
+   *
+   * A module depends on a previous module, if it requires a file the previous
+   * module provides, if both provide the same file or if it provides a file
+   * the previous module requires (and thus must not overwrite it while the
+   * previous module is still reading it).
+   */
+  std::vector<Importer::ModuleExecution> Importer::GetModuleExecutions() const
   {
-    StopClock     overAllTimer;
-    size_t        currentStep=1;
-    MemoryMonitor monitor;
-    double        maxVMUsage=0.0;
-    double        maxResidentSet=0.0;
-
-    for (const auto& module : modules) {
-      if (currentStep>=parameter.GetStartStep() &&
-          currentStep<=parameter.GetEndStep()) {
-        ImportModuleDescription moduleDescription;
-        StopClock               timer;
-        bool                    success;
-        double                  vmUsage;
-        double                  residentSet;
-
-        module->GetDescription(parameter,
-                               moduleDescription);
-
-        progress.SetStep("Step #"+
-                         std::to_string(currentStep)+
-                         " - "+
-                         moduleDescription.GetName());
-        progress.Info("Module description: "+moduleDescription.GetDescription());
-
-        monitor.Reset();
-
-        DumpModuleDescription(moduleDescription,
-                              progress);
-
-        success=module->Import(typeConfig,
-                               parameter,
-                               progress);
+    std::vector<ModuleExecution> executions;
 
-        timer.Stop();
+    auto getProvidedFiles=[](const ImportModuleDescription& description) {
+      std::set<std::string> files;
 
-        monitor.GetMaxValue(vmUsage,residentSet);
+      for (const auto& file : description.GetProvidedFiles()) {
+        files.insert(file);
+      }
+      for (const auto& file : description.GetProvidedOptionalFiles()) {
+        files.insert(file);
+      }
+      for (const auto& file : description.GetProvidedDebuggingFiles()) {
+        files.insert(file);
+      }
+      for (const auto& file : description.GetProvidedTemporaryFiles()) {
+        files.insert(file);
+      }
+      for (const auto& file : description.GetProvidedAnalysisFiles()) {
+        files.insert(file);
+      }
 
-        maxVMUsage=std::max(maxVMUsage,vmUsage);
-        maxResidentSet=std::max(maxResidentSet,residentSet);
+      return files;
+    };
 
-        if (vmUsage!=0.0 || residentSet!=0.0) {
-          progress.Info(std::string("=> ")+timer.ResultString()+"s, RSS "+ByteSizeToString(residentSet)+", VM "+ByteSizeToString(vmUsage));
-        }
-        else {
-          progress.Info(std::string("=> ")+timer.ResultString()+"s");
+    auto intersects=[](const std::set<std::string>& a,
+                       const std::set<std::string>& b) {
+      for (const auto& file : a) {
+        if (b.find(file)!=b.end()) {
+          return true;
         }
+      }
 
-        if (!success) {
-          progress.Error("Error while executing step '"+moduleDescription.GetName()+"'!");
-          return false;
+      return false;
+    };
+
+    std::vector<std::set<std::string>> requiredFiles;
+    std::vector<std::set<std::string>> providedFiles;
+
+    for (size_t step=parameter.GetStartStep()-1;
+         step<std::min(parameter.GetEndStep(),moduleDescriptions.size());
+         step++) {
+      const ImportModuleDescription& description=moduleDescriptions[step];
+      ModuleExecution                execution;
+
+      std::list<std::string>         required=description.GetRequiredFiles();
+
+      requiredFiles.emplace_back(required.begin(),
+                                 required.end());
+      providedFiles.push_back(getProvidedFiles(description));
+
+      execution.step=step;
+
+      for (size_t dependency=0; dependency<executions.size(); dependency++) {
+        if (intersects(requiredFiles.back(),providedFiles[dependency]) ||
+            intersects(providedFiles.back(),providedFiles[dependency]) ||
+            intersects(providedFiles.back(),requiredFiles[dependency])) {
+          execution.dependencies.push_back(dependency);
         }
+      }
 
-        if (parameter.IsEco()) {
-          if (!CleanupTemporaries(currentStep,
-                                  progress)) {
-            return false;
-          }
+      executions.push_back(execution);
+    }
+
+    return executions;
+  }
+
+  /**
+   * Print the start time and duration of each module and the critical path,
+   * the chain of dependent modules that determines the minimal overall time
+   * achievable by executing modules in parallel.
+   */
+  void Importer::DumpTimingReport(const std::vector<ModuleExecution>& executions,
+                                  double overallTime,
+                                  Progress& progress) const
+  {
+    std::vector<double> pathTime(executions.size(),0.0);
+    std::vector<size_t> pathPredecessor(executions.size(),executions.size());
+    double              moduleTime=0.0;
+    size_t              pathEnd=executions.size();
+
+    progress.SetStep("Timing report");
+
+    for (size_t i=0; i<executions.size(); i++) {
+      const ModuleExecution& execution=executions[i];
+
+      for (const auto dependency : execution.dependencies) {
+        if (pathTime[dependency]>pathTime[i]) {
+          pathTime[i]=pathTime[dependency];
+          pathPredecessor[i]=dependency;
         }
       }
 
-      currentStep++;
+      pathTime[i]+=execution.duration;
+      moduleTime+=execution.duration;
+
+      if (pathEnd==executions.size() ||
+          pathTime[i]>pathTime[pathEnd]) {
+        pathEnd=i;
+      }
+
+      progress.Info("Step #"+std::to_string(execution.step+1)+" - "+moduleDescriptions[execution.step].GetName()+
+                    ": start "+SecondsToString(execution.startTime)+"s, duration "+SecondsToString(execution.duration)+"s");
+    }
+
+    if (pathEnd==executions.size()) {
+      return;
+    }
+
+    std::list<std::string> path;
+
+    for (size_t i=pathEnd; i<executions.size(); i=pathPredecessor[i]) {
+      path.push_front(moduleDescriptions[executions[i].step].GetName());
+    }
+
+    std::string pathString;
+
+    for (const auto& name : path) {
+      if (!pathString.empty()) {
+        pathString+=" -> ";
+      }
+
+      pathString+=name;
+    }
+
+    progress.Info("Critical path "+SecondsToString(pathTime[pathEnd])+"s: "+pathString);
+    progress.Info("Sum of module times "+SecondsToString(moduleTime)+"s, overall "+SecondsToString(overallTime)+"s");
+  }
+
+  bool Importer::ExecuteModulesSequential(const TypeConfigRef& typeConfig,
+                                          std::vector<ModuleExecution>& executions,
+                                          Progress& progress)
+  {
+    auto              importStart=std::chrono::steady_clock::now();
+    StopClock         overAllTimer;
+    MemoryMonitor     monitor;
+    double            maxVMUsage=0.0;
+    double            maxResidentSet=0.0;
+    std::vector<bool> finishedSteps(modules.size(),false);
+
+    for (size_t step=0; step+1<parameter.GetStartStep() && step<finishedSteps.size(); step++) {
+      finishedSteps[step]=true;
+    }
+
+    for (auto& execution : executions) {
+      size_t                         currentStep=execution.step+1;
+      const ImportModuleDescription& moduleDescription=moduleDescriptions[execution.step];
+      StopClock                      timer;
+      bool                           success;
+      double                         vmUsage;
+      double                         residentSet;
+
+      progress.SetStep("Step #"+
+                       std::to_string(currentStep)+
+                       " - "+
+                       moduleDescription.GetName());
+      progress.Info("Module description: "+moduleDescription.GetDescription());
+
+      monitor.Reset();
+
+      DumpModuleDescription(moduleDescription,
+                            progress);
+
+      execution.startTime=std::chrono::duration<double>(std::chrono::steady_clock::now()-importStart).count();
+
+      success=modules[execution.step]->Import(typeConfig,
+                                              parameter,
+                                              progress);
+
+      timer.Stop();
+
+      execution.duration=timer.GetMilliseconds()/1000.0;
+      execution.finished=true;
+      finishedSteps[execution.step]=true;
+
+      monitor.GetMaxValue(vmUsage,residentSet);
+
+      maxVMUsage=std::max(maxVMUsage,vmUsage);
+      maxResidentSet=std::max(maxResidentSet,residentSet);
+
+      if (vmUsage!=0.0 || residentSet!=0.0) {
+        progress.Info(std::string("=> ")+timer.ResultString()+"s, RSS "+ByteSizeToString(residentSet)+", VM "+ByteSizeToString(vmUsage));
+      }
+      else {
+        progress.Info(std::string("=> ")+timer.ResultString()+"s");
+      }
+
+      if (!success) {
+        progress.Error("Error while executing step '"+moduleDescription.GetName()+"'!");
+        return false;
+      }
+
+      if (parameter.IsEco()) {
+        if (!CleanupTemporaries(currentStep,
+                                finishedSteps,
+                                progress)) {
+          return false;
+        }
+      }
     }
 
     overAllTimer.Stop();
@@ -1089,29 +1574,212 @@ namespace osmscout {
       progress.Info(std::string("Overall ")+overAllTimer.ResultString()+"s");
     }
 
+    DumpTimingReport(executions,
+                     overAllTimer.GetMilliseconds()/1000.0,
+                     progress);
+
     return true;
   }
 
-  bool Importer::Import(Progress& progress)
-  {
-    TypeConfigRef typeConfig(std::make_shared<TypeConfig>());
+  /**
+   * Execute the modules in parallel, respecting their dependencies. A module
+   * is started as soon as all modules it depends on have finished and less
+   * than the maximum number of parallel modules are running. If a module
+   * fails, no further modules are started.
+   *
+   * Every module running besides the first one takes a worker from the default
+   * WorkerBudget (if available), so that ProcessInParallel() calls within the
+   * modules start correspondingly fewer threads.
+   */
+  bool Importer::ExecuteModulesParallel(const TypeConfigRef& typeConfig,
+                                        std::vector<ModuleExecution>& executions,
+                                        Progress& progress)
+  {
+    auto                     importStart=std::chrono::steady_clock::now();
+    StopClock                overAllTimer;
+    MemoryMonitor            monitor;
+    std::mutex               mutex;
+    std::condition_variable  finishedCondition;
+    std::vector<std::thread> threads;
+    std::vector<bool>        finishedSteps(modules.size(),false);
+    std::vector<size_t>      grantedWorkers(executions.size(),0);
+    size_t                   runningCount=0;
+    size_t                   finishedCount=0;
+    bool                     success=true;
+
+    for (size_t step=0; step+1<parameter.GetStartStep() && step<finishedSteps.size(); step++) {
+      finishedSteps[step]=true;
+    }
 
-    if (!ValidateDescription(progress)) {
-      return false;
+    auto executeModule=[&](size_t index) {
+      ModuleExecution&               execution=executions[index];
+      const ImportModuleDescription& moduleDescription=moduleDescriptions[execution.step];
+      ModuleProgress                 moduleProgress(progress,
+                                                    progressMutex,
+                                                    moduleDescription.GetName());
+      StopClock                      timer;
+      bool                           moduleSuccess;
+
+      moduleProgress.Info("Module description: "+moduleDescription.GetDescription());
+
+      DumpModuleDescription(moduleDescription,
+                            moduleProgress);
+
+      try {
+        moduleSuccess=modules[execution.step]->Import(typeConfig,
+                                                      parameter,
+                                                      moduleProgress);
+      }
+      catch (const std::exception& e) {
+        moduleProgress.Error(e.what());
+        moduleSuccess=false;
+      }
+
+      timer.Stop();
+
+      moduleProgress.Info(std::string("=> ")+timer.ResultString()+"s");
+
+      if (!moduleSuccess) {
+        moduleProgress.Error("Error while executing step '"+moduleDescription.GetName()+"'!");
+      }
+
+      WorkerBudget::GetDefault().Release(grantedWorkers[index]);
+
+      std::lock_guard<std::mutex> lock(mutex);
+
+      execution.duration=timer.GetMilliseconds()/1000.0;
+      execution.running=false;
+      execution.finished=true;
+      finishedSteps[execution.step]=true;
+
+      if (moduleSuccess &&
+          success &&
+          parameter.IsEco()) {
+        moduleSuccess=CleanupTemporaries(execution.step+1,
+                                         finishedSteps,
+                                         moduleProgress);
+      }
+
+      success=success && moduleSuccess;
+      runningCount--;
+      finishedCount++;
+
+      finishedCondition.notify_one();
+    };
+
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+
+      while (finishedCount<executions.size()) {
+        if (success) {
+          for (size_t index=0; index<executions.size() && runningCount<parameter.GetMaxParallelModules(); index++) {
+            ModuleExecution& execution=executions[index];
+
+            if (execution.running ||
+                execution.finished) {
+              continue;
+            }
+
+            bool ready=std::all_of(execution.dependencies.begin(),
+                                   execution.dependencies.end(),
+                                   [&executions](size_t dependency) {
+                                     return executions[dependency].finished;
+                                   });
+
+            if (!ready) {
+              continue;
+            }
+
+            execution.running=true;
+            execution.startTime=std::chrono::duration<double>(std::chrono::steady_clock::now()-importStart).count();
+
+            if (runningCount>0) {
+              grantedWorkers[index]=WorkerBudget::GetDefault().Acquire(1);
+            }
+
+            runningCount++;
+
+            {
+              std::lock_guard<std::mutex> progressLock(progressMutex);
+
+              progress.SetStep("Step #"+
+                               std::to_string(execution.step+1)+
+                               " - "+
+                               moduleDescriptions[execution.step].GetName()+
+                               " ("+std::to_string(runningCount)+" running)");
+            }
+
+            threads.emplace_back(executeModule,index);
+          }
+        }
+
+        if (runningCount==0) {
+          // Either everything is finished or we stopped because of an error
+          break;
+        }
+
+        finishedCondition.wait(lock);
+      }
     }
 
-    if (!ValidateParameter(progress)) {
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    if (!success) {
       return false;
     }
 
-    progress.SetStep("Loading type config");
+    overAllTimer.Stop();
+
+    double vmUsage;
+    double residentSet;
+
+    monitor.GetMaxValue(vmUsage,residentSet);
+
+    if (vmUsage!=0.0 || residentSet!=0.0) {
+      progress.Info(std::string("Overall ")+overAllTimer.ResultString()+"s, RSS "+ByteSizeToString(residentSet)+", VM "+ByteSizeToString(vmUsage));
+    }
+    else {
+      progress.Info(std::string("Overall ")+overAllTimer.ResultString()+"s");
+    }
+
+    DumpTimingReport(executions,
+                     overAllTimer.GetMilliseconds()/1000.0,
+                     progress);
+
+    return true;
+  }
+
+  bool Importer::ExecuteModules(const TypeConfigRef& typeConfig,
+                                Progress& progress)
+  {
+    std::vector<ModuleExecution> executions=GetModuleExecutions();
+
+    if (parameter.GetMaxParallelModules()<=1) {
+      return ExecuteModulesSequential(typeConfig,
+                                      executions,
+                                      progress);
+    }
+
+    return ExecuteModulesParallel(typeConfig,
+                                  executions,
+                                  progress);
+  }
 
-    if (!typeConfig->LoadFromOSTFile(parameter.GetTypefile())) {
+  /**
+   * Load the type configuration from the type file and register the
+   * name tags for the configured languages
+   */
+  bool Importer::LoadTypeConfig(TypeConfig& typeConfig,
+                                Progress& progress)
+  {
+    if (!typeConfig.LoadFromOSTFile(parameter.GetTypefile())) {
       progress.Error("Cannot load type configuration!");
       return false;
     }
 
-    DumpTypeConfigData(*typeConfig,
+    DumpTypeConfigData(typeConfig,
                        progress);
 
     progress.Info("Parsed language(s) :");
@@ -1119,14 +1787,14 @@ namespace osmscout {
     for(const auto& lang : parameter.GetLangOrder()){
       if(lang=="#"){
         progress.Info("  default");
-        typeConfig->GetTagRegistry().RegisterNameTag("name", langIndex);
-        typeConfig->GetTagRegistry().RegisterNameTag("place_name", langIndex+1);
-        typeConfig->GetTagRegistry().RegisterNameTag("brand", langIndex+2);
+        typeConfig.GetTagRegistry().RegisterNameTag("name", langIndex);
+        typeConfig.GetTagRegistry().RegisterNameTag("place_name", langIndex+1);
+        typeConfig.GetTagRegistry().RegisterNameTag("brand", langIndex+2);
       } else {
           progress.Info("  " + lang);
-          typeConfig->GetTagRegistry().RegisterNameTag("name:"+lang, langIndex);
-          typeConfig->GetTagRegistry().RegisterNameTag("place_name:"+lang, langIndex+1);
-          typeConfig->GetTagRegistry().RegisterNameTag("brand:"+lang, langIndex+2);
+          typeConfig.GetTagRegistry().RegisterNameTag("name:"+lang, langIndex);
+          typeConfig.GetTagRegistry().RegisterNameTag("place_name:"+lang, langIndex+1);
+          typeConfig.GetTagRegistry().RegisterNameTag("brand:"+lang, langIndex+2);
       }
       langIndex+=3;
     }
@@ -1136,19 +1804,46 @@ namespace osmscout {
     for(const auto& lang : parameter.GetAltLangOrder()){
       if(lang=="#"){
         progress.Info("  default");
-        typeConfig->GetTagRegistry().RegisterNameAltTag("name", langIndex);
-        typeConfig->GetTagRegistry().RegisterNameAltTag("place_name", langIndex+1);
-        typeConfig->GetTagRegistry().RegisterNameAltTag("brand", langIndex+2);
+        typeConfig.GetTagRegistry().RegisterNameAltTag("name", langIndex);
+        typeConfig.GetTagRegistry().RegisterNameAltTag("place_name", langIndex+1);
+        typeConfig.GetTagRegistry().RegisterNameAltTag("brand", langIndex+2);
       } else {
         progress.Info("  " + lang);
-        typeConfig->GetTagRegistry().RegisterNameAltTag("name:"+lang, langIndex);
-        typeConfig->GetTagRegistry().RegisterNameAltTag("place_name:"+lang, langIndex+1);
-        typeConfig->GetTagRegistry().RegisterNameAltTag("brand:"+lang, langIndex+2);
+        typeConfig.GetTagRegistry().RegisterNameAltTag("name:"+lang, langIndex);
+        typeConfig.GetTagRegistry().RegisterNameAltTag("place_name:"+lang, langIndex+1);
+        typeConfig.GetTagRegistry().RegisterNameAltTag("brand:"+lang, langIndex+2);
       }
       langIndex+=3;
     }
 
-    ImportErrorReporterRef errorReporter=std::make_shared<ImportErrorReporter>(progress,
+    return true;
+  }
+
+  bool Importer::Import(Progress& progress)
+  {
+    TypeConfigRef typeConfig(std::make_shared<TypeConfig>());
+
+    if (!ValidateDescription(progress)) {
+      return false;
+    }
+
+    if (!ValidateParameter(progress)) {
+      return false;
+    }
+
+    progress.SetStep("Loading type config");
+
+    if (!LoadTypeConfig(*typeConfig,
+                        progress)) {
+      return false;
+    }
+
+    // Modules may run in parallel, so reports must be serialized with the
+    // output of the modules
+    ModuleProgress         reporterProgress(progress,
+                                            progressMutex,
+                                            "");
+    ImportErrorReporterRef errorReporter=std::make_shared<ImportErrorReporter>(reporterProgress,
                                                                                typeConfig,
                                                                                parameter.GetDestinationDirectory());
 
@@ -1157,6 +1852,12 @@ namespace osmscout {
     bool result=ExecuteModules(typeConfig,
                                progress);
 
+    if (result &&
+        parameter.GetCompressDataFiles() &&
+        parameter.GetEndStep()>=defaultEndStep) {
+      result=CompressDataFiles(progress);
+    }
+
     parameter.GetErrorReporter()->FinishedImport();
 
     parameter.SetErrorReporter(nullptr);
@@ -1164,6 +1865,88 @@ namespace osmscout {
     return result;
   }
 
+  /**
+   * Converts the final node, way, area and route node data files into
+   * block compressed files (see \ref BlockCompression). Readers access
+   * them unchanged, since FileScanner decompresses transparently and
+   * file offsets stay the same.
+   */
+  bool Importer::CompressDataFiles(Progress& progress)
+  {
+    std::list<std::string> filenames={NodeDataFile::NODES_DAT,
+                                      WayDataFile::WAYS_DAT,
+                                      AreaDataFile::AREAS_DAT};
+
+    for (const auto& router : parameter.GetRouter()) {
+      filenames.push_back(router.GetDataFilename());
+    }
+
+    progress.SetStep("Compressing data files");
+
+    for (const auto& filename : filenames) {
+      std::string path=AppendFileToDir(parameter.GetDestinationDirectory(),
+                                       filename);
+
+      try {
+        if (!ExistsInFilesystem(path)) {
+          continue;
+        }
+
+        FileOffset uncompressedSize=GetFileSize(path);
+
+        CompressFile(path,
+                     (uint32_t)parameter.GetCompressionBlockSize(),
+                     6);
+
+        FileOffset compressedSize=GetFileSize(path);
+
+        progress.Info("Compressed '"+filename+"' from "+
+                      ByteSizeToString(uncompressedSize)+" to "+
+                      ByteSizeToString(compressedSize));
+      }
+      catch (IOException& e) {
+        progress.Error(e.GetDescription());
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Applies the change files (*.osc) given as map files to the existing
+   * database in the destination directory, instead of doing a full import.
+   * See ChangeFileUpdater for what is updated.
+   */
+  bool Importer::Update(Progress& progress)
+  {
+    TypeConfigRef typeConfig(std::make_shared<TypeConfig>());
+
+    progress.SetStep("Loading type config");
+
+    if (!LoadTypeConfig(*typeConfig,
+                        progress)) {
+      return false;
+    }
+
+    for (const auto& filename : parameter.GetMapfiles()) {
+      ChangeFileUpdater             updater;
+      ChangeFileUpdater::Statistics statistics;
+
+      progress.SetStep("Applying change file '"+filename+"'");
+
+      if (!updater.Update(typeConfig,
+                          parameter,
+                          progress,
+                          filename,
+                          statistics)) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
   std::list<std::string> Importer::GetProvidedFiles() const
   {
     std::set<std::string> providedFileSet;
@@ -420,8 +420,9 @@ namespace osmscout {
 
     ctxt=xmlCreatePushParserCtxt(&saxParser,&parser,chars,res,nullptr);
 
-    // Resolve entities, do not do any network communication
-    xmlCtxtUseOptions(ctxt,XML_PARSE_NOENT|XML_PARSE_NONET);
+    // Resolve entities, do not do any network communication, use the SAX1
+    // callbacks (newer libxml2 versions otherwise only call the SAX2 callbacks)
+    xmlCtxtUseOptions(ctxt,XML_PARSE_NOENT|XML_PARSE_NONET|XML_PARSE_SAX1);
 
     while ((res=fread(chars,1,sizeof(chars),file))>0) {
       if (xmlParseChunk(ctxt,chars,res,0)!=0) {
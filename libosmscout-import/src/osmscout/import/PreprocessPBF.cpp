@@ -22,7 +22,10 @@
 #include <osmscout/private/Config.h>
 #include <osmscout/import/ImportFeatures.h>
 
+#include <algorithm>
 #include <cstdio>
+#include <exception>
+#include <thread>
 
 #if defined(HAVE_FCNTL_H)
   #include <fcntl.h>
@@ -41,6 +44,7 @@
 
 #include <osmscout/util/File.h>
 #include <osmscout/util/String.h>
+#include <osmscout/util/WorkQueue.h>
 
 #define MAX_BLOCK_HEADER_SIZE (64*1024)
 #define MAX_BLOB_SIZE         (32*1024*1024)
@@ -90,7 +94,7 @@ namespace osmscout {
       bufferSize=length;
     }
     else if (bufferSize<length) {
-      delete buffer;
+      delete [] buffer;
       buffer=new char[length];
       bufferSize=length;
     }
@@ -121,7 +125,6 @@ namespace osmscout {
 
     if (fread(buffer,sizeof(char),length,file)!=length) {
       progress.Error("Cannot read block header!");
-      delete[] buffer;
       return false;
     }
 
@@ -210,12 +213,14 @@ namespace osmscout {
     return true;
   }
 
-  bool PreprocessPBF::ReadPrimitiveBlock(Progress& progress,
-                                         FILE* file,
-                                         const OSMPBF::BlobHeader& blockHeader,
-                                         OSMPBF::PrimitiveBlock& primitiveBlock)
+  /**
+   * Read the raw (still encoded) blob following the given block header
+   */
+  bool PreprocessPBF::ReadBlob(Progress& progress,
+                               FILE* file,
+                               const OSMPBF::BlobHeader& blockHeader,
+                               std::string& blob)
   {
-    OSMPBF::Blob            blob;
     google::protobuf::int32 length=blockHeader.datasize();
 
     if (length==0 || length>MAX_BLOB_SIZE) {
@@ -223,74 +228,20 @@ namespace osmscout {
       return false;
     }
 
-    AssureBlockSize(length);
+    blob.resize((size_t)length);
 
-    if (fread(buffer,sizeof(char),length,file)!=(size_t)length) {
+    if (fread(&blob[0],sizeof(char),length,file)!=(size_t)length) {
       progress.Error("Cannot read blob!");
       return false;
     }
 
-    if (!blob.ParseFromArray(buffer,length)) {
-      progress.Error("Cannot parse blob!");
-      return false;
-    }
-
-    if (blob.has_raw()) {
-      length=(uint32_t)blob.raw().length();
-      AssureBlockSize(length);
-      memcpy(buffer,blob.raw().data(),(size_t)length);
-    }
-    else if (blob.has_zlib_data()) {
-#if defined(HAVE_LIB_ZLIB) || defined(OSMSCOUT_IMPORT_HAVE_PROTOBUF_SUPPORT)
-      length=blob.raw_size();
-      AssureBlockSize(length);
-
-      z_stream compressedStream;
-
-      compressedStream.next_in=(Bytef*)const_cast<char*>(blob.zlib_data().data());
-      compressedStream.avail_in=(uint32_t)blob.zlib_data().size();
-      compressedStream.next_out=(Bytef*)buffer;
-      compressedStream.avail_out=(uInt)length;
-      compressedStream.zalloc=Z_NULL;
-      compressedStream.zfree=Z_NULL;
-      compressedStream.opaque=Z_NULL;
-
-      if (inflateInit( &compressedStream)!=Z_OK) {
-        progress.Error("Cannot decode zlib compressed blob data!");
-        return false;
-      }
-
-      if (inflate(&compressedStream,Z_FINISH)!=Z_STREAM_END) {
-        progress.Error("Cannot decode zlib compressed blob data!");
-        return false;
-      }
-
-      if (inflateEnd(&compressedStream)!=Z_OK) {
-        progress.Error("Cannot decode zlib compressed blob data!");
-        return false;
-      }
-#else
-      progress.Error("Data is zlib encoded but zlib support is not enabled!");
-      return false;
-#endif
-    }
-    else if (blob.has_lzma_data()) {
-      progress.Error("Data is lzma encoded but lzma support is not enabled!");
-      return false;
-    }
-
-    if (!primitiveBlock.ParseFromArray(buffer,length)) {
-      progress.Error("Cannot parse primitive block!");
-      return false;
-    }
-
     return true;
   }
 
   void PreprocessPBF::ReadNodes(const TypeConfig& typeConfig,
                                 const OSMPBF::PrimitiveBlock& block,
                                 const OSMPBF::PrimitiveGroup& group,
-                                PreprocessorCallback::RawBlockData& data)
+                                PreprocessorCallback::RawBlockData& data) const
   {
     data.nodeData.reserve(data.nodeData.size()+group.nodes_size());
 
@@ -303,8 +254,6 @@ namespace osmscout {
       nodeData.coord.Set((inputNode.lat()*block.granularity()+block.lat_offset())/NANO,
                          (inputNode.lon()*block.granularity()+block.lon_offset())/NANO);
 
-      tagMap.clear();
-
       for (int t=0; t<inputNode.keys_size(); t++) {
         TagId id=typeConfig.GetTagId(block.stringtable().s(inputNode.keys(t)));
 
@@ -320,7 +269,7 @@ namespace osmscout {
   void PreprocessPBF::ReadDenseNodes(const TypeConfig& typeConfig,
                                      const OSMPBF::PrimitiveBlock& block,
                                      const OSMPBF::PrimitiveGroup& group,
-                                     PreprocessorCallback::RawBlockData& data)
+                                     PreprocessorCallback::RawBlockData& data) const
   {
     const OSMPBF::DenseNodes& dense=group.dense();
     Id                        dId=0;
@@ -367,7 +316,7 @@ namespace osmscout {
   void PreprocessPBF::ReadWays(const TypeConfig& typeConfig,
                                const OSMPBF::PrimitiveBlock& block,
                                const OSMPBF::PrimitiveGroup& group,
-                               PreprocessorCallback::RawBlockData& data)
+                               PreprocessorCallback::RawBlockData& data) const
   {
     data.wayData.reserve(data.wayData.size()+group.ways_size());
 
@@ -402,7 +351,7 @@ namespace osmscout {
   void PreprocessPBF::ReadRelations(const TypeConfig& typeConfig,
                                     const OSMPBF::PrimitiveBlock& block,
                                     const OSMPBF::PrimitiveGroup& group,
-                                    PreprocessorCallback::RawBlockData& data)
+                                    PreprocessorCallback::RawBlockData& data) const
   {
     data.relationData.reserve(data.relationData.size()+group.relations_size());
 
@@ -413,8 +362,6 @@ namespace osmscout {
 
       relationData.id=inputRelation.id();
 
-      members.clear();
-
       for (int t=0; t<inputRelation.keys_size(); t++) {
         TagId id=typeConfig.GetTagId(block.stringtable().s(inputRelation.keys(t)));
 
@@ -456,57 +403,154 @@ namespace osmscout {
   PreprocessPBF::PreprocessPBF(PreprocessorCallback& callback)
   : buffer(nullptr),
     bufferSize(0),
-    callback(callback)
+    callback(callback),
+    handoffError(false)
   {
     // no code
   }
 
   PreprocessPBF::~PreprocessPBF()
   {
-    delete buffer;
+    delete [] buffer;
   }
 
-  void PreprocessPBF::ProcessBlock(const TypeConfigRef& typeConfig,
-                                   std::unique_ptr<OSMPBF::PrimitiveBlock>&& block)
+  /**
+   * Inflate and parse the given blob and convert it to RawBlockData.
+   *
+   * Called concurrently by the decoder threads, so it must not touch any
+   * (non-const) member state.
+   *
+   * @throws IOException
+   */
+  PreprocessorCallback::RawBlockDataRef PreprocessPBF::DecodeBlock(const TypeConfigRef& typeConfig,
+                                                                   const std::string& filename,
+                                                                   const BlobRef& rawBlob) const
   {
+    OSMPBF::Blob           blob;
+    OSMPBF::PrimitiveBlock block;
+
+    if (!blob.ParseFromString(*rawBlob)) {
+      throw IOException(filename,"Cannot parse blob","Invalid data");
+    }
+
+    if (blob.has_raw()) {
+      if (!block.ParseFromString(blob.raw())) {
+        throw IOException(filename,"Cannot parse primitive block","Invalid data");
+      }
+    }
+    else if (blob.has_zlib_data()) {
+#if defined(HAVE_LIB_ZLIB) || defined(OSMSCOUT_IMPORT_HAVE_PROTOBUF_SUPPORT)
+      google::protobuf::int32 length=blob.raw_size();
+
+      if (length<=0 || length>MAX_BLOB_SIZE) {
+        throw IOException(filename,"Cannot decode zlib compressed blob data","Blob size invalid");
+      }
+
+      std::unique_ptr<char[]> data(new char[length]);
+      z_stream                compressedStream;
+
+      compressedStream.next_in=(Bytef*)const_cast<char*>(blob.zlib_data().data());
+      compressedStream.avail_in=(uint32_t)blob.zlib_data().size();
+      compressedStream.next_out=(Bytef*)data.get();
+      compressedStream.avail_out=(uInt)length;
+      compressedStream.zalloc=Z_NULL;
+      compressedStream.zfree=Z_NULL;
+      compressedStream.opaque=Z_NULL;
+
+      if (inflateInit( &compressedStream)!=Z_OK) {
+        throw IOException(filename,"Cannot decode zlib compressed blob data","Cannot initialize zlib");
+      }
+
+      if (inflate(&compressedStream,Z_FINISH)!=Z_STREAM_END) {
+        std::string error=compressedStream.msg!=nullptr ? compressedStream.msg : "Invalid data";
+
+        inflateEnd(&compressedStream);
+        throw IOException(filename,"Cannot decode zlib compressed blob data",error);
+      }
+
+      if (inflateEnd(&compressedStream)!=Z_OK) {
+        throw IOException(filename,"Cannot decode zlib compressed blob data","Invalid data");
+      }
+
+      if (!block.ParseFromArray(data.get(),length)) {
+        throw IOException(filename,"Cannot parse primitive block","Invalid data");
+      }
+#else
+      throw IOException(filename,"Cannot decode blob data","Data is zlib encoded but zlib support is not enabled");
+#endif
+    }
+    else if (blob.has_lzma_data()) {
+      throw IOException(filename,"Cannot decode blob data","Data is lzma encoded but lzma support is not enabled");
+    }
+
     PreprocessorCallback::RawBlockDataRef blockData(new PreprocessorCallback::RawBlockData());
 
     for (int currentGroup=0;
-         currentGroup<block->primitivegroup_size();
+         currentGroup<block.primitivegroup_size();
          currentGroup++) {
-      const OSMPBF::PrimitiveGroup &group=block->primitivegroup(currentGroup);
+      const OSMPBF::PrimitiveGroup &group=block.primitivegroup(currentGroup);
 
       if (group.nodes_size()>0) {
         ReadNodes(*typeConfig,
-                  *block,
+                  block,
                   group,
                   *blockData);
       }
       else if (group.has_dense()) {
         ReadDenseNodes(*typeConfig,
-                       *block,
+                       block,
                        group,
                        *blockData);
       }
       else if (group.ways_size()>0) {
         ReadWays(*typeConfig,
-                 *block,
+                 block,
                  group,
                  *blockData);
       }
       else if (group.relations_size()>0) {
         ReadRelations(*typeConfig,
-                      *block,
+                      block,
                       group,
                       *blockData);
       }
     }
 
-    callback.ProcessBlock(std::move(blockData));
+    return blockData;
+  }
+
+  /**
+   * Wait for the given block to be decoded and pass it to the callback.
+   * Blocks are handed off in the order they were read from the file.
+   *
+   * Nobody waits for the result of the handoff task, so any exception thrown
+   * while decoding or processing the block must be caught here and turned into
+   * a handoff error, else the import would silently miss the data of the block.
+   */
+  void PreprocessPBF::HandoffBlock(Progress& progress,
+                                   std::shared_future<PreprocessorCallback::RawBlockDataRef>& block)
+  {
+    try {
+      PreprocessorCallback::RawBlockDataRef blockData=block.get();
+
+      if (!handoffError) {
+        callback.ProcessBlock(std::move(blockData));
+      }
+    }
+    catch (IOException& e) {
+      if (!handoffError.exchange(true)) {
+        progress.Error(e.GetDescription());
+      }
+    }
+    catch (std::exception& e) {
+      if (!handoffError.exchange(true)) {
+        progress.Error(std::string("Cannot decode or process block: ")+e.what());
+      }
+    }
   }
 
   bool PreprocessPBF::Import(const TypeConfigRef& typeConfig,
-                             const ImportParameter& /*parameter*/,
+                             const ImportParameter& parameter,
                              Progress& progress,
                              const std::string& filename)
   {
@@ -565,19 +609,49 @@ namespace osmscout {
         }
       }
 
-      nodes.reserve(20000);
-      members.reserve(2000);
+      //
+      // Start the pipeline: this thread reads the raw blobs, the decoder threads
+      // decode them and the handoff thread passes them in file order to the callback.
+      // Both queues are bounded, so the reader blocks if decoding or processing is slower.
+      //
 
-      std::future<void> currentBlockTask;
+      size_t                                           decoderCount=std::max((unsigned int)1,std::thread::hardware_concurrency());
+      WorkQueue<PreprocessorCallback::RawBlockDataRef> decodeQueue(parameter.GetProcessingQueueSize());
+      WorkQueue<void>                                  handoffQueue(parameter.GetProcessingQueueSize());
+      std::vector<std::thread>                         decoderThreads;
 
-      while (true) {
+      progress.Info("Using "+std::to_string(decoderCount)+" block decoder threads");
+
+      handoffError=false;
+
+      for (size_t t=1; t<=decoderCount; t++) {
+        decoderThreads.emplace_back([&decodeQueue]() {
+          std::packaged_task<PreprocessorCallback::RawBlockDataRef()> task;
+
+          while (decodeQueue.PopTask(task)) {
+            task();
+          }
+        });
+      }
+
+      std::thread handoffThread([&handoffQueue]() {
+        std::packaged_task<void()> task;
+
+        while (handoffQueue.PopTask(task)) {
+          task();
+        }
+      });
+
+      bool success=true;
+
+      while (!handoffError) {
         OSMPBF::BlobHeader blockHeader;
 
         if (!GetPos(file,
                     currentPosition)) {
           progress.Error("Cannot read current position in '"+filename+"'!");
-          fclose(file);
-          return false;
+          success=false;
+          break;
         }
 
         progress.SetProgress(currentPosition,
@@ -587,38 +661,55 @@ namespace osmscout {
                              file,
                              blockHeader,
                              true)) {
-          fclose(file);
           break;
         }
 
         if (blockHeader.type()!="OSMData") {
           progress.Error("File '"+filename+"' is not valid (block header type is '"+blockHeader.type()+"' and not 'OSMData')!");
-          fclose(file);
-          return false;
+          success=false;
+          break;
         }
 
-        std::unique_ptr<OSMPBF::PrimitiveBlock> block(new OSMPBF::PrimitiveBlock());
+        BlobRef blob=std::make_shared<std::string>();
 
-        if (!ReadPrimitiveBlock(progress,
-                                file,
-                                blockHeader,
-                                *block)) {
-          fclose(file);
-          return false;
+        if (!ReadBlob(progress,
+                      file,
+                      blockHeader,
+                      *blob)) {
+          success=false;
+          break;
         }
 
-        if (currentBlockTask.valid()) {
-          currentBlockTask.get();
-        }
+        std::packaged_task<PreprocessorCallback::RawBlockDataRef()> decodeTask(std::bind(&PreprocessPBF::DecodeBlock,this,
+                                                                                         typeConfig,
+                                                                                         filename,
+                                                                                         blob));
+        // See Preprocess::Callback::ProcessBlock() for the reason of using shared_future
+        std::shared_future<PreprocessorCallback::RawBlockDataRef> decodeResult(decodeTask.get_future());
+
+        decodeQueue.PushTask(decodeTask);
 
-        currentBlockTask=std::async(std::launch::async,
-                                    &PreprocessPBF::ProcessBlock,this,
-                                    typeConfig,
-                                    std::move(block));
+        std::packaged_task<void()> handoffTask(std::bind(&PreprocessPBF::HandoffBlock,this,
+                                                         std::ref(progress),
+                                                         decodeResult));
+
+        handoffQueue.PushTask(handoffTask);
+      }
+
+      fclose(file);
+
+      decodeQueue.Stop();
+
+      for (auto& thread : decoderThreads) {
+        thread.join();
       }
 
-      if (currentBlockTask.valid()) {
-        currentBlockTask.get();
+      handoffQueue.Stop();
+      handoffThread.join();
+
+      if (!success ||
+          handoffError) {
+        return false;
       }
     }
     catch (IOException& e) {
@@ -629,4 +720,3 @@ namespace osmscout {
     return true;
   }
 }
-
@@ -21,6 +21,8 @@
 
 #include <iostream>
 #include <iomanip>
+#include <numeric>
+#include <unordered_map>
 
 #include <osmscout/TypeFeatures.h>
 #include <osmscout/WaterIndex.h>
@@ -32,6 +34,8 @@
 #include <osmscout/util/StopClock.h>
 #include <osmscout/util/Geometry.h>
 
+#include <osmscout/import/Import.h>
+
 #if !defined(DEBUG_COASTLINE)
 //#define DEBUG_COASTLINE
 #endif
@@ -103,6 +107,14 @@ namespace osmscout {
     area[index]=(area[index] | (state << offset));
   }
 
+  /**
+   * Free the memory of the cell states. Only the dimensions of the map stay valid.
+   */
+  void WaterIndexProcessor::StateMap::Release()
+  {
+    std::vector<uint8_t>().swap(area);
+  }
+
   std::string WaterIndexProcessor::StateToString(State state) const
   {
     switch (state) {
@@ -1116,18 +1128,17 @@ namespace osmscout {
   {
     progress.Info("Calculate coastline data");
 
-    int                           index=-1;
-    std::vector<CoastlineDataRef> transformedCoastlines;
-    std::vector<CoastRef>         coasts;
-
-    transformedCoastlines.resize(coastlines.size());
-    coasts.resize(coastlines.size());
+    std::vector<CoastlineDataRef> transformedCoastlines(coastlines.size());
+    std::vector<CoastRef>         coasts(coastlines.size());
+    std::vector<CoastRef>         sourceCoasts(coastlines.begin(),coastlines.end());
+    std::vector<size_t>           indexes(coastlines.size());
 
-    for (const auto& coast : coastlines) {
-      index++;
-      progress.SetProgress(index,coastlines.size());
+    std::iota(indexes.begin(),indexes.end(),0);
 
-      TransPolygon polygon;
+    // Coastlines are transformed independently of each other
+    ProcessInParallel(indexes,[&](size_t index) {
+      const CoastRef& coast=sourceCoasts[index];
+      TransPolygon    polygon;
 
       // For areas we first transform the bounding box to make sure, that
       // the area coastline will be big enough to be actually visible
@@ -1163,7 +1174,7 @@ namespace osmscout {
         // Artificial values but for drawing an area a box of at least 4x4 might make sense
         if (pixelWidth<=minObjectDimension ||
             pixelHeight<=minObjectDimension) {
-          continue;
+          return;
         }
       }
 
@@ -1204,13 +1215,13 @@ namespace osmscout {
 
         if (coastline->points.size()<=3) {
           // ignore island reduced just to line
-          continue;
+          return;
         }
       }
 
       transformedCoastlines[index]=coastline;
       coasts[index]=coast;
-    }
+    });
 
     /* In some countries are islands too close to land or other islands
      * that its coastlines intersect after polygon optimisation.
@@ -1285,6 +1296,42 @@ namespace osmscout {
     }
 
     progress.Info("Calculate covered tiles");
+
+    std::vector<size_t> crossingIndexes;
+
+    for (size_t index=0; index<transformedCoastlines.size(); index++) {
+      if (transformedCoastlines[index]) {
+        crossingIndexes.push_back(index);
+      }
+    }
+
+    // Calculate all intersections for all path steps for all cells covered,
+    // for all coastlines in parallel. Coastlines completely within one cell
+    // do not have any intersections.
+    ProcessInParallel(crossingIndexes,[&](size_t index) {
+      const CoastlineDataRef& coastline=transformedCoastlines[index];
+      GeoBox                  boundingBox;
+
+      GetBoundingBox(coasts[index]->coast,
+                     boundingBox);
+
+      uint32_t cxMin=(uint32_t)floor((boundingBox.GetMinLon()+180.0)/stateMap.GetCellWidth());
+      uint32_t cxMax=(uint32_t)floor((boundingBox.GetMaxLon()+180.0)/stateMap.GetCellWidth());
+      uint32_t cyMin=(uint32_t)floor((boundingBox.GetMinLat()+90.0)/stateMap.GetCellHeight());
+      uint32_t cyMax=(uint32_t)floor((boundingBox.GetMaxLat()+90.0)/stateMap.GetCellHeight());
+
+      if (cxMin!=cxMax ||
+          cyMin!=cyMax) {
+        // The running number of the coastline is the number of preceding coastlines not filtered out
+        size_t curCoast=std::lower_bound(crossingIndexes.begin(),crossingIndexes.end(),index)-crossingIndexes.begin();
+
+        GetCellIntersections(stateMap,
+                             coastline->points,
+                             curCoast,
+                             coastline->cellIntersections);
+      }
+    });
+
     size_t curCoast=0;
 
     data.coastlines.resize(transformedCoastlines.size());
@@ -1329,12 +1376,6 @@ namespace osmscout {
       else {
         coastline->isCompletelyInCell=false;
 
-        // Calculate all intersections for all path steps for all cells covered
-        GetCellIntersections(stateMap,
-                             coastline->points,
-                             curCoast,
-                             coastline->cellIntersections);
-
         for (const auto& intersectionEntry : coastline->cellIntersections) {
           data.cellCoastlines[intersectionEntry.first].push_back(curCoast);
         }
@@ -1608,7 +1649,7 @@ namespace osmscout {
                                              const CellBoundaries& cellBoundaries,
                                              IntersectionRef& pathStart, // incoming path
                                              IntersectionRef& pathEnd,
-                                             Data& data,
+                                             const Data& data,
                                              const std::list<IntersectionRef>& intersectionsCW,
                                              const std::vector<size_t>& containingPaths)
   {
@@ -1782,7 +1823,7 @@ namespace osmscout {
                                            const std::list<IntersectionRef>& intersectionsCW,
                                            std::set<IntersectionRef>& visitedIntersections,
                                            const CellBoundaries& cellBoundaries,
-                                           Data& data,
+                                           const Data& data,
                                            const std::vector<size_t>& containingPaths)
   {
 #if defined(DEBUG_COASTLINE)
@@ -1894,8 +1935,8 @@ namespace osmscout {
                                                 const Pixel &cell,
                                                 const std::list<size_t>& intersectCoastlines,
                                                 const StateMap& stateMap,
-                                                std::map<Pixel,std::list<GroundTile> >& cellGroundTileMap,
-                                                Data& data)
+                                                std::list<GroundTile>& groundTiles,
+                                                const Data& data)
   {
       std::list<IntersectionRef> intersectionsCW;        // Intersections in clock wise order over all coastlines
       std::set<IntersectionRef>  visitedIntersections;
@@ -1904,7 +1945,7 @@ namespace osmscout {
       // For every coastline by index intersecting the current cell
       for (const auto& currentCoastline : intersectCoastlines) {
         CoastlineDataRef coastData=data.coastlines[currentCoastline];
-        std::map<Pixel,std::list<IntersectionRef>>::iterator cellData=coastData->cellIntersections.find(cell);
+        const auto       cellData=coastData->cellIntersections.find(cell);
 
         assert(cellData!=coastData->cellIntersections.end());
 
@@ -1978,7 +2019,7 @@ namespace osmscout {
             continue;
         }
 
-        cellGroundTileMap[cell].push_back(groundTile);
+        groundTiles.push_back(groundTile);
       }
   }
 
@@ -1992,22 +2033,52 @@ namespace osmscout {
   {
     progress.Info("Handle coastlines partially in a cell");
 
-    // For every cell with intersections
-    size_t currentCell=0;
+    struct CellJob
+    {
+      const Pixel&                      cell;
+      const std::list<size_t>&          intersectCoastlines;
+      std::list<GroundTile>             groundTiles;
+      std::unique_ptr<BufferedProgress> progress;
+    };
+
+    std::vector<CellJob> jobs;
+    std::vector<size_t>  indexes(data.cellCoastlines.size());
+
+    jobs.reserve(data.cellCoastlines.size());
+
     for (const auto& cellEntry : data.cellCoastlines) {
-      progress.SetProgress(currentCell,data.cellCoastlines.size());
-      currentCell++;
+      jobs.push_back(CellJob{cellEntry.first,
+                             cellEntry.second,
+                             std::list<GroundTile>(),
+                             std::unique_ptr<BufferedProgress>(new BufferedProgress(progress.OutputDebug()))});
+    }
+
+    std::iota(indexes.begin(),indexes.end(),0);
+
+    // Cells only read the coastline data and can be handled independently
+    ProcessInParallel(indexes,[&](size_t index) {
+      CellJob& job=jobs[index];
 
 #if defined(DEBUG_COASTLINE)
-      std::cout << " - cell " << cellEntry.first.x << " " << cellEntry.first.y << "): " << std::endl;
+      std::cout << " - cell " << job.cell.x << " " << job.cell.y << "): " << std::endl;
 #endif
 
-      HandleCoastlineCell(progress,
-                          cellEntry.first,
-                          cellEntry.second,
+      HandleCoastlineCell(*job.progress,
+                          job.cell,
+                          job.intersectCoastlines,
                           stateMap,
-                          cellGroundTileMap,
+                          job.groundTiles,
                           data);
+    });
+
+    for (auto& job : jobs) {
+      job.progress->Flush(progress);
+
+      if (!job.groundTiles.empty()) {
+        std::list<GroundTile>& groundTiles=cellGroundTileMap[job.cell];
+
+        groundTiles.splice(groundTiles.end(),job.groundTiles);
+      }
     }
   }
 
@@ -2376,13 +2447,20 @@ namespace osmscout {
     if (level.hasCellData) {
 
       //
-      // Calculate size of data
+      // Calculate size of data and the offset of the data of each cell
       //
 
-      size_t dataSize=4;
-      char   buffer[10];
+      size_t                                  dataSize=4;
+      char                                    buffer[10];
+      std::unordered_map<uint32_t,FileOffset> cellDataOffsets;
+
+      cellDataOffsets.reserve(cellGroundTileMap.size());
 
       for (const auto& coord : cellGroundTileMap) {
+        uint32_t cellId=coord.first.y*level.stateMap.GetXCount()+coord.first.x;
+
+        cellDataOffsets[cellId]=dataSize;
+
         // Number of ground tiles
         dataSize+=EncodeNumber(coord.second.size(),buffer);
 
@@ -2408,17 +2486,25 @@ namespace osmscout {
                     ByteSizeToString(1.0*level.stateMap.GetXCount()*level.stateMap.GetYCount()*level.dataOffsetBytes+dataSize));
 
       //
-      // Write bitmap
+      // Write bitmap, cells with data reference their data instead of holding their state
       //
 
       level.indexDataOffset=writer.GetPos();
 
       for (uint32_t y=0; y<level.stateMap.GetYCount(); y++) {
         for (uint32_t x=0; x<level.stateMap.GetXCount(); x++) {
-          State state=level.stateMap.GetState(x,y);
+          auto cellDataOffset=cellDataOffsets.find(y*level.stateMap.GetXCount()+x);
+
+          if (cellDataOffset!=cellDataOffsets.end()) {
+            writer.WriteFileOffset(cellDataOffset->second,
+                                   level.dataOffsetBytes);
+          }
+          else {
+            State state=level.stateMap.GetState(x,y);
 
-          writer.WriteFileOffset((FileOffset) state,
-                                 level.dataOffsetBytes);
+            writer.WriteFileOffset((FileOffset) state,
+                                   level.dataOffsetBytes);
+          }
         }
       }
 
@@ -2426,14 +2512,10 @@ namespace osmscout {
       // Write data
       //
 
-      FileOffset dataOffset=writer.GetPos();
-
       // TODO: when data format will be changing, consider usage ones (0xFF..FF) as empty placeholder
       writer.WriteFileOffset((FileOffset)0,4);
 
       for (const auto& coord : cellGroundTileMap) {
-        FileOffset startPos=writer.GetPos();
-
         writer.WriteNumber((uint32_t) coord.second.size());
 
         for (const auto& tile : coord.second) {
@@ -2453,17 +2535,6 @@ namespace osmscout {
             writer.Write(coord.y);
           }
         }
-
-        FileOffset endPos;
-        uint32_t   cellId=coord.first.y*level.stateMap.GetXCount()+coord.first.x;
-        size_t     index =cellId*level.dataOffsetBytes;
-
-        endPos=writer.GetPos();
-
-        writer.SetPos(level.indexDataOffset+index);
-        writer.WriteFileOffset(startPos-dataOffset,
-                               level.dataOffsetBytes);
-        writer.SetPos(endPos);
       }
     }
     else {
@@ -59,13 +59,15 @@ namespace osmscout {
     std::vector<O>     data;
 
     bool               complete;
+    size_t             generation; //!< Incremented on every change of the actual data
 
   public:
     /**
      * Create an empty and unassigned TileData
      */
     TileData()
-    : complete(false)
+    : complete(false),
+      generation(0)
     {
       // no code
     }
@@ -112,6 +114,7 @@ namespace osmscout {
       }
 
       complete=false;
+      generation++;
     }
 
     /**
@@ -139,6 +142,7 @@ namespace osmscout {
       }
 
       complete=false;
+      generation++;
     }
 
     /**
@@ -153,6 +157,7 @@ namespace osmscout {
       this->types.Add(types);
 
       complete=true;
+      generation++;
     }
 
     /**
@@ -167,6 +172,7 @@ namespace osmscout {
       this->types=types;
 
       complete=true;
+      generation++;
     }
 
     /**
@@ -181,6 +187,7 @@ namespace osmscout {
       this->types=types;
 
       complete=true;
+      generation++;
     }
 
     /**
@@ -217,6 +224,18 @@ namespace osmscout {
       return types;
     }
 
+    /**
+     * Return the current generation of the data. The generation changes every time
+     * data is added to or replaced in the tile, so it can be used to detect
+     * changes since the last time the data was copied.
+     */
+    size_t GetGeneration() const
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+
+      return generation;
+    }
+
     size_t GetDataSize() const
     {
       std::lock_guard<std::mutex> guard(mutex);
@@ -399,6 +418,19 @@ namespace osmscout {
              optimizedAreaData.IsComplete();
     }
 
+    /**
+     * Return a value that changes every time data of any object type of the tile
+     * has been changed.
+     */
+    inline size_t GetGeneration() const
+    {
+      return nodeData.GetGeneration()+
+             wayData.GetGeneration()+
+             areaData.GetGeneration()+
+             optimizedWayData.GetGeneration()+
+             optimizedAreaData.GetGeneration();
+    }
+
     /**
      * Return 'true' if no data for any type has been assigned
      */
@@ -0,0 +1,218 @@
+#ifndef OSMSCOUT_INCREMENTALMAPDATA_H
+#define OSMSCOUT_INCREMENTALMAPDATA_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <list>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <osmscout/MapImportExport.h>
+
+#include <osmscout/DataTileCache.h>
+#include <osmscout/MapPainter.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Renderer
+   *
+   * MapData that can be updated incrementally from a changing list of tiles.
+   *
+   * MapService::AddTileDataToMapData() builds a complete new MapData instance
+   * from all given tiles. While panning the map most of the visible tiles stay the
+   * same between two frames, so rebuilding everything is wasted work.
+   * IncrementalMapData remembers the contribution of each tile and on Update()
+   * only removes the objects of tiles that are not visible anymore and adds
+   * the objects of newly visible (or changed) tiles. Objects that are part
+   * of multiple tiles are reference counted and stay in the MapData as long
+   * as at least one tile references them.
+   *
+   * The order of objects in the resulting MapData is not stable between
+   * updates, the MapPainter sorts data anyway.
+   *
+   * The class is not thread safe, the caller must take care that Update() and
+   * access to the MapData do not happen in parallel.
+   */
+  class OSMSCOUT_MAP_API IncrementalMapData CLASS_FINAL
+  {
+  private:
+    /**
+     * Reference counted, index based set of objects, that keeps its content
+     * in a flat vector (as expected by MapData). Removal is done by swapping the
+     * last element into the hole, so all operations are O(1).
+     */
+    template<typename O>
+    class ObjectList CLASS_FINAL
+    {
+    private:
+      struct Entry
+      {
+        size_t index;
+        size_t refCount;
+      };
+
+    private:
+      std::unordered_map<FileOffset,Entry> entries; //!< Key to position in vector
+      std::vector<FileOffset>              keys;    //!< Key of each object in the vector
+
+    private:
+      /**
+       * The key of an object is its file offset combined with the source, since offsets of
+       * objects from the low zoom optimization files may collide with offsets from the regular
+       * data files.
+       */
+      static inline FileOffset GetKey(const O& object,
+                                      bool optimized)
+      {
+        return (object->GetFileOffset() << 1) | (optimized ? 1 : 0);
+      }
+
+    public:
+      void Add(std::vector<O>& objects,
+               const O& object,
+               bool optimized)
+      {
+        FileOffset key=GetKey(object,optimized);
+        auto       entry=entries.find(key);
+
+        if (entry!=entries.end()) {
+          entry->second.refCount++;
+          return;
+        }
+
+        entries[key]=Entry{objects.size(),1};
+        keys.push_back(key);
+        objects.push_back(object);
+      }
+
+      void Remove(std::vector<O>& objects,
+                  const O& object,
+                  bool optimized)
+      {
+        FileOffset key=GetKey(object,optimized);
+        auto       entry=entries.find(key);
+
+        if (entry==entries.end()) {
+          return;
+        }
+
+        if (--entry->second.refCount>0) {
+          return;
+        }
+
+        size_t index=entry->second.index;
+        size_t last=objects.size()-1;
+
+        if (index!=last) {
+          objects[index]=std::move(objects[last]);
+          keys[index]=keys[last];
+          entries[keys[index]].index=index;
+        }
+
+        objects.pop_back();
+        keys.pop_back();
+        entries.erase(entry);
+      }
+
+      void Clear(std::vector<O>& objects)
+      {
+        entries.clear();
+        keys.clear();
+        objects.clear();
+      }
+    };
+
+    /**
+     * Objects a tile did contribute at the last Update()
+     */
+    struct TileState
+    {
+      TileRef              tile;
+      size_t               generation;
+      std::vector<NodeRef> nodes;
+      std::vector<WayRef>  ways;
+      std::vector<WayRef>  optimizedWays;
+      std::vector<AreaRef> areas;
+      std::vector<AreaRef> optimizedAreas;
+    };
+
+  private:
+    MapDataRef                  data;
+    std::map<TileKey,TileState> tileStates;
+    ObjectList<NodeRef>         nodes;
+    ObjectList<WayRef>          ways;
+    ObjectList<AreaRef>         areas;
+
+    size_t                      addedTiles;   //!< Number of tiles added during last update
+    size_t                      removedTiles; //!< Number of tiles removed during last update
+
+  private:
+    void AddTile(TileState& state);
+    void RemoveTile(TileState& state);
+
+  public:
+    IncrementalMapData();
+
+    bool Update(const std::list<TileRef>& tiles);
+    void Clear();
+
+    /**
+     * Return the MapData. The database related parts of the MapData (nodes, ways, areas)
+     * must not be modified by the caller. POI data and ground tiles are not touched
+     * by IncrementalMapData and can be freely changed.
+     */
+    inline MapDataRef GetMapData() const
+    {
+      return data;
+    }
+
+    /**
+     * Return the number of tiles, that have been (re)added during the last update
+     */
+    inline size_t GetAddedTileCount() const
+    {
+      return addedTiles;
+    }
+
+    /**
+     * Return the number of tiles, that have been removed during the last update
+     */
+    inline size_t GetRemovedTileCount() const
+    {
+      return removedTiles;
+    }
+
+    /**
+     * Return the number of tiles currently contributing to the MapData
+     */
+    inline size_t GetTileCount() const
+    {
+      return tileStates.size();
+    }
+  };
+
+  //! \ingroup Renderer
+  typedef std::shared_ptr<IncrementalMapData> IncrementalMapDataRef;
+}
+
+#endif
@@ -46,6 +46,7 @@
 
 #include <osmscout/LabelLayouter.h>
 #include <osmscout/MapParameter.h>
+#include <osmscout/MapStyleCache.h>
 
 namespace osmscout {
 
@@ -279,6 +280,8 @@ namespace osmscout {
     std::vector<TextStyleRef>    textStyles;     //!< Temporary storage for StyleConfig return value
     std::vector<LineStyleRef>    lineStyles;     //!< Temporary storage for StyleConfig return value
 
+    MapStyleCache                styleCache;     //!< Styles of database objects resolved during previous render passes
+
     /**
       Fallback styles in case they are missing for the style sheet
       */
@@ -346,10 +349,11 @@ namespace osmscout {
       Private draw algorithm implementation routines.
      */
     //@{
-    void PrepareNode(const StyleConfig& styleConfig,
-                     const Projection& projection,
+    void PrepareNode(const Projection& projection,
                      const MapParameter& parameter,
-                     const NodeRef& node);
+                     const NodeRef& node,
+                     const IconStyleRef& iconStyle,
+                     const std::vector<TextStyleRef>& textStyles);
 
     void PrepareNodes(const StyleConfig& styleConfig,
                       const Projection& projection,
@@ -361,7 +365,8 @@ namespace osmscout {
                         const MapParameter& parameter,
                         const ObjectFileRef& ref,
                         const FeatureValueBuffer& buffer,
-                        const Way& way);
+                        const Way& way,
+                        const std::vector<LineStyleRef>& lineStyles);
 
     void PrepareWays(const StyleConfig& styleConfig,
                      const Projection& projection,
@@ -371,7 +376,8 @@ namespace osmscout {
     void PrepareArea(const StyleConfig& styleConfig,
                      const Projection& projection,
                      const MapParameter& parameter,
-                     const AreaRef &area);
+                     const AreaRef &area,
+                     bool useStyleCache);
 
     void PrepareAreaLabel(const StyleConfig& styleConfig,
                           const Projection& projection,
@@ -35,6 +35,7 @@
 
 #include <osmscout/util/Breaker.h>
 #include <osmscout/util/GeoBox.h>
+#include <osmscout/util/QueryArena.h>
 #include <osmscout/util/StopClock.h>
 #include <osmscout/util/WorkQueue.h>
 
@@ -56,6 +57,7 @@ namespace osmscout {
     bool          useLowZoomOptimization;
     BreakerRef    breaker;
     bool          useMultithreading;
+    bool          useQueryArena;
 
   public:
     AreaSearchParameter();
@@ -66,6 +68,8 @@ namespace osmscout {
 
     void SetUseMultithreading(bool useMultithreading);
 
+    void SetUseQueryArena(bool useQueryArena);
+
     void SetBreaker(const BreakerRef& breaker);
 
     unsigned long GetMaximumAreaLevel() const;
@@ -74,6 +78,8 @@ namespace osmscout {
 
     bool GetUseMultithreading() const;
 
+    bool GetUseQueryArena() const;
+
     bool IsAborted() const;
   };
 
@@ -135,6 +141,8 @@ namespace osmscout {
 
 
   private:
+    static QueryArenaRef CreateQueryArena(const AreaSearchParameter& parameter);
+
     TypeDefinitionRef GetTypeDefinition(const AreaSearchParameter& parameter,
                                         const StyleConfig& styleConfig,
                                         const Magnification& magnification) const;
@@ -0,0 +1,238 @@
+#ifndef OSMSCOUT_MAPSTYLECACHE_H
+#define OSMSCOUT_MAPSTYLECACHE_H
+
+/*
+  This source is part of the libosmscout-map library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <osmscout/MapImportExport.h>
+
+#include <osmscout/Area.h>
+#include <osmscout/Node.h>
+#include <osmscout/Way.h>
+
+#include <osmscout/StyleConfig.h>
+
+#include <osmscout/util/Projection.h>
+
+#include <osmscout/system/Compiler.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Renderer
+   *
+   * Cache for the styles resolved for database objects during rendering.
+   *
+   * Style resolution (evaluating the style sheet conditions against the
+   * features of an object and composing the partial styles) is repeated for
+   * every object on every frame, even if the same objects are rendered again
+   * with only a different center, rotation or canvas size. The cache holds the
+   * result of style resolution per object as long as the style relevant
+   * parameters of the projection do not change. These are the magnification
+   * level, the DPI and the results of the size conditions of the style sheet.
+   * Meter in pixel and meter in mm themselves change with the latitude of the
+   * center (and thus with every north/south pan and every tile), but only
+   * rarely flip the result of a size condition.
+   *
+   * Objects are identified by their address. The cache does not hold any
+   * reference to the objects. To detect the reuse of an address by a different
+   * object after the original object was freed, each entry also stores the file
+   * offset and the type of the object. Objects without a file offset (data
+   * files start with a header, so 0 is never the offset of a stored object)
+   * are not cached at all.
+   *
+   * Entries of objects not used during the last render pass are dropped,
+   * if they make up the majority of the cache.
+   */
+  class OSMSCOUT_MAP_API MapStyleCache CLASS_FINAL
+  {
+  public:
+    struct OSMSCOUT_MAP_API NodeStyles
+    {
+      IconStyleRef              iconStyle;
+      std::vector<TextStyleRef> textStyles;
+    };
+
+    struct OSMSCOUT_MAP_API WayStyles
+    {
+      std::vector<LineStyleRef> lineStyles;
+    };
+
+    struct OSMSCOUT_MAP_API RingStyles
+    {
+      bool                        resolved=false;
+      FillStyleRef                fillStyle;
+      std::vector<BorderStyleRef> borderStyles;
+    };
+
+    struct OSMSCOUT_MAP_API AreaStyles
+    {
+      std::vector<RingStyles> rings;
+    };
+
+  private:
+    template<typename O, typename S>
+    class ObjectStyles CLASS_FINAL
+    {
+    private:
+      struct Entry
+      {
+        const TypeInfo* type=nullptr;
+        FileOffset      fileOffset=0;
+        size_t          lastUsed=0;
+        S               styles;
+      };
+
+    private:
+      std::unordered_map<const O*,Entry> entries;
+      S                                  uncached;  //!< Styles of the last object without file offset
+      size_t                             used=0;    //!< Number of entries used during current render pass
+
+    public:
+      /**
+       * Return the styles entry for the given object. If the entry is new (or was
+       * stale), 'created' is set to true and the caller has to fill the styles.
+       *
+       * The entry returned for an object without file offset is only valid
+       * until the next call.
+       */
+      S& Get(const std::shared_ptr<O>& object,
+             size_t renderPass,
+             bool& created)
+      {
+        if (object->GetFileOffset()==0) {
+          created=true;
+          uncached=S();
+
+          return uncached;
+        }
+
+        Entry& entry=entries[object.get()];
+
+        created=entry.type!=object->GetType().get() ||
+                entry.fileOffset!=object->GetFileOffset();
+
+        if (created) {
+          entry.type=object->GetType().get();
+          entry.fileOffset=object->GetFileOffset();
+          entry.styles=S();
+        }
+
+        if (created || entry.lastUsed!=renderPass) {
+          used++;
+        }
+
+        entry.lastUsed=renderPass;
+
+        return entry.styles;
+      }
+
+      /**
+       * Drop all entries not used during the given render pass, if they
+       * are the majority
+       */
+      void Cleanup(size_t renderPass)
+      {
+        if (entries.size()>2*used) {
+          auto entry=entries.begin();
+
+          while (entry!=entries.end()) {
+            if (entry->second.lastUsed!=renderPass) {
+              entry=entries.erase(entry);
+            }
+            else {
+              ++entry;
+            }
+          }
+        }
+
+        used=0;
+      }
+
+      void Clear()
+      {
+        entries.clear();
+        used=0;
+      }
+
+      size_t GetSize() const
+      {
+        return entries.size();
+      }
+    };
+
+  private:
+    size_t                        renderPass;
+    size_t                        resolveCount;          //!< Number of objects styles were resolved for
+    bool                          valid;
+    uint32_t                      level;
+    double                        dpi;
+    std::vector<bool>             sizeConditionResults;  //!< Result of each size condition of the style sheet
+
+    ObjectStyles<Node,NodeStyles> nodeStyles;
+    ObjectStyles<Way,WayStyles>   wayStyles;
+    ObjectStyles<Area,AreaStyles> areaStyles;
+
+  public:
+    MapStyleCache();
+
+    void StartRenderPass(const StyleConfig& styleConfig,
+                         const Projection& projection);
+    void Clear();
+
+    const NodeStyles& GetNodeStyles(const StyleConfig& styleConfig,
+                                    const Projection& projection,
+                                    const NodeRef& node);
+
+    const WayStyles& GetWayStyles(const StyleConfig& styleConfig,
+                                  const Projection& projection,
+                                  const WayRef& way);
+
+    const RingStyles& GetRingStyles(const StyleConfig& styleConfig,
+                                    const Projection& projection,
+                                    const AreaRef& area,
+                                    size_t ringIndex,
+                                    const TypeInfoRef& type);
+
+    /**
+     * Return the number of objects currently cached
+     */
+    inline size_t GetSize() const
+    {
+      return nodeStyles.GetSize()+
+             wayStyles.GetSize()+
+             areaStyles.GetSize();
+    }
+
+    /**
+     * Return the number of times styles were resolved for an object (and thus
+     * not taken from the cache)
+     */
+    inline size_t GetResolveCount() const
+    {
+      return resolveCount;
+    }
+  };
+}
+
+#endif
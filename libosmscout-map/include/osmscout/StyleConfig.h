@@ -594,6 +594,8 @@ namespace osmscout {
 
     std::vector<TypeInfoSet>                   areaTypeSets;
 
+    std::vector<SizeConditionRef>              sizeConditions;         //!< Distinct size conditions of all styles
+
     std::unordered_map<std::string,bool>       flags;
     std::unordered_map<std::string,StyleConstantRef> constants;
     std::list<std::string>                     errors;
@@ -643,6 +645,16 @@ namespace osmscout {
 
     TypeConfigRef GetTypeConfig() const;
 
+    /**
+     * Return the distinct size conditions used by the style sheet. Besides the
+     * magnification level and the DPI, their results for a given projection are
+     * the only projection dependent input of style resolution.
+     */
+    inline const std::vector<SizeConditionRef>& GetSizeConditions() const
+    {
+      return sizeConditions;
+    }
+
     size_t GetFeatureFilterIndex(const Feature& feature) const;
 
     StyleConfig& SetWayPrio(const TypeInfoRef& type,
@@ -0,0 +1,287 @@
+#ifndef OSMSCOUT_TILEBATCHRENDERER_H
+#define OSMSCOUT_TILEBATCHRENDERER_H
+
+/*
+  This source is part of the libosmscout-map library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <osmscout/MapImportExport.h>
+
+#include <osmscout/MapPainter.h>
+#include <osmscout/MapService.h>
+#include <osmscout/StyleConfig.h>
+#include <osmscout/TileStore.h>
+
+#include <osmscout/util/GeoBox.h>
+#include <osmscout/util/Magnification.h>
+#include <osmscout/util/Projection.h>
+#include <osmscout/util/Tiling.h>
+
+#include <osmscout/system/Compiler.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Renderer
+   *
+   * Renders one tile into a buffer. The TileBatchRenderer creates one instance
+   * per thread, so implementations do not need to be thread safe and can
+   * hold a backend specific MapPainter and its drawing surface.
+   */
+  class OSMSCOUT_MAP_API TileBatchPainter
+  {
+  public:
+    virtual ~TileBatchPainter();
+
+    /**
+     * Render the given data for the given tile and return the encoded result in output.
+     * Return false, if the tile could not be rendered.
+     */
+    virtual bool RenderTile(const OSMTileId& tileId,
+                            const TileProjection& projection,
+                            const MapData& data,
+                            std::string& output) = 0;
+  };
+
+  typedef std::shared_ptr<TileBatchPainter> TileBatchPainterRef;
+
+  /**
+   * \ingroup Renderer
+   *
+   * Destination of the tiles rendered by the TileBatchRenderer. Methods are called
+   * concurrently from all render threads, so implementations must be thread safe.
+   */
+  class OSMSCOUT_MAP_API TileBatchSink
+  {
+  public:
+    virtual ~TileBatchSink();
+
+    /**
+     * Return true, if the tile already exists in the sink and thus does not need to be
+     * rendered again when resuming an interrupted batch.
+     */
+    virtual bool HasTile(const Magnification& magnification,
+                         const OSMTileId& tileId) = 0;
+
+    virtual bool WriteTile(const Magnification& magnification,
+                           const OSMTileId& tileId,
+                           const std::string& data) = 0;
+  };
+
+  typedef std::shared_ptr<TileBatchSink> TileBatchSinkRef;
+
+  /**
+   * \ingroup Renderer
+   *
+   * TileBatchSink writing each tile into a separate file named
+   * "<level>_<x>_<y>.<extension>" in the given directory.
+   */
+  class OSMSCOUT_MAP_API FileTileBatchSink : public TileBatchSink
+  {
+  private:
+    std::string directory;
+    std::string extension;
+
+  private:
+    std::string GetFilename(const Magnification& magnification,
+                            const OSMTileId& tileId) const;
+
+  public:
+    FileTileBatchSink(const std::string& directory,
+                      const std::string& extension);
+
+    bool HasTile(const Magnification& magnification,
+                 const OSMTileId& tileId) override;
+
+    bool WriteTile(const Magnification& magnification,
+                   const OSMTileId& tileId,
+                   const std::string& data) override;
+  };
+
+  /**
+   * \ingroup Renderer
+   *
+   * TileBatchSink writing the tiles into a TileStore using the given namespace,
+   * so that batch rendered tiles can later be served by interactive clients.
+   */
+  class OSMSCOUT_MAP_API TileStoreBatchSink : public TileBatchSink
+  {
+  private:
+    TileStoreRef store;
+    uint64_t     space;
+
+  public:
+    TileStoreBatchSink(const TileStoreRef& store,
+                       uint64_t space);
+
+    bool HasTile(const Magnification& magnification,
+                 const OSMTileId& tileId) override;
+
+    bool WriteTile(const Magnification& magnification,
+                   const OSMTileId& tileId,
+                   const std::string& data) override;
+  };
+
+  /**
+   * \ingroup Renderer
+   *
+   * Parameter for the TileBatchRenderer
+   */
+  class OSMSCOUT_MAP_API TileBatchParameter CLASS_FINAL
+  {
+  private:
+    size_t              threadCount;     //!< Number of render threads
+    uint32_t            metaTileSize;    //!< Width and height (in tiles) of a unit of work
+    size_t              tileWidth;       //!< Width of a tile in pixel
+    size_t              tileHeight;      //!< Height of a tile in pixel
+    double              dpi;             //!< DPI used for the tile projection
+    bool                skipExisting;    //!< Do not render tiles already existing in the sink
+    AreaSearchParameter searchParameter; //!< Parameter for loading the tile data
+
+  public:
+    TileBatchParameter();
+
+    void SetThreadCount(size_t threadCount);
+    void SetMetaTileSize(uint32_t metaTileSize);
+    void SetTileSize(size_t tileWidth,
+                     size_t tileHeight);
+    void SetDPI(double dpi);
+    void SetSkipExisting(bool skipExisting);
+    void SetSearchParameter(const AreaSearchParameter& searchParameter);
+
+    inline size_t GetThreadCount() const
+    {
+      return threadCount;
+    }
+
+    inline uint32_t GetMetaTileSize() const
+    {
+      return metaTileSize;
+    }
+
+    inline size_t GetTileWidth() const
+    {
+      return tileWidth;
+    }
+
+    inline size_t GetTileHeight() const
+    {
+      return tileHeight;
+    }
+
+    inline double GetDPI() const
+    {
+      return dpi;
+    }
+
+    inline bool GetSkipExisting() const
+    {
+      return skipExisting;
+    }
+
+    inline const AreaSearchParameter& GetSearchParameter() const
+    {
+      return searchParameter;
+    }
+  };
+
+  /**
+   * \ingroup Renderer
+   *
+   * Statistics of a TileBatchRenderer run. Times are summed up over all threads,
+   * so they show where the render threads spend their time, while totalTime is
+   * the wall clock time of the run.
+   */
+  struct OSMSCOUT_MAP_API TileBatchStatistics
+  {
+    size_t tileCount=0;        //!< Number of tiles rendered and written
+    size_t skippedTileCount=0; //!< Number of tiles skipped, because they already existed in the sink
+    size_t failedTileCount=0;  //!< Number of tiles that could not be loaded, rendered or written
+    size_t dataTileHits=0;     //!< Number of data tiles already loaded when requested
+    size_t dataTileMisses=0;   //!< Number of data tiles that had to be loaded
+    double loadTime=0.0;       //!< Time spend loading data in milliseconds
+    double mergeTime=0.0;      //!< Time spend collecting data of a tile in milliseconds
+    double renderTime=0.0;     //!< Time spend rendering in milliseconds
+    double writeTime=0.0;      //!< Time spend writing to the sink in milliseconds
+    double totalTime=0.0;      //!< Wall clock time of the run in milliseconds
+
+    void Add(const TileBatchStatistics& other);
+
+    double GetTilesPerSecond() const;
+    double GetDataTileHitRate() const;
+  };
+
+  /**
+   * \ingroup Renderer
+   *
+   * Renders all tiles of a bounding box for a range of magnification levels
+   * using multiple threads sharing one MapService.
+   *
+   * The tiles of each level are partitioned into meta tiles of
+   * metaTileSize x metaTileSize tiles. Threads take meta tiles in row order
+   * from a shared counter, load the data of the complete meta tile at once
+   * and then render its tiles. Thus each thread works on a compact area, which
+   * keeps the data tile cache hit rate high, while the dynamic assignment
+   * balances dense and sparse regions.
+   *
+   * Rendering is resumable: tiles that already exist in the sink are skipped
+   * if skipExisting is set.
+   */
+  class OSMSCOUT_MAP_API TileBatchRenderer CLASS_FINAL
+  {
+  public:
+    typedef std::function<TileBatchPainterRef()> PainterFactory;
+
+  private:
+    MapServiceRef      mapService;
+    StyleConfigRef     styleConfig;
+    TileBatchParameter parameter;
+    std::atomic<bool>  aborted;
+
+  private:
+    void RenderMetaTiles(const Magnification& magnification,
+                         const OSMTileIdBox& tileBox,
+                         uint32_t metaTileColumns,
+                         uint32_t metaTileCount,
+                         std::atomic<uint32_t>& nextMetaTile,
+                         TileBatchPainter& painter,
+                         TileBatchSink& sink,
+                         TileBatchStatistics& statistics);
+
+  public:
+    TileBatchRenderer(const MapServiceRef& mapService,
+                      const StyleConfigRef& styleConfig,
+                      const TileBatchParameter& parameter);
+
+    bool Render(const GeoBox& boundingBox,
+                const MagnificationLevel& startLevel,
+                const MagnificationLevel& endLevel,
+                const PainterFactory& painterFactory,
+                TileBatchSink& sink,
+                TileBatchStatistics& statistics);
+
+    void Abort();
+  };
+}
+
+#endif
@@ -0,0 +1,156 @@
+#ifndef OSMSCOUT_TILESTORE_H
+#define OSMSCOUT_TILESTORE_H
+
+/*
+  This source is part of the libosmscout-map library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <osmscout/MapImportExport.h>
+
+#include <osmscout/util/Magnification.h>
+#include <osmscout/util/MemoryMappedFile.h>
+#include <osmscout/util/Tiling.h>
+
+#include <osmscout/system/Compiler.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Renderer
+   *
+   * Persistent store for rendered tiles (or any other per tile data).
+   *
+   * Tiles are identified by a namespace and their level and tile coordinates.
+   * The namespace should be derived (see GetNamespace()) from everything that
+   * influences the rendering result (style sheet, style flags, DPI, databases,...),
+   * so that changed rendering parameters or updated databases automatically
+   * result in cache misses. Tiles of outdated namespaces are evicted by compaction.
+   *
+   * The store consists of two files in the given directory:
+   * - "tiles.dat", an append-only pack file holding the tile data
+   * - "tiles.idx", an open addressing hash table mapping keys to the position
+   *   of the data in the pack file. The index is memory mapped, so opening
+   *   the store and looking up tiles is cheap.
+   *
+   * If the pack file exceeds the configured maximum size, it is compacted:
+   * only the most recently used tiles (up to 3/4 of the maximum size) are kept.
+   *
+   * The files use the native byte order. A store is used by one process at a
+   * time, but TileStore itself is thread safe.
+   */
+  class OSMSCOUT_MAP_API TileStore CLASS_FINAL
+  {
+  public:
+    static const uint32_t FILE_FORMAT_VERSION=1;
+
+  private:
+    struct Header
+    {
+      char     magic[4];
+      uint32_t version;
+      uint64_t slotCount;     //!< Number of slots in the index, always a power of 2
+      uint64_t usedCount;     //!< Number of used slots
+      uint64_t dataSize;      //!< Size of the data in the pack file
+      uint64_t accessCounter; //!< Logical clock for LRU handling
+    };
+
+    struct Slot
+    {
+      uint64_t space;
+      uint64_t offset;
+      uint64_t lastAccess;
+      uint32_t level;
+      uint32_t x;
+      uint32_t y;
+      uint32_t size;          //!< Size of the tile data, 0 for an unused slot
+    };
+
+  private:
+    mutable std::mutex mutex;
+    std::string        directory;
+    uint64_t           maxDataSize;
+    MemoryMappedFile   index;
+    std::fstream       pack;
+
+  private:
+    std::string GetIndexFilename() const;
+    std::string GetPackFilename() const;
+
+    inline Header& GetHeader() const
+    {
+      return *reinterpret_cast<Header*>(index.GetData());
+    }
+
+    inline Slot* GetSlots() const
+    {
+      return reinterpret_cast<Slot*>(index.GetData()+sizeof(Header));
+    }
+
+    Slot* FindSlot(uint64_t space,
+                   uint32_t level,
+                   uint32_t x,
+                   uint32_t y) const;
+
+    void InitializeIndex(uint64_t slotCount);
+    void Reset();
+    void Grow();
+    void Compact(uint64_t targetSize);
+
+  public:
+    TileStore();
+    ~TileStore();
+
+    bool Open(const std::string& directory,
+              uint64_t maxDataSize);
+    void Close();
+
+    bool IsOpen() const;
+
+    bool Contains(uint64_t space,
+                  const MagnificationLevel& level,
+                  const OSMTileId& tile) const;
+
+    bool Get(uint64_t space,
+             const MagnificationLevel& level,
+             const OSMTileId& tile,
+             std::string& data);
+
+    bool Put(uint64_t space,
+             const MagnificationLevel& level,
+             const OSMTileId& tile,
+             const std::string& data);
+
+    bool Clear();
+    bool Flush();
+
+    size_t GetTileCount() const;
+    uint64_t GetDataSize() const;
+
+    static uint64_t GetNamespace(const std::string& description);
+  };
+
+  typedef std::shared_ptr<TileStore> TileStoreRef;
+}
+
+#endif
@@ -0,0 +1,268 @@
+#ifndef OSMSCOUT_VECTORTILE_H
+#define OSMSCOUT_VECTORTILE_H
+
+/*
+  This source is part of the libosmscout-map library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <osmscout/MapImportExport.h>
+
+#include <osmscout/FeatureReader.h>
+#include <osmscout/TypeConfig.h>
+
+#include <osmscout/MapPainter.h>
+
+#include <osmscout/util/Magnification.h>
+#include <osmscout/util/Tiling.h>
+
+#include <osmscout/system/Compiler.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup VectorTile
+   *
+   * A point in the integer coordinate system of a vector tile. (0,0) is the
+   * upper left corner of the tile, (extent,extent) the lower right corner.
+   */
+  struct OSMSCOUT_MAP_API VectorTilePoint
+  {
+    int32_t x;
+    int32_t y;
+
+    inline VectorTilePoint()
+    : x(0),y(0)
+    {
+      // no code
+    }
+
+    inline VectorTilePoint(int32_t x, int32_t y)
+    : x(x),y(y)
+    {
+      // no code
+    }
+
+    inline bool operator==(const VectorTilePoint& other) const
+    {
+      return x==other.x && y==other.y;
+    }
+
+    inline bool operator!=(const VectorTilePoint& other) const
+    {
+      return x!=other.x || y!=other.y;
+    }
+  };
+
+  /**
+   * \ingroup VectorTile
+   *
+   * One layer of a vector tile. Features are encoded immediately while being
+   * added, keys and values of the feature properties are pooled per layer.
+   *
+   * The encoding follows the Mapbox Vector Tile specification 2.1.
+   */
+  class OSMSCOUT_MAP_API VectorTileLayer CLASS_FINAL
+  {
+  public:
+    enum class GeometryType : uint32_t
+    {
+      point      = 1,
+      lineString = 2,
+      polygon    = 3
+    };
+
+    typedef std::vector<std::pair<std::string,std::string>> Properties;
+
+  private:
+    std::string                               name;
+    uint32_t                                  extent;
+    std::vector<std::string>                  keys;
+    std::unordered_map<std::string,uint32_t>  keyIndex;
+    std::vector<std::string>                  values;
+    std::unordered_map<std::string,uint32_t>  valueIndex;
+    std::string                               features;     //!< Already encoded features
+    size_t                                    featureCount;
+
+  private:
+    uint32_t GetKeyIndex(const std::string& key);
+    uint32_t GetValueIndex(const std::string& value);
+
+    void AddFeature(uint64_t id,
+                    const Properties& properties,
+                    GeometryType type,
+                    const std::vector<uint32_t>& geometry);
+
+  public:
+    VectorTileLayer(const std::string& name,
+                    uint32_t extent);
+
+    inline std::string GetName() const
+    {
+      return name;
+    }
+
+    inline uint32_t GetExtent() const
+    {
+      return extent;
+    }
+
+    inline size_t GetFeatureCount() const
+    {
+      return featureCount;
+    }
+
+    inline bool IsEmpty() const
+    {
+      return featureCount==0;
+    }
+
+    void AddPoint(uint64_t id,
+                  const Properties& properties,
+                  const VectorTilePoint& point);
+
+    void AddLineStrings(uint64_t id,
+                        const Properties& properties,
+                        const std::vector<std::vector<VectorTilePoint>>& lines);
+
+    void AddPolygon(uint64_t id,
+                    const Properties& properties,
+                    const std::vector<std::vector<VectorTilePoint>>& rings);
+
+    void Encode(std::string& buffer) const;
+  };
+
+  /**
+   * \ingroup VectorTile
+   *
+   * A vector tile, consisting of a number of named layers.
+   */
+  class OSMSCOUT_MAP_API VectorTile CLASS_FINAL
+  {
+  private:
+    uint32_t                   extent;
+    std::list<VectorTileLayer> layers;
+
+  public:
+    explicit VectorTile(uint32_t extent=4096);
+
+    inline uint32_t GetExtent() const
+    {
+      return extent;
+    }
+
+    VectorTileLayer& GetLayer(const std::string& name);
+
+    size_t GetFeatureCount() const;
+
+    std::string Encode() const;
+  };
+
+  /**
+   * \ingroup VectorTile
+   *
+   * Converts MapData (as returned by MapService for a given tile) into a vector tile.
+   *
+   * Geometries are projected into the local coordinate system of the tile,
+   * clipped against the tile (plus a configurable buffer to allow seamless
+   * rendering of lines and areas at the tile borders), quantized to the
+   * integer grid of the tile and simplified.
+   *
+   * Nodes are written to the layer "nodes", ways to the layer "ways" and
+   * areas to the layer "areas". Each feature has a property "type" with the
+   * name of the type and, if available, "name" and "ref".
+   */
+  class OSMSCOUT_MAP_API VectorTileBuilder CLASS_FINAL
+  {
+  public:
+    struct OSMSCOUT_MAP_API Vertex
+    {
+      double x;
+      double y;
+    };
+
+  private:
+    NameFeatureValueReader nameReader;
+    RefFeatureValueReader  refReader;
+    uint32_t               extent;
+    uint32_t               buffer;
+    double                 simplificationTolerance;
+
+  private:
+    void GetProperties(const FeatureValueBuffer& featureBuffer,
+                       VectorTileLayer::Properties& properties) const;
+
+    void Quantize(const std::vector<Vertex>& vertices,
+                  bool closed,
+                  std::vector<VectorTilePoint>& points) const;
+
+  public:
+    explicit VectorTileBuilder(const TypeConfig& typeConfig);
+
+    void SetExtent(uint32_t extent);
+    void SetBuffer(uint32_t buffer);
+    void SetSimplificationTolerance(double tolerance);
+
+    inline uint32_t GetExtent() const
+    {
+      return extent;
+    }
+
+    inline uint32_t GetBuffer() const
+    {
+      return buffer;
+    }
+
+    inline double GetSimplificationTolerance() const
+    {
+      return simplificationTolerance;
+    }
+
+    void Build(const OSMTileId& tileId,
+               const Magnification& magnification,
+               const MapData& data,
+               VectorTile& tile) const;
+
+    static void ClipLine(const std::vector<Vertex>& line,
+                         double minX, double minY,
+                         double maxX, double maxY,
+                         std::vector<std::vector<Vertex>>& parts);
+
+    static void ClipRing(const std::vector<Vertex>& ring,
+                         double minX, double minY,
+                         double maxX, double maxY,
+                         std::vector<Vertex>& result);
+
+    static void Simplify(std::vector<VectorTilePoint>& points,
+                         double tolerance);
+  };
+
+  /**
+   * \defgroup VectorTile Vector tile export
+   *
+   * Classes for exporting map data as (Mapbox compatible) vector tiles.
+   */
+}
+
+#endif
@@ -0,0 +1,190 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/IncrementalMapData.h>
+
+namespace osmscout {
+
+  IncrementalMapData::IncrementalMapData()
+  : data(std::make_shared<MapData>()),
+    addedTiles(0),
+    removedTiles(0)
+  {
+    // no code
+  }
+
+  /**
+   * Copy the current data of the tile into the state and add it to the MapData
+   */
+  void IncrementalMapData::AddTile(TileState& state)
+  {
+    // Read the generation before copying, so that we will catch changes
+    // that happen while we copy during the next update
+    state.generation=state.tile->GetGeneration();
+
+    state.nodes.clear();
+    state.ways.clear();
+    state.optimizedWays.clear();
+    state.areas.clear();
+    state.optimizedAreas.clear();
+
+    state.tile->GetNodeData().CopyData([&state](const NodeRef& node) {
+      state.nodes.push_back(node);
+    });
+
+    state.tile->GetWayData().CopyData([&state](const WayRef& way) {
+      state.ways.push_back(way);
+    });
+
+    state.tile->GetOptimizedWayData().CopyData([&state](const WayRef& way) {
+      state.optimizedWays.push_back(way);
+    });
+
+    state.tile->GetAreaData().CopyData([&state](const AreaRef& area) {
+      state.areas.push_back(area);
+    });
+
+    state.tile->GetOptimizedAreaData().CopyData([&state](const AreaRef& area) {
+      state.optimizedAreas.push_back(area);
+    });
+
+    for (const auto& node : state.nodes) {
+      nodes.Add(data->nodes,node,false);
+    }
+
+    for (const auto& way : state.ways) {
+      ways.Add(data->ways,way,false);
+    }
+
+    for (const auto& way : state.optimizedWays) {
+      ways.Add(data->ways,way,true);
+    }
+
+    for (const auto& area : state.areas) {
+      areas.Add(data->areas,area,false);
+    }
+
+    for (const auto& area : state.optimizedAreas) {
+      areas.Add(data->areas,area,true);
+    }
+  }
+
+  /**
+   * Remove all objects the tile did contribute during the last update from the MapData
+   */
+  void IncrementalMapData::RemoveTile(TileState& state)
+  {
+    for (const auto& node : state.nodes) {
+      nodes.Remove(data->nodes,node,false);
+    }
+
+    for (const auto& way : state.ways) {
+      ways.Remove(data->ways,way,false);
+    }
+
+    for (const auto& way : state.optimizedWays) {
+      ways.Remove(data->ways,way,true);
+    }
+
+    for (const auto& area : state.areas) {
+      areas.Remove(data->areas,area,false);
+    }
+
+    for (const auto& area : state.optimizedAreas) {
+      areas.Remove(data->areas,area,true);
+    }
+  }
+
+  /**
+   * Update the MapData to reflect the data of the given list of tiles.
+   *
+   * Only tiles that were not part of the last update or whose data has changed
+   * since the last update are copied. Data of tiles not part of the given list
+   * anymore is removed.
+   *
+   * @return true, if the MapData has changed
+   */
+  bool IncrementalMapData::Update(const std::list<TileRef>& tiles)
+  {
+    std::map<TileKey,TileRef> currentTiles;
+
+    addedTiles=0;
+    removedTiles=0;
+
+    for (const auto& tile : tiles) {
+      currentTiles[tile->GetKey()]=tile;
+    }
+
+    auto stateEntry=tileStates.begin();
+    while (stateEntry!=tileStates.end()) {
+      if (currentTiles.find(stateEntry->first)==currentTiles.end()) {
+        RemoveTile(stateEntry->second);
+        stateEntry=tileStates.erase(stateEntry);
+        removedTiles++;
+      }
+      else {
+        ++stateEntry;
+      }
+    }
+
+    for (const auto& tileEntry : currentTiles) {
+      auto existingState=tileStates.find(tileEntry.first);
+
+      if (existingState!=tileStates.end()) {
+        TileState& state=existingState->second;
+
+        if (state.tile==tileEntry.second &&
+            state.generation==tileEntry.second->GetGeneration()) {
+          continue;
+        }
+
+        // Add before remove, so objects still referenced by the tile
+        // are not removed from and reinserted into the MapData
+        TileState oldState=std::move(state);
+
+        state.tile=tileEntry.second;
+        AddTile(state);
+        RemoveTile(oldState);
+      }
+      else {
+        TileState& state=tileStates[tileEntry.first];
+
+        state.tile=tileEntry.second;
+        AddTile(state);
+      }
+
+      addedTiles++;
+    }
+
+    return addedTiles>0 || removedTiles>0;
+  }
+
+  /**
+   * Remove all tiles and all database data from the MapData
+   */
+  void IncrementalMapData::Clear()
+  {
+    tileStates.clear();
+    nodes.Clear(data->nodes);
+    ways.Clear(data->ways);
+    areas.Clear(data->areas);
+    addedTiles=0;
+    removedTiles=0;
+  }
+}
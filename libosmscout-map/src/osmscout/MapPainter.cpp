@@ -819,10 +819,15 @@ namespace osmscout {
       StopClockNano nodeTimer;
 #endif
 
-      PrepareNode(styleConfig,
-                  projection,
+      const MapStyleCache::NodeStyles& styles=styleCache.GetNodeStyles(styleConfig,
+                                                                       projection,
+                                                                       node);
+
+      PrepareNode(projection,
                   parameter,
-                  node);
+                  node,
+                  styles.iconStyle,
+                  styles.textStyles);
 
 #if defined(DEBUG_NODE_DRAW)
       nodeTimer.Stop();
@@ -836,10 +841,18 @@ namespace osmscout {
       StopClockNano nodeTimer;
 #endif
 
-      PrepareNode(styleConfig,
-                  projection,
+      IconStyleRef iconStyle=styleConfig.GetNodeIconStyle(node->GetFeatureValueBuffer(),
+                                                          projection);
+
+      styleConfig.GetNodeTextStyles(node->GetFeatureValueBuffer(),
+                                    projection,
+                                    textStyles);
+
+      PrepareNode(projection,
                   parameter,
-                  node);
+                  node,
+                  iconStyle,
+                  textStyles);
 
 #if defined(DEBUG_NODE_DRAW)
       nodeTimer.Stop();
@@ -1007,18 +1020,12 @@ namespace osmscout {
     return true;
   }
 
-  void MapPainter::PrepareNode(const StyleConfig& styleConfig,
-                               const Projection& projection,
+  void MapPainter::PrepareNode(const Projection& projection,
                                const MapParameter& parameter,
-                               const NodeRef& node)
+                               const NodeRef& node,
+                               const IconStyleRef& iconStyle,
+                               const std::vector<TextStyleRef>& textStyles)
   {
-    IconStyleRef iconStyle=styleConfig.GetNodeIconStyle(node->GetFeatureValueBuffer(),
-                                                        projection);
-
-    styleConfig.GetNodeTextStyles(node->GetFeatureValueBuffer(),
-                                 projection,
-                                 textStyles);
-
     double x,y;
 
     Transform(projection,
@@ -1295,7 +1302,8 @@ namespace osmscout {
   void MapPainter::PrepareArea(const StyleConfig& styleConfig,
                                const Projection& projection,
                                const MapParameter& parameter,
-                               const AreaRef &area)
+                               const AreaRef &area,
+                               bool useStyleCache)
   {
     std::vector<PolyData> td(area->rings.size());
 
@@ -1362,9 +1370,26 @@ namespace osmscout {
           type=ring.GetType();
         }
 
-        fillStyle=styleConfig.GetAreaFillStyle(type,
-                                               ring.GetFeatureValueBuffer(),
-                                               projection);
+        if (useStyleCache) {
+          const MapStyleCache::RingStyles& ringStyles=styleCache.GetRingStyles(styleConfig,
+                                                                               projection,
+                                                                               area,
+                                                                               i,
+                                                                               type);
+
+          fillStyle=ringStyles.fillStyle;
+          borderStyles=ringStyles.borderStyles;
+        }
+        else {
+          fillStyle=styleConfig.GetAreaFillStyle(type,
+                                                 ring.GetFeatureValueBuffer(),
+                                                 projection);
+
+          styleConfig.GetAreaBorderStyles(type,
+                                          ring.GetFeatureValueBuffer(),
+                                          projection,
+                                          borderStyles);
+        }
 
         FillStyleProcessorRef fillProcessor=parameter.GetFillStyleProcessor(ring.GetType()->GetIndex());
 
@@ -1373,11 +1398,6 @@ namespace osmscout {
                                            fillStyle);
         }
 
-        styleConfig.GetAreaBorderStyles(type,
-                                        ring.GetFeatureValueBuffer(),
-                                        projection,
-                                        borderStyles);
-
         if (!fillStyle && borderStyles.empty()) {
           continue;
         }
@@ -1483,9 +1503,10 @@ namespace osmscout {
     //Areas
     for (const auto& area : data.areas) {
       PrepareArea(styleConfig,
-                   projection,
-                   parameter,
-                   area);
+                  projection,
+                  parameter,
+                  area,
+                  true);
     }
 
     areaData.sort(AreaSorter);
@@ -1495,7 +1516,8 @@ namespace osmscout {
       PrepareArea(styleConfig,
                   projection,
                   parameter,
-                  area);
+                  area,
+                  false);
     }
   }
 
@@ -1504,12 +1526,9 @@ namespace osmscout {
                                   const MapParameter& parameter,
                                   const ObjectFileRef& ref,
                                   const FeatureValueBuffer& buffer,
-                                  const Way& way)
+                                  const Way& way,
+                                  const std::vector<LineStyleRef>& lineStyles)
   {
-    styleConfig.GetWayLineStyles(buffer,
-                                 projection,
-                                 lineStyles);
-
     if (lineStyles.empty()) {
       return;
     }
@@ -1701,13 +1720,18 @@ namespace osmscout {
     wayPathData.clear();
 
     for (const auto& way : data.ways) {
+      const MapStyleCache::WayStyles& styles=styleCache.GetWayStyles(styleConfig,
+                                                                     projection,
+                                                                     way);
+
       CalculatePaths(styleConfig,
                      projection,
                      parameter,
                      ObjectFileRef(way->GetFileOffset(),
                                    refWay),
                      way->GetFeatureValueBuffer(),
-                     *way);
+                     *way,
+                     styles.lineStyles);
 
       CalculateWayShieldLabels(styleConfig,
                                projection,
@@ -1716,13 +1740,18 @@ namespace osmscout {
     }
 
     for (const auto& way : data.poiWays) {
+      styleConfig.GetWayLineStyles(way->GetFeatureValueBuffer(),
+                                   projection,
+                                   lineStyles);
+
       CalculatePaths(styleConfig,
                      projection,
                      parameter,
                      ObjectFileRef(way->GetFileOffset(),
                                    refWay),
                      way->GetFeatureValueBuffer(),
-                     *way);
+                     *way,
+                     lineStyles);
 
       CalculateWayShieldLabels(styleConfig,
                                projection,
@@ -1788,6 +1817,8 @@ namespace osmscout {
     shieldGridSizeVert=180.0/(std::pow(2,projection.GetMagnification().GetLevel()+1));
 
     transBuffer.Reset();
+    styleCache.StartRenderPass(*styleConfig,
+                               projection);
 
     standardFontSize=GetFontHeight(projection,
                                    parameter,
@@ -33,7 +33,8 @@ namespace osmscout {
   AreaSearchParameter::AreaSearchParameter()
   : maxAreaLevel(4),
     useLowZoomOptimization(true),
-    useMultithreading(false)
+    useMultithreading(false),
+    useQueryArena(false)
   {
     // no code
   }
@@ -53,6 +54,18 @@ namespace osmscout {
     this->useMultithreading=useMultithreading;
   }
 
+  /**
+   * If set, the nodes, ways and areas loaded for a tile are allocated in
+   * a QueryArena instead of one by one on the heap. The memory of the
+   * arena is released in one go, when the last object loaded into it is
+   * released (normally when the tile is removed from the cache). Objects
+   * allocated in an arena are not added to the caches of the data files.
+   */
+  void AreaSearchParameter::SetUseQueryArena(bool useQueryArena)
+  {
+    this->useQueryArena=useQueryArena;
+  }
+
   void AreaSearchParameter::SetBreaker(const BreakerRef& breaker)
   {
     this->breaker=breaker;
@@ -73,6 +86,11 @@ namespace osmscout {
     return useMultithreading;
   }
 
+  bool AreaSearchParameter::GetUseQueryArena() const
+  {
+    return useQueryArena;
+  }
+
   bool AreaSearchParameter::IsAborted() const
   {
     if (breaker) {
@@ -226,6 +244,19 @@ namespace osmscout {
     return typeDefinition;
   }
 
+  /**
+   * Return a new arena for the objects of one tile, if requested by the
+   * parameter, else an empty reference.
+   */
+  QueryArenaRef MapService::CreateQueryArena(const AreaSearchParameter& parameter)
+  {
+    if (parameter.GetUseQueryArena()) {
+      return std::make_shared<QueryArena>();
+    }
+
+    return QueryArenaRef();
+  }
+
   bool MapService::GetNodes(const AreaSearchParameter& parameter,
                             const TypeInfoSet& nodeTypes,
                             const GeoBox& boundingBox,
@@ -280,7 +311,8 @@ namespace osmscout {
 
         if (!database->GetNodesByOffset(offsets,
                                         boundingBox,
-                                        nodes)) {
+                                        nodes,
+                                        CreateQueryArena(parameter))) {
           log.Error() << "Error reading nodes in area!";
           return false;
         }
@@ -443,7 +475,9 @@ namespace osmscout {
         std::vector<AreaRef> areas;
 
         if (!database->GetAreasByBlockSpans(spans,
-                                            areas)) {
+                                            boundingBox,
+                                            areas,
+                                            CreateQueryArena(parameter))) {
           log.Error() << "Error reading areas in area!";
           return false;
         }
@@ -601,7 +635,9 @@ namespace osmscout {
         std::vector<WayRef> ways;
 
         if (!database->GetWaysByOffset(offsets,
-                                       ways)) {
+                                       boundingBox,
+                                       ways,
+                                       CreateQueryArena(parameter))) {
           log.Error() << "Error reading ways in area!";
           return false;
         }
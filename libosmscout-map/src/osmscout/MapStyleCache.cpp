@@ -0,0 +1,162 @@
+/*
+  This source is part of the libosmscout-map library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/MapStyleCache.h>
+
+namespace osmscout {
+
+  MapStyleCache::MapStyleCache()
+  : renderPass(0),
+    resolveCount(0),
+    valid(false),
+    level(0),
+    dpi(0.0)
+  {
+    // no code
+  }
+
+  /**
+   * Must be called before each render pass. Drops all cached styles if the
+   * given projection resolves to different styles than the projection of the
+   * previous render pass, else drops the entries not used during the previous pass
+   * if they are the majority.
+   */
+  void MapStyleCache::StartRenderPass(const StyleConfig& styleConfig,
+                                      const Projection& projection)
+  {
+    const std::vector<SizeConditionRef>& sizeConditions=styleConfig.GetSizeConditions();
+    std::vector<bool>                    results;
+
+    results.reserve(sizeConditions.size());
+
+    for (const auto& sizeCondition : sizeConditions) {
+      results.push_back(sizeCondition->Evaluate(projection.GetMeterInPixel(),
+                                                projection.GetMeterInMM()));
+    }
+
+    if (!valid ||
+        level!=projection.GetMagnification().GetLevel() ||
+        dpi!=projection.GetDPI() ||
+        sizeConditionResults!=results) {
+      Clear();
+
+      valid=true;
+      level=projection.GetMagnification().GetLevel();
+      dpi=projection.GetDPI();
+      sizeConditionResults=std::move(results);
+    }
+    else {
+      nodeStyles.Cleanup(renderPass);
+      wayStyles.Cleanup(renderPass);
+      areaStyles.Cleanup(renderPass);
+    }
+
+    renderPass++;
+  }
+
+  void MapStyleCache::Clear()
+  {
+    nodeStyles.Clear();
+    wayStyles.Clear();
+    areaStyles.Clear();
+
+    valid=false;
+  }
+
+  const MapStyleCache::NodeStyles& MapStyleCache::GetNodeStyles(const StyleConfig& styleConfig,
+                                                                const Projection& projection,
+                                                                const NodeRef& node)
+  {
+    bool       created;
+    NodeStyles &styles=nodeStyles.Get(node,
+                                      renderPass,
+                                      created);
+
+    if (created) {
+      resolveCount++;
+      styles.iconStyle=styleConfig.GetNodeIconStyle(node->GetFeatureValueBuffer(),
+                                                    projection);
+      styleConfig.GetNodeTextStyles(node->GetFeatureValueBuffer(),
+                                    projection,
+                                    styles.textStyles);
+    }
+
+    return styles;
+  }
+
+  const MapStyleCache::WayStyles& MapStyleCache::GetWayStyles(const StyleConfig& styleConfig,
+                                                              const Projection& projection,
+                                                              const WayRef& way)
+  {
+    bool      created;
+    WayStyles &styles=wayStyles.Get(way,
+                                    renderPass,
+                                    created);
+
+    if (created) {
+      resolveCount++;
+      styleConfig.GetWayLineStyles(way->GetFeatureValueBuffer(),
+                                   projection,
+                                   styles.lineStyles);
+    }
+
+    return styles;
+  }
+
+  /**
+   * Return the fill and border styles of the given ring of the area. The type is
+   * passed explicitly, since the outer ring uses the type of the area.
+   */
+  const MapStyleCache::RingStyles& MapStyleCache::GetRingStyles(const StyleConfig& styleConfig,
+                                                                const Projection& projection,
+                                                                const AreaRef& area,
+                                                                size_t ringIndex,
+                                                                const TypeInfoRef& type)
+  {
+    bool       created;
+    AreaStyles &styles=areaStyles.Get(area,
+                                      renderPass,
+                                      created);
+
+    // An optimized area may have the same file offset and type, but different rings
+    if (created ||
+        styles.rings.size()!=area->rings.size()) {
+      resolveCount++;
+      styles.rings.clear();
+      styles.rings.resize(area->rings.size());
+    }
+
+    RingStyles &ringStyles=styles.rings[ringIndex];
+
+    if (!ringStyles.resolved) {
+      const Area::Ring &ring=area->rings[ringIndex];
+
+      ringStyles.fillStyle=styleConfig.GetAreaFillStyle(type,
+                                                        ring.GetFeatureValueBuffer(),
+                                                        projection);
+      styleConfig.GetAreaBorderStyles(type,
+                                      ring.GetFeatureValueBuffer(),
+                                      projection,
+                                      ringStyles.borderStyles);
+      ringStyles.resolved=true;
+    }
+
+    return ringStyles;
+  }
+}
@@ -21,6 +21,7 @@
 
 #include <string.h>
 
+#include <algorithm>
 #include <set>
 
 #include <sstream>
@@ -393,6 +394,8 @@ namespace osmscout {
     areaBorderSymbolStyleSelectors.clear();
     areaTypeSets.clear();
 
+    sizeConditions.clear();
+
     constants.clear();
   }
 
@@ -506,6 +509,20 @@ namespace osmscout {
     }
   }
 
+  template <class S, class A>
+  void GetSizeConditionsInConditionals(const std::list<ConditionalStyle<S,A> >& conditionals,
+                                       std::vector<SizeConditionRef>& sizeConditions)
+  {
+    for (const auto& conditional : conditionals) {
+      const SizeConditionRef& sizeCondition=conditional.filter.GetSizeCondition();
+
+      if (sizeCondition &&
+          std::find(sizeConditions.begin(),sizeConditions.end(),sizeCondition)==sizeConditions.end()) {
+        sizeConditions.push_back(sizeCondition);
+      }
+    }
+  }
+
   template <class S, class A>
   void CalculateUsedTypes(const TypeConfig& typeConfig,
                           const std::list<ConditionalStyle<S,A> >& conditionals,
@@ -916,6 +933,21 @@ namespace osmscout {
 
   void StyleConfig::Postprocess()
   {
+    sizeConditions.clear();
+
+    GetSizeConditionsInConditionals(nodeTextStyleConditionals,sizeConditions);
+    GetSizeConditionsInConditionals(nodeIconStyleConditionals,sizeConditions);
+    GetSizeConditionsInConditionals(wayLineStyleConditionals,sizeConditions);
+    GetSizeConditionsInConditionals(wayPathTextStyleConditionals,sizeConditions);
+    GetSizeConditionsInConditionals(wayPathSymbolStyleConditionals,sizeConditions);
+    GetSizeConditionsInConditionals(wayPathShieldStyleConditionals,sizeConditions);
+    GetSizeConditionsInConditionals(areaFillStyleConditionals,sizeConditions);
+    GetSizeConditionsInConditionals(areaBorderStyleConditionals,sizeConditions);
+    GetSizeConditionsInConditionals(areaTextStyleConditionals,sizeConditions);
+    GetSizeConditionsInConditionals(areaIconStyleConditionals,sizeConditions);
+    GetSizeConditionsInConditionals(areaBorderTextStyleConditionals,sizeConditions);
+    GetSizeConditionsInConditionals(areaBorderSymbolStyleConditionals,sizeConditions);
+
     PostprocessNodes();
     PostprocessWays();
     PostprocessAreas();
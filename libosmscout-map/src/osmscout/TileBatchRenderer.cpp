@@ -0,0 +1,456 @@
+/*
+  This source is part of the libosmscout-map library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/TileBatchRenderer.h>
+
+#include <algorithm>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/Logger.h>
+#include <osmscout/util/StopClock.h>
+
+namespace osmscout {
+
+  TileBatchPainter::~TileBatchPainter()
+  {
+    // no code
+  }
+
+  TileBatchSink::~TileBatchSink()
+  {
+    // no code
+  }
+
+  FileTileBatchSink::FileTileBatchSink(const std::string& directory,
+                                       const std::string& extension)
+  : directory(directory),
+    extension(extension)
+  {
+    // no code
+  }
+
+  std::string FileTileBatchSink::GetFilename(const Magnification& magnification,
+                                             const OSMTileId& tileId) const
+  {
+    return AppendFileToDir(directory,
+                           std::to_string(magnification.GetLevel())+"_"+
+                           std::to_string(tileId.GetX())+"_"+
+                           std::to_string(tileId.GetY())+"."+extension);
+  }
+
+  bool FileTileBatchSink::HasTile(const Magnification& magnification,
+                                  const OSMTileId& tileId)
+  {
+    return ExistsInFilesystem(GetFilename(magnification,
+                                          tileId));
+  }
+
+  /**
+   * Write the tile into a temporary file first and rename it afterwards, so that
+   * an interrupted run does not leave truncated tiles that would be skipped
+   * on resume.
+   */
+  bool FileTileBatchSink::WriteTile(const Magnification& magnification,
+                                    const OSMTileId& tileId,
+                                    const std::string& data)
+  {
+    std::string filename=GetFilename(magnification,
+                                     tileId);
+    std::string tmpFilename=filename+".tmp";
+
+    std::ofstream file(tmpFilename,std::ios::out|std::ios::binary|std::ios::trunc);
+
+    file.write(data.data(),data.length());
+    file.close();
+
+    if (!file) {
+      log.Error() << "Cannot write tile '" << tmpFilename << "'";
+      RemoveFile(tmpFilename);
+      return false;
+    }
+
+    if (!RenameFile(tmpFilename,
+                    filename)) {
+      log.Error() << "Cannot rename '" << tmpFilename << "' to '" << filename << "'";
+      return false;
+    }
+
+    return true;
+  }
+
+  TileStoreBatchSink::TileStoreBatchSink(const TileStoreRef& store,
+                                         uint64_t space)
+  : store(store),
+    space(space)
+  {
+    // no code
+  }
+
+  bool TileStoreBatchSink::HasTile(const Magnification& magnification,
+                                   const OSMTileId& tileId)
+  {
+    return store->Contains(space,
+                           MagnificationLevel(magnification.GetLevel()),
+                           tileId);
+  }
+
+  bool TileStoreBatchSink::WriteTile(const Magnification& magnification,
+                                     const OSMTileId& tileId,
+                                     const std::string& data)
+  {
+    return store->Put(space,
+                      MagnificationLevel(magnification.GetLevel()),
+                      tileId,
+                      data);
+  }
+
+  TileBatchParameter::TileBatchParameter()
+  : threadCount(std::max(1u,std::thread::hardware_concurrency())),
+    metaTileSize(4),
+    tileWidth(256),
+    tileHeight(256),
+    dpi(96.0),
+    skipExisting(true)
+  {
+    searchParameter.SetUseLowZoomOptimization(true);
+    searchParameter.SetMaximumAreaLevel(3);
+  }
+
+  void TileBatchParameter::SetThreadCount(size_t threadCount)
+  {
+    this->threadCount=std::max((size_t)1,threadCount);
+  }
+
+  void TileBatchParameter::SetMetaTileSize(uint32_t metaTileSize)
+  {
+    this->metaTileSize=std::max(1u,metaTileSize);
+  }
+
+  void TileBatchParameter::SetTileSize(size_t tileWidth,
+                                       size_t tileHeight)
+  {
+    this->tileWidth=tileWidth;
+    this->tileHeight=tileHeight;
+  }
+
+  void TileBatchParameter::SetDPI(double dpi)
+  {
+    this->dpi=dpi;
+  }
+
+  void TileBatchParameter::SetSkipExisting(bool skipExisting)
+  {
+    this->skipExisting=skipExisting;
+  }
+
+  void TileBatchParameter::SetSearchParameter(const AreaSearchParameter& searchParameter)
+  {
+    this->searchParameter=searchParameter;
+  }
+
+  void TileBatchStatistics::Add(const TileBatchStatistics& other)
+  {
+    tileCount+=other.tileCount;
+    skippedTileCount+=other.skippedTileCount;
+    failedTileCount+=other.failedTileCount;
+    dataTileHits+=other.dataTileHits;
+    dataTileMisses+=other.dataTileMisses;
+    loadTime+=other.loadTime;
+    mergeTime+=other.mergeTime;
+    renderTime+=other.renderTime;
+    writeTime+=other.writeTime;
+    totalTime+=other.totalTime;
+  }
+
+  double TileBatchStatistics::GetTilesPerSecond() const
+  {
+    if (totalTime<=0.0) {
+      return 0.0;
+    }
+
+    return tileCount*1000.0/totalTime;
+  }
+
+  double TileBatchStatistics::GetDataTileHitRate() const
+  {
+    if (dataTileHits+dataTileMisses==0) {
+      return 0.0;
+    }
+
+    return static_cast<double>(dataTileHits)/(dataTileHits+dataTileMisses);
+  }
+
+  TileBatchRenderer::TileBatchRenderer(const MapServiceRef& mapService,
+                                       const StyleConfigRef& styleConfig,
+                                       const TileBatchParameter& parameter)
+  : mapService(mapService),
+    styleConfig(styleConfig),
+    parameter(parameter),
+    aborted(false)
+  {
+    // no code
+  }
+
+  void TileBatchRenderer::RenderMetaTiles(const Magnification& magnification,
+                                          const OSMTileIdBox& tileBox,
+                                          uint32_t metaTileColumns,
+                                          uint32_t metaTileCount,
+                                          std::atomic<uint32_t>& nextMetaTile,
+                                          TileBatchPainter& painter,
+                                          TileBatchSink& sink,
+                                          TileBatchStatistics& statistics)
+  {
+    uint32_t metaTileSize=parameter.GetMetaTileSize();
+    uint32_t metaTileIndex;
+
+    while (!aborted &&
+           (metaTileIndex=nextMetaTile.fetch_add(1))<metaTileCount) {
+      uint32_t               column=metaTileIndex%metaTileColumns;
+      uint32_t               row=metaTileIndex/metaTileColumns;
+      OSMTileId              minTile(tileBox.GetMinX()+column*metaTileSize,
+                                     tileBox.GetMinY()+row*metaTileSize);
+      OSMTileId              maxTile(std::min(minTile.GetX()+metaTileSize-1,tileBox.GetMaxX()),
+                                     std::min(minTile.GetY()+metaTileSize-1,tileBox.GetMaxY()));
+      OSMTileIdBox           metaTile(minTile,maxTile);
+      std::vector<OSMTileId> tileIds;
+
+      for (const auto& tileId : metaTile) {
+        if (parameter.GetSkipExisting() &&
+            sink.HasTile(magnification,tileId)) {
+          statistics.skippedTileCount++;
+          continue;
+        }
+
+        tileIds.push_back(tileId);
+      }
+
+      if (tileIds.empty()) {
+        continue;
+      }
+
+      // Load the data of the whole meta tile at once
+      StopClock          loadTimer;
+      std::list<TileRef> dataTiles;
+
+      mapService->LookupTiles(magnification,
+                              metaTile.GetBoundingBox(magnification),
+                              dataTiles);
+
+      for (const auto& dataTile : dataTiles) {
+        if (dataTile->IsComplete()) {
+          statistics.dataTileHits++;
+        }
+        else {
+          statistics.dataTileMisses++;
+        }
+      }
+
+      bool loaded=mapService->LoadMissingTileData(parameter.GetSearchParameter(),
+                                                  *styleConfig,
+                                                  dataTiles);
+
+      loadTimer.Stop();
+      statistics.loadTime+=loadTimer.GetMilliseconds();
+
+      if (!loaded) {
+        log.Error() << "Cannot load data for meta tile " << magnification.GetLevel() << " " << metaTile.GetDisplayText();
+        statistics.failedTileCount+=tileIds.size();
+        continue;
+      }
+
+      for (const auto& tileId : tileIds) {
+        StopClock          mergeTimer;
+        TileProjection     projection;
+        MapData            data;
+        std::list<TileRef> tiles;
+
+        projection.Set(tileId,
+                       magnification,
+                       parameter.GetDPI(),
+                       parameter.GetTileWidth(),
+                       parameter.GetTileHeight());
+
+        mapService->LookupTiles(magnification,
+                                tileId.GetBoundingBox(magnification),
+                                tiles);
+
+        // Normally a no-op, since the meta tile has been loaded already, but tiles
+        // might have been evicted from the cache in between
+        if (!mapService->LoadMissingTileData(parameter.GetSearchParameter(),
+                                             *styleConfig,
+                                             tiles)) {
+          statistics.failedTileCount++;
+          continue;
+        }
+
+        mapService->AddTileDataToMapData(tiles,
+                                         data);
+        mapService->GetGroundTiles(projection,
+                                   data.groundTiles);
+
+        mergeTimer.Stop();
+        statistics.mergeTime+=mergeTimer.GetMilliseconds();
+
+        StopClock   renderTimer;
+        std::string output;
+        bool        rendered=painter.RenderTile(tileId,
+                                                projection,
+                                                data,
+                                                output);
+
+        renderTimer.Stop();
+        statistics.renderTime+=renderTimer.GetMilliseconds();
+
+        if (!rendered) {
+          log.Error() << "Cannot render tile " << magnification.GetLevel() << " " << tileId.GetDisplayText();
+          statistics.failedTileCount++;
+          continue;
+        }
+
+        StopClock writeTimer;
+        bool      written=sink.WriteTile(magnification,
+                                         tileId,
+                                         output);
+
+        writeTimer.Stop();
+        statistics.writeTime+=writeTimer.GetMilliseconds();
+
+        if (!written) {
+          statistics.failedTileCount++;
+          continue;
+        }
+
+        statistics.tileCount++;
+      }
+    }
+  }
+
+  /**
+   * Render all tiles of the given bounding box for all levels between startLevel and
+   * endLevel (both inclusive). The painter factory is called once per thread.
+   *
+   * Statistics of the run are added to the given statistics.
+   *
+   * An Abort() called before or during the run stops it. The abort flag is
+   * reset when Render() returns, so the next call starts normally.
+   *
+   * @return true, if all tiles were rendered and written successfully
+   */
+  bool TileBatchRenderer::Render(const GeoBox& boundingBox,
+                                 const MagnificationLevel& startLevel,
+                                 const MagnificationLevel& endLevel,
+                                 const PainterFactory& painterFactory,
+                                 TileBatchSink& sink,
+                                 TileBatchStatistics& statistics)
+  {
+    std::vector<TileBatchPainterRef> painters;
+
+    for (size_t t=0; t<parameter.GetThreadCount(); t++) {
+      TileBatchPainterRef painter=painterFactory();
+
+      if (!painter) {
+        log.Error() << "Cannot create painter";
+        aborted=false;
+        return false;
+      }
+
+      painters.push_back(painter);
+    }
+
+    StopClock totalTimer;
+    bool      success=true;
+
+    for (MagnificationLevel level=std::min(startLevel,endLevel);
+         level<=std::max(startLevel,endLevel) && !aborted;
+         level++) {
+      Magnification                    magnification(level);
+      OSMTileIdBox                     tileBox(OSMTileId::GetOSMTile(magnification,
+                                                                     boundingBox.GetMinCoord()),
+                                               OSMTileId::GetOSMTile(magnification,
+                                                                     boundingBox.GetMaxCoord()));
+      uint32_t                         metaTileSize=parameter.GetMetaTileSize();
+      uint32_t                         metaTileColumns=(tileBox.GetWidth()+metaTileSize-1)/metaTileSize;
+      uint32_t                         metaTileRows=(tileBox.GetHeight()+metaTileSize-1)/metaTileSize;
+      std::atomic<uint32_t>            nextMetaTile(0);
+      std::vector<TileBatchStatistics> threadStatistics(painters.size());
+      std::vector<std::thread>         threads;
+      StopClock                        levelTimer;
+
+      log.Info() << "Rendering level " << level.Get() << ", " << tileBox.GetCount() << " tiles " << tileBox.GetDisplayText();
+
+      for (size_t t=0; t<painters.size(); t++) {
+        threads.emplace_back(&TileBatchRenderer::RenderMetaTiles,
+                             this,
+                             std::cref(magnification),
+                             std::cref(tileBox),
+                             metaTileColumns,
+                             metaTileColumns*metaTileRows,
+                             std::ref(nextMetaTile),
+                             std::ref(*painters[t]),
+                             std::ref(sink),
+                             std::ref(threadStatistics[t]));
+      }
+
+      for (auto& thread : threads) {
+        thread.join();
+      }
+
+      levelTimer.Stop();
+
+      TileBatchStatistics levelStatistics;
+
+      for (const auto& threadStatistic : threadStatistics) {
+        levelStatistics.Add(threadStatistic);
+      }
+
+      levelStatistics.totalTime=levelTimer.GetMilliseconds();
+
+      log.Info() << "Level " << level.Get() << ": "
+                 << levelStatistics.tileCount << " rendered, "
+                 << levelStatistics.skippedTileCount << " skipped, "
+                 << levelStatistics.failedTileCount << " failed, "
+                 << levelStatistics.GetTilesPerSecond() << " tiles/s, "
+                 << "data tile hit rate " << levelStatistics.GetDataTileHitRate()*100.0 << "%";
+
+      success=success && levelStatistics.failedTileCount==0;
+
+      levelStatistics.totalTime=0.0;
+      statistics.Add(levelStatistics);
+    }
+
+    totalTimer.Stop();
+    statistics.totalTime+=totalTimer.GetMilliseconds();
+
+    bool wasAborted=aborted.exchange(false);
+
+    return success && !wasAborted;
+  }
+
+  /**
+   * Stop rendering after the current meta tiles. Can be called from any thread.
+   * If no Render() call is running, the next one stops immediately.
+   */
+  void TileBatchRenderer::Abort()
+  {
+    aborted=true;
+  }
+}
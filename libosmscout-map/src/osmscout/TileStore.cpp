@@ -0,0 +1,561 @@
+/*
+  This source is part of the libosmscout-map library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/TileStore.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/Logger.h>
+
+namespace osmscout {
+
+  static const char     magic[4]={'O','S','T','S'};
+  static const uint64_t initialSlotCount=4096;
+
+  static inline uint64_t HashKey(uint64_t space,
+                                 uint32_t level,
+                                 uint32_t x,
+                                 uint32_t y)
+  {
+    uint64_t hash=space;
+
+    hash^=(static_cast<uint64_t>(level)+1)*0x9e3779b97f4a7c15ULL;
+    hash^=((static_cast<uint64_t>(x) << 32) | y)*0xc2b2ae3d27d4eb4fULL;
+    hash^=hash >> 31;
+    hash*=0xbf58476d1ce4e5b9ULL;
+    hash^=hash >> 29;
+
+    return hash;
+  }
+
+  TileStore::TileStore()
+  : maxDataSize(0)
+  {
+    // no code
+  }
+
+  TileStore::~TileStore()
+  {
+    Close();
+  }
+
+  std::string TileStore::GetIndexFilename() const
+  {
+    return AppendFileToDir(directory,"tiles.idx");
+  }
+
+  std::string TileStore::GetPackFilename() const
+  {
+    return AppendFileToDir(directory,"tiles.dat");
+  }
+
+  /**
+   * Return the slot for the given key, or the empty slot where the key
+   * would have to be inserted
+   */
+  TileStore::Slot* TileStore::FindSlot(uint64_t space,
+                                       uint32_t level,
+                                       uint32_t x,
+                                       uint32_t y) const
+  {
+    uint64_t mask=GetHeader().slotCount-1;
+    uint64_t pos=HashKey(space,level,x,y) & mask;
+    Slot*    slots=GetSlots();
+
+    while (true) {
+      Slot& slot=slots[pos];
+
+      if (slot.size==0 ||
+          (slot.space==space &&
+           slot.level==level &&
+           slot.x==x &&
+           slot.y==y)) {
+        return &slot;
+      }
+
+      pos=(pos+1) & mask;
+    }
+  }
+
+  /**
+   * Resize the index to the given number of slots and clear all slots. Data size
+   * and access counter are preserved.
+   *
+   * @throws IOException
+   */
+  void TileStore::InitializeIndex(uint64_t slotCount)
+  {
+    uint64_t dataSize=0;
+    uint64_t accessCounter=0;
+
+    if (index.GetSize()>=sizeof(Header) &&
+        std::memcmp(GetHeader().magic,magic,sizeof(magic))==0) {
+      dataSize=GetHeader().dataSize;
+      accessCounter=GetHeader().accessCounter;
+    }
+
+    index.Resize(sizeof(Header)+slotCount*sizeof(Slot));
+
+    std::memset(index.GetData(),0,index.GetSize());
+
+    Header& header=GetHeader();
+
+    std::memcpy(header.magic,magic,sizeof(magic));
+    header.version=FILE_FORMAT_VERSION;
+    header.slotCount=slotCount;
+    header.usedCount=0;
+    header.dataSize=dataSize;
+    header.accessCounter=accessCounter;
+  }
+
+  /**
+   * Drop all tiles
+   *
+   * @throws IOException
+   */
+  void TileStore::Reset()
+  {
+    if (pack.is_open()) {
+      pack.close();
+    }
+
+    pack.open(GetPackFilename(),
+              std::ios::in|std::ios::out|std::ios::binary|std::ios::trunc);
+
+    if (!pack) {
+      throw IOException(GetPackFilename(),"Cannot create tile pack file");
+    }
+
+    index.Resize(0);
+    InitializeIndex(initialSlotCount);
+  }
+
+  /**
+   * Double the number of slots of the index
+   *
+   * @throws IOException
+   */
+  void TileStore::Grow()
+  {
+    std::vector<Slot> usedSlots;
+    Slot*             slots=GetSlots();
+
+    usedSlots.reserve(GetHeader().usedCount);
+
+    for (uint64_t i=0; i<GetHeader().slotCount; i++) {
+      if (slots[i].size>0) {
+        usedSlots.push_back(slots[i]);
+      }
+    }
+
+    InitializeIndex(GetHeader().slotCount*2);
+
+    for (const auto& usedSlot : usedSlots) {
+      *FindSlot(usedSlot.space,usedSlot.level,usedSlot.x,usedSlot.y)=usedSlot;
+    }
+
+    GetHeader().usedCount=usedSlots.size();
+  }
+
+  /**
+   * Rewrite the pack file, keeping only the most recently used tiles up to
+   * the given size of data.
+   *
+   * The new pack is written to a separate file first. Before it replaces the
+   * current pack, the index is emptied and written back, so a crash while
+   * replacing the pack leaves an empty store instead of an index pointing at
+   * offsets of the old pack. If the pack cannot be replaced, the old pack and
+   * index are kept.
+   *
+   * @throws IOException
+   */
+  void TileStore::Compact(uint64_t targetSize)
+  {
+    std::vector<Slot> usedSlots;
+    Slot*             slots=GetSlots();
+
+    usedSlots.reserve(GetHeader().usedCount);
+
+    for (uint64_t i=0; i<GetHeader().slotCount; i++) {
+      if (slots[i].size>0) {
+        usedSlots.push_back(slots[i]);
+      }
+    }
+
+    std::sort(usedSlots.begin(),
+              usedSlots.end(),
+              [](const Slot& a, const Slot& b) {
+                return a.lastAccess>b.lastAccess;
+              });
+
+    std::string       newPackFilename=GetPackFilename()+".new";
+    std::ofstream     newPack(newPackFilename,std::ios::out|std::ios::binary|std::ios::trunc);
+    std::vector<char> buffer;
+    std::vector<Slot> keptSlots;
+    uint64_t          newDataSize=0;
+
+    for (const auto& usedSlot : usedSlots) {
+      if (newDataSize+usedSlot.size>targetSize) {
+        break;
+      }
+
+      buffer.resize(usedSlot.size);
+
+      pack.seekg(usedSlot.offset);
+      pack.read(buffer.data(),usedSlot.size);
+      newPack.write(buffer.data(),usedSlot.size);
+
+      if (!pack || !newPack) {
+        pack.clear();
+        newPack.close();
+        RemoveFile(newPackFilename);
+        throw IOException(newPackFilename,"Cannot compact tile pack file");
+      }
+
+      keptSlots.push_back(usedSlot);
+      keptSlots.back().offset=newDataSize;
+      newDataSize+=usedSlot.size;
+    }
+
+    newPack.close();
+
+    if (!newPack) {
+      RemoveFile(newPackFilename);
+      throw IOException(newPackFilename,"Cannot write tile pack file");
+    }
+
+    uint64_t oldDataSize=GetHeader().dataSize;
+
+    InitializeIndex(GetHeader().slotCount);
+    GetHeader().dataSize=0;
+    index.Flush();
+
+    pack.close();
+
+    bool replaced=RenameFile(newPackFilename,GetPackFilename());
+
+    if (!replaced) {
+      RemoveFile(newPackFilename);
+    }
+
+    pack.open(GetPackFilename(),
+              std::ios::in|std::ios::out|std::ios::binary);
+
+    if (!pack) {
+      throw IOException(GetPackFilename(),"Cannot open tile pack file");
+    }
+
+    const std::vector<Slot>& slotsToKeep=replaced ? keptSlots : usedSlots;
+
+    for (const auto& slot : slotsToKeep) {
+      *FindSlot(slot.space,slot.level,slot.x,slot.y)=slot;
+    }
+
+    GetHeader().usedCount=slotsToKeep.size();
+    GetHeader().dataSize=replaced ? newDataSize : oldDataSize;
+
+    index.Flush();
+
+    if (!replaced) {
+      log.Error() << "Cannot replace tile pack file '" << GetPackFilename() << "', tile store is not compacted";
+      return;
+    }
+
+    log.Info() << "Compacted tile store '" << directory << "': kept " << keptSlots.size() << " of " << usedSlots.size() << " tiles";
+  }
+
+  /**
+   * Open (or create) the tile store in the given directory. The directory must
+   * already exist. If maxDataSize is greater than 0, the store is compacted
+   * whenever the pack file grows beyond maxDataSize bytes.
+   *
+   * An index that is invalid or does not match the pack file is reset.
+   */
+  bool TileStore::Open(const std::string& directory,
+                       uint64_t maxDataSize)
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+
+    if (index.IsOpen()) {
+      log.Error() << "Tile store '" << this->directory << "' already opened";
+      return false;
+    }
+
+    this->directory=directory;
+    this->maxDataSize=maxDataSize;
+
+    try {
+      if (!ExistsInFilesystem(GetPackFilename())) {
+        std::ofstream(GetPackFilename(),std::ios::out|std::ios::binary);
+      }
+
+      pack.open(GetPackFilename(),
+                std::ios::in|std::ios::out|std::ios::binary);
+
+      if (!pack) {
+        throw IOException(GetPackFilename(),"Cannot open tile pack file");
+      }
+
+      index.Open(GetIndexFilename(),
+                 true);
+
+      if (index.GetSize()<sizeof(Header) ||
+          std::memcmp(GetHeader().magic,magic,sizeof(magic))!=0 ||
+          GetHeader().version!=FILE_FORMAT_VERSION ||
+          index.GetSize()!=sizeof(Header)+GetHeader().slotCount*sizeof(Slot) ||
+          GetFileSize(GetPackFilename())<GetHeader().dataSize) {
+        log.Warn() << "Tile store '" << directory << "' is empty, outdated or inconsistent, resetting";
+        Reset();
+      }
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      index.CloseFailsafe();
+      pack.close();
+      return false;
+    }
+
+    return true;
+  }
+
+  void TileStore::Close()
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+
+    if (pack.is_open()) {
+      pack.close();
+    }
+
+    try {
+      if (index.IsOpen()) {
+        index.Close();
+      }
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+    }
+  }
+
+  bool TileStore::IsOpen() const
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+
+    return index.IsOpen();
+  }
+
+  bool TileStore::Contains(uint64_t space,
+                           const MagnificationLevel& level,
+                           const OSMTileId& tile) const
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+
+    if (!index.IsOpen()) {
+      return false;
+    }
+
+    return FindSlot(space,level.Get(),tile.GetX(),tile.GetY())->size>0;
+  }
+
+  /**
+   * Return the data of the given tile. Returns false, if the tile is not in the store
+   * or cannot be read.
+   */
+  bool TileStore::Get(uint64_t space,
+                      const MagnificationLevel& level,
+                      const OSMTileId& tile,
+                      std::string& data)
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+
+    if (!index.IsOpen()) {
+      return false;
+    }
+
+    Slot* slot=FindSlot(space,level.Get(),tile.GetX(),tile.GetY());
+
+    if (slot->size==0) {
+      return false;
+    }
+
+    data.resize(slot->size);
+
+    pack.seekg(slot->offset);
+    pack.read(&data[0],slot->size);
+
+    if (!pack) {
+      log.Error() << "Cannot read tile from '" << GetPackFilename() << "'";
+      pack.clear();
+      return false;
+    }
+
+    slot->lastAccess=++GetHeader().accessCounter;
+
+    return true;
+  }
+
+  /**
+   * Store the given (non-empty) data for the given tile, replacing existing data.
+   */
+  bool TileStore::Put(uint64_t space,
+                      const MagnificationLevel& level,
+                      const OSMTileId& tile,
+                      const std::string& data)
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+
+    if (!index.IsOpen() ||
+        data.empty()) {
+      return false;
+    }
+
+    try {
+      Header&  header=GetHeader();
+      uint64_t offset=header.dataSize;
+
+      // Make sure that the data has reached the file before it gets referenced
+      // by the index
+      pack.seekp(offset);
+      pack.write(data.data(),data.length());
+      pack.flush();
+
+      if (!pack) {
+        pack.clear();
+        throw IOException(GetPackFilename(),"Cannot write tile");
+      }
+
+      header.dataSize+=data.length();
+
+      Slot* slot=FindSlot(space,level.Get(),tile.GetX(),tile.GetY());
+
+      if (slot->size==0) {
+        slot->space=space;
+        slot->level=level.Get();
+        slot->x=tile.GetX();
+        slot->y=tile.GetY();
+        header.usedCount++;
+      }
+
+      slot->offset=offset;
+      slot->size=static_cast<uint32_t>(data.length());
+      slot->lastAccess=++header.accessCounter;
+
+      if (header.usedCount*10>header.slotCount*7) {
+        Grow();
+      }
+
+      if (maxDataSize>0 &&
+          GetHeader().dataSize>maxDataSize) {
+        Compact(maxDataSize/4*3);
+      }
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Remove all tiles from the store
+   */
+  bool TileStore::Clear()
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+
+    if (!index.IsOpen()) {
+      return false;
+    }
+
+    try {
+      Reset();
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      return false;
+    }
+
+    return true;
+  }
+
+  bool TileStore::Flush()
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+
+    if (!index.IsOpen()) {
+      return false;
+    }
+
+    try {
+      pack.flush();
+      index.Flush();
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      return false;
+    }
+
+    return true;
+  }
+
+  size_t TileStore::GetTileCount() const
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+
+    if (!index.IsOpen()) {
+      return 0;
+    }
+
+    return GetHeader().usedCount;
+  }
+
+  /**
+   * Return the size of the pack file, including data of replaced tiles
+   * not yet removed by compaction
+   */
+  uint64_t TileStore::GetDataSize() const
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+
+    if (!index.IsOpen()) {
+      return 0;
+    }
+
+    return GetHeader().dataSize;
+  }
+
+  /**
+   * Calculate a namespace from a textual description of everything that influences
+   * the content of the tiles (FNV-1a hash)
+   */
+  uint64_t TileStore::GetNamespace(const std::string& description)
+  {
+    uint64_t hash=0xcbf29ce484222325ULL;
+
+    for (const auto c : description) {
+      hash^=static_cast<unsigned char>(c);
+      hash*=0x100000001b3ULL;
+    }
+
+    return hash;
+  }
+}
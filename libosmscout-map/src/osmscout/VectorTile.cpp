@@ -0,0 +1,846 @@
+/*
+  This source is part of the libosmscout-map library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/VectorTile.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <osmscout/util/Projection.h>
+
+#include <osmscout/system/Assert.h>
+
+namespace osmscout {
+
+  /**
+   * Protocol buffer wire types used by the vector tile encoding
+   */
+  static const uint32_t wireTypeVarint         =0;
+  static const uint32_t wireTypeLengthDelimited=2;
+
+  /**
+   * Geometry command ids as defined by the vector tile specification
+   */
+  static const uint32_t commandMoveTo   =1;
+  static const uint32_t commandLineTo   =2;
+  static const uint32_t commandClosePath=7;
+
+  static inline void EncodeVarint(uint64_t value,
+                                  std::string& buffer)
+  {
+    while (value>=0x80) {
+      buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+      value>>=7;
+    }
+
+    buffer.push_back(static_cast<char>(value));
+  }
+
+  static inline void EncodeKey(uint32_t field,
+                               uint32_t wireType,
+                               std::string& buffer)
+  {
+    EncodeVarint((field << 3) | wireType,
+                 buffer);
+  }
+
+  static inline void EncodeLengthDelimited(uint32_t field,
+                                           const std::string& value,
+                                           std::string& buffer)
+  {
+    EncodeKey(field,wireTypeLengthDelimited,buffer);
+    EncodeVarint(value.length(),buffer);
+    buffer.append(value);
+  }
+
+  static inline void EncodePacked(uint32_t field,
+                                  const std::vector<uint32_t>& values,
+                                  std::string& buffer)
+  {
+    std::string packed;
+
+    for (const auto value : values) {
+      EncodeVarint(value,packed);
+    }
+
+    EncodeLengthDelimited(field,packed,buffer);
+  }
+
+  static inline uint32_t ZigZag(int32_t value)
+  {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+  }
+
+  static inline uint32_t Command(uint32_t id,
+                                 uint32_t count)
+  {
+    return (id & 0x7) | (count << 3);
+  }
+
+  /**
+   * Appends the given points as a MoveTo command followed by a LineTo command
+   * to the geometry, updating the cursor.
+   */
+  static void EncodePath(const std::vector<VectorTilePoint>& points,
+                         size_t count,
+                         VectorTilePoint& cursor,
+                         std::vector<uint32_t>& geometry)
+  {
+    geometry.push_back(Command(commandMoveTo,1));
+    geometry.push_back(ZigZag(points[0].x-cursor.x));
+    geometry.push_back(ZigZag(points[0].y-cursor.y));
+    cursor=points[0];
+
+    geometry.push_back(Command(commandLineTo,static_cast<uint32_t>(count-1)));
+
+    for (size_t i=1; i<count; i++) {
+      geometry.push_back(ZigZag(points[i].x-cursor.x));
+      geometry.push_back(ZigZag(points[i].y-cursor.y));
+      cursor=points[i];
+    }
+  }
+
+  VectorTileLayer::VectorTileLayer(const std::string& name,
+                                   uint32_t extent)
+  : name(name),
+    extent(extent),
+    featureCount(0)
+  {
+    // no code
+  }
+
+  uint32_t VectorTileLayer::GetKeyIndex(const std::string& key)
+  {
+    auto entry=keyIndex.find(key);
+
+    if (entry!=keyIndex.end()) {
+      return entry->second;
+    }
+
+    uint32_t index=static_cast<uint32_t>(keys.size());
+
+    keys.push_back(key);
+    keyIndex[key]=index;
+
+    return index;
+  }
+
+  uint32_t VectorTileLayer::GetValueIndex(const std::string& value)
+  {
+    auto entry=valueIndex.find(value);
+
+    if (entry!=valueIndex.end()) {
+      return entry->second;
+    }
+
+    uint32_t index=static_cast<uint32_t>(values.size());
+
+    values.push_back(value);
+    valueIndex[value]=index;
+
+    return index;
+  }
+
+  void VectorTileLayer::AddFeature(uint64_t id,
+                                   const Properties& properties,
+                                   GeometryType type,
+                                   const std::vector<uint32_t>& geometry)
+  {
+    std::string           feature;
+    std::vector<uint32_t> tags;
+
+    tags.reserve(properties.size()*2);
+
+    for (const auto& property : properties) {
+      tags.push_back(GetKeyIndex(property.first));
+      tags.push_back(GetValueIndex(property.second));
+    }
+
+    EncodeKey(1,wireTypeVarint,feature);
+    EncodeVarint(id,feature);
+
+    if (!tags.empty()) {
+      EncodePacked(2,tags,feature);
+    }
+
+    EncodeKey(3,wireTypeVarint,feature);
+    EncodeVarint(static_cast<uint32_t>(type),feature);
+
+    EncodePacked(4,geometry,feature);
+
+    EncodeLengthDelimited(2,feature,features);
+    featureCount++;
+  }
+
+  void VectorTileLayer::AddPoint(uint64_t id,
+                                 const Properties& properties,
+                                 const VectorTilePoint& point)
+  {
+    std::vector<uint32_t> geometry;
+
+    geometry.reserve(3);
+    geometry.push_back(Command(commandMoveTo,1));
+    geometry.push_back(ZigZag(point.x));
+    geometry.push_back(ZigZag(point.y));
+
+    AddFeature(id,
+               properties,
+               GeometryType::point,
+               geometry);
+  }
+
+  /**
+   * Add a (multi) line string feature. Lines with less than two points are ignored.
+   * If no line is left, no feature is added.
+   */
+  void VectorTileLayer::AddLineStrings(uint64_t id,
+                                       const Properties& properties,
+                                       const std::vector<std::vector<VectorTilePoint>>& lines)
+  {
+    std::vector<uint32_t> geometry;
+    VectorTilePoint       cursor;
+
+    for (const auto& line : lines) {
+      if (line.size()<2) {
+        continue;
+      }
+
+      EncodePath(line,
+                 line.size(),
+                 cursor,
+                 geometry);
+    }
+
+    if (geometry.empty()) {
+      return;
+    }
+
+    AddFeature(id,
+               properties,
+               GeometryType::lineString,
+               geometry);
+  }
+
+  /**
+   * Add a (multi) polygon feature. Rings must be passed without repeating the first point
+   * at the end and must already be correctly oriented (exterior rings with positive,
+   * interior rings with negative area in tile coordinates). Each exterior ring must
+   * be followed by its interior rings. Rings with less than three points are ignored.
+   */
+  void VectorTileLayer::AddPolygon(uint64_t id,
+                                   const Properties& properties,
+                                   const std::vector<std::vector<VectorTilePoint>>& rings)
+  {
+    std::vector<uint32_t> geometry;
+    VectorTilePoint       cursor;
+
+    for (const auto& ring : rings) {
+      if (ring.size()<3) {
+        continue;
+      }
+
+      EncodePath(ring,
+                 ring.size(),
+                 cursor,
+                 geometry);
+
+      geometry.push_back(Command(commandClosePath,1));
+    }
+
+    if (geometry.empty()) {
+      return;
+    }
+
+    AddFeature(id,
+               properties,
+               GeometryType::polygon,
+               geometry);
+  }
+
+  /**
+   * Append the encoded layer message (without the enclosing tile field) to the buffer
+   */
+  void VectorTileLayer::Encode(std::string& buffer) const
+  {
+    EncodeKey(15,wireTypeVarint,buffer);
+    EncodeVarint(2,buffer);
+
+    EncodeLengthDelimited(1,name,buffer);
+
+    buffer.append(features);
+
+    for (const auto& key : keys) {
+      EncodeLengthDelimited(3,key,buffer);
+    }
+
+    for (const auto& value : values) {
+      std::string valueMessage;
+
+      EncodeLengthDelimited(1,value,valueMessage);
+      EncodeLengthDelimited(4,valueMessage,buffer);
+    }
+
+    EncodeKey(5,wireTypeVarint,buffer);
+    EncodeVarint(extent,buffer);
+  }
+
+  VectorTile::VectorTile(uint32_t extent)
+  : extent(extent)
+  {
+    // no code
+  }
+
+  /**
+   * Return the layer with the given name, creating it if it does not exist yet
+   */
+  VectorTileLayer& VectorTile::GetLayer(const std::string& name)
+  {
+    for (auto& layer : layers) {
+      if (layer.GetName()==name) {
+        return layer;
+      }
+    }
+
+    layers.emplace_back(name,extent);
+
+    return layers.back();
+  }
+
+  size_t VectorTile::GetFeatureCount() const
+  {
+    size_t count=0;
+
+    for (const auto& layer : layers) {
+      count+=layer.GetFeatureCount();
+    }
+
+    return count;
+  }
+
+  /**
+   * Return the encoded tile. Empty layers are skipped.
+   */
+  std::string VectorTile::Encode() const
+  {
+    std::string buffer;
+
+    for (const auto& layer : layers) {
+      if (layer.IsEmpty()) {
+        continue;
+      }
+
+      std::string layerBuffer;
+
+      layer.Encode(layerBuffer);
+      EncodeLengthDelimited(3,layerBuffer,buffer);
+    }
+
+    return buffer;
+  }
+
+  VectorTileBuilder::VectorTileBuilder(const TypeConfig& typeConfig)
+  : nameReader(typeConfig),
+    refReader(typeConfig),
+    extent(4096),
+    buffer(64),
+    simplificationTolerance(1.0)
+  {
+    // no code
+  }
+
+  void VectorTileBuilder::SetExtent(uint32_t extent)
+  {
+    this->extent=extent;
+  }
+
+  /**
+   * Set the size of the border (in tile units) around the tile, geometries are clipped
+   * against
+   */
+  void VectorTileBuilder::SetBuffer(uint32_t buffer)
+  {
+    this->buffer=buffer;
+  }
+
+  /**
+   * Set the maximum allowed deviation (in tile units) of the simplified from the
+   * original geometry. 0.0 disables simplification (beside dropping duplicated points).
+   */
+  void VectorTileBuilder::SetSimplificationTolerance(double tolerance)
+  {
+    this->simplificationTolerance=tolerance;
+  }
+
+  void VectorTileBuilder::GetProperties(const FeatureValueBuffer& featureBuffer,
+                                        VectorTileLayer::Properties& properties) const
+  {
+    properties.clear();
+    properties.emplace_back("type",featureBuffer.GetType()->GetName());
+
+    NameFeatureValue *nameValue=nameReader.GetValue(featureBuffer);
+
+    if (nameValue!=nullptr) {
+      properties.emplace_back("name",nameValue->GetName());
+    }
+
+    RefFeatureValue *refValue=refReader.GetValue(featureBuffer);
+
+    if (refValue!=nullptr) {
+      properties.emplace_back("ref",refValue->GetRef());
+    }
+  }
+
+  /**
+   * Convert the vertices into integer tile coordinates, dropping consecutive duplicates
+   * and simplifying the result. For closed geometries the closing point is dropped, too.
+   */
+  void VectorTileBuilder::Quantize(const std::vector<Vertex>& vertices,
+                                   bool closed,
+                                   std::vector<VectorTilePoint>& points) const
+  {
+    points.clear();
+    points.reserve(vertices.size());
+
+    for (const auto& vertex : vertices) {
+      VectorTilePoint point(static_cast<int32_t>(std::lround(vertex.x)),
+                            static_cast<int32_t>(std::lround(vertex.y)));
+
+      if (points.empty() ||
+          points.back()!=point) {
+        points.push_back(point);
+      }
+    }
+
+    if (closed) {
+      while (points.size()>1 &&
+             points.front()==points.back()) {
+        points.pop_back();
+      }
+    }
+
+    if (simplificationTolerance>0.0) {
+      Simplify(points,
+               simplificationTolerance);
+    }
+  }
+
+  /**
+   * Clip the line against the given rectangle (Liang-Barsky per segment). Since a line
+   * may leave and reenter the rectangle, the result may consist of multiple parts.
+   */
+  void VectorTileBuilder::ClipLine(const std::vector<Vertex>& line,
+                                   double minX, double minY,
+                                   double maxX, double maxY,
+                                   std::vector<std::vector<Vertex>>& parts)
+  {
+    std::vector<Vertex> current;
+
+    for (size_t i=1; i<line.size(); i++) {
+      double x0=line[i-1].x;
+      double y0=line[i-1].y;
+      double dx=line[i].x-x0;
+      double dy=line[i].y-y0;
+      double t0=0.0;
+      double t1=1.0;
+      double p[4]={-dx,dx,-dy,dy};
+      double q[4]={x0-minX,maxX-x0,y0-minY,maxY-y0};
+      bool   visible=true;
+
+      for (size_t edge=0; edge<4 && visible; edge++) {
+        if (p[edge]==0.0) {
+          if (q[edge]<0.0) {
+            visible=false;
+          }
+        }
+        else {
+          double t=q[edge]/p[edge];
+
+          if (p[edge]<0.0) {
+            if (t>t1) {
+              visible=false;
+            }
+            else if (t>t0) {
+              t0=t;
+            }
+          }
+          else {
+            if (t<t0) {
+              visible=false;
+            }
+            else if (t<t1) {
+              t1=t;
+            }
+          }
+        }
+      }
+
+      if (!visible) {
+        if (!current.empty()) {
+          parts.push_back(std::move(current));
+          current.clear();
+        }
+
+        continue;
+      }
+
+      Vertex start{x0+t0*dx,y0+t0*dy};
+      Vertex end{x0+t1*dx,y0+t1*dy};
+
+      if (current.empty()) {
+        current.push_back(start);
+      }
+
+      current.push_back(end);
+
+      // The segment left the rectangle, the next visible segment starts a new part
+      if (t1<1.0) {
+        parts.push_back(std::move(current));
+        current.clear();
+      }
+    }
+
+    if (!current.empty()) {
+      parts.push_back(std::move(current));
+    }
+  }
+
+  /**
+   * Clip the closed ring against the given rectangle (Sutherland-Hodgman). The result
+   * is a closed ring, too, possibly having degenerated edges along the rectangle border.
+   */
+  void VectorTileBuilder::ClipRing(const std::vector<Vertex>& ring,
+                                   double minX, double minY,
+                                   double maxX, double maxY,
+                                   std::vector<Vertex>& result)
+  {
+    std::vector<Vertex> input;
+
+    result=ring;
+
+    for (size_t edge=0; edge<4 && !result.empty(); edge++) {
+      auto inside=[edge,minX,minY,maxX,maxY](const Vertex& v) -> bool {
+        switch (edge) {
+        case 0:
+          return v.x>=minX;
+        case 1:
+          return v.x<=maxX;
+        case 2:
+          return v.y>=minY;
+        default:
+          return v.y<=maxY;
+        }
+      };
+
+      auto intersect=[edge,minX,minY,maxX,maxY](const Vertex& a, const Vertex& b) -> Vertex {
+        double border;
+
+        switch (edge) {
+        case 0:
+          border=minX;
+          break;
+        case 1:
+          border=maxX;
+          break;
+        case 2:
+          border=minY;
+          break;
+        default:
+          border=maxY;
+          break;
+        }
+
+        if (edge<2) {
+          double t=(border-a.x)/(b.x-a.x);
+
+          return Vertex{border,a.y+t*(b.y-a.y)};
+        }
+
+        double t=(border-a.y)/(b.y-a.y);
+
+        return Vertex{a.x+t*(b.x-a.x),border};
+      };
+
+      input.swap(result);
+      result.clear();
+
+      Vertex previous=input.back();
+
+      for (const auto& current : input) {
+        if (inside(current)) {
+          if (!inside(previous)) {
+            result.push_back(intersect(previous,current));
+          }
+
+          result.push_back(current);
+        }
+        else if (inside(previous)) {
+          result.push_back(intersect(previous,current));
+        }
+
+        previous=current;
+      }
+    }
+  }
+
+  /**
+   * Simplify the given points using the Douglas-Peucker algorithm. The first and the last
+   * point are always kept.
+   */
+  void VectorTileBuilder::Simplify(std::vector<VectorTilePoint>& points,
+                                   double tolerance)
+  {
+    if (points.size()<3) {
+      return;
+    }
+
+    std::vector<bool>                     keep(points.size(),false);
+    std::vector<std::pair<size_t,size_t>> stack;
+    double                                toleranceSquared=tolerance*tolerance;
+
+    keep.front()=true;
+    keep.back()=true;
+    stack.emplace_back(0,points.size()-1);
+
+    while (!stack.empty()) {
+      size_t start=stack.back().first;
+      size_t end=stack.back().second;
+
+      stack.pop_back();
+
+      double ax=points[start].x;
+      double ay=points[start].y;
+      double dx=points[end].x-ax;
+      double dy=points[end].y-ay;
+      double lengthSquared=dx*dx+dy*dy;
+      double maxDistance=0.0;
+      size_t maxIndex=start;
+
+      for (size_t i=start+1; i<end; i++) {
+        double px=points[i].x-ax;
+        double py=points[i].y-ay;
+        double distance;
+
+        if (lengthSquared==0.0) {
+          distance=px*px+py*py;
+        }
+        else {
+          double cross=px*dy-py*dx;
+
+          distance=cross*cross/lengthSquared;
+        }
+
+        if (distance>maxDistance) {
+          maxDistance=distance;
+          maxIndex=i;
+        }
+      }
+
+      if (maxDistance>toleranceSquared) {
+        keep[maxIndex]=true;
+
+        if (maxIndex-start>1) {
+          stack.emplace_back(start,maxIndex);
+        }
+
+        if (end-maxIndex>1) {
+          stack.emplace_back(maxIndex,end);
+        }
+      }
+    }
+
+    size_t target=0;
+
+    for (size_t i=0; i<points.size(); i++) {
+      if (keep[i]) {
+        points[target]=points[i];
+        target++;
+      }
+    }
+
+    points.resize(target);
+  }
+
+  static double GetSignedArea(const std::vector<VectorTilePoint>& ring)
+  {
+    double area=0.0;
+
+    for (size_t i=0; i<ring.size(); i++) {
+      const VectorTilePoint& a=ring[i];
+      const VectorTilePoint& b=ring[(i+1)%ring.size()];
+
+      area+=static_cast<double>(a.x)*b.y-static_cast<double>(b.x)*a.y;
+    }
+
+    return area/2.0;
+  }
+
+  /**
+   * Add the given data to the vector tile. The MapData should contain the data
+   * of the given tile (possibly more), data not visible in the tile is dropped.
+   */
+  void VectorTileBuilder::Build(const OSMTileId& tileId,
+                                const Magnification& magnification,
+                                const MapData& data,
+                                VectorTile& tile) const
+  {
+    TileProjection                   projection;
+    double                           minCoord=-static_cast<double>(buffer);
+    double                           maxCoord=static_cast<double>(extent)+buffer;
+    VectorTileLayer::Properties      properties;
+    std::vector<Vertex>              vertices;
+    std::vector<VectorTilePoint>     points;
+    std::vector<std::vector<Vertex>> parts;
+    std::vector<Vertex>              clipped;
+
+    projection.Set(tileId,
+                   magnification,
+                   extent,
+                   extent);
+
+    VectorTileLayer& nodeLayer=tile.GetLayer("nodes");
+
+    for (const auto& node : data.nodes) {
+      double x,y;
+
+      projection.GeoToPixel(node->GetCoords(),
+                            x,y);
+
+      if (x<0.0 || x>=extent ||
+          y<0.0 || y>=extent) {
+        continue;
+      }
+
+      GetProperties(node->GetFeatureValueBuffer(),
+                    properties);
+
+      nodeLayer.AddPoint(node->GetFileOffset(),
+                         properties,
+                         VectorTilePoint(static_cast<int32_t>(x),
+                                         static_cast<int32_t>(y)));
+    }
+
+    VectorTileLayer& wayLayer=tile.GetLayer("ways");
+
+    for (const auto& way : data.ways) {
+      std::vector<std::vector<VectorTilePoint>> lines;
+
+      vertices.resize(way->nodes.size());
+
+      for (size_t i=0; i<way->nodes.size(); i++) {
+        projection.GeoToPixel(way->nodes[i].GetCoord(),
+                              vertices[i].x,
+                              vertices[i].y);
+      }
+
+      parts.clear();
+      ClipLine(vertices,
+               minCoord,minCoord,
+               maxCoord,maxCoord,
+               parts);
+
+      for (const auto& part : parts) {
+        Quantize(part,
+                 false,
+                 points);
+
+        if (points.size()>=2) {
+          lines.push_back(points);
+        }
+      }
+
+      if (lines.empty()) {
+        continue;
+      }
+
+      GetProperties(way->GetFeatureValueBuffer(),
+                    properties);
+
+      wayLayer.AddLineStrings(way->GetFileOffset(),
+                              properties,
+                              lines);
+    }
+
+    VectorTileLayer& areaLayer=tile.GetLayer("areas");
+
+    for (const auto& area : data.areas) {
+      std::vector<std::vector<VectorTilePoint>> rings;
+      bool                                      hasOuter=false;
+
+      for (const auto& ring : area->rings) {
+        if (ring.IsMasterRing() ||
+            ring.nodes.size()<3) {
+          continue;
+        }
+
+        vertices.resize(ring.nodes.size());
+
+        for (size_t i=0; i<ring.nodes.size(); i++) {
+          projection.GeoToPixel(ring.nodes[i].GetCoord(),
+                                vertices[i].x,
+                                vertices[i].y);
+        }
+
+        ClipRing(vertices,
+                 minCoord,minCoord,
+                 maxCoord,maxCoord,
+                 clipped);
+
+        Quantize(clipped,
+                 true,
+                 points);
+
+        if (points.size()<3) {
+          continue;
+        }
+
+        double signedArea=GetSignedArea(points);
+
+        if (signedArea==0.0) {
+          continue;
+        }
+
+        // Rings on odd levels are outer rings, rings on even levels are holes
+        bool isOuter=ring.GetRing()%2==1;
+
+        if (!isOuter && !hasOuter) {
+          continue;
+        }
+
+        if ((isOuter && signedArea<0.0) ||
+            (!isOuter && signedArea>0.0)) {
+          std::reverse(points.begin(),points.end());
+        }
+
+        hasOuter=hasOuter || isOuter;
+        rings.push_back(points);
+      }
+
+      if (rings.empty()) {
+        continue;
+      }
+
+      GetProperties(area->GetFeatureValueBuffer(),
+                    properties);
+
+      areaLayer.AddPolygon(area->GetFileOffset(),
+                           properties,
+                           rings);
+    }
+  }
+}
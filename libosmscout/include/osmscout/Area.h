@@ -289,6 +289,15 @@ namespace osmscout {
      */
     void WriteOptimized(const TypeConfig& typeConfig,
                         FileWriter& writer) const;
+
+  private:
+    void ReadRings(const TypeConfig& typeConfig,
+                   FileScanner& scanner,
+                   FeatureValueBuffer&& featureValueBuffer,
+                   uint32_t ringCount,
+                   bool hasMaster);
+
+    friend class AreaView;
   };
 
   typedef std::shared_ptr<Area> AreaRef;
@@ -25,6 +25,7 @@
 #include <mutex>
 #include <vector>
 
+#include <osmscout/AreaNodeUpdates.h>
 #include <osmscout/TypeConfig.h>
 #include <osmscout/TypeInfoSet.h>
 
@@ -40,6 +41,9 @@ namespace osmscout {
     a given area.
 
     Ways can be limited by type and result count.
+
+    If the database was updated incrementally, the AreaNodeUpdates
+    are applied to the result.
     */
   class OSMSCOUT_API AreaNodeIndex
   {
@@ -49,6 +53,7 @@ namespace osmscout {
   private:
     struct ListTile
     {
+      TileId             tileId;
       FileOffset         fileOffset;
       uint16_t           entryCount;
       bool               storeGeoCoord;
@@ -56,20 +61,25 @@ namespace osmscout {
 
     struct BitmapTile
     {
+      TileId             tileId;
       FileOffset         fileOffset;
       uint8_t            dataOffsetBytes;
       MagnificationLevel magnification;
     };
 
+    /**
+     * Tile directories are stored as flat vectors sorted by tile id, to keep
+     * Open() cheap (one allocation per type instead of one per tile)
+     */
     struct TypeData
     {
-      bool                        isComplex;
-      GeoBox                      boundingBox;
-      FileOffset                  indexOffset=0;
-      uint16_t                    entryCount=0;
+      bool                    isComplex;
+      GeoBox                  boundingBox;
+      FileOffset              indexOffset=0;
+      uint16_t                entryCount=0;
 
-      std::map<TileId,ListTile>   listTiles;
-      std::map<TileId,BitmapTile> bitmapTiles;
+      std::vector<ListTile>   listTiles;
+      std::vector<BitmapTile> bitmapTiles;
     };
 
   private:
@@ -78,6 +88,7 @@ namespace osmscout {
 
     MagnificationLevel    gridMag;
     std::vector<TypeData> nodeTypeData;
+    AreaNodeUpdates       updates;        //!< Incremental updates on top of the index
 
     mutable std::mutex    lookupMutex;
 
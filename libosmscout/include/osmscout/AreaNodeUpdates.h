@@ -0,0 +1,101 @@
+#ifndef OSMSCOUT_AREANODEUPDATES_H
+#define OSMSCOUT_AREANODEUPDATES_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <string>
+#include <vector>
+
+#include <osmscout/CoreImportExport.h>
+
+#include <osmscout/GeoCoord.h>
+#include <osmscout/OSMScoutTypes.h>
+
+#include <osmscout/util/GeoBox.h>
+
+#include <osmscout/system/Compiler.h>
+
+namespace osmscout {
+
+  /**
+    \ingroup Database
+
+    Incremental changes of the nodes of a database, applied on top of
+    'areanode.idx' without rebuilding it.
+
+    Nodes created or modified by an update are appended to 'nodes.dat' and
+    registered here as entries. Nodes of 'nodes.dat' that were modified or
+    deleted by an update are tombstoned by their file offset, so that they are
+    no longer returned by the AreaNodeIndex.
+
+    The data is stored in 'areanode.upd'. A full import compacts the
+    database, since it rewrites 'nodes.dat' and the index and removes the file.
+    */
+  class OSMSCOUT_API AreaNodeUpdates CLASS_FINAL
+  {
+  public:
+    static const char* const AREA_NODE_UPD;
+
+    struct Entry
+    {
+      OSMId      id;         //!< OSM id of the node
+      TypeId     type;       //!< Node type id
+      GeoCoord   coord;      //!< Coordinate of the node
+      FileOffset fileOffset; //!< Offset of the node in 'nodes.dat'
+    };
+
+  private:
+    std::vector<FileOffset> removedOffsets; //!< Sorted offsets of tombstoned nodes
+    std::vector<Entry>      entries;        //!< Added nodes, sorted by OSM id
+
+  public:
+    bool Load(const std::string& path);
+    bool Store(const std::string& path) const;
+
+    inline bool IsEmpty() const
+    {
+      return removedOffsets.empty() && entries.empty();
+    }
+
+    inline size_t GetRemovedCount() const
+    {
+      return removedOffsets.size();
+    }
+
+    inline const std::vector<Entry>& GetEntries() const
+    {
+      return entries;
+    }
+
+    bool IsRemoved(FileOffset offset) const;
+    void Remove(FileOffset offset);
+
+    const Entry* Find(OSMId id) const;
+    void Set(const Entry& entry);
+    bool Erase(OSMId id);
+
+    bool Apply(TypeId type,
+               const GeoBox& boundingBox,
+               size_t start,
+               std::vector<FileOffset>& offsets) const;
+  };
+}
+
+#endif
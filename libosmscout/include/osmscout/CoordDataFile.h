@@ -29,6 +29,19 @@ namespace osmscout {
 
   /**
    * \ingroup Database
+   *
+   * Gives access to the coordinates of OSM nodes by their OSM id, as written by the
+   * CoordDataGenerator during import. The data file uses one of two layouts:
+   *
+   * - Paged: Only pages of ids that contain at least one coordinate are stored. Pages
+   *   are located via an index, which is loaded on Open().
+   * - Dense: There is one fixed size entry for each id between the smallest and the
+   *   biggest id. Ids without a coordinate are holes in the (sparse) file. Resolving an
+   *   id is a plain array access if the file is memory mapped. This layout is meant
+   *   for big imports, where the page index would get huge.
+   *
+   * An entry consists of the serial of the coordinate (0 for unused entries) followed
+   * by the encoded coordinate.
    */
   class OSMSCOUT_API CoordDataFile
   {
@@ -45,8 +58,15 @@ namespace osmscout {
     bool                isOpen;             //!< If true,the data file is opened
     std::string         datafilename;       //!< complete filename for data file
     mutable FileScanner scanner;            //!< File stream to the data file
-    uint32_t            pageSize;
+    uint32_t            pageSize;           //!< Number of entries per page, 0 for the dense layout
     PageIdFileOffsetMap pageFileOffsetMap;
+    OSMId               firstId;            //!< Dense layout: The id of the first entry
+    uint64_t            idCount;            //!< Dense layout: The number of entries
+    FileOffset          dataOffset;         //!< Dense layout: File offset of the first entry
+
+  private:
+    bool ReadCoord(OSMId id,
+                   Coord& coord) const;
 
   public:
     CoordDataFile();
@@ -58,7 +78,16 @@ namespace osmscout {
 
     std::string GetFilename() const;
 
+    /**
+     * Return true, if the file uses the dense layout
+     */
+    inline bool IsDense() const
+    {
+      return pageSize==0;
+    }
+
     bool Get(const std::set<OSMId>& ids, ResultMap& resultMap) const;
+    bool Get(const std::vector<OSMId>& ids, std::vector<Coord>& coords) const;
   };
 }
 
@@ -27,11 +27,14 @@
 #include <vector>
 
 #include <osmscout/NumericIndex.h>
+#include <osmscout/ObjectBoxIndex.h>
 #include <osmscout/TypeConfig.h>
 
 #include <osmscout/util/Cache.h>
+#include <osmscout/util/File.h>
 #include <osmscout/util/FileScanner.h>
 #include <osmscout/util/Logger.h>
+#include <osmscout/util/QueryArena.h>
 
 //#include <map>
 namespace osmscout {
@@ -86,6 +89,7 @@ namespace osmscout {
     mutable ValueCache  cache;
 
     mutable FileScanner scanner;         //!< File stream to the data file
+    ObjectBoxIndex      objectBoxIndex;  //!< Optional bounding boxes of the objects in the data file
 
     mutable std::mutex  accessMutex;     //!< Mutex to secure multi-thread access
 
@@ -117,16 +121,19 @@ namespace osmscout {
                      ValueType& entry) const;
 
     bool GetByBlockSpan(const DataBlockSpan& span,
-                        std::vector<ValueType>& data) const;
+                        std::vector<ValueType>& data,
+                        const QueryArenaRef& arena=QueryArenaRef()) const;
 
     template<typename IteratorIn>
     bool GetByOffset(IteratorIn begin, IteratorIn end, size_t size,
-                     std::vector<ValueType>& data) const;
+                     std::vector<ValueType>& data,
+                     const QueryArenaRef& arena=QueryArenaRef()) const;
 
     template<typename IteratorIn>
     bool GetByOffset(IteratorIn begin, IteratorIn end, size_t size,
                      const GeoBox& boundingBox,
-                     std::vector<ValueType>& data) const;
+                     std::vector<ValueType>& data,
+                     const QueryArenaRef& arena=QueryArenaRef()) const;
 
     template<typename IteratorIn>
     bool GetByOffset(IteratorIn begin, IteratorIn end, size_t size,
@@ -134,7 +141,20 @@ namespace osmscout {
 
     template<typename IteratorIn>
     bool GetByBlockSpans(IteratorIn begin, IteratorIn end,
-                         std::vector<ValueType>& data) const;
+                         std::vector<ValueType>& data,
+                         const QueryArenaRef& arena=QueryArenaRef()) const;
+
+    template<typename V, typename IteratorIn>
+    bool GetIntersectingByOffset(IteratorIn begin, IteratorIn end, size_t size,
+                                 const GeoBox& boundingBox,
+                                 std::vector<ValueType>& data,
+                                 const QueryArenaRef& arena=QueryArenaRef()) const;
+
+    template<typename V, typename IteratorIn>
+    bool GetIntersectingByBlockSpans(IteratorIn begin, IteratorIn end,
+                                     const GeoBox& boundingBox,
+                                     std::vector<ValueType>& data,
+                                     const QueryArenaRef& arena=QueryArenaRef()) const;
   };
 
   template <class N>
@@ -196,7 +216,8 @@ namespace osmscout {
   }
 
   /**
-   * Open the index file.
+   * Open the index file. If there is an ObjectBoxIndex for the data file,
+   * it is opened, too.
    *
    * Method is NOT thread-safe.
    */
@@ -213,10 +234,25 @@ namespace osmscout {
       scanner.Open(datafilename,
                    FileScanner::LowMemRandom,
                    memoryMappedData);
+
+      std::string objectBoxFilename=ObjectBoxIndex::GetIndexFilename(datafilename);
+
+      if (ExistsInFilesystem(objectBoxFilename) &&
+          objectBoxIndex.Open(objectBoxFilename)) {
+        uint32_t dataCount;
+
+        scanner.Read(dataCount);
+
+        if (objectBoxIndex.GetEntryCount()!=dataCount) {
+          log.Warn() << "Ignoring '" << objectBoxFilename << "', it does not match '" << datafilename << "'";
+          objectBoxIndex.Close();
+        }
+      }
     }
     catch (IOException& e) {
       log.Error() << e.GetDescription();
       scanner.CloseFailsafe();
+      objectBoxIndex.Close();
       return false;
     }
 
@@ -244,6 +280,8 @@ namespace osmscout {
   {
     typeConfig=nullptr;
 
+    objectBoxIndex.Close();
+
     try  {
       if (scanner.IsOpen()) {
         scanner.Close();
@@ -276,6 +314,10 @@ namespace osmscout {
    *    in result vector.
    * @param data
    *    vector containing data. Data is appended.
+   * @param arena
+   *    optional arena, objects not found in the cache are allocated in. These objects are
+   *    not added to the cache, since a cached object would keep the whole arena alive. The
+   *    memory of the arena is released, when the last of its objects is released.
    * @return
    *    false if there was an error, else true
    *
@@ -285,7 +327,8 @@ namespace osmscout {
   template <typename IteratorIn>
   bool DataFile<N>::GetByOffset(IteratorIn begin, IteratorIn end,
                                 size_t size,
-                                std::vector<ValueType>& data) const
+                                std::vector<ValueType>& data,
+                                const QueryArenaRef& arena) const
   {
     if (size==0) {
       return true;
@@ -306,7 +349,7 @@ namespace osmscout {
         data.push_back(entryRef->value);
       }
       else {
-        ValueType value=std::make_shared<N>();
+        ValueType value=MakeShared<N>(arena);
 
         if (!ReadData(*offsetIter,
                       *value)) {
@@ -314,7 +357,9 @@ namespace osmscout {
           return false;
         }
 
-        cache.SetEntry(ValueCacheEntry(*offsetIter,value));
+        if (!arena) {
+          cache.SetEntry(ValueCacheEntry(*offsetIter,value));
+        }
         data.push_back(value);
       }
     }
@@ -323,7 +368,8 @@ namespace osmscout {
   }
 
   /**
-   * Read data values from the given file offsets.
+   * Read data values from the given file offsets, that intersect the given
+   * bounding box.
    *
    * Method is thread-safe.
    */
@@ -332,7 +378,8 @@ namespace osmscout {
   bool DataFile<N>::GetByOffset(IteratorIn begin, IteratorIn end,
                                 size_t size,
                                 const GeoBox& boundingBox,
-                                std::vector<ValueType>& data) const
+                                std::vector<ValueType>& data,
+                                const QueryArenaRef& arena) const
   {
     if (size==0) {
       return true;
@@ -350,19 +397,23 @@ namespace osmscout {
     //std::map<std::string,size_t> missRateTypes;
     size_t inBoxCount=0;
     for (IteratorIn offsetIter=begin; offsetIter!=end; ++offsetIter) {
-      ValueType value=std::make_shared<N>();
+      ValueType value;
 
       ValueCacheRef entryRef;
       if (cache.GetEntry(*offsetIter,entryRef)){
         value=entryRef->value;
       }else{
+        value=MakeShared<N>(arena);
+
         if (!ReadData(*offsetIter,
                       *value)) {
           log.Error() << "Error while reading data from offset " << *offsetIter << " of file " << datafilename << "!";
           return false;
         }
 
-        cache.SetEntry(ValueCacheEntry(*offsetIter,value));
+        if (!arena) {
+          cache.SetEntry(ValueCacheEntry(*offsetIter,value));
+        }
       }
 
       if (!value->Intersects(boundingBox)) {
@@ -462,7 +513,8 @@ namespace osmscout {
    */
   template <class N>
   bool DataFile<N>::GetByBlockSpan(const DataBlockSpan& span,
-                                   std::vector<ValueType>& data) const
+                                   std::vector<ValueType>& data,
+                                   const QueryArenaRef& arena) const
   {
     if (span.count==0) {
       return true;
@@ -487,14 +539,16 @@ namespace osmscout {
             scanner.SetPos(offset);
           }
 
-          ValueType value=std::make_shared<N>();
+          ValueType value=MakeShared<N>(arena);
 
           if (!ReadData(*value)) {
             log.Error() << "Error while reading data #" << i << " starting from offset " << span.startOffset << " of file " << datafilename << "!";
             return false;
           }
 
-          cache.SetEntry(ValueCacheEntry(offset,value));
+          if (!arena) {
+            cache.SetEntry(ValueCacheEntry(offset,value));
+          }
           offset=value->GetNextFileOffset();
           offsetSetup=true;
           data.push_back(value);
@@ -517,7 +571,8 @@ namespace osmscout {
   template <class N>
   template<typename IteratorIn>
   bool DataFile<N>::GetByBlockSpans(IteratorIn begin, IteratorIn end,
-                                    std::vector<ValueType>& data) const
+                                    std::vector<ValueType>& data,
+                                    const QueryArenaRef& arena) const
   {
     uint32_t overallCount=0;
 
@@ -548,7 +603,7 @@ namespace osmscout {
               scanner.SetPos(offset);
             }
 
-            ValueType value=std::make_shared<N>();
+            ValueType value=MakeShared<N>(arena);
 
             if (!ReadData(*value)) {
               log.Error() << "Error while reading data #" << i << " starting from offset " << spanIter->startOffset <<
@@ -556,7 +611,9 @@ namespace osmscout {
               return false;
             }
 
-            cache.SetEntry(ValueCacheEntry(offset,value));
+            if (!arena) {
+              cache.SetEntry(ValueCacheEntry(offset,value));
+            }
             offset=value->GetNextFileOffset();
             offsetSetup=true;
             data.push_back(value);
@@ -572,6 +629,208 @@ namespace osmscout {
     return true;
   }
 
+  /**
+   * Read data values from the given file offsets, that intersect the given
+   * bounding box.
+   *
+   * If the data file has an ObjectBoxIndex, objects are filtered by the
+   * box stored in the index and only intersecting objects are read.
+   * Objects without an index entry are first read as a view of type V (for
+   * example WayView), which decodes the features and the bounding box
+   * without materializing the geometry. Only objects intersecting the
+   * bounding box are then completely read, reusing the decoded features.
+   *
+   * Method is thread-safe.
+   */
+  template <class N>
+  template<typename V, typename IteratorIn>
+  bool DataFile<N>::GetIntersectingByOffset(IteratorIn begin, IteratorIn end,
+                                            size_t size,
+                                            const GeoBox& boundingBox,
+                                            std::vector<ValueType>& data,
+                                            const QueryArenaRef& arena) const
+  {
+    if (size==0) {
+      return true;
+    }
+
+    data.reserve(data.size()+size);
+    std::lock_guard<std::mutex> lock(accessMutex);
+
+    try {
+      V view;
+
+      for (IteratorIn offsetIter=begin; offsetIter!=end; ++offsetIter) {
+        ValueCacheRef entryRef;
+        GeoBox        objectBox;
+        bool          hasObjectBox=objectBoxIndex.GetBoundingBox(*offsetIter,
+                                                                 objectBox);
+
+        if (hasObjectBox &&
+            !objectBox.Intersects(boundingBox)) {
+          continue;
+        }
+
+        if (cache.GetEntry(*offsetIter,entryRef)) {
+          if (entryRef->value->Intersects(boundingBox)) {
+            data.push_back(entryRef->value);
+          }
+
+          continue;
+        }
+
+        ValueType value;
+
+        scanner.SetPos(*offsetIter);
+
+        if (hasObjectBox) {
+          value=MakeShared<N>(arena);
+
+          value->Read(*typeConfig,
+                      scanner);
+        }
+        else {
+          view.Read(*typeConfig,
+                    scanner);
+
+          if (!view.Intersects(boundingBox)) {
+            continue;
+          }
+
+          value=MakeShared<N>(arena);
+
+          view.Materialize(*typeConfig,
+                           scanner,
+                           *value);
+        }
+
+        if (!arena) {
+          cache.SetEntry(ValueCacheEntry(*offsetIter,value));
+        }
+        data.push_back(value);
+      }
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Read data values from the given DataBlockSpans, that intersect the given
+   * bounding box. If the ObjectBoxIndex holds the objects of a span, their
+   * offsets and boxes are taken from the index, else the objects are read
+   * as views of type V first, see GetIntersectingByOffset().
+   *
+   * Method is thread-safe.
+   */
+  template <class N>
+  template<typename V, typename IteratorIn>
+  bool DataFile<N>::GetIntersectingByBlockSpans(IteratorIn begin, IteratorIn end,
+                                                const GeoBox& boundingBox,
+                                                std::vector<ValueType>& data,
+                                                const QueryArenaRef& arena) const
+  {
+    uint32_t overallCount=0;
+
+    for (IteratorIn spanIter=begin; spanIter!=end; ++spanIter) {
+      overallCount+=spanIter->count;
+    }
+
+    data.reserve(data.size()+overallCount);
+
+    try {
+      std::lock_guard<std::mutex> lock(accessMutex);
+      V view;
+
+      for (IteratorIn spanIter=begin; spanIter!=end; ++spanIter) {
+        size_t entryIndex;
+
+        if (objectBoxIndex.GetEntryIndex(spanIter->startOffset,
+                                         entryIndex) &&
+            entryIndex+spanIter->count<=objectBoxIndex.GetEntryCount()) {
+          for (size_t e=entryIndex; e<entryIndex+spanIter->count; e++) {
+            if (!objectBoxIndex.GetBox(e).Intersects(boundingBox)) {
+              continue;
+            }
+
+            FileOffset    offset=objectBoxIndex.GetOffset(e);
+            ValueCacheRef entryRef;
+
+            if (cache.GetEntry(offset,entryRef)) {
+              data.push_back(entryRef->value);
+              continue;
+            }
+
+            ValueType value=MakeShared<N>(arena);
+
+            scanner.SetPos(offset);
+            value->Read(*typeConfig,
+                        scanner);
+
+            if (!arena) {
+              cache.SetEntry(ValueCacheEntry(offset,value));
+            }
+            data.push_back(value);
+          }
+
+          continue;
+        }
+
+        bool       offsetSetup=false;
+        FileOffset offset=spanIter->startOffset;
+
+        for (uint32_t i=1; i<=spanIter->count; i++) {
+          ValueCacheRef entryRef;
+
+          if (cache.GetEntry(offset,entryRef)) {
+            if (entryRef->value->Intersects(boundingBox)) {
+              data.push_back(entryRef->value);
+            }
+
+            offset=entryRef->value->GetNextFileOffset();
+            offsetSetup=false;
+
+            continue;
+          }
+
+          if (!offsetSetup) {
+            scanner.SetPos(offset);
+          }
+
+          // After reading the view or the complete object the scanner is
+          // positioned at the next object
+          view.Read(*typeConfig,
+                    scanner);
+          offsetSetup=true;
+
+          if (view.Intersects(boundingBox)) {
+            ValueType value=MakeShared<N>(arena);
+
+            view.Materialize(*typeConfig,
+                             scanner,
+                             *value);
+
+            if (!arena) {
+              cache.SetEntry(ValueCacheEntry(offset,value));
+            }
+            data.push_back(value);
+          }
+
+          offset=view.GetNextFileOffset();
+        }
+      }
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      return false;
+    }
+
+    return true;
+  }
+
   /**
    * \ingroup Database
    *
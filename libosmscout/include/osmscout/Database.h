@@ -54,6 +54,8 @@
 #include <osmscout/routing/Route.h>
 
 #include <osmscout/util/GeoBox.h>
+#include <osmscout/util/QueryArena.h>
+#include <osmscout/util/StopClock.h>
 
 #include <osmscout/system/Compiler.h>
 
@@ -254,6 +256,17 @@ namespace osmscout {
     }
   };
 
+  /**
+   * \ingroup Database
+   *
+   * Time spent on (lazily) opening one of the files or indexes of a database
+   */
+  struct OSMSCOUT_API DatabaseOpenTime
+  {
+    std::string name;     //!< Name of the data file or index
+    double      duration; //!< Duration of the open operation in milliseconds
+  };
+
   /**
    * \ingroup Database
    *
@@ -308,6 +321,13 @@ namespace osmscout {
     mutable OptimizeWaysLowZoomRef  optimizeWaysLowZoom;      //!< Optimized data for low zoom situations
     mutable std::mutex              optimizeWaysMutex;        //!< Mutex to make lazy initialisation of optimized ways index thread-safe
 
+    mutable std::vector<DatabaseOpenTime> openTimes;          //!< Time spent opening the individual files, in order of opening
+    mutable std::mutex              openTimesMutex;           //!< Mutex to make recording of open times thread-safe
+
+  private:
+    void RecordOpenTime(const std::string& name,
+                        const StopClock& timer) const;
+
   public:
     explicit Database(const DatabaseParameter& parameter);
     virtual ~Database();
@@ -346,10 +366,12 @@ namespace osmscout {
     bool GetNodeByOffset(const FileOffset& offset,
                          NodeRef& node) const;
     bool GetNodesByOffset(const std::vector<FileOffset>& offsets,
-                          std::vector<NodeRef>& nodes) const;
+                          std::vector<NodeRef>& nodes,
+                          const QueryArenaRef& arena=QueryArenaRef()) const;
     bool GetNodesByOffset(const std::vector<FileOffset>& offsets,
                           const GeoBox& boundingBox,
-                          std::vector<NodeRef>& nodes) const;
+                          std::vector<NodeRef>& nodes,
+                          const QueryArenaRef& arena=QueryArenaRef()) const;
     bool GetNodesByOffset(const std::set<FileOffset>& offsets,
                           std::vector<NodeRef>& nodes) const;
     bool GetNodesByOffset(const std::list<FileOffset>& offsets,
@@ -360,7 +382,8 @@ namespace osmscout {
     bool GetAreaByOffset(const FileOffset& offset,
                          AreaRef& area) const;
     bool GetAreasByOffset(const std::vector<FileOffset>& offsets,
-                          std::vector<AreaRef>& areas) const;
+                          std::vector<AreaRef>& areas,
+                          const QueryArenaRef& arena=QueryArenaRef()) const;
     bool GetAreasByOffset(const std::set<FileOffset>& offsets,
                           std::vector<AreaRef>& areas) const;
     bool GetAreasByOffset(const std::list<FileOffset>& offsets,
@@ -370,13 +393,23 @@ namespace osmscout {
     bool GetAreasByBlockSpan(const DataBlockSpan& span,
                              std::vector<AreaRef>& area) const;
     bool GetAreasByBlockSpans(const std::vector<DataBlockSpan>& spans,
-                              std::vector<AreaRef>& areas) const;
+                              std::vector<AreaRef>& areas,
+                              const QueryArenaRef& arena=QueryArenaRef()) const;
+    bool GetAreasByBlockSpans(const std::vector<DataBlockSpan>& spans,
+                              const GeoBox& boundingBox,
+                              std::vector<AreaRef>& areas,
+                              const QueryArenaRef& arena=QueryArenaRef()) const;
 
 
     bool GetWayByOffset(const FileOffset& offset,
                         WayRef& way) const;
     bool GetWaysByOffset(const std::vector<FileOffset>& offsets,
-                         std::vector<WayRef>& ways) const;
+                         std::vector<WayRef>& ways,
+                         const QueryArenaRef& arena=QueryArenaRef()) const;
+    bool GetWaysByOffset(const std::vector<FileOffset>& offsets,
+                         const GeoBox& boundingBox,
+                         std::vector<WayRef>& ways,
+                         const QueryArenaRef& arena=QueryArenaRef()) const;
     bool GetWaysByOffset(const std::set<FileOffset>& offsets,
                          std::vector<WayRef>& ways) const;
     bool GetWaysByOffset(const std::list<FileOffset>& offsets,
@@ -475,6 +508,9 @@ namespace osmscout {
                                            const GeoBox& boundingBox);
 
     void DumpStatistics();
+
+    std::vector<DatabaseOpenTime> GetOpenTimes() const;
+    void DumpOpenTimes() const;
   };
 
   //! Reference counted reference to an Database instance
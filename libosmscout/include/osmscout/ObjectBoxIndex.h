@@ -0,0 +1,102 @@
+#ifndef OSMSCOUT_OBJECTBOXINDEX_H
+#define OSMSCOUT_OBJECTBOXINDEX_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <string>
+
+#include <osmscout/CoreImportExport.h>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/GeoBox.h>
+#include <osmscout/util/MemoryMappedFile.h>
+
+#include <osmscout/system/Compiler.h>
+
+namespace osmscout {
+
+  /**
+    \ingroup Database
+
+    ObjectBoxIndex holds the bounding box of each object of a data file (for
+    example ways.dat) in a separate file next to it ("ways.box"). This allows
+    to drop objects outside of a query region before reading them.
+
+    The file is memory mapped and consists of three parts:
+    - the number of entries (uint32_t)
+    - the file offsets of all objects in data file order (uint64_t each)
+    - the bounding boxes of all objects in the same order, each as four
+      coordinate values (min lat, min lon, max lat, max lon) quantized like
+      coordinates in the data file (uint32_t each)
+
+    All values are stored in little endian byte order. Since the quantization
+    is the same as in the data file, the boxes are exactly the boxes of the
+    deserialized objects.
+    */
+  class OSMSCOUT_API ObjectBoxIndex CLASS_FINAL
+  {
+  public:
+    static const char* FILE_EXTENSION;
+
+  private:
+    static const size_t OFFSET_SIZE=8;
+    static const size_t BOX_SIZE=4*4;
+
+  private:
+    MemoryMappedFile    file;       //!< The memory mapped index file
+    uint32_t            entryCount; //!< Number of entries
+    const unsigned char *offsets;   //!< Start of the file offsets
+    const unsigned char *boxes;     //!< Start of the bounding boxes
+
+  public:
+    ObjectBoxIndex();
+
+    bool Open(const std::string& filename);
+    bool Close();
+
+    inline bool IsOpen() const
+    {
+      return file.IsOpen();
+    }
+
+    inline std::string GetFilename() const
+    {
+      return file.GetFilename();
+    }
+
+    inline uint32_t GetEntryCount() const
+    {
+      return entryCount;
+    }
+
+    FileOffset GetOffset(size_t index) const;
+    GeoBox GetBox(size_t index) const;
+
+    bool GetEntryIndex(FileOffset offset,
+                       size_t& index) const;
+
+    bool GetBoundingBox(FileOffset offset,
+                        GeoBox& boundingBox) const;
+
+    static std::string GetIndexFilename(const std::string& dataFilename);
+  };
+}
+
+#endif
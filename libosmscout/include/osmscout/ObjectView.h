@@ -0,0 +1,188 @@
+#ifndef OSMSCOUT_OBJECTVIEW_H
+#define OSMSCOUT_OBJECTVIEW_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <vector>
+
+#include <osmscout/Area.h>
+#include <osmscout/Point.h>
+#include <osmscout/TypeConfig.h>
+#include <osmscout/Way.h>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/GeoBox.h>
+
+#include <osmscout/system/Compiler.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Database
+   *
+   * Lightweight view of a way in the data file.
+   *
+   * Reading a view decodes the type, the features and the bounding box of
+   * the way, but does not materialize its nodes. The geometry or the
+   * complete Way can be read on demand, using the file offsets stored in
+   * the view. This allows to check a way against a bounding box (or its
+   * type and features) without the cost of a complete deserialization.
+   *
+   * Materializing the way moves the already decoded features into it, so
+   * that they are not decoded a second time.
+   */
+  class OSMSCOUT_API WayView CLASS_FINAL
+  {
+  private:
+    FeatureValueBuffer featureValueBuffer; //!< List of features
+    GeoBox             boundingBox;        //!< Bounding box of the geometry
+    bool               readIds;            //!< Node ids are stored with the geometry
+    FileOffset         fileOffset;         //!< Offset into the data file of this way
+    FileOffset         geometryOffset;     //!< Offset of the geometry of this way
+    FileOffset         nextFileOffset;     //!< Offset after this way
+
+  public:
+    inline WayView()
+    : readIds(false),
+      fileOffset(0),
+      geometryOffset(0),
+      nextFileOffset(0)
+    {
+      // no code
+    }
+
+    inline TypeInfoRef GetType() const
+    {
+      return featureValueBuffer.GetType();
+    }
+
+    inline const FeatureValueBuffer& GetFeatureValueBuffer() const
+    {
+      return featureValueBuffer;
+    }
+
+    inline GeoBox GetBoundingBox() const
+    {
+      return boundingBox;
+    }
+
+    inline bool Intersects(const GeoBox& box) const
+    {
+      return boundingBox.Intersects(box);
+    }
+
+    inline FileOffset GetFileOffset() const
+    {
+      return fileOffset;
+    }
+
+    inline FileOffset GetNextFileOffset() const
+    {
+      return nextFileOffset;
+    }
+
+    void Read(const TypeConfig& typeConfig,
+              FileScanner& scanner);
+
+    void ReadNodes(FileScanner& scanner,
+                   std::vector<Point>& nodes) const;
+
+    void Materialize(const TypeConfig& typeConfig,
+                     FileScanner& scanner,
+                     Way& way);
+  };
+
+  /**
+   * \ingroup Database
+   *
+   * Lightweight view of an area in the data file.
+   *
+   * Reading a view decodes the type and the features of the area and the
+   * bounding box of its outer rings, but does not materialize any ring.
+   * The complete Area can be read on demand, reusing the features of the
+   * view for its first ring.
+   */
+  class OSMSCOUT_API AreaView CLASS_FINAL
+  {
+  private:
+    FeatureValueBuffer featureValueBuffer; //!< Features of the area (the master or outer ring)
+    GeoBox             boundingBox;        //!< Bounding box of the outer rings
+    size_t             ringCount;          //!< Number of rings
+    bool               hasMaster;          //!< The first ring is a master ring
+    FileOffset         fileOffset;         //!< Offset into the data file of this area
+    FileOffset         geometryOffset;     //!< Offset of the nodes of the first ring
+    FileOffset         nextFileOffset;     //!< Offset after this area
+
+  public:
+    inline AreaView()
+    : ringCount(0),
+      hasMaster(false),
+      fileOffset(0),
+      geometryOffset(0),
+      nextFileOffset(0)
+    {
+      // no code
+    }
+
+    inline TypeInfoRef GetType() const
+    {
+      return featureValueBuffer.GetType();
+    }
+
+    inline const FeatureValueBuffer& GetFeatureValueBuffer() const
+    {
+      return featureValueBuffer;
+    }
+
+    inline GeoBox GetBoundingBox() const
+    {
+      return boundingBox;
+    }
+
+    inline bool Intersects(const GeoBox& box) const
+    {
+      return boundingBox.Intersects(box);
+    }
+
+    inline size_t GetRingCount() const
+    {
+      return ringCount;
+    }
+
+    inline FileOffset GetFileOffset() const
+    {
+      return fileOffset;
+    }
+
+    inline FileOffset GetNextFileOffset() const
+    {
+      return nextFileOffset;
+    }
+
+    void Read(const TypeConfig& typeConfig,
+              FileScanner& scanner);
+
+    void Materialize(const TypeConfig& typeConfig,
+                     FileScanner& scanner,
+                     Area& area);
+  };
+}
+
+#endif
@@ -653,15 +653,24 @@ namespace osmscout {
    */
   class OSMSCOUT_API FeatureValueBuffer CLASS_FINAL
   {
+  public:
+    /**
+     * Feature bit masks of up to this size (in bytes) are stored inline
+     * and do not require a heap allocation
+     */
+    static const size_t INLINE_FEATURE_MASK_BYTES=8;
+
   private:
     TypeInfoRef type;
-    uint8_t     *featureBits;
+    uint8_t     *featureBits;        //!< Either points to inlineFeatureBits or to a heap allocated mask
     char        *featureValueBuffer;
+    uint8_t     inlineFeatureBits[INLINE_FEATURE_MASK_BYTES];
 
   private:
     void DeleteData();
     void AllocateBits();
     void AllocateValueBufferLazy();
+    void TakeData(FeatureValueBuffer& other);
 
     /**
      * Return a raw pointer to the value (as reserved in the internal featureValueBuffer). If the
@@ -676,6 +685,7 @@ namespace osmscout {
   public:
     FeatureValueBuffer();
     FeatureValueBuffer(const FeatureValueBuffer& other);
+    FeatureValueBuffer(FeatureValueBuffer&& other) noexcept;
     ~FeatureValueBuffer();
 
     /**
@@ -776,6 +786,7 @@ namespace osmscout {
                bool specialFlag2) const;
 
     FeatureValueBuffer& operator=(const FeatureValueBuffer& other);
+    FeatureValueBuffer& operator=(FeatureValueBuffer&& other) noexcept;
     bool operator==(const FeatureValueBuffer& other) const;
     bool operator!=(const FeatureValueBuffer& other) const;
 
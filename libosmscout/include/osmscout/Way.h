@@ -201,6 +201,11 @@ namespace osmscout {
                FileWriter& writer) const;
     void WriteOptimized(const TypeConfig& typeConfig,
                         FileWriter& writer) const;
+
+  private:
+    void ReadGeometry(FileScanner& scanner);
+
+    friend class WayView;
   };
 
   typedef std::shared_ptr<Way> WayRef;
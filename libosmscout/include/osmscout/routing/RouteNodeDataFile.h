@@ -39,6 +39,7 @@ namespace osmscout {
   private:
     struct IndexEntry
     {
+      Pixel      cell;
       FileOffset fileOffset;
       uint32_t   count;
     };
@@ -62,7 +63,7 @@ namespace osmscout {
 
     TypeConfigRef              typeConfig;      //! typeConfig
 
-    std::map<Pixel,IndexEntry> index;
+    std::vector<IndexEntry>    index;           //!< Index entries, sorted by cell
 
     mutable FileScanner        scanner;         //!< File stream to the data file
     mutable ValueCache         cache;           //!< Cache of loaded route node pages
@@ -70,6 +71,7 @@ namespace osmscout {
     mutable Magnification      magnification;   //!< Magnification of tiled index
 
   private:
+    const IndexEntry* FindIndexEntry(const Pixel& tile) const;
     bool LoadIndexPage(const osmscout::Pixel& tile,
                        ValueCache::CacheRef& cacheRef) const;
     bool GetIndexPage(const osmscout::Pixel& tile,
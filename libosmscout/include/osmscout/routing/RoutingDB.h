@@ -21,6 +21,7 @@
 */
 
 #include <memory>
+#include <mutex>
 
 #include <osmscout/Database.h>
 #include <osmscout/DataFile.h>
@@ -36,16 +37,24 @@ namespace osmscout {
    * \ingroup Routing
    *
    * Encapsulation of the routing relevant data files, similar to Database.
+   *
+   * Like the files of the Database, the route node data file is opened lazily
+   * on first access.
    */
   class RoutingDatabase CLASS_FINAL
   {
   private:
     TypeConfigRef                    typeConfig;
     std::string                      path;
-    RouteNodeDataFile                routeNodeDataFile;
+    bool                             routerDataMMap;
+    mutable RouteNodeDataFile        routeNodeDataFile;     //!< Cached access to the route node data file
+    mutable std::mutex               routeNodeDataFileMutex; //!< Mutex to make lazy initialisation of route node data file thread-safe
     IndexedDataFile<Id,Intersection> junctionDataFile;      //!< Cached access to the 'junctions.dat' file
     ObjectVariantDataFile            objectVariantDataFile;
 
+  private:
+    bool OpenRouteNodeDataFile() const;
+
   public:
     RoutingDatabase();
 
@@ -55,6 +64,10 @@ namespace osmscout {
     inline bool GetRouteNode(const Id& id,
                              RouteNodeRef& node)
     {
+      if (!OpenRouteNodeDataFile()) {
+        return false;
+      }
+
       return routeNodeDataFile.Get(id,
                                    node);
     }
@@ -63,6 +76,10 @@ namespace osmscout {
     inline bool GetRouteNodes(IteratorIn begin, IteratorIn end, size_t size,
                               std::unordered_map<Id,RouteNodeRef>& routeNodeMap)
     {
+      if (!OpenRouteNodeDataFile()) {
+        return false;
+      }
+
       return routeNodeDataFile.Get(begin,
                                    end,
                                    size,
@@ -73,6 +90,10 @@ namespace osmscout {
     inline bool GetRouteNodes(IteratorIn begin, IteratorIn end, size_t size,
                               std::vector<RouteNodeRef>& routeNodes)
     {
+      if (!OpenRouteNodeDataFile()) {
+        return false;
+      }
+
       return routeNodeDataFile.Get(begin,
                                    end,
                                    size,
@@ -89,6 +110,10 @@ namespace osmscout {
 
     inline bool ContainsNode(const Id id) const
     {
+      if (!OpenRouteNodeDataFile()) {
+        return false;
+      }
+
       RouteNodeRef node;
       routeNodeDataFile.Get(id, node);
       return (bool)node;
@@ -0,0 +1,82 @@
+#ifndef OSMSCOUT_UTIL_BLOCKCOMPRESSION_H
+#define OSMSCOUT_UTIL_BLOCKCOMPRESSION_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <osmscout/CoreImportExport.h>
+
+namespace osmscout {
+
+  /**
+   * \defgroup BlockCompression Block compressed data files
+   * \ingroup File
+   *
+   * A data file can be converted into a block compressed container.
+   * The content of the file is split into blocks of a fixed (uncompressed)
+   * size, which are compressed independently using zlib. A block table
+   * maps each block to its position in the container.
+   *
+   * FileScanner detects such files on Open() and transparently decompresses
+   * the blocks accessed. Since the blocks have a fixed uncompressed size,
+   * a logical file offset directly translates into a block index and an
+   * offset within the block. Thus all file offsets stored in other files
+   * (indexes, other data files) stay valid.
+   *
+   * Layout of the container (numbers in little endian):
+   * - 8 byte magic BLOCK_COMPRESSION_MAGIC
+   * - uint32_t uncompressed size of a block
+   * - uint64_t uncompressed size of the file
+   * - uint32_t number of blocks n
+   * - (n+1) uint64_t file offsets of the compressed blocks, the last entry
+   *   is the end of the last block
+   * - the compressed blocks
+   *
+   * @{
+   */
+
+  extern OSMSCOUT_API const char BLOCK_COMPRESSION_MAGIC[8];
+
+  //! Size of the fixed part of the header: magic, block size, file size, block count
+  constexpr size_t BLOCK_COMPRESSION_HEADER_SIZE=8+4+8+4;
+
+  extern OSMSCOUT_API bool IsBlockCompressionSupported();
+
+  extern OSMSCOUT_API bool IsBlockCompressedFile(const std::string& filename);
+
+  extern OSMSCOUT_API void CompressFile(const std::string& filename,
+                                        uint32_t blockSize,
+                                        int level);
+
+  extern OSMSCOUT_API void DecompressBlock(const std::string& filename,
+                                           const char* source,
+                                           size_t sourceSize,
+                                           char* destination,
+                                           size_t destinationSize);
+
+  /**
+   * @}
+   */
+}
+
+#endif
@@ -21,6 +21,7 @@
 */
 
 #include <cstdio>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -56,6 +57,11 @@ namespace osmscout {
     mapping the complete file into the memory of the process (without
     allocating real memory) resulting in measurable speed increase because of
     exchanging buffered file access with in memory array access.
+
+    Without mmap, the file is read in blocks into an internal buffer, so
+    that reading many small values does not result in one library call per
+    value. The buffer is big for sequential access and small for random
+    access (see SetBufferSize()).
     */
   class OSMSCOUT_API FileScanner CLASS_FINAL
   {
@@ -82,6 +88,30 @@ namespace osmscout {
     uint8_t              *byteBuffer;    //!< Temporary buffer for loading of std::vector<GeoCoord>
     size_t               byteBufferSize; //!< Size of the temporary byte buffer
 
+    // For buffered reading without mmap
+    std::vector<char>    readBuffer;       //!< Block of the file read in advance
+    const char           *readBufferData;  //!< Data of the read buffer (readBuffer or a cached block)
+    size_t               readBufferSize;   //!< Configured size of the read buffer, 0 for the default of the mode
+    size_t               readBufferLimit;  //!< Size of the read buffer used for the current file
+    FileOffset           readBufferOffset; //!< File offset of the first byte in the read buffer
+    size_t               readBufferFill;   //!< Number of valid bytes in the read buffer
+    size_t               readBufferPos;    //!< Position of the reading cursor in the read buffer
+
+    // For block compressed files
+    struct CachedBlock
+    {
+      size_t            index;      //!< Index of the block in the file
+      uint64_t          lastAccess; //!< Value of blockAccessCounter at the last access
+      std::vector<char> data;       //!< Decompressed data
+    };
+
+    bool                     compressed;          //!< The file is block compressed
+    uint32_t                 compressedBlockSize; //!< Uncompressed size of a block
+    std::vector<FileOffset>  blockOffsets;        //!< File offsets of the compressed blocks
+    std::vector<char>        compressedBlock;     //!< Buffer for reading a compressed block
+    std::vector<CachedBlock> blockCache;          //!< Recently used decompressed blocks
+    uint64_t                 blockAccessCounter;  //!< Logical clock for LRU handling of the cache
+
     // For Windows mmap usage
 #if defined(__WIN32__) || defined(WIN32)
     HANDLE       mmfHandle;
@@ -90,6 +120,27 @@ namespace osmscout {
   private:
     void AssureByteBufferSize(size_t size);
     void FreeBuffer();
+    bool ReadUnbuffered(char* data, size_t bytes);
+    bool ReadCompressionHeader();
+    void LoadBlock(FileOffset pos);
+    bool ReadCompressed(char* data, size_t bytes);
+
+    /**
+     * Copy the given number of bytes from the read buffer, refilling it
+     * from the file if necessary. Returns false, if the file does not hold
+     * enough data.
+     */
+    inline bool ReadBuffered(void* data, size_t bytes)
+    {
+      if (readBufferPos+bytes>readBufferFill) {
+        return ReadUnbuffered(static_cast<char*>(data),bytes);
+      }
+
+      std::memcpy(data,readBufferData+readBufferPos,bytes);
+      readBufferPos+=bytes;
+
+      return true;
+    }
 
     /**
      * Reads bytes to internal temporary buffer
@@ -105,6 +156,11 @@ namespace osmscout {
      */
     char* ReadInternal(size_t bytes);
 
+    bool ReadPointsHeader(bool readIds,
+                          bool& hasNodes,
+                          size_t& nodeCount,
+                          size_t& coordBitSize);
+
     /**
      * Set coordinates using raw data from file.
      *
@@ -180,6 +236,11 @@ namespace osmscout {
       return value!=0;
     }
 
+  public:
+    static const size_t SEQUENTIAL_BUFFER_SIZE; //!< Default read buffer size for Sequential and Normal mode
+    static const size_t RANDOM_BUFFER_SIZE;     //!< Default read buffer size for the random access modes
+    static const size_t BLOCK_CACHE_SIZE;       //!< Number of decompressed blocks cached for compressed files
+
   public:
     FileScanner();
     virtual ~FileScanner();
@@ -197,6 +258,11 @@ namespace osmscout {
 
     bool IsEOF() const;
 
+    inline bool IsCompressed() const
+    {
+      return compressed;
+    }
+
     inline  bool HasError() const
     {
       return file==nullptr || hasError;
@@ -204,6 +270,8 @@ namespace osmscout {
 
     std::string GetFilename() const;
 
+    void SetBufferSize(size_t bufferSize);
+
     void GotoBegin();
     void SetPos(FileOffset pos);
     FileOffset GetPos() const;
@@ -259,6 +327,9 @@ namespace osmscout {
               GeoBox &bbox,
               bool readIds);
 
+    void ReadBoundingBox(GeoBox& bbox,
+                         bool readIds);
+
     void ReadBox(GeoBox& box);
 
     void ReadTypeId(TypeId& id,
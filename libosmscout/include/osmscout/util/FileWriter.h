@@ -21,6 +21,7 @@
 */
 
 #include <cstdio>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -43,6 +44,11 @@ namespace osmscout {
     FileScanner implements platform independent writing to data in files.
     It uses C standard library FILE internally and wraps it to offer
     a number of convenience methods.
+
+    Data is collected in an internal buffer and handed to the FILE in big
+    blocks, so that writing many small values does not result in one library
+    call per value. The buffer is written if it is full, on SetPos(),
+    Flush() and Close().
     */
   class OSMSCOUT_API FileWriter CLASS_FINAL
   {
@@ -52,15 +58,43 @@ namespace osmscout {
     bool                 hasError;    //!< Flag for signaling that the stream has errors
     std::vector<int32_t> deltaBuffer; //!< Temporary storage for deltas for storing of std::vector<GeoCoord>
     std::vector<uint8_t> byteBuffer;  //!< Temporary data buffer for storing of std::vector<GeoCoord>
+    std::vector<char>    writeBuffer; //!< Data written, but not yet handed to the FILE object
+    size_t               bufferSize;  //!< Size of the write buffer
+    size_t               bufferFill;  //!< Number of bytes in the write buffer
+    FileOffset           position;    //!< Current (logical) position of the writing cursor
+
+  private:
+    void FlushBuffer();
+    void WriteUnbuffered(const char* data, size_t bytes);
+
+    /**
+     * Append the given data to the write buffer and writes the buffer
+     * to the file, if it is full.
+     *
+     * @throws IOException
+     */
+    inline void WriteBuffered(const void* data, size_t bytes)
+    {
+      if (bufferFill+bytes>writeBuffer.size()) {
+        WriteUnbuffered(static_cast<const char*>(data),bytes);
+        return;
+      }
+
+      std::memcpy(writeBuffer.data()+bufferFill,data,bytes);
+      bufferFill+=bytes;
+      position+=bytes;
+    }
 
   public:
     static const uint64_t MAX_NODES;
+    static const size_t   DEFAULT_BUFFER_SIZE;
 
   public:
     FileWriter();
     virtual ~FileWriter();
 
     void Open(const std::string& filename);
+    void OpenForAppend(const std::string& filename);
     void Close();
     void CloseFailsafe();
     inline bool IsOpen() const
@@ -75,6 +109,13 @@ namespace osmscout {
 
     std::string GetFilename() const;
 
+    void SetBufferSize(size_t bufferSize);
+
+    inline size_t GetBufferSize() const
+    {
+      return bufferSize;
+    }
+
     FileOffset GetPos();
     void SetPos(FileOffset pos);
     void GotoBegin();
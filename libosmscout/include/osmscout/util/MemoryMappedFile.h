@@ -0,0 +1,102 @@
+#ifndef OSMSCOUT_UTIL_MEMORYMAPPEDFILE_H
+#define OSMSCOUT_UTIL_MEMORYMAPPEDFILE_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <osmscout/CoreImportExport.h>
+
+#include <osmscout/util/Exception.h>
+
+#include <osmscout/system/Compiler.h>
+
+namespace osmscout {
+
+  /**
+    \ingroup File
+
+    MemoryMappedFile gives read and write access to the complete content of a
+    file as one continuous memory region. The file can be resized.
+
+    If mmap is available, the file is mapped shared, so changes are written
+    back by the operating system. Else the content is read into memory on Open()
+    and written back on Flush() and Close().
+
+    Files opened using OpenReadOnly() can neither be changed nor resized.
+
+    Note that Resize() may move the memory region, so pointers returned by
+    GetData() are only valid until the next call to Resize().
+    */
+  class OSMSCOUT_API MemoryMappedFile CLASS_FINAL
+  {
+  private:
+    std::string       filename; //!< The filename
+    std::FILE         *file;    //!< The low level FILE object
+    char              *data;    //!< Start of the memory region
+    size_t            size;     //!< Size of the memory region and the file
+    std::vector<char> buffer;   //!< In memory copy of the file, if mmap is not available
+    bool              readOnly; //!< The file was opened read-only
+
+  private:
+    void Map();
+    void Unmap();
+
+  public:
+    MemoryMappedFile();
+    ~MemoryMappedFile();
+
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+    void Open(const std::string& filename,
+              bool create);
+    void OpenReadOnly(const std::string& filename);
+    void Close();
+    void CloseFailsafe();
+
+    void Resize(size_t size);
+    void Flush();
+
+    inline bool IsOpen() const
+    {
+      return file!=nullptr;
+    }
+
+    inline std::string GetFilename() const
+    {
+      return filename;
+    }
+
+    inline char* GetData() const
+    {
+      return data;
+    }
+
+    inline size_t GetSize() const
+    {
+      return size;
+    }
+  };
+}
+
+#endif
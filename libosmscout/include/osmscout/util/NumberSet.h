@@ -22,8 +22,9 @@
 
 #include <osmscout/CoreImportExport.h>
 
-#include <bitset>
+#include <cstdint>
 #include <unordered_map>
+#include <vector>
 
 #include <osmscout/OSMScoutTypes.h>
 
@@ -34,24 +35,77 @@ namespace osmscout {
   /**
    * \ingroup Util
    *
+   * Compressed set of (numeric) ids.
+   *
+   * Ids are split into chunks of 65536 consecutive values. Each chunk stores
+   * the lower 16 bits of its values in one of three containers (similar to a
+   * "roaring bitmap"):
+   * - a sorted array of values, if the chunk has at most 4096 values
+   * - a bitmap of 8 KiB, if the chunk has more values
+   * - a sorted list of runs of consecutive values, if this is smaller
+   *   than the alternatives (only created by Optimize())
+   *
+   * Thus memory usage is about 2 bytes per id for sparse ids, 1 bit per id for
+   * dense ids and even less for long ranges of consecutive ids. Chunks without
+   * ids do not use memory at all, so the set also works for huge and sparse ids.
    */
   class OSMSCOUT_API NumberSet CLASS_FINAL
   {
   private:
-    typedef std::bitset<4096>                 Bitset;
-    typedef std::unordered_map<size_t,Bitset> Map;
+    class Container
+    {
+    private:
+      enum class Type : uint8_t
+      {
+        array,
+        bitmap,
+        run
+      };
+
+    public:
+      static const size_t maxArraySize=4096;
+      static const size_t bitmapWords=65536/64;
+
+    private:
+      Type                  type;
+      uint32_t              count;
+      std::vector<uint16_t> values;   //!< Sorted values (array) or pairs of run start and run length-1 (run)
+      std::vector<uint64_t> bitmap;
+
+    private:
+      void CollectValues(std::vector<uint16_t>& result) const;
+      void ConvertToArray();
+      void ConvertToBitmap();
+      void ConvertToRun();
+      size_t GetRunCount() const;
+
+    public:
+      Container();
+
+      bool Set(uint16_t value);
+      bool IsSet(uint16_t value) const;
+
+      void Optimize();
+
+      size_t GetMemory() const;
+    };
+
+    typedef std::unordered_map<uint64_t,Container> Map;
 
   private:
     Map                                       map;
     size_t                                    count;
 
-    public:
+  public:
     NumberSet();
 
     void Set(Id id);
     bool IsSet(Id id) const;
     size_t GetNodeUsedCount() const;
 
+    void Optimize();
+    size_t GetMemory() const;
+
     void Clear();
   };
 
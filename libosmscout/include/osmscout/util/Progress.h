@@ -22,6 +22,8 @@
 
 #include <ctime>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <osmscout/CoreFeatures.h>
 
@@ -61,6 +63,35 @@ namespace osmscout {
     virtual ~SilentProgress() override;
   };
 
+  /**
+   * Progress buffering all messages, so that the messages of work done in
+   * parallel can be passed on later in a deterministic order
+   */
+  class OSMSCOUT_API BufferedProgress : public Progress
+  {
+  private:
+    enum class Level
+    {
+      debug,
+      info,
+      warning,
+      error
+    };
+
+  private:
+    std::vector<std::pair<Level,std::string>> messages;
+
+  public:
+    explicit BufferedProgress(bool outputDebug);
+
+    void Debug(const std::string& text) override;
+    void Info(const std::string& text) override;
+    void Warning(const std::string& text) override;
+    void Error(const std::string& text) override;
+
+    void Flush(Progress& progress);
+  };
+
   class OSMSCOUT_API ConsoleProgress : public Progress
   {
   private:
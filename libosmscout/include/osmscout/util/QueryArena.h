@@ -0,0 +1,162 @@
+#ifndef OSMSCOUT_UTIL_QUERYARENA_H
+#define OSMSCOUT_UTIL_QUERYARENA_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <osmscout/CoreImportExport.h>
+
+#include <osmscout/system/Compiler.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Util
+   *
+   * Monotonic memory arena for objects loaded in the context of one query
+   * (for example all nodes, ways and areas of one map tile).
+   *
+   * Memory is taken from large blocks by bumping a pointer. Single
+   * allocations are never freed, instead all blocks are released together
+   * when the arena is destroyed. This replaces one heap allocation per
+   * loaded object by one heap allocation per block and gives the objects
+   * of a query good locality.
+   *
+   * Allocation is thread-safe.
+   */
+  class OSMSCOUT_API QueryArena CLASS_FINAL
+  {
+  public:
+    static const size_t DEFAULT_BLOCK_SIZE=64*1024;
+
+  private:
+    struct Block
+    {
+      std::unique_ptr<char[]> data;
+      size_t                  size;
+      size_t                  used;
+    };
+
+  private:
+    mutable std::mutex accessMutex;
+    size_t             blockSize;
+    std::vector<Block> blocks;
+    size_t             allocationCount;
+    size_t             allocatedBytes;
+
+  public:
+    explicit QueryArena(size_t blockSize=DEFAULT_BLOCK_SIZE);
+
+    QueryArena(const QueryArena&) = delete;
+    QueryArena& operator=(const QueryArena&) = delete;
+
+    void* Allocate(size_t size,
+                   size_t alignment);
+
+    size_t GetAllocationCount() const;
+    size_t GetAllocatedBytes() const;
+    size_t GetBlockCount() const;
+    size_t GetMemoryUsage() const;
+  };
+
+  typedef std::shared_ptr<QueryArena> QueryArenaRef;
+
+  /**
+   * \ingroup Util
+   *
+   * Standard library allocator taking its memory from a QueryArena.
+   * Deallocation is a no-op, memory is returned when the arena is destroyed.
+   *
+   * The allocator holds a reference to the arena. Objects created by
+   * std::allocate_shared() store a copy of the allocator in their control
+   * block, so the arena stays alive as long as any of its objects is
+   * referenced.
+   */
+  template<typename T>
+  class QueryArenaAllocator
+  {
+  public:
+    typedef T value_type;
+
+  private:
+    QueryArenaRef arena;
+
+    template<typename U>
+    friend class QueryArenaAllocator;
+
+  public:
+    explicit QueryArenaAllocator(const QueryArenaRef& arena)
+    : arena(arena)
+    {
+      // no code
+    }
+
+    template<typename U>
+    QueryArenaAllocator(const QueryArenaAllocator<U>& other)
+    : arena(other.arena)
+    {
+      // no code
+    }
+
+    T* allocate(size_t n)
+    {
+      return static_cast<T*>(arena->Allocate(n*sizeof(T),
+                                             alignof(T)));
+    }
+
+    void deallocate(T* /*p*/,
+                    size_t /*n*/)
+    {
+      // no code
+    }
+
+    template<typename U>
+    bool operator==(const QueryArenaAllocator<U>& other) const
+    {
+      return arena==other.arena;
+    }
+
+    template<typename U>
+    bool operator!=(const QueryArenaAllocator<U>& other) const
+    {
+      return arena!=other.arena;
+    }
+  };
+
+  /**
+   * Create a default constructed object, either in the given arena or - if
+   * no arena is given - on the heap.
+   */
+  template<typename T>
+  std::shared_ptr<T> MakeShared(const QueryArenaRef& arena)
+  {
+    if (arena) {
+      return std::allocate_shared<T>(QueryArenaAllocator<T>(arena));
+    }
+
+    return std::make_shared<T>();
+  }
+}
+
+#endif
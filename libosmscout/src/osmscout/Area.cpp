@@ -247,6 +247,27 @@ namespace osmscout {
       ringCount++;
     }
 
+    ReadRings(typeConfig,
+              scanner,
+              std::move(featureValueBuffer),
+              ringCount,
+              hasMaster);
+  }
+
+  /**
+   * Read the rings of the area, starting with the nodes of the first ring.
+   * The already read features of the first ring are moved into it.
+   *
+   * @throws IOException
+   */
+  void Area::ReadRings(const TypeConfig& typeConfig,
+                       FileScanner& scanner,
+                       FeatureValueBuffer&& featureValueBuffer,
+                       uint32_t ringCount,
+                       bool hasMaster)
+  {
+    TypeId ringType;
+
     rings.resize(ringCount);
 
     rings[0].featureValueBuffer=std::move(featureValueBuffer);
@@ -268,7 +289,7 @@ namespace osmscout {
       scanner.ReadTypeId(ringType,
                          typeConfig.GetAreaTypeIdBytes());
 
-      type=typeConfig.GetAreaTypeInfo(ringType);
+      TypeInfoRef type=typeConfig.GetAreaTypeInfo(ringType);
 
       ring.SetType(type);
 
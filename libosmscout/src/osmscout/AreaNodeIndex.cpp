@@ -34,6 +34,43 @@ namespace osmscout {
 
   const char* AreaNodeIndex::AREA_NODE_IDX="areanode.idx";
 
+  template<typename T>
+  static void SortTiles(std::vector<T>& tiles)
+  {
+    auto tileIdLess=[](const T& a,
+                       const T& b) {
+      return a.tileId<b.tileId;
+    };
+
+    if (!std::is_sorted(tiles.begin(),tiles.end(),tileIdLess)) {
+      std::sort(tiles.begin(),tiles.end(),tileIdLess);
+    }
+  }
+
+  /**
+   * Return the tile with the given id from a tile directory sorted by tile id
+   * or nullptr, if there is no such tile.
+   */
+  template<typename T>
+  static const T* FindTile(const std::vector<T>& tiles,
+                           const TileId& tileId)
+  {
+    auto tile=std::lower_bound(tiles.begin(),
+                               tiles.end(),
+                               tileId,
+                               [](const T& entry,
+                                  const TileId& id) {
+                                 return entry.tileId<id;
+                               });
+
+    if (tile!=tiles.end() &&
+        tile->tileId==tileId) {
+      return &(*tile);
+    }
+
+    return nullptr;
+  }
+
   AreaNodeIndex::AreaNodeIndex()
   {
     // no code
@@ -111,16 +148,22 @@ namespace osmscout {
           nodeTypeData.resize(typeId+1);
         }
 
-        uint32_t x,y;
+        uint32_t   x,y;
+        FileOffset fileOffset;
+        uint16_t   entryCount;
+        bool       storeGeoCoord;
 
         scanner.Read(x);
         scanner.Read(y);
 
-        ListTile& entry=nodeTypeData[typeId].listTiles[TileId(x,y)];
+        scanner.ReadFileOffset(fileOffset);
+        scanner.Read(entryCount);
+        scanner.Read(storeGeoCoord);
 
-        scanner.ReadFileOffset(entry.fileOffset);
-        scanner.Read(entry.entryCount);
-        scanner.Read(entry.storeGeoCoord);
+        nodeTypeData[typeId].listTiles.push_back(ListTile{TileId(x,y),
+                                                          fileOffset,
+                                                          entryCount,
+                                                          storeGeoCoord});
       }
 
       uint32_t bitmapEntryCount;
@@ -136,20 +179,32 @@ namespace osmscout {
           nodeTypeData.resize(typeId+1);
         }
 
-        uint32_t x,y;
-        uint8_t  magnification;
+        uint32_t   x,y;
+        FileOffset fileOffset;
+        uint8_t    dataOffsetBytes;
+        uint8_t    magnification;
 
         scanner.Read(x);
         scanner.Read(y);
 
-        BitmapTile& entry=nodeTypeData[typeId].bitmapTiles[TileId(x,y)];
-
-        scanner.ReadFileOffset(entry.fileOffset);
-        scanner.Read(entry.dataOffsetBytes);
+        scanner.ReadFileOffset(fileOffset);
+        scanner.Read(dataOffsetBytes);
 
         scanner.Read(magnification);
 
-        entry.magnification=MagnificationLevel(magnification);
+        nodeTypeData[typeId].bitmapTiles.push_back(BitmapTile{TileId(x,y),
+                                                              fileOffset,
+                                                              dataOffsetBytes,
+                                                              MagnificationLevel(magnification)});
+      }
+
+      for (auto& typeData : nodeTypeData) {
+        SortTiles(typeData.listTiles);
+        SortTiles(typeData.bitmapTiles);
+      }
+
+      if (!updates.Load(path)) {
+        return false;
       }
 
       return !scanner.HasError();
@@ -200,15 +255,16 @@ namespace osmscout {
                       TileId::GetTile(gridMag,boundingBox.GetMaxCoord()));
 
     for (const auto& tileId : tileBox) {
-      auto tile=typeData.listTiles.find(tileId);
+      const ListTile* tile=FindTile(typeData.listTiles,
+                                    tileId);
 
-      if (tile!=typeData.listTiles.end()) {
-        scanner.SetPos(tile->second.fileOffset);
+      if (tile!=nullptr) {
+        scanner.SetPos(tile->fileOffset);
 
         FileOffset previousOffset=0;
 
-        if (tile->second.storeGeoCoord) {
-          for (auto i=1; i<=tile->second.entryCount; i++) {
+        if (tile->storeGeoCoord) {
+          for (auto i=1; i<=tile->entryCount; i++) {
             GeoCoord   coord;
             FileOffset fileOffset;
 
@@ -225,7 +281,7 @@ namespace osmscout {
           }
         }
         else {
-          for (auto i=1; i<=tile->second.entryCount; i++) {
+          for (auto i=1; i<=tile->entryCount; i++) {
             FileOffset fileOffset;
 
             scanner.ReadNumber(fileOffset);
@@ -253,11 +309,12 @@ namespace osmscout {
                                             boundingBox.GetMaxCoord()));
 
     for (const auto& tileId : searchTileBox) {
-      auto tileBitmap=typeData.bitmapTiles.find(tileId);
+      const BitmapTile* tileBitmap=FindTile(typeData.bitmapTiles,
+                                            tileId);
 
-      if (tileBitmap!=typeData.bitmapTiles.end()) {
-        MagnificationLevel magnification(tileBitmap->second.magnification);
-        GeoBox             box=tileBitmap->first.GetBoundingBox(gridMag);
+      if (tileBitmap!=nullptr) {
+        MagnificationLevel magnification(tileBitmap->magnification);
+        GeoBox             box=tileBitmap->tileId.GetBoundingBox(gridMag);
         TileIdBox          bitmapTileBox(TileId::GetTile(magnification,
                                                          box.GetMinCoord()),
                                          TileId::GetTile(magnification,
@@ -268,7 +325,7 @@ namespace osmscout {
                                                               boundingBox.GetMaxCoord()));
 
         // Offset of the data behind the bitmap
-        FileOffset dataOffset=tileBitmap->second.fileOffset+bitmapTileBox.GetCount()*tileBitmap->second.dataOffsetBytes;
+        FileOffset dataOffset=tileBitmap->fileOffset+bitmapTileBox.GetCount()*tileBitmap->dataOffsetBytes;
 
         auto minxc=std::max(bitmapTileBox.GetMinX(),boundingBoxTileBox.GetMinX());
         auto maxxc=std::min(bitmapTileBox.GetMaxX(),boundingBoxTileBox.GetMaxX());
@@ -281,9 +338,9 @@ namespace osmscout {
           std::lock_guard<std::mutex> guard(lookupMutex);
           FileOffset                  initialCellDataOffset=0;
           size_t                      cellDataOffsetCount=0;
-          FileOffset                  cellIndexOffset=tileBitmap->second.fileOffset+
+          FileOffset                  cellIndexOffset=tileBitmap->fileOffset+
                                                       ((y-bitmapTileBox.GetMinY())*bitmapTileBox.GetWidth()+
-                                                       minxc-bitmapTileBox.GetMinX())*tileBitmap->second.dataOffsetBytes;
+                                                       minxc-bitmapTileBox.GetMinX())*tileBitmap->dataOffsetBytes;
 
           scanner.SetPos(cellIndexOffset);
 
@@ -292,7 +349,7 @@ namespace osmscout {
             FileOffset cellDataOffset;
 
             scanner.ReadFileOffset(cellDataOffset,
-                                   tileBitmap->second.dataOffsetBytes);
+                                   tileBitmap->dataOffsetBytes);
 
             if (cellDataOffset==0) {
               continue;
@@ -360,16 +417,18 @@ namespace osmscout {
           continue;
         }
 
-        auto index=type->GetNodeId();
+        auto   index=type->GetNodeId();
+        size_t typeStart=offsets.size();
+        bool   loaded=true;
+
         if (index<nodeTypeData.size()) {
           if (!nodeTypeData[index].boundingBox.Intersects(boundingBox)) {
             // No data available in given bounding box
-            continue;
+            loaded=false;
           }
-
-          if (!nodeTypeData[index].isComplex &&
-              nodeTypeData[index].indexOffset!=0 &&
-              nodeTypeData[index].entryCount!=0) {
+          else if (!nodeTypeData[index].isComplex &&
+                   nodeTypeData[index].indexOffset!=0 &&
+                   nodeTypeData[index].entryCount!=0) {
             if (!GetOffsetsList(nodeTypeData[index],boundingBox,offsets)) {
               return false;
             }
@@ -383,11 +442,18 @@ namespace osmscout {
             }
           }
           else {
-            continue;
+            loaded=false;
           }
         }
 
-        loadedTypes.Set(type);
+        if (!updates.IsEmpty() &&
+            updates.Apply(index,boundingBox,typeStart,offsets)) {
+          loaded=true;
+        }
+
+        if (loaded) {
+          loadedTypes.Set(type);
+        }
       }
     }
     catch (IOException& e) {
@@ -0,0 +1,259 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/AreaNodeUpdates.h>
+
+#include <algorithm>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+#include <osmscout/util/Logger.h>
+
+namespace osmscout {
+
+  const char* const AreaNodeUpdates::AREA_NODE_UPD="areanode.upd";
+
+  /**
+   * Load the updates from the given database directory. A missing file
+   * is not an error, it just means that there are no updates.
+   */
+  bool AreaNodeUpdates::Load(const std::string& path)
+  {
+    std::string filename=AppendFileToDir(path,AREA_NODE_UPD);
+
+    removedOffsets.clear();
+    entries.clear();
+
+    FileScanner scanner;
+
+    try {
+      if (!ExistsInFilesystem(filename)) {
+        return true;
+      }
+
+      scanner.Open(filename,
+                   FileScanner::Sequential,
+                   false);
+
+      uint32_t removedCount;
+
+      scanner.Read(removedCount);
+
+      removedOffsets.resize(removedCount);
+
+      for (auto& offset : removedOffsets) {
+        scanner.ReadFileOffset(offset);
+      }
+
+      uint32_t entryCount;
+
+      scanner.Read(entryCount);
+
+      entries.resize(entryCount);
+
+      for (auto& entry : entries) {
+        scanner.Read(entry.id);
+        scanner.ReadNumber(entry.type);
+        scanner.ReadCoord(entry.coord);
+        scanner.ReadFileOffset(entry.fileOffset);
+      }
+
+      scanner.Close();
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      scanner.CloseFailsafe();
+      removedOffsets.clear();
+      entries.clear();
+
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Store the updates in the given database directory. If there are no
+   * updates, an existing file is removed.
+   */
+  bool AreaNodeUpdates::Store(const std::string& path) const
+  {
+    std::string filename=AppendFileToDir(path,AREA_NODE_UPD);
+
+    FileWriter writer;
+
+    try {
+      if (IsEmpty()) {
+        if (ExistsInFilesystem(filename)) {
+          return RemoveFile(filename);
+        }
+
+        return true;
+      }
+
+      writer.Open(filename);
+
+      writer.Write((uint32_t)removedOffsets.size());
+
+      for (const auto offset : removedOffsets) {
+        writer.WriteFileOffset(offset);
+      }
+
+      writer.Write((uint32_t)entries.size());
+
+      for (const auto& entry : entries) {
+        writer.Write(entry.id);
+        writer.WriteNumber(entry.type);
+        writer.WriteCoord(entry.coord);
+        writer.WriteFileOffset(entry.fileOffset);
+      }
+
+      writer.Close();
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      writer.CloseFailsafe();
+
+      return false;
+    }
+
+    return true;
+  }
+
+  bool AreaNodeUpdates::IsRemoved(FileOffset offset) const
+  {
+    return std::binary_search(removedOffsets.begin(),
+                              removedOffsets.end(),
+                              offset);
+  }
+
+  /**
+   * Tombstone the node at the given offset
+   */
+  void AreaNodeUpdates::Remove(FileOffset offset)
+  {
+    auto pos=std::lower_bound(removedOffsets.begin(),
+                              removedOffsets.end(),
+                              offset);
+
+    if (pos==removedOffsets.end() ||
+        *pos!=offset) {
+      removedOffsets.insert(pos,offset);
+    }
+  }
+
+  static bool EntryIdLess(const AreaNodeUpdates::Entry& entry,
+                          OSMId id)
+  {
+    return entry.id<id;
+  }
+
+  /**
+   * Return the entry for the node with the given OSM id or nullptr, if
+   * the node was not added by an update.
+   */
+  const AreaNodeUpdates::Entry* AreaNodeUpdates::Find(OSMId id) const
+  {
+    auto pos=std::lower_bound(entries.begin(),
+                              entries.end(),
+                              id,
+                              EntryIdLess);
+
+    if (pos==entries.end() ||
+        pos->id!=id) {
+      return nullptr;
+    }
+
+    return &(*pos);
+  }
+
+  /**
+   * Add the given entry, replacing an existing entry with the same OSM id
+   */
+  void AreaNodeUpdates::Set(const Entry& entry)
+  {
+    auto pos=std::lower_bound(entries.begin(),
+                              entries.end(),
+                              entry.id,
+                              EntryIdLess);
+
+    if (pos!=entries.end() &&
+        pos->id==entry.id) {
+      *pos=entry;
+    }
+    else {
+      entries.insert(pos,entry);
+    }
+  }
+
+  /**
+   * Remove the entry with the given OSM id. Returns false, if there is no such entry.
+   */
+  bool AreaNodeUpdates::Erase(OSMId id)
+  {
+    auto pos=std::lower_bound(entries.begin(),
+                              entries.end(),
+                              id,
+                              EntryIdLess);
+
+    if (pos==entries.end() ||
+        pos->id!=id) {
+      return false;
+    }
+
+    entries.erase(pos);
+
+    return true;
+  }
+
+  /**
+   * Apply the updates to the offsets of the given type collected from the
+   * index, starting at index start: tombstoned offsets are removed and the
+   * offsets of added nodes of the given type in the bounding box are appended.
+   *
+   * Returns true, if at least one offset was appended.
+   */
+  bool AreaNodeUpdates::Apply(TypeId type,
+                              const GeoBox& boundingBox,
+                              size_t start,
+                              std::vector<FileOffset>& offsets) const
+  {
+    if (!removedOffsets.empty()) {
+      offsets.erase(std::remove_if(offsets.begin()+start,
+                                   offsets.end(),
+                                   [this](FileOffset offset) {
+                                     return IsRemoved(offset);
+                                   }),
+                    offsets.end());
+    }
+
+    bool added=false;
+
+    for (const auto& entry : entries) {
+      if (entry.type==type &&
+          boundingBox.Includes(entry.coord)) {
+        offsets.push_back(entry.fileOffset);
+        added=true;
+      }
+    }
+
+    return added;
+  }
+}
@@ -30,7 +30,10 @@ namespace osmscout {
 
   CoordDataFile::CoordDataFile()
   : isOpen(false),
-    pageSize(0)
+    pageSize(0),
+    firstId(0),
+    idCount(0),
+    dataOffset(0)
   {
     // no code
   }
@@ -60,6 +63,17 @@ namespace osmscout {
       scanner.Read(mapOffset);
       scanner.Read(pageSize);
 
+      if (pageSize==0) {
+        // Dense layout, entries directly follow the header
+        scanner.Read(firstId);
+        scanner.Read(idCount);
+
+        dataOffset=scanner.GetPos();
+        isOpen=true;
+
+        return true;
+      }
+
       scanner.SetPos(mapOffset);
 
       uint32_t mapSize;
@@ -107,6 +121,63 @@ namespace osmscout {
     return true;
   }
 
+  /**
+   * Read the coordinate of the given node. Returns false, if the node is unknown.
+   *
+   * @throws IOException
+   */
+  bool CoordDataFile::ReadCoord(OSMId id,
+                                Coord& coord) const
+  {
+    FileOffset offset;
+
+    if (IsDense()) {
+      if (id<firstId ||
+          (uint64_t)(id-firstId)>=idCount) {
+        return false;
+      }
+
+      offset=dataOffset+(FileOffset)(id-firstId)*(coordByteSize+1);
+    }
+    else {
+      PageId relatedId=id+std::numeric_limits<OSMId>::min();
+      PageId pageId=relatedId/pageSize;
+
+      auto   pageOffset=pageFileOffsetMap.find(pageId);
+
+      if (pageOffset==pageFileOffsetMap.end()) {
+        return false;
+      }
+
+      offset=pageOffset->second+(relatedId%pageSize)*(coordByteSize+1);
+    }
+
+    scanner.SetPos(offset);
+
+    uint8_t  serial;
+    bool     isSet;
+    GeoCoord geoCoord;
+
+    scanner.Read(serial);
+
+    // Unused entries of the dense layout are zero
+    if (serial==0) {
+      return false;
+    }
+
+    scanner.ReadConditionalCoord(geoCoord,
+                                 isSet);
+
+    if (!isSet) {
+      return false;
+    }
+
+    coord=Coord(serial,
+                geoCoord);
+
+    return true;
+  }
+
   bool CoordDataFile::Get(const std::set<OSMId>& ids, ResultMap& resultMap) const
   {
     assert(isOpen);
@@ -115,35 +186,41 @@ namespace osmscout {
     resultMap.reserve(ids.size());
 
     try {
-      for (const auto& id : ids) {
-        PageId relatedId=id+std::numeric_limits<OSMId>::min();
-        PageId pageId=relatedId/pageSize;
-
-        auto   pageOffset=pageFileOffsetMap.find(pageId);
+      Coord coord;
 
-        if (pageOffset==pageFileOffsetMap.end()) {
-          continue;
+      for (const auto& id : ids) {
+        if (ReadCoord(id,coord)) {
+          resultMap.insert(std::make_pair(id,
+                                          coord));
         }
+      }
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
 
-        FileOffset offset=pageOffset->second+(relatedId%pageSize)*(coordByteSize+1);
+      return false;
+    }
 
-        scanner.SetPos(offset);
+    return true;
+  }
 
-        uint8_t  serial;
-        bool     isSet;
-        GeoCoord coord;
+  /**
+   * Return the coordinates of the given nodes. coords[i] is the coordinate of ids[i].
+   * Unknown nodes have a coordinate with the serial 0.
+   *
+   * Sorted ids result in sequential file access.
+   */
+  bool CoordDataFile::Get(const std::vector<OSMId>& ids, std::vector<Coord>& coords) const
+  {
+    assert(isOpen);
 
-        scanner.Read(serial);
-        scanner.ReadConditionalCoord(coord,
-                                     isSet);
+    coords.resize(ids.size());
 
-        if (!isSet) {
-          continue;
+    try {
+      for (size_t i=0; i<ids.size(); i++) {
+        if (!ReadCoord(ids[i],coords[i])) {
+          coords[i]=Coord(0,GeoCoord());
         }
-
-        resultMap.insert(std::make_pair(id,
-                                        Coord(serial,
-                                              coord)));
       }
     }
     catch (IOException& e) {
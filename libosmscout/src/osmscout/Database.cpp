@@ -25,6 +25,8 @@
 #include <omp.h>
 #endif
 
+#include <osmscout/ObjectView.h>
+
 #include <osmscout/system/Assert.h>
 #include <osmscout/system/Math.h>
 
@@ -200,11 +202,17 @@ namespace osmscout {
 
     typeConfig=std::make_shared<TypeConfig>();
 
+    StopClock timer;
+
     if (!typeConfig->LoadFromDataFile(path)) {
       log.Error() << "Cannot load 'types.dat'!";
       return false;
     }
 
+    timer.Stop();
+
+    RecordOpenTime("TypeConfig",timer);
+
     isOpen=true;
 
     return true;
@@ -271,6 +279,12 @@ namespace osmscout {
       optimizeAreasLowZoom=nullptr;
     }
 
+    {
+      std::lock_guard<std::mutex> guard(openTimesMutex);
+
+      openTimes.clear();
+    }
+
     isOpen=false;
   }
 
@@ -284,6 +298,16 @@ namespace osmscout {
     return typeConfig;
   }
 
+  void Database::RecordOpenTime(const std::string& name,
+                                const StopClock& timer) const
+  {
+    log.Debug() << "Opening " << name << ": " << timer.ResultString();
+
+    std::lock_guard<std::mutex> guard(openTimesMutex);
+
+    openTimes.push_back(DatabaseOpenTime{name,timer.GetMilliseconds()});
+  }
+
   BoundingBoxDataFileRef Database::GetBoundingBoxDataFile() const
   {
     std::lock_guard<std::mutex> guard(boundingBoxDataFileMutex);
@@ -306,7 +330,7 @@ namespace osmscout {
 
       timer.Stop();
 
-      log.Debug() << "Opening BoundingBoxDataFile: " << timer.ResultString();
+      RecordOpenTime("BoundingBoxDataFile",timer);
     }
 
     return boundingBoxDataFile;
@@ -336,7 +360,7 @@ namespace osmscout {
 
       timer.Stop();
 
-      log.Debug() << "Opening NodeDataFile: " << timer.ResultString();
+      RecordOpenTime("NodeDataFile",timer);
     }
 
     return nodeDataFile;
@@ -366,7 +390,7 @@ namespace osmscout {
 
       timer.Stop();
 
-      log.Debug() << "Opening AreaDataFile: " << timer.ResultString();
+      RecordOpenTime("AreaDataFile",timer);
     }
 
     return areaDataFile;
@@ -396,7 +420,7 @@ namespace osmscout {
 
       timer.Stop();
 
-      log.Debug() << "Opening WayDataFile: " << timer.ResultString();
+      RecordOpenTime("WayDataFile",timer);
     }
 
     return wayDataFile;
@@ -424,7 +448,7 @@ namespace osmscout {
 
       timer.Stop();
 
-      log.Debug() << "Opening AreaNodeIndex: " << timer.ResultString();
+      RecordOpenTime("AreaNodeIndex",timer);
     }
 
     return areaNodeIndex;
@@ -452,7 +476,7 @@ namespace osmscout {
 
       timer.Stop();
 
-      log.Debug() << "Opening AreaAreaIndex: " << timer.ResultString();
+      RecordOpenTime("AreaAreaIndex",timer);
     }
 
     return areaAreaIndex;
@@ -482,7 +506,7 @@ namespace osmscout {
 
       timer.Stop();
 
-      log.Debug() << "Opening AreaWayIndex: " << timer.ResultString();
+      RecordOpenTime("AreaWayIndex",timer);
     }
 
     return areaWayIndex;
@@ -510,7 +534,7 @@ namespace osmscout {
 
       timer.Stop();
 
-      log.Debug() << "Opening LocationIndex: " << timer.ResultString();
+      RecordOpenTime("LocationIndex",timer);
     }
 
     return locationIndex;
@@ -538,7 +562,7 @@ namespace osmscout {
 
       timer.Stop();
 
-      log.Debug() << "Opening WaterIndex: " << timer.ResultString();
+      RecordOpenTime("WaterIndex",timer);
     }
 
     return waterIndex;
@@ -569,7 +593,7 @@ namespace osmscout {
 
       timer.Stop();
 
-      log.Debug() << "Opening OptimizeAreasLowZoom: " << timer.ResultString();
+      RecordOpenTime("OptimizeAreasLowZoom",timer);
     }
 
     return optimizeAreasLowZoom;
@@ -595,7 +619,7 @@ namespace osmscout {
 
       timer.Stop();
 
-      log.Debug() << "Opening OptimizeWaysLowZoom: " << timer.ResultString();
+      RecordOpenTime("OptimizeWaysLowZoom",timer);
     }
 
     return optimizeWaysLowZoom;
@@ -637,7 +661,8 @@ namespace osmscout {
   }
 
   bool Database::GetNodesByOffset(const std::vector<FileOffset>& offsets,
-                                  std::vector<NodeRef>& nodes) const
+                                  std::vector<NodeRef>& nodes,
+                                  const QueryArenaRef& arena) const
   {
     NodeDataFileRef nodeDataFile=GetNodeDataFile();
 
@@ -647,7 +672,7 @@ namespace osmscout {
 
     StopClock time;
 
-    bool result=nodeDataFile->GetByOffset(offsets.begin(),offsets.end(),offsets.size(),nodes);
+    bool result=nodeDataFile->GetByOffset(offsets.begin(),offsets.end(),offsets.size(),nodes,arena);
 
     time.Stop();
 
@@ -660,7 +685,8 @@ namespace osmscout {
 
   bool Database::GetNodesByOffset(const std::vector<FileOffset>& offsets,
                                   const GeoBox& boundingBox,
-                                  std::vector<NodeRef>& nodes) const
+                                  std::vector<NodeRef>& nodes,
+                                  const QueryArenaRef& arena) const
   {
     NodeDataFileRef nodeDataFile=GetNodeDataFile();
 
@@ -674,7 +700,8 @@ namespace osmscout {
                                           offsets.end(),
                                           offsets.size(),
                                           boundingBox,
-                                          nodes);
+                                          nodes,
+                                          arena);
 
     time.Stop();
 
@@ -777,7 +804,8 @@ namespace osmscout {
   }
 
   bool Database::GetAreasByOffset(const std::vector<FileOffset>& offsets,
-                                  std::vector<AreaRef>& areas) const
+                                  std::vector<AreaRef>& areas,
+                                  const QueryArenaRef& arena) const
   {
     AreaDataFileRef areaDataFile=GetAreaDataFile();
 
@@ -787,7 +815,7 @@ namespace osmscout {
 
     StopClock time;
 
-    bool result=areaDataFile->GetByOffset(offsets.begin(),offsets.end(),offsets.size(),areas);
+    bool result=areaDataFile->GetByOffset(offsets.begin(),offsets.end(),offsets.size(),areas,arena);
 
     if (time.GetMilliseconds()>100) {
       log.Warn() << "Retrieving " << areas.size() << " areas by offset took " << time.ResultString();
@@ -872,7 +900,8 @@ namespace osmscout {
   }
 
   bool Database::GetAreasByBlockSpans(const std::vector<DataBlockSpan>& spans,
-                                      std::vector<AreaRef>& areas) const
+                                      std::vector<AreaRef>& areas,
+                                      const QueryArenaRef& arena) const
   {
     AreaDataFileRef areaDataFile=GetAreaDataFile();
 
@@ -882,7 +911,31 @@ namespace osmscout {
 
     return areaDataFile->GetByBlockSpans(spans.begin(),
                                          spans.end(),
-                                         areas);
+                                         areas,
+                                         arena);
+  }
+
+  /**
+   * Load the areas of the given spans, that intersect the given bounding box.
+   * Areas not in the cache are only completely deserialized, if their
+   * bounding box intersects.
+   */
+  bool Database::GetAreasByBlockSpans(const std::vector<DataBlockSpan>& spans,
+                                      const GeoBox& boundingBox,
+                                      std::vector<AreaRef>& areas,
+                                      const QueryArenaRef& arena) const
+  {
+    AreaDataFileRef areaDataFile=GetAreaDataFile();
+
+    if (!areaDataFile) {
+      return false;
+    }
+
+    return areaDataFile->GetIntersectingByBlockSpans<AreaView>(spans.begin(),
+                                                               spans.end(),
+                                                               boundingBox,
+                                                               areas,
+                                                               arena);
   }
 
   bool Database::GetWayByOffset(const FileOffset& offset,
@@ -906,7 +959,8 @@ namespace osmscout {
   }
 
   bool Database::GetWaysByOffset(const std::vector<FileOffset>& offsets,
-                                 std::vector<WayRef>& ways) const
+                                 std::vector<WayRef>& ways,
+                                 const QueryArenaRef& arena) const
   {
     WayDataFileRef wayDataFile=GetWayDataFile();
 
@@ -916,7 +970,39 @@ namespace osmscout {
 
     StopClock time;
 
-    bool result=wayDataFile->GetByOffset(offsets.begin(),offsets.end(),offsets.size(),ways);
+    bool result=wayDataFile->GetByOffset(offsets.begin(),offsets.end(),offsets.size(),ways,arena);
+
+    if (time.GetMilliseconds()>100) {
+      log.Warn() << "Retrieving " << ways.size() << " ways by offset took " << time.ResultString();
+    }
+
+    return result;
+  }
+
+  /**
+   * Load the ways at the given offsets, that intersect the given bounding box.
+   * Ways not in the cache are only completely deserialized, if their
+   * bounding box intersects.
+   */
+  bool Database::GetWaysByOffset(const std::vector<FileOffset>& offsets,
+                                 const GeoBox& boundingBox,
+                                 std::vector<WayRef>& ways,
+                                 const QueryArenaRef& arena) const
+  {
+    WayDataFileRef wayDataFile=GetWayDataFile();
+
+    if (!wayDataFile) {
+      return false;
+    }
+
+    StopClock time;
+
+    bool result=wayDataFile->GetIntersectingByOffset<WayView>(offsets.begin(),
+                                                              offsets.end(),
+                                                              offsets.size(),
+                                                              boundingBox,
+                                                              ways,
+                                                              arena);
 
     if (time.GetMilliseconds()>100) {
       log.Warn() << "Retrieving " << ways.size() << " ways by offset took " << time.ResultString();
@@ -1003,6 +1089,36 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Return the time spent on opening the individual files and indexes of
+   * the database so far. Since files are opened lazily on first use, the
+   * list grows while the database is used.
+   *
+   * Method is thread-safe.
+   */
+  std::vector<DatabaseOpenTime> Database::GetOpenTimes() const
+  {
+    std::lock_guard<std::mutex> guard(openTimesMutex);
+
+    return openTimes;
+  }
+
+  /**
+   * Dump the time spent on opening the individual files and indexes of the
+   * database so far to the log.
+   */
+  void Database::DumpOpenTimes() const
+  {
+    double total=0.0;
+
+    for (const auto& openTime : GetOpenTimes()) {
+      log.Info() << "Opening " << openTime.name << ": " << openTime.duration << " ms";
+      total+=openTime.duration;
+    }
+
+    log.Info() << "Opening total: " << total << " ms";
+  }
+
   NodeRegionSearchResult Database::LoadNodesInRadius(const GeoCoord& location,
                                                      const TypeInfoSet& types,
                                                      Distance maxDistance)
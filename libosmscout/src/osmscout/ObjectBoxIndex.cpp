@@ -0,0 +1,205 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/ObjectBoxIndex.h>
+
+#include <osmscout/util/Logger.h>
+
+namespace osmscout {
+
+  const char* ObjectBoxIndex::FILE_EXTENSION=".box";
+
+  static inline uint32_t DecodeUInt32(const unsigned char* data)
+  {
+    return  (uint32_t)data[0]
+          | ((uint32_t)data[1] <<  8)
+          | ((uint32_t)data[2] << 16)
+          | ((uint32_t)data[3] << 24);
+  }
+
+  static inline uint64_t DecodeUInt64(const unsigned char* data)
+  {
+    return (uint64_t)DecodeUInt32(data)
+           | ((uint64_t)DecodeUInt32(data+4) << 32);
+  }
+
+  ObjectBoxIndex::ObjectBoxIndex()
+  : entryCount(0),
+    offsets(nullptr),
+    boxes(nullptr)
+  {
+    // no code
+  }
+
+  /**
+   * Open the index file with the given name
+   */
+  bool ObjectBoxIndex::Open(const std::string& filename)
+  {
+    try {
+      file.OpenReadOnly(filename);
+
+      if (file.GetSize()<4) {
+        throw IOException(filename,"Cannot open index","File is too small");
+      }
+
+      const unsigned char* data=reinterpret_cast<const unsigned char*>(file.GetData());
+
+      entryCount=DecodeUInt32(data);
+
+      if (file.GetSize()!=4+(size_t)entryCount*(OFFSET_SIZE+BOX_SIZE)) {
+        throw IOException(filename,"Cannot open index","File size does not match number of entries");
+      }
+
+      offsets=data+4;
+      boxes=offsets+(size_t)entryCount*OFFSET_SIZE;
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      file.CloseFailsafe();
+      entryCount=0;
+      offsets=nullptr;
+      boxes=nullptr;
+
+      return false;
+    }
+
+    return true;
+  }
+
+  bool ObjectBoxIndex::Close()
+  {
+    entryCount=0;
+    offsets=nullptr;
+    boxes=nullptr;
+
+    try {
+      if (file.IsOpen()) {
+        file.Close();
+      }
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      file.CloseFailsafe();
+
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Return the file offset of the object with the given index. Entries are
+   * in the order of the data file.
+   */
+  FileOffset ObjectBoxIndex::GetOffset(size_t index) const
+  {
+    return DecodeUInt64(offsets+index*OFFSET_SIZE);
+  }
+
+  /**
+   * Return the bounding box of the object with the given index
+   */
+  GeoBox ObjectBoxIndex::GetBox(size_t index) const
+  {
+    const unsigned char* box=boxes+index*BOX_SIZE;
+    uint32_t             minLat=DecodeUInt32(box);
+    uint32_t             minLon=DecodeUInt32(box+4);
+    uint32_t             maxLat=DecodeUInt32(box+8);
+    uint32_t             maxLon=DecodeUInt32(box+12);
+
+    if (minLat>maxLat ||
+        minLon>maxLon) {
+      return GeoBox();
+    }
+
+    return GeoBox(GeoCoord(minLat/latConversionFactor-90.0,
+                           minLon/lonConversionFactor-180.0),
+                  GeoCoord(maxLat/latConversionFactor-90.0,
+                           maxLon/lonConversionFactor-180.0));
+  }
+
+  /**
+   * Return the index of the entry for the object at the given file offset.
+   * Returns false, if the index does not hold an entry for the offset.
+   *
+   * Method is thread-safe.
+   */
+  bool ObjectBoxIndex::GetEntryIndex(FileOffset offset,
+                                     size_t& index) const
+  {
+    size_t left=0;
+    size_t right=entryCount;
+
+    while (left<right) {
+      size_t     middle=left+(right-left)/2;
+      FileOffset middleOffset=GetOffset(middle);
+
+      if (middleOffset<offset) {
+        left=middle+1;
+      }
+      else if (middleOffset>offset) {
+        right=middle;
+      }
+      else {
+        index=middle;
+
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /**
+   * Return the bounding box of the object at the given file offset. Returns
+   * false, if the index does not hold an entry for the offset.
+   *
+   * Method is thread-safe.
+   */
+  bool ObjectBoxIndex::GetBoundingBox(FileOffset offset,
+                                      GeoBox& boundingBox) const
+  {
+    size_t index;
+
+    if (!GetEntryIndex(offset,
+                       index)) {
+      return false;
+    }
+
+    boundingBox=GetBox(index);
+
+    return true;
+  }
+
+  /**
+   * Return the name of the index file for the given data file
+   */
+  std::string ObjectBoxIndex::GetIndexFilename(const std::string& dataFilename)
+  {
+    std::string::size_type extension=dataFilename.rfind(".dat");
+
+    if (extension!=std::string::npos &&
+        extension+4==dataFilename.length()) {
+      return dataFilename.substr(0,extension)+FILE_EXTENSION;
+    }
+
+    return dataFilename+FILE_EXTENSION;
+  }
+}
@@ -0,0 +1,199 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/ObjectView.h>
+
+#include <utility>
+
+namespace osmscout {
+
+  /**
+   * Read the view of the way at the current position of the FileScanner.
+   * After the call the scanner is positioned after the way.
+   *
+   * @throws IOException
+   */
+  void WayView::Read(const TypeConfig& typeConfig,
+                     FileScanner& scanner)
+  {
+    TypeId typeId;
+
+    fileOffset=scanner.GetPos();
+
+    scanner.ReadTypeId(typeId,
+                       typeConfig.GetWayTypeIdBytes());
+
+    TypeInfoRef type=typeConfig.GetWayTypeInfo(typeId);
+
+    featureValueBuffer.SetType(type);
+
+    featureValueBuffer.Read(scanner);
+
+    geometryOffset=scanner.GetPos();
+    readIds=type->CanRoute() ||
+            type->GetOptimizeLowZoom();
+
+    scanner.ReadBoundingBox(boundingBox,
+                            readIds);
+
+    nextFileOffset=scanner.GetPos();
+  }
+
+  /**
+   * Read the nodes of the way (including node ids, if stored for its type)
+   *
+   * @throws IOException
+   */
+  void WayView::ReadNodes(FileScanner& scanner,
+                          std::vector<Point>& nodes) const
+  {
+    std::vector<SegmentGeoBox> segments;
+    GeoBox                     bbox;
+
+    scanner.SetPos(geometryOffset);
+
+    scanner.Read(nodes,
+                 segments,
+                 bbox,
+                 readIds);
+  }
+
+  /**
+   * Read the complete way. The features of the view are moved into the
+   * way, only its nodes are read. Afterwards the view has no type
+   * and features anymore.
+   *
+   * @throws IOException
+   */
+  void WayView::Materialize(const TypeConfig& /*typeConfig*/,
+                            FileScanner& scanner,
+                            Way& way)
+  {
+    way.fileOffset=fileOffset;
+    way.featureValueBuffer=std::move(featureValueBuffer);
+
+    scanner.SetPos(geometryOffset);
+
+    way.ReadGeometry(scanner);
+  }
+
+  /**
+   * Read the view of the area at the current position of the FileScanner.
+   * After the call the scanner is positioned after the area.
+   *
+   * Features of inner rings are decoded (to skip them), but not stored.
+   *
+   * @throws IOException
+   */
+  void AreaView::Read(const TypeConfig& typeConfig,
+                      FileScanner& scanner)
+  {
+    TypeId   ringType;
+    bool     multipleRings;
+    uint32_t rings=1;
+
+    fileOffset=scanner.GetPos();
+
+    scanner.ReadTypeId(ringType,
+                       typeConfig.GetAreaTypeIdBytes());
+
+    TypeInfoRef type=typeConfig.GetAreaTypeInfo(ringType);
+
+    featureValueBuffer.SetType(type);
+
+    featureValueBuffer.Read(scanner,
+                            multipleRings,
+                            hasMaster);
+
+    if (multipleRings) {
+      scanner.ReadNumber(rings);
+
+      rings++;
+    }
+
+    ringCount=rings;
+    geometryOffset=scanner.GetPos();
+
+    GeoBox ringBoundingBox;
+
+    scanner.ReadBoundingBox(ringBoundingBox,
+                            type->CanRoute());
+
+    if (hasMaster) {
+      boundingBox.Invalidate();
+    }
+    else {
+      boundingBox=ringBoundingBox;
+    }
+
+    for (size_t i=1; i<ringCount; i++) {
+      FeatureValueBuffer ringFeatureValueBuffer;
+      uint8_t            ring;
+
+      scanner.ReadTypeId(ringType,
+                         typeConfig.GetAreaTypeIdBytes());
+
+      type=typeConfig.GetAreaTypeInfo(ringType);
+
+      if (type->GetAreaId()!=typeIgnore) {
+        ringFeatureValueBuffer.SetType(type);
+        ringFeatureValueBuffer.Read(scanner);
+      }
+
+      scanner.Read(ring);
+      scanner.ReadBoundingBox(ringBoundingBox,
+                              type->GetAreaId()!=typeIgnore &&
+                              type->CanRoute());
+
+      if (ring==Area::outerRingId &&
+          ringBoundingBox.IsValid()) {
+        if (boundingBox.IsValid()) {
+          boundingBox.Include(ringBoundingBox);
+        }
+        else {
+          boundingBox=ringBoundingBox;
+        }
+      }
+    }
+
+    nextFileOffset=scanner.GetPos();
+  }
+
+  /**
+   * Read the complete area. The features of the view are moved into the
+   * first ring, only the nodes and the other rings are read. Afterwards
+   * the view has no type and features anymore.
+   *
+   * @throws IOException
+   */
+  void AreaView::Materialize(const TypeConfig& typeConfig,
+                             FileScanner& scanner,
+                             Area& area)
+  {
+    area.fileOffset=fileOffset;
+
+    scanner.SetPos(geometryOffset);
+
+    area.ReadRings(typeConfig,
+                   scanner,
+                   std::move(featureValueBuffer),
+                   (uint32_t)ringCount,
+                   hasMaster);
+  }
+}
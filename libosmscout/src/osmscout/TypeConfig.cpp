@@ -280,6 +280,8 @@ namespace osmscout {
     }
   }
 
+  const size_t FeatureValueBuffer::INLINE_FEATURE_MASK_BYTES;
+
   FeatureValueBuffer::FeatureValueBuffer()
     : featureBits(nullptr),
       featureValueBuffer(nullptr)
@@ -294,6 +296,17 @@ namespace osmscout {
     Set(other);
   }
 
+  /**
+   * Takes over the type and the feature values of the other buffer without
+   * copying the values. The other buffer is left without type.
+   */
+  FeatureValueBuffer::FeatureValueBuffer(FeatureValueBuffer&& other) noexcept
+    : featureBits(nullptr),
+      featureValueBuffer(nullptr)
+  {
+    TakeData(other);
+  }
+
   FeatureValueBuffer::~FeatureValueBuffer()
   {
     if (type) {
@@ -354,17 +367,47 @@ namespace osmscout {
     }
 
     if (featureBits!=nullptr) {
-      delete [] featureBits;
+      if (featureBits!=inlineFeatureBits) {
+        delete [] featureBits;
+      }
+
       featureBits=nullptr;
     }
 
     type=nullptr;
   }
 
+  void FeatureValueBuffer::TakeData(FeatureValueBuffer& other)
+  {
+    type=std::move(other.type);
+
+    if (other.featureBits==other.inlineFeatureBits) {
+      std::copy(other.inlineFeatureBits,
+                other.inlineFeatureBits+INLINE_FEATURE_MASK_BYTES,
+                inlineFeatureBits);
+      featureBits=inlineFeatureBits;
+    }
+    else {
+      featureBits=other.featureBits;
+    }
+
+    featureValueBuffer=other.featureValueBuffer;
+
+    other.type=nullptr;
+    other.featureBits=nullptr;
+    other.featureValueBuffer=nullptr;
+  }
+
   void FeatureValueBuffer::AllocateBits()
   {
     if (type && type->HasFeatures()) {
-      featureBits=new uint8_t[type->GetFeatureMaskBytes()]();
+      if (type->GetFeatureMaskBytes()<=INLINE_FEATURE_MASK_BYTES) {
+        featureBits=inlineFeatureBits;
+        std::fill(featureBits,featureBits+type->GetFeatureMaskBytes(),0);
+      }
+      else {
+        featureBits=new uint8_t[type->GetFeatureMaskBytes()]();
+      }
     }
     else
     {
@@ -435,8 +478,9 @@ namespace osmscout {
    */
   void FeatureValueBuffer::Read(FileScanner& scanner)
   {
-    for (size_t i=0; i<type->GetFeatureMaskBytes(); i++) {
-      scanner.Read(featureBits[i]);
+    if (featureBits!=nullptr) {
+      scanner.Read(reinterpret_cast<char*>(featureBits),
+                   type->GetFeatureMaskBytes());
     }
     for (const auto &feature : type->GetFeatures()) {
       size_t idx=feature.GetIndex();
@@ -459,8 +503,9 @@ namespace osmscout {
   void FeatureValueBuffer::Read(FileScanner& scanner,
                                 bool& specialFlag)
   {
-    for (size_t i=0; i<type->GetFeatureMaskBytes(); i++) {
-      scanner.Read(featureBits[i]);
+    if (featureBits!=nullptr) {
+      scanner.Read(reinterpret_cast<char*>(featureBits),
+                   type->GetFeatureMaskBytes());
     }
 
     if (BitsToBytes(type->GetFeatureCount())==BitsToBytes(type->GetFeatureCount()+1)) {
@@ -496,8 +541,9 @@ namespace osmscout {
                                 bool& specialFlag1,
                                 bool& specialFlag2)
   {
-    for (size_t i=0; i<type->GetFeatureMaskBytes(); i++) {
-      scanner.Read(featureBits[i]);
+    if (featureBits!=nullptr) {
+      scanner.Read(reinterpret_cast<char*>(featureBits),
+                   type->GetFeatureMaskBytes());
     }
 
     if (BitsToBytes(type->GetFeatureCount())==BitsToBytes(type->GetFeatureCount()+2)) {
@@ -654,7 +700,22 @@ namespace osmscout {
 
   FeatureValueBuffer& FeatureValueBuffer::operator=(const FeatureValueBuffer& other)
   {
-    Set(other);
+    if (this!=&other) {
+      Set(other);
+    }
+
+    return *this;
+  }
+
+  FeatureValueBuffer& FeatureValueBuffer::operator=(FeatureValueBuffer&& other) noexcept
+  {
+    if (this!=&other) {
+      if (type) {
+        DeleteData();
+      }
+
+      TakeData(other);
+    }
 
     return *this;
   }
@@ -87,6 +87,19 @@ namespace osmscout {
 
     featureValueBuffer.Read(scanner);
 
+    ReadGeometry(scanner);
+  }
+
+  /**
+   * Read the nodes of the way, that follow the features. The type of the
+   * way must already be set.
+   *
+   * @throws IOException
+   */
+  void Way::ReadGeometry(FileScanner& scanner)
+  {
+    TypeInfoRef type=featureValueBuffer.GetType();
+
     scanner.Read(nodes,
                  segments,
                  bbox,
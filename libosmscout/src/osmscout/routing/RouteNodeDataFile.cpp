@@ -19,6 +19,8 @@
 
 #include <osmscout/routing/RouteNodeDataFile.h>
 
+#include <algorithm>
+
 namespace osmscout {
 
   RouteNodeRef RouteNodeDataFile::IndexPage::find(FileScanner& scanner,
@@ -87,16 +89,28 @@ namespace osmscout {
       scanner.SetPos(indexFileOffset);
       scanner.Read(indexEntryCount);
 
+      index.clear();
+      index.reserve(indexEntryCount);
+
       for (size_t i=1; i<=indexEntryCount; i++) {
-        Pixel      cell;
         IndexEntry entry;
 
-        scanner.Read(cell.x);
-        scanner.Read(cell.y);
+        scanner.Read(entry.cell.x);
+        scanner.Read(entry.cell.y);
         scanner.ReadFileOffset(entry.fileOffset);
         scanner.Read(entry.count);
 
-        index[cell]=entry;
+        index.push_back(entry);
+      }
+
+      // The importer writes the index sorted by cell, older files may differ
+      auto cellLess=[](const IndexEntry& a,
+                       const IndexEntry& b) {
+        return a.cell<b.cell;
+      };
+
+      if (!std::is_sorted(index.begin(),index.end(),cellLess)) {
+        std::sort(index.begin(),index.end(),cellLess);
       }
     }
     catch (IOException& e) {
@@ -126,6 +140,7 @@ namespace osmscout {
   bool RouteNodeDataFile::Close()
   {
     typeConfig=nullptr;
+    index.clear();
 
     try  {
       if (scanner.IsOpen()) {
@@ -141,21 +156,39 @@ namespace osmscout {
     return true;
   }
 
+  const RouteNodeDataFile::IndexEntry* RouteNodeDataFile::FindIndexEntry(const Pixel& tile) const
+  {
+    auto entry=std::lower_bound(index.begin(),
+                                index.end(),
+                                tile,
+                                [](const IndexEntry& entry,
+                                   const Pixel& cell) {
+                                  return entry.cell<cell;
+                                });
+
+    if (entry!=index.end() &&
+        entry->cell==tile) {
+      return &(*entry);
+    }
+
+    return nullptr;
+  }
+
   bool RouteNodeDataFile::LoadIndexPage(const osmscout::Pixel& tile,
                                         ValueCache::CacheRef& cacheRef) const
   {
     assert(IsOpen());
 
-    auto entry=index.find(tile);
+    const IndexEntry* entry=FindIndexEntry(tile);
 
-    if (entry==index.end()) {
+    if (entry==nullptr) {
       return false;
     }
 
     ValueCache::CacheEntry cacheEntry(tile.GetId());
 
-    cacheEntry.value.fileOffset=entry->second.fileOffset;
-    cacheEntry.value.remaining=entry->second.count;
+    cacheEntry.value.fileOffset=entry->fileOffset;
+    cacheEntry.value.remaining=entry->count;
 
     cacheRef=cache.SetEntry(cacheEntry);
 
@@ -206,9 +239,7 @@ namespace osmscout {
 
   bool RouteNodeDataFile::IsCovered(const Pixel& tile) const
   {
-    auto entry=index.find(tile);
-
-    return entry!=index.end();
+    return FindIndexEntry(tile)!=nullptr;
   }
 
   bool RouteNodeDataFile::IsCovered(const GeoCoord& coord) const
@@ -21,10 +21,14 @@
 
 #include <osmscout/routing/RoutingService.h>
 
+#include <osmscout/util/File.h>
+#include <osmscout/util/StopClock.h>
+
 namespace osmscout {
 
   RoutingDatabase::RoutingDatabase()
     :
+    routerDataMMap(false),
     routeNodeDataFile(RoutingService::GetDataFilename(osmscout::RoutingService::DEFAULT_FILENAME_BASE),1000),
     junctionDataFile(RoutingService::FILENAME_INTERSECTIONS_DAT,
                      RoutingService::FILENAME_INTERSECTIONS_IDX,
@@ -39,10 +43,11 @@ namespace osmscout {
   {
     typeConfig=database->GetTypeConfig();
     path=database->GetPath();
+    routerDataMMap=database->GetParameter().GetRouterDataMMap();
 
-    if (!routeNodeDataFile.Open(database->GetTypeConfig(),
-                          database->GetPath(),
-                          database->GetParameter().GetRouterDataMMap())) {
+    // The route node data file itself is opened on first access
+    if (!ExistsInFilesystem(AppendFileToDir(path,
+                                            RoutingService::GetDataFilename(osmscout::RoutingService::DEFAULT_FILENAME_BASE)))) {
       log.Error() << "Cannot open route node data file'" << database->GetPath() << "'!";
       return false;
     }
@@ -54,13 +59,48 @@ namespace osmscout {
 
   void RoutingDatabase::Close()
   {
-    routeNodeDataFile.Close();
+    {
+      std::lock_guard<std::mutex> guard(routeNodeDataFileMutex);
+
+      if (routeNodeDataFile.IsOpen()) {
+        routeNodeDataFile.Close();
+      }
+    }
+
     junctionDataFile.Close();
 
     typeConfig.reset();
     path.clear();
   }
 
+  bool RoutingDatabase::OpenRouteNodeDataFile() const
+  {
+    std::lock_guard<std::mutex> guard(routeNodeDataFileMutex);
+
+    if (routeNodeDataFile.IsOpen()) {
+      return true;
+    }
+
+    if (!typeConfig) {
+      return false;
+    }
+
+    StopClock timer;
+
+    if (!routeNodeDataFile.Open(typeConfig,
+                                path,
+                                routerDataMMap)) {
+      log.Error() << "Cannot open route node data file'" << path << "'!";
+      return false;
+    }
+
+    timer.Stop();
+
+    log.Debug() << "Opening RouteNodeDataFile: " << timer.ResultString();
+
+    return true;
+  }
+
   bool RoutingDatabase::GetJunctions(const std::set<Id>& ids,
                                      std::vector<JunctionRef>& junctions)
   {
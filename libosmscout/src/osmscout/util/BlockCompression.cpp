@@ -0,0 +1,210 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/util/BlockCompression.h>
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <osmscout/private/Config.h>
+
+#include <osmscout/util/Exception.h>
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileWriter.h>
+
+#if defined(HAVE_LIB_ZLIB)
+  #include <zlib.h>
+#endif
+
+namespace osmscout {
+
+  const char BLOCK_COMPRESSION_MAGIC[8]={'\x89','O','S','C','B','L','K','\x01'};
+
+  static_assert(BLOCK_COMPRESSION_HEADER_SIZE==sizeof(BLOCK_COMPRESSION_MAGIC)+4+8+4,
+                "Block compression header size does not match layout");
+
+  /**
+   * Return true, if block compressed files can be written and read
+   */
+  bool IsBlockCompressionSupported()
+  {
+#if defined(HAVE_LIB_ZLIB)
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  /**
+   * Return true, if the given file is a block compressed container
+   *
+   * @throws IOException
+   */
+  bool IsBlockCompressedFile(const std::string& filename)
+  {
+    std::FILE *file=std::fopen(filename.c_str(),"rb");
+
+    if (file==nullptr) {
+      throw IOException(filename,"Cannot open file for reading");
+    }
+
+    char magic[sizeof(BLOCK_COMPRESSION_MAGIC)];
+    bool compressed=std::fread(magic,1,sizeof(magic),file)==sizeof(magic) &&
+                    std::memcmp(magic,BLOCK_COMPRESSION_MAGIC,sizeof(magic))==0;
+
+    std::fclose(file);
+
+    return compressed;
+  }
+
+  /**
+   * Convert the given file into a block compressed container, using blocks
+   * of the given uncompressed size and the given zlib compression level.
+   * Files that are already compressed are left untouched.
+   *
+   * @throws IOException
+   */
+  void CompressFile(const std::string& filename,
+                    uint32_t blockSize,
+                    int level)
+  {
+#if defined(HAVE_LIB_ZLIB)
+    if (blockSize==0) {
+      throw IOException(filename,"Cannot compress file","Block size must not be 0");
+    }
+
+    if (IsBlockCompressedFile(filename)) {
+      return;
+    }
+
+    std::string tmpFilename=filename+".tmp";
+    FileOffset  fileSize=GetFileSize(filename);
+    uint32_t    blockCount=(uint32_t)((fileSize+blockSize-1)/blockSize);
+    std::FILE   *file=std::fopen(filename.c_str(),"rb");
+
+    if (file==nullptr) {
+      throw IOException(filename,"Cannot open file for reading");
+    }
+
+    FileWriter              writer;
+    std::vector<char>       block(blockSize);
+    std::vector<Bytef>      compressed(compressBound(blockSize));
+    std::vector<FileOffset> blockOffsets;
+
+    blockOffsets.reserve(blockCount+1);
+
+    try {
+      writer.Open(tmpFilename);
+
+      writer.Write(BLOCK_COMPRESSION_MAGIC,sizeof(BLOCK_COMPRESSION_MAGIC));
+      writer.Write(blockSize);
+      writer.Write((uint64_t)fileSize);
+      writer.Write(blockCount);
+
+      FileOffset tableOffset=writer.GetPos();
+
+      for (uint32_t b=0; b<=blockCount; b++) {
+        writer.Write((uint64_t)0);
+      }
+
+      for (uint32_t b=0; b<blockCount; b++) {
+        size_t bytes=std::fread(block.data(),1,blockSize,file);
+
+        if (bytes==0 ||
+            (bytes<blockSize && b+1<blockCount)) {
+          throw IOException(filename,"Cannot read block "+std::to_string(b));
+        }
+
+        uLongf compressedSize=(uLongf)compressed.size();
+
+        if (compress2(compressed.data(),
+                      &compressedSize,
+                      reinterpret_cast<const Bytef*>(block.data()),
+                      (uLong)bytes,
+                      level)!=Z_OK) {
+          throw IOException(filename,"Cannot compress block "+std::to_string(b));
+        }
+
+        blockOffsets.push_back(writer.GetPos());
+        writer.Write(reinterpret_cast<const char*>(compressed.data()),
+                     compressedSize);
+      }
+
+      blockOffsets.push_back(writer.GetPos());
+
+      writer.SetPos(tableOffset);
+
+      for (const auto blockOffset : blockOffsets) {
+        writer.Write((uint64_t)blockOffset);
+      }
+
+      writer.Close();
+    }
+    catch (IOException& e) {
+      std::fclose(file);
+      writer.CloseFailsafe();
+      RemoveFile(tmpFilename);
+      throw;
+    }
+
+    std::fclose(file);
+
+    if (!RemoveFile(filename) ||
+        !RenameFile(tmpFilename,filename)) {
+      throw IOException(filename,"Cannot replace file by its compressed version");
+    }
+#else
+    (void)blockSize;
+    (void)level;
+    throw IOException(filename,"Cannot compress file","Block compression is not supported");
+#endif
+  }
+
+  /**
+   * Decompress one block of the given block compressed file. The
+   * decompressed block must have exactly the given size.
+   *
+   * @throws IOException
+   */
+  void DecompressBlock(const std::string& filename,
+                       const char* source,
+                       size_t sourceSize,
+                       char* destination,
+                       size_t destinationSize)
+  {
+#if defined(HAVE_LIB_ZLIB)
+    uLongf size=(uLongf)destinationSize;
+
+    if (uncompress(reinterpret_cast<Bytef*>(destination),
+                   &size,
+                   reinterpret_cast<const Bytef*>(source),
+                   (uLong)sourceSize)!=Z_OK ||
+        size!=destinationSize) {
+      throw IOException(filename,"Cannot decompress block");
+    }
+#else
+    (void)source;
+    (void)sourceSize;
+    (void)destination;
+    (void)destinationSize;
+    throw IOException(filename,"Cannot decompress block","Block compression is not supported");
+#endif
+  }
+}
@@ -25,6 +25,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
 #include <limits>
 
 #if defined(HAVE_MMAP)
@@ -47,6 +48,7 @@
 #include <osmscout/system/Assert.h>
 #include <osmscout/system/Compiler.h>
 
+#include <osmscout/util/BlockCompression.h>
 #include <osmscout/util/Exception.h>
 #include <osmscout/util/Logger.h>
 #include <osmscout/util/Number.h>
@@ -54,6 +56,10 @@
 
 namespace osmscout {
 
+  const size_t FileScanner::SEQUENTIAL_BUFFER_SIZE=1024*1024;
+  const size_t FileScanner::RANDOM_BUFFER_SIZE=8*1024;
+  const size_t FileScanner::BLOCK_CACHE_SIZE=8;
+
   FileScanner::FileScanner()
    : file(nullptr),
      hasError(true),
@@ -61,7 +67,16 @@ namespace osmscout {
      size(0),
      offset(0),
      byteBuffer(nullptr),
-     byteBufferSize(0)
+     byteBufferSize(0),
+     readBufferData(nullptr),
+     readBufferSize(0),
+     readBufferLimit(0),
+     readBufferOffset(0),
+     readBufferFill(0),
+     readBufferPos(0),
+     compressed(false),
+     compressedBlockSize(0),
+     blockAccessCounter(0)
 #if defined(_WIN32)
      ,mmfHandle((HANDLE)0)
 #endif
@@ -130,6 +145,24 @@ namespace osmscout {
       throw IOException(filename,"Cannot open file for reading");
     }
 
+    // We do our own buffering
+    setvbuf(file,nullptr,_IONBF,0);
+
+    if (readBufferSize>0) {
+      readBufferLimit=readBufferSize;
+    }
+    else if (mode==FastRandom || mode==LowMemRandom) {
+      readBufferLimit=RANDOM_BUFFER_SIZE;
+    }
+    else {
+      readBufferLimit=SEQUENTIAL_BUFFER_SIZE;
+    }
+
+    readBufferData=nullptr;
+    readBufferOffset=0;
+    readBufferFill=0;
+    readBufferPos=0;
+
 #if defined(HAVE_FSEEKO)
     off_t size;
 
@@ -189,6 +222,11 @@ namespace osmscout {
     }
 #endif
 
+    if (ReadCompressionHeader()) {
+      // Blocks are read on demand, mmap would only give us the compressed data
+      useMmap=false;
+    }
+
 #if defined(HAVE_POSIX_FADVISE)
     if (mode==FastRandom) {
       if (posix_fadvise(fileno(file),0,size,POSIX_FADV_WILLNEED)<0) {
@@ -285,6 +323,13 @@ namespace osmscout {
     }
 
     FreeBuffer();
+    readBuffer.clear();
+    readBuffer.shrink_to_fit();
+    readBufferData=nullptr;
+    compressed=false;
+    blockOffsets.clear();
+    compressedBlock.clear();
+    blockCache.clear();
 
     if (fclose(file)!=0) {
       file=nullptr;
@@ -308,6 +353,13 @@ namespace osmscout {
     }
 
     FreeBuffer();
+    readBuffer.clear();
+    readBuffer.shrink_to_fit();
+    readBufferData=nullptr;
+    compressed=false;
+    blockOffsets.clear();
+    compressedBlock.clear();
+    blockCache.clear();
 
     fclose(file);
 
@@ -330,7 +382,7 @@ namespace osmscout {
     }
 #endif
 
-    return feof(file)!=0;
+    return readBufferOffset+readBufferPos>=size;
   }
 
   std::string FileScanner::GetFilename() const
@@ -338,6 +390,261 @@ namespace osmscout {
     return filename;
   }
 
+  /**
+   * Set the size of the read buffer used, if the file is not memory mapped.
+   * A size of 0 selects a default depending on the mode passed to Open().
+   * Takes effect on the next call to Open().
+   */
+  void FileScanner::SetBufferSize(size_t bufferSize)
+  {
+    readBufferSize=bufferSize;
+  }
+
+  /**
+   * Slow path of ReadBuffered(), if the read buffer does not hold enough data:
+   * copies the rest of the buffer and then either refills it or reads
+   * directly into the destination, if the request is bigger than the buffer.
+   */
+  bool FileScanner::ReadUnbuffered(char* data, size_t bytes)
+  {
+    if (compressed) {
+      return ReadCompressed(data,bytes);
+    }
+
+    size_t available=readBufferFill-readBufferPos;
+
+    if (available>0) {
+      memcpy(data,readBufferData+readBufferPos,available);
+      data+=available;
+      bytes-=available;
+    }
+
+    readBufferOffset+=readBufferFill;
+    readBufferFill=0;
+    readBufferPos=0;
+
+    if (bytes>=readBufferLimit) {
+      size_t read=fread(data,1,bytes,file);
+
+      readBufferOffset+=read;
+
+      return read==bytes;
+    }
+
+    if (readBuffer.size()!=readBufferLimit) {
+      readBuffer.resize(readBufferLimit);
+    }
+
+    readBufferData=readBuffer.data();
+
+    readBufferFill=fread(readBuffer.data(),1,readBufferLimit,file);
+
+    if (readBufferFill<bytes) {
+      readBufferPos=readBufferFill;
+
+      return false;
+    }
+
+    memcpy(data,readBufferData,bytes);
+    readBufferPos=bytes;
+
+    return true;
+  }
+
+  /**
+   * Checks, if the file is block compressed (see \ref BlockCompression) and
+   * if so, reads the block table and sets the size of the file to the
+   * uncompressed size. Otherwise the file position is reset to the start of
+   * the file.
+   */
+  bool FileScanner::ReadCompressionHeader()
+  {
+    compressed=false;
+    blockOffsets.clear();
+    blockCache.clear();
+
+    if (size<BLOCK_COMPRESSION_HEADER_SIZE) {
+      return false;
+    }
+
+    char header[BLOCK_COMPRESSION_HEADER_SIZE];
+
+    if (fread(header,1,BLOCK_COMPRESSION_HEADER_SIZE,file)!=BLOCK_COMPRESSION_HEADER_SIZE) {
+      throw IOException(filename,"Cannot read file header");
+    }
+
+    if (memcmp(header,BLOCK_COMPRESSION_MAGIC,sizeof(BLOCK_COMPRESSION_MAGIC))!=0) {
+      if (fseek(file,0L,SEEK_SET)!=0) {
+        throw IOException(filename,"Cannot seek to start of file");
+      }
+
+      return false;
+    }
+
+    if (!IsBlockCompressionSupported()) {
+      throw IOException(filename,"Cannot open file for reading","Block compression is not supported");
+    }
+
+    const auto *data=reinterpret_cast<const unsigned char*>(header+sizeof(BLOCK_COMPRESSION_MAGIC));
+    uint64_t   uncompressedSize=0;
+    uint32_t   blockCount=0;
+
+    compressedBlockSize=0;
+
+    for (size_t i=0; i<4; i++) {
+      compressedBlockSize|=((uint32_t)data[i]) << (i*8);
+    }
+
+    for (size_t i=0; i<8; i++) {
+      uncompressedSize|=((uint64_t)data[4+i]) << (i*8);
+    }
+
+    for (size_t i=0; i<4; i++) {
+      blockCount|=((uint32_t)data[12+i]) << (i*8);
+    }
+
+    if (compressedBlockSize==0 ||
+        (uncompressedSize+compressedBlockSize-1)/compressedBlockSize!=blockCount) {
+      throw IOException(filename,"Cannot open file for reading","Inconsistent block compression header");
+    }
+
+    std::vector<unsigned char> table(((size_t)blockCount+1)*8);
+
+    if (fread(table.data(),1,table.size(),file)!=table.size()) {
+      throw IOException(filename,"Cannot read block table");
+    }
+
+    blockOffsets.resize((size_t)blockCount+1);
+
+    for (size_t b=0; b<blockOffsets.size(); b++) {
+      uint64_t blockOffset=0;
+
+      for (size_t i=0; i<8; i++) {
+        blockOffset|=((uint64_t)table[b*8+i]) << (i*8);
+      }
+
+      blockOffsets[b]=blockOffset;
+    }
+
+    compressed=true;
+    size=uncompressedSize;
+
+    return true;
+  }
+
+  /**
+   * Makes the block holding the given (uncompressed) file position the
+   * current read buffer. The block is taken from the cache or read and
+   * decompressed, replacing the least recently used cache entry.
+   */
+  void FileScanner::LoadBlock(FileOffset pos)
+  {
+    size_t index=(size_t)(pos/compressedBlockSize);
+
+    if (index+1>=blockOffsets.size()) {
+      throw IOException(filename,"Cannot read block","Position beyond file end");
+    }
+
+    blockAccessCounter++;
+
+    CachedBlock *block=nullptr;
+
+    for (auto& entry : blockCache) {
+      if (entry.index==index) {
+        block=&entry;
+        break;
+      }
+    }
+
+    if (block==nullptr) {
+      if (blockCache.size()<BLOCK_CACHE_SIZE) {
+        blockCache.emplace_back();
+        block=&blockCache.back();
+      }
+      else {
+        block=&*std::min_element(blockCache.begin(),
+                                 blockCache.end(),
+                                 [](const CachedBlock& a, const CachedBlock& b) {
+                                   return a.lastAccess<b.lastAccess;
+                                 });
+      }
+
+      FileOffset blockStart=(FileOffset)index*compressedBlockSize;
+      size_t     blockSize=(size_t)std::min((FileOffset)compressedBlockSize,
+                                            size-blockStart);
+      size_t     sourceSize=(size_t)(blockOffsets[index+1]-blockOffsets[index]);
+
+      block->index=std::numeric_limits<size_t>::max();
+      compressedBlock.resize(sourceSize);
+      block->data.resize(blockSize);
+
+      clearerr(file);
+
+#if defined(HAVE_FSEEKO)
+      bool seekError=fseeko(file,(off_t)blockOffsets[index],SEEK_SET)!=0;
+#elif defined(HAVE__FSEEKi64)
+      bool seekError=_fseeki64(file,(__int64)blockOffsets[index],SEEK_SET)!=0;
+#else
+      bool seekError=fseek(file,(long)blockOffsets[index],SEEK_SET)!=0;
+#endif
+
+      if (seekError ||
+          fread(compressedBlock.data(),1,sourceSize,file)!=sourceSize) {
+        throw IOException(filename,"Cannot read block "+std::to_string(index));
+      }
+
+      DecompressBlock(filename,
+                      compressedBlock.data(),
+                      sourceSize,
+                      block->data.data(),
+                      blockSize);
+
+      block->index=index;
+    }
+
+    block->lastAccess=blockAccessCounter;
+
+    readBufferData=block->data.data();
+    readBufferOffset=(FileOffset)index*compressedBlockSize;
+    readBufferFill=block->data.size();
+    readBufferPos=(size_t)(pos-readBufferOffset);
+  }
+
+  /**
+   * Slow path of ReadBuffered() for block compressed files: copies the
+   * requested data block by block.
+   */
+  bool FileScanner::ReadCompressed(char* data, size_t bytes)
+  {
+    try {
+      while (bytes>0) {
+        FileOffset pos=readBufferOffset+readBufferPos;
+
+        if (readBufferPos>=readBufferFill) {
+          if (pos>=size) {
+            return false;
+          }
+
+          LoadBlock(pos);
+        }
+
+        size_t available=std::min(readBufferFill-readBufferPos,bytes);
+
+        memcpy(data,readBufferData+readBufferPos,available);
+        readBufferPos+=available;
+        data+=available;
+        bytes-=available;
+      }
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+
+      return false;
+    }
+
+    return true;
+  }
+
   /**
    * Moves the reading cursor to the start of the file (offset 0)
    *
@@ -372,6 +679,22 @@ namespace osmscout {
     }
 #endif
 
+    if (pos>=readBufferOffset &&
+        pos<=readBufferOffset+readBufferFill) {
+      readBufferPos=(size_t)(pos-readBufferOffset);
+
+      return;
+    }
+
+    if (compressed) {
+      // The block is loaded on the next read
+      readBufferOffset=pos;
+      readBufferFill=0;
+      readBufferPos=0;
+
+      return;
+    }
+
     clearerr(file);
 
 #if defined(HAVE_FSEEKO)
@@ -385,6 +708,10 @@ namespace osmscout {
     if (hasError) {
       throw IOException(filename,"Cannot set position in file");
     }
+
+    readBufferOffset=pos;
+    readBufferFill=0;
+    readBufferPos=0;
   }
 
   /**
@@ -404,34 +731,7 @@ namespace osmscout {
     }
 #endif
 
-#if defined(HAVE_FSEEKO)
-    off_t filepos=ftello(file);
-
-    if (filepos==-1) {
-      hasError=true;
-      throw IOException(filename,"Cannot set position in file");
-    }
-
-    return (FileOffset)filepos;
-#elif defined(HAVE__FTELLI64)
-    __int64 filepos=_ftelli64(file);
-
-    if (filepos==-1) {
-      hasError=true;
-      throw IOException(filename,"Cannot set position in file");
-    }
-
-    return (FileOffset)filepos;
-#else
-    long filepos=ftell(file);
-
-    if (filepos==-1) {
-      hasError=true;
-      throw IOException(filename,"Cannot set position in file");
-    }
-
-    return (FileOffset)filepos;
-#endif
+    return readBufferOffset+readBufferPos;
   }
 
   char* FileScanner::ReadInternal(size_t bytes)
@@ -456,7 +756,7 @@ namespace osmscout {
 #endif
 
     AssureByteBufferSize(bytes);
-    hasError=fread(byteBuffer,1,bytes,file)!=bytes;
+    hasError=!ReadBuffered(byteBuffer,bytes);
 
     if (hasError) {
       throw IOException(filename,"Cannot read byte array");
@@ -485,7 +785,7 @@ namespace osmscout {
     }
 #endif
 
-    hasError=fread(buffer,1,bytes,file)!=bytes;
+    hasError=!ReadBuffered(buffer,bytes);
 
     if (hasError) {
       throw IOException(filename,"Cannot read byte array");
@@ -529,7 +829,7 @@ namespace osmscout {
 
     char character;
 
-    hasError=fread(&character,1,1,file)!=1;
+    hasError=!ReadBuffered(&character,1);
 
     if (hasError) {
       throw IOException(filename,"Cannot read string");
@@ -538,7 +838,7 @@ namespace osmscout {
     while (character!='\0') {
       value.append(1,character);
 
-      hasError=fread(&character,1,1,file)!=1;
+      hasError=!ReadBuffered(&character,1);
 
       if (hasError) {
         throw IOException(filename,"Cannot read string");
@@ -570,7 +870,7 @@ namespace osmscout {
     }
 #endif
 
-    hasError=fread(&value,1,1,file)!=1;
+    hasError=!ReadBuffered(&value,1);
 
     if (hasError) {
       throw IOException(filename,"Cannot read bool");
@@ -602,7 +902,7 @@ namespace osmscout {
     }
 #endif
 
-    hasError=fread(&number,1,1,file)!=1;
+    hasError=!ReadBuffered(&number,1);
 
     if (hasError) {
       throw IOException(filename,"Cannot read int8_t");
@@ -644,7 +944,7 @@ namespace osmscout {
 
     unsigned char buffer[2];
 
-    hasError=fread(&buffer,1,2,file)!=2;
+    hasError=!ReadBuffered(&buffer,2);
 
     if (hasError) {
       throw IOException(filename,"Cannot read int16_t");
@@ -708,7 +1008,7 @@ namespace osmscout {
 
     unsigned char buffer[4];
 
-    hasError=fread(&buffer,1,4,file)!=4;
+    hasError=!ReadBuffered(&buffer,4);
 
     if (hasError) {
       throw IOException(filename,"Cannot read int32_t");
@@ -802,7 +1102,7 @@ namespace osmscout {
 
     unsigned char buffer[8];
 
-    hasError=fread(&buffer,1,8,file)!=8;
+    hasError=!ReadBuffered(&buffer,8);
 
     if (hasError) {
       throw IOException(filename,"Cannot read int64_t");
@@ -874,7 +1174,7 @@ namespace osmscout {
     }
 #endif
 
-    hasError=fread(&number,1,1,file)!=1;
+    hasError=!ReadBuffered(&number,1);
 
     if (hasError) {
       throw IOException(filename,"Cannot read uint8_t");
@@ -916,7 +1216,7 @@ namespace osmscout {
 
     unsigned char buffer[2];
 
-    hasError=fread(&buffer,1,2,file)!=2;
+    hasError=!ReadBuffered(&buffer,2);
 
     if (hasError) {
       throw IOException(filename,"Cannot read uint16_t");
@@ -980,7 +1280,7 @@ namespace osmscout {
 
     unsigned char buffer[4];
 
-    hasError=fread(&buffer,1,4,file)!=4;
+    hasError=!ReadBuffered(&buffer,4);
 
     if (hasError) {
       throw IOException(filename,"Cannot read uint32_t");
@@ -1074,7 +1374,7 @@ namespace osmscout {
 
     unsigned char buffer[8];
 
-    hasError=fread(&buffer,1,8,file)!=8;
+    hasError=!ReadBuffered(&buffer,8);
 
     if (hasError) {
       throw IOException(filename,"Cannot read uint64_t");
@@ -1161,7 +1461,7 @@ namespace osmscout {
 
     unsigned char buffer[2];
 
-    hasError=fread(&buffer,1,bytes,file)!=bytes;
+    hasError=!ReadBuffered(&buffer,bytes);
 
     if (hasError) {
       throw IOException(filename,"Cannot read size limited uint16_t");
@@ -1234,7 +1534,7 @@ namespace osmscout {
 
     unsigned char buffer[4];
 
-    hasError=fread(&buffer,1,bytes,file)!=bytes;
+    hasError=!ReadBuffered(&buffer,bytes);
 
     if (hasError) {
       throw IOException(filename,"Cannot read size limited uint32_t");
@@ -1349,7 +1649,7 @@ namespace osmscout {
 
     unsigned char buffer[8];
 
-    hasError=fread(&buffer,1,bytes,file)!=bytes;
+    hasError=!ReadBuffered(&buffer,bytes);
 
     if (hasError) {
       throw IOException(filename,"Cannot read size limited uint64_t");
@@ -1488,7 +1788,7 @@ namespace osmscout {
 
     unsigned char buffer[8];
 
-    hasError=fread(&buffer,1,8,file)!=8;
+    hasError=!ReadBuffered(&buffer,8);
 
     if (hasError) {
       throw IOException(filename,"Cannot read file offset");
@@ -1619,7 +1919,7 @@ namespace osmscout {
 
     unsigned char buffer[8];
 
-    hasError=fread(&buffer,1,bytes,file)!=bytes;
+    hasError=!ReadBuffered(&buffer,bytes);
 
     if (hasError) {
       throw IOException(filename,"Cannot read file offset");
@@ -1707,7 +2007,7 @@ namespace osmscout {
 
     char buffer;
 
-    if (fread(&buffer,1,1,file)!=1) {
+    if (!ReadBuffered(&buffer,1)) {
       hasError=true;
       throw IOException(filename,"Cannot read int16_t number");
     }
@@ -1726,7 +2026,7 @@ namespace osmscout {
 
       while ((buffer & 0x80)!=0) {
 
-        if (fread(&buffer,1,1,file)!=1) {
+        if (!ReadBuffered(&buffer,1)) {
           hasError=true;
           throw IOException(filename,"Cannot read int16_t number");
         }
@@ -1747,7 +2047,7 @@ namespace osmscout {
 
       while ((buffer & 0x80)!=0) {
 
-        if (fread(&buffer,1,1,file)!=1) {
+        if (!ReadBuffered(&buffer,1)) {
           hasError=true;
           throw IOException(filename,"Cannot read int16_t number");
         }
@@ -1787,7 +2087,7 @@ namespace osmscout {
 
     char buffer;
 
-    if (fread(&buffer,1,1,file)!=1) {
+    if (!ReadBuffered(&buffer,1)) {
       hasError=true;
       throw IOException(filename,"Cannot read int32_t number");
     }
@@ -1807,7 +2107,7 @@ namespace osmscout {
 
       while ((buffer & 0x80)!=0) {
 
-        if (fread(&buffer,1,1,file)!=1) {
+        if (!ReadBuffered(&buffer,1)) {
           hasError=true;
           throw IOException(filename,"Cannot read int32_t number");
         }
@@ -1828,7 +2128,7 @@ namespace osmscout {
 
       while ((buffer & 0x80)!=0) {
 
-        if (fread(&buffer,1,1,file)!=1) {
+        if (!ReadBuffered(&buffer,1)) {
           hasError=true;
           throw IOException(filename,"Cannot read int32_t number");
         }
@@ -1868,7 +2168,7 @@ namespace osmscout {
 
     char buffer;
 
-    if (fread(&buffer,1,1,file)!=1) {
+    if (!ReadBuffered(&buffer,1)) {
       hasError=true;
       throw IOException(filename,"Cannot read int64_t number");
     }
@@ -1887,7 +2187,7 @@ namespace osmscout {
 
       while ((buffer & 0x80)!=0) {
 
-        if (fread(&buffer,1,1,file)!=1) {
+        if (!ReadBuffered(&buffer,1)) {
           hasError=true;
           throw IOException(filename,"Cannot read int64_t number");
         }
@@ -1908,7 +2208,7 @@ namespace osmscout {
 
       while ((buffer & 0x80)!=0) {
 
-        if (fread(&buffer,1,1,file)!=1) {
+        if (!ReadBuffered(&buffer,1)) {
           hasError=true;
           throw IOException(filename,"Cannot read int64_t number");
         }
@@ -1953,7 +2253,7 @@ namespace osmscout {
 
     char buffer;
 
-    if (fread(&buffer,1,1,file)!=1) {
+    if (!ReadBuffered(&buffer,1)) {
       hasError=true;
       throw IOException(filename,"Cannot read uint16_t number");
     }
@@ -1967,7 +2267,7 @@ namespace osmscout {
         return;
       }
 
-      if (fread(&buffer,1,1,file)!=1) {
+      if (!ReadBuffered(&buffer,1)) {
         hasError=true;
         throw IOException(filename,"Cannot read uint16_t number");
       }
@@ -2006,7 +2306,7 @@ namespace osmscout {
 
     char buffer;
 
-    if (fread(&buffer,1,1,file)!=1) {
+    if (!ReadBuffered(&buffer,1)) {
       hasError=true;
       throw IOException(filename,"Cannot read uint32_t number");
     }
@@ -2020,7 +2320,7 @@ namespace osmscout {
         return;
       }
 
-      if (fread(&buffer,1,1,file)!=1) {
+      if (!ReadBuffered(&buffer,1)) {
         hasError=true;
         throw IOException(filename,"Cannot read uint32_t number");
       }
@@ -2059,7 +2359,7 @@ namespace osmscout {
 
     char buffer;
 
-    if (fread(&buffer,1,1,file)!=1) {
+    if (!ReadBuffered(&buffer,1)) {
       hasError=true;
       throw IOException(filename,"Cannot read uint64_t number");
     }
@@ -2073,7 +2373,7 @@ namespace osmscout {
         return;
       }
 
-      if (fread(&buffer,1,1,file)!=1) {
+      if (!ReadBuffered(&buffer,1)) {
         hasError=true;
         throw IOException(filename,"Cannot read uint64_t number");
       }
@@ -2120,7 +2420,7 @@ namespace osmscout {
 
     unsigned char buffer[coordByteSize];
 
-    hasError=fread(&buffer,1,coordByteSize,file)!=coordByteSize;
+    hasError=!ReadBuffered(&buffer,coordByteSize);
 
     if (hasError) {
       throw IOException(filename,"Cannot read coordinate");
@@ -2186,7 +2486,7 @@ namespace osmscout {
 
     unsigned char buffer[coordByteSize];
 
-    hasError=fread(&buffer,1,coordByteSize,file)!=coordByteSize;
+    hasError=!ReadBuffered(&buffer,coordByteSize);
 
     if (hasError) {
       throw IOException(filename,"Cannot read coordinate");
@@ -2212,24 +2512,26 @@ namespace osmscout {
     }
   }
 
-  void FileScanner::Read(std::vector<Point>& nodes,
-                         std::vector<SegmentGeoBox> &segments,
-                         GeoBox &bbox,
-                         bool readIds)
+  /**
+   * Read the header of a vector of Point as written by FileWriter::Write().
+   * Returns false, if the vector is empty.
+   *
+   * @throws IOException
+   */
+  bool FileScanner::ReadPointsHeader(bool readIds,
+                                     bool& hasNodes,
+                                     size_t& nodeCount,
+                                     size_t& coordBitSize)
   {
-    size_t  coordBitSize;
     uint8_t sizeByte;
 
     Read(sizeByte);
 
     // Fast exit for empty arrays
     if (sizeByte==0) {
-      return;
+      return false;
     }
 
-    bool   hasNodes;
-    size_t nodeCount;
-
     if (readIds) {
       hasNodes=(sizeByte & 0x04)!=0;
 
@@ -2297,6 +2599,25 @@ namespace osmscout {
       }
     }
 
+    return true;
+  }
+
+  void FileScanner::Read(std::vector<Point>& nodes,
+                         std::vector<SegmentGeoBox> &segments,
+                         GeoBox &bbox,
+                         bool readIds)
+  {
+    bool   hasNodes;
+    size_t nodeCount;
+    size_t coordBitSize;
+
+    if (!ReadPointsHeader(readIds,
+                          hasNodes,
+                          nodeCount,
+                          coordBitSize)) {
+      return;
+    }
+
     nodes.resize(nodeCount);
 
     size_t byteBufferSize=(nodeCount-1)*coordBitSize/8;
@@ -2434,6 +2755,122 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Reads a vector of Point as written by FileWriter::Write(), but only
+   * calculates its bounding box without materializing the points.
+   * Node ids are skipped. The bounding box is invalid, if the vector is
+   * empty.
+   *
+   * @throws IOException
+   */
+  void FileScanner::ReadBoundingBox(GeoBox& bbox,
+                                    bool readIds)
+  {
+    bool   hasNodes;
+    size_t nodeCount;
+    size_t coordBitSize;
+
+    bbox.Invalidate();
+
+    if (!ReadPointsHeader(readIds,
+                          hasNodes,
+                          nodeCount,
+                          coordBitSize)) {
+      return;
+    }
+
+    size_t byteBufferSize=(nodeCount-1)*coordBitSize/8;
+
+    GeoCoord firstCoord;
+
+    ReadCoord(firstCoord);
+
+    uint32_t latValue=(uint32_t)round((firstCoord.GetLat()+90.0)*latConversionFactor);
+    uint32_t lonValue=(uint32_t)round((firstCoord.GetLon()+180.0)*lonConversionFactor);
+    uint32_t minLat=latValue;
+    uint32_t maxLat=latValue;
+    uint32_t minLon=lonValue;
+    uint32_t maxLon=lonValue;
+
+    uint8_t *tmpBuffer = (uint8_t*)ReadInternal(byteBufferSize);
+
+    if (coordBitSize==16) {
+      for (size_t i=0; i<byteBufferSize; i+=2) {
+        latValue+=(int32_t)(int8_t)tmpBuffer[i];
+        lonValue+=(int32_t)(int8_t)tmpBuffer[i+1];
+
+        minLat=std::min(minLat,latValue);
+        maxLat=std::max(maxLat,latValue);
+        minLon=std::min(minLon,lonValue);
+        maxLon=std::max(maxLon,lonValue);
+      }
+    }
+    else if (coordBitSize==32) {
+      for (size_t i=0; i<byteBufferSize; i+=4) {
+        latValue+=(int32_t)(int16_t)(tmpBuffer[i+0] | (tmpBuffer[i+1]<<8));
+        lonValue+=(int32_t)(int16_t)(tmpBuffer[i+2] | (tmpBuffer[i+3]<<8));
+
+        minLat=std::min(minLat,latValue);
+        maxLat=std::max(maxLat,latValue);
+        minLon=std::min(minLon,lonValue);
+        maxLon=std::max(maxLon,lonValue);
+      }
+    }
+    else {
+      for (size_t i=0; i<byteBufferSize; i+=6) {
+        uint32_t latUDelta=(tmpBuffer[i+0]) | (tmpBuffer[i+1]<<8) | (tmpBuffer[i+2]<<16);
+        uint32_t lonUDelta=(tmpBuffer[i+3]) | (tmpBuffer[i+4]<<8) | (tmpBuffer[i+5]<<16);
+
+        if (latUDelta & 0x800000) {
+          latUDelta|=0xff000000;
+        }
+
+        if (lonUDelta & 0x800000) {
+          lonUDelta|=0xff000000;
+        }
+
+        latValue+=(int32_t)latUDelta;
+        lonValue+=(int32_t)lonUDelta;
+
+        minLat=std::min(minLat,latValue);
+        maxLat=std::max(maxLat,latValue);
+        minLon=std::min(minLon,lonValue);
+        maxLon=std::max(maxLon,lonValue);
+      }
+    }
+
+    GeoCoord minCoord;
+    GeoCoord maxCoord;
+
+    SetCoord(minLat,minLon,minCoord);
+    SetCoord(maxLat,maxLon,maxCoord);
+
+    bbox.Set(minCoord,
+             maxCoord);
+
+    if (hasNodes) {
+      size_t idCurrent=0;
+
+      while (idCurrent<nodeCount) {
+        uint8_t bitset;
+        size_t  bitmask=1;
+
+        Read(bitset);
+
+        for (size_t i=0; i<8 && idCurrent<nodeCount; i++) {
+          if (bitset & bitmask) {
+            uint8_t serial;
+
+            Read(serial);
+          }
+
+          bitmask*=2;
+          idCurrent++;
+        }
+      }
+    }
+  }
+
   void FileScanner::ReadBox(GeoBox& box)
   {
     if (HasError()) {
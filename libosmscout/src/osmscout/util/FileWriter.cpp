@@ -38,10 +38,14 @@
 namespace osmscout {
 
   const uint64_t FileWriter::MAX_NODES=0x03FFFFFF; // 26 bits
+  const size_t   FileWriter::DEFAULT_BUFFER_SIZE=1024*1024;
 
   FileWriter::FileWriter()
    : file(nullptr),
-     hasError(true)
+     hasError(true),
+     bufferSize(DEFAULT_BUFFER_SIZE),
+     bufferFill(0),
+     position(0)
   {
     // no code
   }
@@ -73,6 +77,61 @@ namespace osmscout {
       throw IOException(filename,"Error opening file for writing");
     }
 
+    // We do our own buffering
+    setvbuf(file,nullptr,_IONBF,0);
+
+    writeBuffer.resize(bufferSize);
+    bufferFill=0;
+    position=0;
+
+    hasError=false;
+  }
+
+  /**
+   * Opens an existing file for writing, keeping its content. The writing
+   * cursor is placed at the end of the file, so that data written is appended.
+   *
+   * @throws IOException
+   */
+  void FileWriter::OpenForAppend(const std::string& filename)
+  {
+    if (file!=nullptr) {
+      throw IOException(filename,"Error opening file for writing","File already opened");
+    }
+
+    hasError=true;
+    this->filename=filename;
+
+    file=fopen(filename.c_str(),"r+b");
+
+    if (file==nullptr) {
+      throw IOException(filename,"Error opening file for writing");
+    }
+
+    // We do our own buffering
+    setvbuf(file,nullptr,_IONBF,0);
+
+#if defined(HAVE_FSEEKO)
+    bool   seekError=fseeko(file,0L,SEEK_END)!=0;
+    off_t  size=seekError ? -1 : ftello(file);
+#elif defined(HAVE__FSEEKI64) && defined(HAVE__FTELLI64)
+    bool    seekError=_fseeki64(file,0L,SEEK_END)!=0;
+    __int64 size=seekError ? -1 : _ftelli64(file);
+#else
+    bool    seekError=fseek(file,0L,SEEK_END)!=0;
+    long    size=seekError ? -1 : ftell(file);
+#endif
+
+    if (size==-1) {
+      fclose(file);
+      file=nullptr;
+      throw IOException(filename,"Cannot seek to end of file");
+    }
+
+    writeBuffer.resize(bufferSize);
+    bufferFill=0;
+    position=(FileOffset)size;
+
     hasError=false;
   }
 
@@ -86,6 +145,19 @@ namespace osmscout {
       throw IOException(filename,"Cannot close file","File already closed");
     }
 
+    try {
+      if (!hasError) {
+        FlushBuffer();
+      }
+    }
+    catch (IOException& /*e*/) {
+      CloseFailsafe();
+      throw;
+    }
+
+    writeBuffer.clear();
+    writeBuffer.shrink_to_fit();
+
     if (fclose(file)!=0) {
       file=nullptr;
       throw IOException(filename,"Cannot close file");
@@ -100,6 +172,15 @@ namespace osmscout {
       return;
     }
 
+    if (!hasError &&
+        bufferFill>0) {
+      hasError=fwrite(writeBuffer.data(),sizeof(char),bufferFill,file)!=bufferFill;
+    }
+
+    bufferFill=0;
+    writeBuffer.clear();
+    writeBuffer.shrink_to_fit();
+
     fclose(file);
 
     file=nullptr;
@@ -111,44 +192,80 @@ namespace osmscout {
   }
 
   /**
-   * Returns the current position of the writing cursor in relation to the begining of the file
+   * Set the size of the internal write buffer. A size of 0 hands
+   * every write directly to the FILE object.
    *
    * @throws IOException
    */
-  FileOffset FileWriter::GetPos()
+  void FileWriter::SetBufferSize(size_t bufferSize)
   {
-    if (HasError()) {
-      throw IOException(filename,"Cannot read position in file","File already in error state");
+    if (file!=nullptr) {
+      FlushBuffer();
+      writeBuffer.resize(bufferSize);
     }
 
-#if defined(HAVE_FSEEKO)
-    off_t filepos=ftello(file);
+    this->bufferSize=bufferSize;
+  }
 
-    if (filepos==-1) {
-      hasError=true;
-      throw IOException(filename,"Cannot read position in file");
+  /**
+   * Hand the content of the write buffer to the FILE object.
+   *
+   * @throws IOException
+   */
+  void FileWriter::FlushBuffer()
+  {
+    if (bufferFill==0) {
+      return;
     }
 
-    return (FileOffset)filepos;
-#elif defined(HAVE__FTELLI64)
-    __int64 filepos=_ftelli64(file);
+    hasError=fwrite(writeBuffer.data(),sizeof(char),bufferFill,file)!=bufferFill;
+    bufferFill=0;
 
-    if (filepos==-1) {
-      hasError=true;
-      throw IOException(filename,"Cannot read position in file");
+    if (hasError) {
+      throw IOException(filename,"Cannot write data");
     }
+  }
 
-    return (FileOffset)filepos;
-#else
-    long filepos=ftell(file);
+  /**
+   * Slow path of WriteBuffered(), if the data does not fit into the remaining
+   * buffer: flushes the buffer and either buffers the data or writes it
+   * directly, if it is bigger than the buffer itself.
+   *
+   * @throws IOException
+   */
+  void FileWriter::WriteUnbuffered(const char* data, size_t bytes)
+  {
+    FlushBuffer();
+
+    if (bytes<=writeBuffer.size()) {
+      memcpy(writeBuffer.data(),data,bytes);
+      bufferFill=bytes;
+      position+=bytes;
 
-    if (filepos==-1) {
-      hasError=true;
-      throw IOException(filename,"Cannot read position in file");
+      return;
     }
 
-    return (FileOffset)filepos;
-#endif
+    hasError=fwrite(data,sizeof(char),bytes,file)!=bytes;
+
+    if (hasError) {
+      throw IOException(filename,"Cannot write data");
+    }
+
+    position+=bytes;
+  }
+
+  /**
+   * Returns the current position of the writing cursor in relation to the begining of the file
+   *
+   * @throws IOException
+   */
+  FileOffset FileWriter::GetPos()
+  {
+    if (HasError()) {
+      throw IOException(filename,"Cannot read position in file","File already in error state");
+    }
+
+    return position;
   }
 
   /**
@@ -162,6 +279,12 @@ namespace osmscout {
       throw IOException(filename,"Cannot read position in file","File already in error state");
     }
 
+    if (pos==position) {
+      return;
+    }
+
+    FlushBuffer();
+
 #if defined(HAVE_FSEEKO)
     hasError=fseeko(file,(off_t)pos,SEEK_SET)!=0;
 #elif defined(HAVE__FTELLI64)
@@ -173,6 +296,8 @@ namespace osmscout {
     if (hasError) {
       throw IOException(filename,"Cannot set position in file");
     }
+
+    position=pos;
   }
 
   /**
@@ -195,11 +320,7 @@ namespace osmscout {
       throw IOException(filename,"Cannot write char*","File already in error state");
     }
 
-    hasError=fwrite(buffer,sizeof(char),bytes,file)!=bytes;
-
-    if (hasError) {
-      throw IOException(filename,"Cannot write char*");
-    }
+    WriteBuffered(buffer,bytes);
   }
 
   /**
@@ -214,11 +335,7 @@ namespace osmscout {
 
     size_t length=value.length()+1;
 
-    hasError=fwrite(value.c_str(),sizeof(char),length,file)!=length;
-
-    if (hasError) {
-      throw IOException(filename,"Cannot write std::string");
-    }
+    WriteBuffered(value.c_str(),length);
   }
 
   /**
@@ -233,11 +350,7 @@ namespace osmscout {
 
     char value=boolean ? (char)1 : (char)0;
 
-    hasError=fwrite((const char*)&value,sizeof(char),1,file)!=1;
-
-    if (hasError) {
-      throw IOException(filename,"Cannot write bool");
-    }
+    WriteBuffered((const char*)&value,1);
   }
 
   /**
@@ -250,11 +363,7 @@ namespace osmscout {
       throw IOException(filename,"Cannot write int8_t","File already in error state");
     }
 
-    hasError=fwrite(&number,sizeof(char),sizeof(int8_t),file)!=sizeof(int8_t);
-
-    if (hasError) {
-      throw IOException(filename,"Cannot write int8_t");
-    }
+    WriteBuffered(&number,sizeof(int8_t));
   }
 
   /**
@@ -272,11 +381,7 @@ namespace osmscout {
     buffer[0]=((number >> 0) & 0xff);
     buffer[1]=((number >> 8) & 0xff);
 
-    hasError=fwrite(buffer,1,2,file)!=2;
-
-    if (hasError) {
-      throw IOException(filename,"Cannot write int16_t");
-    }
+    WriteBuffered(buffer,2);
   }
 
   /**
@@ -296,11 +401,7 @@ namespace osmscout {
     buffer[2]=((number >> 16) & 0xff);
     buffer[3]=((number >> 24) & 0xff);
 
-    hasError=fwrite(buffer,1,4,file)!=4;
-
-    if (hasError) {
-      throw IOException(filename,"Cannot write int32_t");
-    }
+    WriteBuffered(buffer,4);
   }
 
   /**
@@ -324,11 +425,7 @@ namespace osmscout {
     buffer[6]=((number >> 48) & 0xff);
     buffer[7]=((number >> 56) & 0xff);
 
-    hasError=fwrite(buffer,1,8,file)!=8;
-
-    if (hasError) {
-      throw IOException(filename,"Cannot write int64_t");
-    }
+    WriteBuffered(buffer,8);
   }
 
   /**
@@ -341,11 +438,7 @@ namespace osmscout {
       throw IOException(filename,"Cannot write uint8_t","File already in error state");
     }
 
-    hasError=fwrite(&number,1,1,file)!=1;
-
-    if (hasError) {
-      throw IOException(filename,"Cannot write uint8_t");
-    }
+    WriteBuffered(&number,1);
   }
 
   /**
@@ -363,11 +456,7 @@ namespace osmscout {
     buffer[0]=((number >> 0) & 0xff);
     buffer[1]=((number >> 8) & 0xff);
 
-    hasError=fwrite(buffer,1,2,file)!=2;
-
-    if (hasError) {
-      throw IOException(filename,"Cannot write uint16_t");
-    }
+    WriteBuffered(buffer,2);
   }
 
   /**
@@ -387,11 +476,7 @@ namespace osmscout {
     buffer[2]=((number >> 16) & 0xff);
     buffer[3]=((number >> 24) & 0xff);
 
-    hasError=fwrite(buffer,1,4,file)!=4;
-
-    if (hasError) {
-      throw IOException(filename,"Cannot write uint32_t");
-    }
+    WriteBuffered(buffer,4);
   }
 
   /**
@@ -415,11 +500,7 @@ namespace osmscout {
     buffer[6]=((number >> 48) & 0xff);
     buffer[7]=((number >> 56) & 0xff);
 
-    hasError=fwrite(buffer,1,8,file)!=8;
-
-    if (hasError) {
-      throw IOException(filename,"Cannot write uint64_t");
-    }
+    WriteBuffered(buffer,8);
   }
 
   /**
@@ -437,11 +518,7 @@ namespace osmscout {
     buffer[0]=((number >> 0) & 0xff);
     buffer[1]=((number >> 8) & 0xff);
 
-    hasError=fwrite(buffer,1,bytes,file)!=bytes;
-
-    if (hasError) {
-      throw IOException(filename,"Cannot write size restricted uint16_t");
-    }
+    WriteBuffered(buffer,bytes);
   }
 
   /**
@@ -461,11 +538,7 @@ namespace osmscout {
     buffer[2]=((number >> 16) & 0xff);
     buffer[3]=((number >> 24) & 0xff);
 
-    hasError=fwrite(buffer,1,bytes,file)!=bytes;
-
-    if (hasError) {
-      throw IOException(filename,"Cannot write size restricted uint32_t");
-    }
+    WriteBuffered(buffer,bytes);
   }
 
   /**
@@ -489,11 +562,7 @@ namespace osmscout {
     buffer[6]=((number >> 48) & 0xff);
     buffer[7]=((number >> 56) & 0xff);
 
-    hasError=fwrite(buffer,1,bytes,file)!=bytes;
-
-    if (hasError) {
-      throw IOException(filename,"Cannot write size restricted uint64_t");
-    }
+    WriteBuffered(buffer,bytes);
   }
 
   /**
@@ -527,11 +596,7 @@ namespace osmscout {
     buffer[6]=((fileOffset >> 48) & 0xff);
     buffer[7]=((fileOffset >> 56) & 0xff);
 
-    hasError=fwrite(buffer,1,8,file)!=8;
-
-    if (hasError) {
-      throw IOException(filename,"Cannot write FileOffset");
-    }
+    WriteBuffered(buffer,8);
   }
 
   /**
@@ -558,11 +623,7 @@ namespace osmscout {
     buffer[6]=((fileOffset >> 48) & 0xff);
     buffer[7]=((fileOffset >> 56) & 0xff);
 
-    hasError=fwrite(buffer,1,bytes,file)!=bytes;
-
-    if (HasError()) {
-      throw IOException(filename,"Cannot write size limited FileOffset");
-    }
+    WriteBuffered(buffer,bytes);
   }
 
   /**
@@ -583,11 +644,7 @@ namespace osmscout {
 
     bytes=EncodeNumber(number,buffer);
 
-    hasError=fwrite(buffer,sizeof(unsigned char),bytes,file)!=bytes;
-
-    if (hasError) {
-      throw IOException(filename,"Cannot write int16_t number");
-    }
+    WriteBuffered(buffer,bytes);
   }
 
   /**
@@ -608,11 +665,7 @@ namespace osmscout {
 
     bytes=EncodeNumber(number,buffer);
 
-    hasError=fwrite(buffer,sizeof(unsigned char),bytes,file)!=bytes;
-
-    if (hasError) {
-      throw IOException(filename,"Cannot write int32_t number");
-    }
+    WriteBuffered(buffer,bytes);
   }
 
   /**
@@ -633,11 +686,7 @@ namespace osmscout {
 
     bytes=EncodeNumber(number,buffer);
 
-    hasError=fwrite(buffer,sizeof(unsigned char),bytes,file)!=bytes;
-
-    if (hasError) {
-      throw IOException(filename,"Cannot write int64_t number");
-    }
+    WriteBuffered(buffer,bytes);
   }
 
   /**
@@ -658,11 +707,7 @@ namespace osmscout {
 
     bytes=EncodeNumber(number,buffer);
 
-    hasError=fwrite(buffer,sizeof(unsigned char),bytes,file)!=bytes;
-
-    if (hasError) {
-      throw IOException(filename,"Cannot write uint16_t number");
-    }
+    WriteBuffered(buffer,bytes);
   }
 
   /**
@@ -683,11 +728,7 @@ namespace osmscout {
 
     bytes=EncodeNumber(number,buffer);
 
-    hasError=fwrite(buffer,sizeof(unsigned char),bytes,file)!=bytes;
-
-    if (hasError) {
-      throw IOException(filename,"Cannot write uint32_t number");
-    }
+    WriteBuffered(buffer,bytes);
   }
 
   /**
@@ -708,11 +749,7 @@ namespace osmscout {
 
     bytes=EncodeNumber(number,buffer);
 
-    hasError=fwrite(buffer,sizeof(unsigned char),bytes,file)!=bytes;
-
-    if (hasError) {
-      throw IOException(filename,"Cannot write uint64_t number");
-    }
+    WriteBuffered(buffer,bytes);
   }
 
   /**
@@ -746,11 +783,7 @@ namespace osmscout {
 
     buffer[6]=((latValue >> 24) & 0x07) | ((lonValue >> 20) & 0x70);
 
-    hasError=fwrite(buffer,1,coordByteSize,file)!=coordByteSize;
-
-    if (hasError) {
-      throw IOException(filename,"Cannot write coordinate");
-    }
+    WriteBuffered(buffer,coordByteSize);
   }
 
   /**
@@ -775,11 +808,7 @@ namespace osmscout {
 
     buffer[6]=0xff;
 
-    hasError=fwrite(buffer,1,coordByteSize,file)!=coordByteSize;
-
-    if (hasError) {
-      throw IOException(filename,"Cannot write coordinate");
-    }
+    WriteBuffered(buffer,coordByteSize);
   }
 
   void FileWriter::Write(const std::vector<GeoCoord>& nodes)
@@ -1294,6 +1323,8 @@ namespace osmscout {
       throw IOException(filename,"Cannot flush file","File already in error state");
     }
 
+    FlushBuffer();
+
     hasError=fflush(file)!=0;
 
     if (hasError) {
@@ -1326,13 +1357,15 @@ namespace osmscout {
 
     memset(buffer,0,bytesToWrite);
 
-    hasError=fwrite(buffer,sizeof(char),bytesToWrite,file)!=bytesToWrite;
+    try {
+      WriteBuffered(buffer,bytesToWrite);
+    }
+    catch (IOException& /*e*/) {
+      delete [] buffer;
+      throw;
+    }
 
     delete [] buffer;
-
-    if (hasError) {
-      throw IOException(filename,"Cannot write data to flush current block");
-    }
   }
 
   bool IsValidToWrite(const std::vector<Point>& nodes)
@@ -0,0 +1,314 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/private/Config.h>
+
+#include <osmscout/util/MemoryMappedFile.h>
+
+#include <errno.h>
+#include <string.h>
+
+#if defined(HAVE_MMAP)
+  #include <unistd.h>
+  #include <sys/mman.h>
+#endif
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/Logger.h>
+
+namespace osmscout {
+
+  MemoryMappedFile::MemoryMappedFile()
+  : file(nullptr),
+    data(nullptr),
+    size(0),
+    readOnly(false)
+  {
+    // no code
+  }
+
+  MemoryMappedFile::~MemoryMappedFile()
+  {
+    if (file!=nullptr) {
+      log.Warn() << "Automatically closing MemoryMappedFile for file '" << filename << "'!";
+      CloseFailsafe();
+    }
+  }
+
+  /**
+   * Map the current content of the file
+   *
+   * @throws IOException
+   */
+  void MemoryMappedFile::Map()
+  {
+    data=nullptr;
+
+    if (size==0) {
+      return;
+    }
+
+#if defined(HAVE_MMAP)
+    void* region=mmap(nullptr,size,readOnly ? PROT_READ : PROT_READ|PROT_WRITE,MAP_SHARED,fileno(file),0);
+
+    if (region==MAP_FAILED) {
+      throw IOException(filename,"Cannot mmap file",strerror(errno));
+    }
+
+    data=static_cast<char*>(region);
+#else
+    buffer.resize(size);
+
+    if (fseek(file,0,SEEK_SET)!=0 ||
+        fread(buffer.data(),1,size,file)!=size) {
+      throw IOException(filename,"Cannot read file");
+    }
+
+    data=buffer.data();
+#endif
+  }
+
+  /**
+   * Release the memory region, writing back changes
+   *
+   * @throws IOException
+   */
+  void MemoryMappedFile::Unmap()
+  {
+    if (data==nullptr) {
+      return;
+    }
+
+#if defined(HAVE_MMAP)
+    if (munmap(data,size)!=0) {
+      data=nullptr;
+      throw IOException(filename,"Cannot munmap file",strerror(errno));
+    }
+#else
+    if (!readOnly) {
+      Flush();
+    }
+
+    buffer.clear();
+    buffer.shrink_to_fit();
+#endif
+
+    data=nullptr;
+  }
+
+  /**
+   * Open the given file for reading and writing. If create is true, a non
+   * existing file is created (with size 0).
+   *
+   * @throws IOException
+   */
+  void MemoryMappedFile::Open(const std::string& filename,
+                              bool create)
+  {
+    if (file!=nullptr) {
+      throw IOException(filename,"Error opening file for mapping","File already opened");
+    }
+
+    this->filename=filename;
+    this->readOnly=false;
+
+    if (create &&
+        !ExistsInFilesystem(filename)) {
+      std::FILE* newFile=fopen(filename.c_str(),"wb");
+
+      if (newFile==nullptr ||
+          fclose(newFile)!=0) {
+        throw IOException(filename,"Cannot create file");
+      }
+    }
+
+    file=fopen(filename.c_str(),"r+b");
+
+    if (file==nullptr) {
+      throw IOException(filename,"Cannot open file for mapping");
+    }
+
+    try {
+      size=(size_t)GetFileSize(filename);
+      Map();
+    }
+    catch (IOException& e) {
+      CloseFailsafe();
+      throw e;
+    }
+  }
+
+  /**
+   * Open the given file for reading only. The memory region must not be
+   * changed.
+   *
+   * @throws IOException
+   */
+  void MemoryMappedFile::OpenReadOnly(const std::string& filename)
+  {
+    if (file!=nullptr) {
+      throw IOException(filename,"Error opening file for mapping","File already opened");
+    }
+
+    this->filename=filename;
+    this->readOnly=true;
+
+    file=fopen(filename.c_str(),"rb");
+
+    if (file==nullptr) {
+      throw IOException(filename,"Cannot open file for mapping");
+    }
+
+    try {
+      size=(size_t)GetFileSize(filename);
+      Map();
+    }
+    catch (IOException& e) {
+      CloseFailsafe();
+      throw e;
+    }
+  }
+
+  /**
+   * Change the size of the file and the memory region. New content is
+   * initialized with zero. The memory region may be moved.
+   *
+   * @throws IOException
+   */
+  void MemoryMappedFile::Resize(size_t size)
+  {
+    if (file==nullptr) {
+      throw IOException(filename,"Cannot resize file","File not opened");
+    }
+
+    if (readOnly) {
+      throw IOException(filename,"Cannot resize file","File opened read-only");
+    }
+
+    if (size==this->size) {
+      return;
+    }
+
+#if defined(HAVE_MMAP)
+    Unmap();
+
+    if (ftruncate(fileno(file),(off_t)size)!=0) {
+      throw IOException(filename,"Cannot resize file",strerror(errno));
+    }
+
+    this->size=size;
+
+    Map();
+#else
+    buffer.resize(size,0);
+    this->size=size;
+    data=size>0 ? buffer.data() : nullptr;
+
+    // Write back everything, so the file has the new size, too
+    std::FILE* newFile=freopen(filename.c_str(),"w+b",file);
+
+    if (newFile==nullptr) {
+      file=nullptr;
+      throw IOException(filename,"Cannot resize file");
+    }
+
+    file=newFile;
+
+    Flush();
+#endif
+  }
+
+  /**
+   * Make sure that all changes are written to the file
+   *
+   * @throws IOException
+   */
+  void MemoryMappedFile::Flush()
+  {
+    if (file==nullptr) {
+      throw IOException(filename,"Cannot flush file","File not opened");
+    }
+
+    if (data==nullptr ||
+        readOnly) {
+      return;
+    }
+
+#if defined(HAVE_MMAP)
+    if (msync(data,size,MS_SYNC)!=0) {
+      throw IOException(filename,"Cannot flush file",strerror(errno));
+    }
+#else
+    if (fseek(file,0,SEEK_SET)!=0 ||
+        fwrite(data,1,size,file)!=size ||
+        fflush(file)!=0) {
+      throw IOException(filename,"Cannot flush file");
+    }
+#endif
+  }
+
+  /**
+   * Unmap and close the file
+   *
+   * @throws IOException
+   */
+  void MemoryMappedFile::Close()
+  {
+    if (file==nullptr) {
+      throw IOException(filename,"Cannot close file","File already closed");
+    }
+
+    try {
+      Unmap();
+    }
+    catch (IOException& e) {
+      CloseFailsafe();
+      throw e;
+    }
+
+    if (fclose(file)!=0) {
+      file=nullptr;
+      size=0;
+      throw IOException(filename,"Cannot close file");
+    }
+
+    file=nullptr;
+    size=0;
+  }
+
+  void MemoryMappedFile::CloseFailsafe()
+  {
+    if (file==nullptr) {
+      return;
+    }
+
+    try {
+      Unmap();
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+    }
+
+    fclose(file);
+
+    file=nullptr;
+    data=nullptr;
+    size=0;
+  }
+}
@@ -19,49 +19,322 @@
 
 #include <osmscout/util/NumberSet.h>
 
+#include <algorithm>
 #include <limits>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 namespace osmscout {
 
-  NumberSet::NumberSet()
-    : count(0)
+  /**
+   * Return the number of bits set, using the hardware population count
+   * instruction if the compiler supports it
+   */
+  static inline size_t CountBits(uint64_t value)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_popcountll(value);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return (size_t)__popcnt64(value);
+#else
+    size_t count=0;
+
+    while (value!=0) {
+      value&=value-1;
+      count++;
+    }
+
+    return count;
+#endif
+  }
+
+  NumberSet::Container::Container()
+  : type(Type::array),
+    count(0)
   {
     // no code
   }
 
-  void NumberSet::Set(Id id)
+  /**
+   * Return all values of the container in ascending order
+   */
+  void NumberSet::Container::CollectValues(std::vector<uint16_t>& result) const
   {
-    size_t resolvedId=id+std::numeric_limits<Id>::min();
-    size_t offset=resolvedId/(4096/2);
+    result.clear();
+    result.reserve(count);
 
-    auto entry=map.find(offset);
+    switch (type) {
+    case Type::array:
+      result=values;
+      break;
+    case Type::bitmap:
+      for (size_t word=0; word<bitmap.size(); word++) {
+        uint64_t bits=bitmap[word];
 
-    if (entry==map.end()) {
-      entry=map.insert(std::make_pair(offset,Bitset())).first;
+        while (bits!=0) {
+          uint64_t lowestBit=bits & (~bits+1);
+
+          result.push_back((uint16_t)(word*64+CountBits(lowestBit-1)));
+          bits^=lowestBit;
+        }
+      }
+      break;
+    case Type::run:
+      for (size_t run=0; run<values.size(); run+=2) {
+        for (uint32_t value=values[run]; value<=(uint32_t)values[run]+values[run+1]; value++) {
+          result.push_back((uint16_t)value);
+        }
+      }
+      break;
+    }
+  }
+
+  void NumberSet::Container::ConvertToArray()
+  {
+    std::vector<uint16_t> result;
+
+    CollectValues(result);
+
+    values.swap(result);
+    bitmap.clear();
+    bitmap.shrink_to_fit();
+    type=Type::array;
+  }
+
+  void NumberSet::Container::ConvertToBitmap()
+  {
+    std::vector<uint16_t> result;
+
+    CollectValues(result);
+
+    bitmap.assign(bitmapWords,0);
+
+    for (const auto value : result) {
+      bitmap[value/64]|=(uint64_t)1 << (value%64);
+    }
+
+    values.clear();
+    values.shrink_to_fit();
+    type=Type::bitmap;
+  }
+
+  void NumberSet::Container::ConvertToRun()
+  {
+    std::vector<uint16_t> result;
+    std::vector<uint16_t> runs;
+
+    CollectValues(result);
+
+    runs.reserve(2*GetRunCount());
+
+    for (size_t i=0; i<result.size(); i++) {
+      if (i>0 &&
+          result[i]==result[i-1]+1) {
+        runs.back()++;
+      }
+      else {
+        runs.push_back(result[i]);
+        runs.push_back(0);
+      }
+    }
+
+    values.swap(runs);
+    bitmap.clear();
+    bitmap.shrink_to_fit();
+    type=Type::run;
+  }
+
+  /**
+   * Return the number of runs of consecutive values
+   */
+  size_t NumberSet::Container::GetRunCount() const
+  {
+    size_t runs=0;
+
+    switch (type) {
+    case Type::array:
+      for (size_t i=0; i<values.size(); i++) {
+        if (i==0 ||
+            values[i]!=values[i-1]+1) {
+          runs++;
+        }
+      }
+      break;
+    case Type::bitmap: {
+      uint64_t carry=0;
+
+      // A run starts at every set bit, whose predecessor is not set
+      for (const auto word : bitmap) {
+        runs+=CountBits(word & ~((word << 1) | carry));
+        carry=word >> 63;
+      }
+      break;
+    }
+    case Type::run:
+      runs=values.size()/2;
+      break;
+    }
+
+    return runs;
+  }
+
+  /**
+   * Set the value, return true if the value was not set before
+   */
+  bool NumberSet::Container::Set(uint16_t value)
+  {
+    switch (type) {
+    case Type::array: {
+      auto entry=std::lower_bound(values.begin(),
+                                  values.end(),
+                                  value);
+
+      if (entry!=values.end() &&
+          *entry==value) {
+        return false;
+      }
+
+      values.insert(entry,value);
+      count++;
+
+      if (count>maxArraySize) {
+        ConvertToBitmap();
+      }
+
+      return true;
     }
+    case Type::bitmap: {
+      uint64_t& word=bitmap[value/64];
+      uint64_t  mask=(uint64_t)1 << (value%64);
 
-    size_t index=resolvedId%4096;
+      if ((word & mask)!=0) {
+        return false;
+      }
 
-    if (!entry->second[index]) {
+      word|=mask;
+      count++;
+
+      return true;
+    }
+    case Type::run:
+      if (IsSet(value)) {
+        return false;
+      }
+
+      // Runs are immutable, convert back to a container that allows insertion
+      if (count<maxArraySize) {
+        ConvertToArray();
+      }
+      else {
+        ConvertToBitmap();
+      }
+
+      return Set(value);
+    }
+
+    return false;
+  }
+
+  bool NumberSet::Container::IsSet(uint16_t value) const
+  {
+    switch (type) {
+    case Type::array:
+      return std::binary_search(values.begin(),
+                                values.end(),
+                                value);
+    case Type::bitmap:
+      return (bitmap[value/64] & ((uint64_t)1 << (value%64)))!=0;
+    case Type::run: {
+      // Find the last run starting at or before the value
+      size_t low=0;
+      size_t high=values.size()/2;
+
+      while (low<high) {
+        size_t middle=(low+high)/2;
+
+        if (values[2*middle]<=value) {
+          low=middle+1;
+        }
+        else {
+          high=middle;
+        }
+      }
+
+      if (low==0) {
+        return false;
+      }
+
+      return value-values[2*(low-1)]<=values[2*(low-1)+1];
+    }
+    }
+
+    return false;
+  }
+
+  /**
+   * Switch to the container type using the least memory
+   */
+  void NumberSet::Container::Optimize()
+  {
+    size_t runSize=GetRunCount()*2*sizeof(uint16_t);
+    size_t arraySize=count<=maxArraySize ? count*sizeof(uint16_t) : std::numeric_limits<size_t>::max();
+    size_t bitmapSize=bitmapWords*sizeof(uint64_t);
+
+    if (runSize<arraySize &&
+        runSize<bitmapSize) {
+      if (type!=Type::run) {
+        ConvertToRun();
+      }
+    }
+    else if (arraySize<=bitmapSize) {
+      if (type!=Type::array) {
+        ConvertToArray();
+      }
+    }
+    else if (type!=Type::bitmap) {
+      ConvertToBitmap();
+    }
+
+    values.shrink_to_fit();
+  }
+
+  /**
+   * Return the size of the dynamically allocated memory in bytes
+   */
+  size_t NumberSet::Container::GetMemory() const
+  {
+    return values.capacity()*sizeof(uint16_t)+
+           bitmap.capacity()*sizeof(uint64_t);
+  }
+
+  NumberSet::NumberSet()
+    : count(0)
+  {
+    // no code
+  }
+
+  void NumberSet::Set(Id id)
+  {
+    uint64_t resolvedId=id+std::numeric_limits<Id>::min();
+
+    if (map[resolvedId >> 16].Set((uint16_t)(resolvedId & 0xffff))) {
       count++;
-      entry->second.set(index);
     }
   }
 
   bool NumberSet::IsSet(Id id) const
   {
-    size_t resolvedId=id+std::numeric_limits<Id>::min();
-    size_t offset=resolvedId/(4096/2);
+    uint64_t resolvedId=id+std::numeric_limits<Id>::min();
 
-    auto entry=map.find(offset);
+    auto entry=map.find(resolvedId >> 16);
 
     if (entry==map.end()) {
       return false;
     }
 
-    size_t index=resolvedId%4096;
-
-    return entry->second[index];
+    return entry->second.IsSet((uint16_t)(resolvedId & 0xffff));
   }
 
   size_t NumberSet::GetNodeUsedCount() const
@@ -69,6 +342,33 @@ namespace osmscout {
     return count;
   }
 
+  /**
+   * Convert all chunks to the most compact representation. Call this
+   * after all ids have been set to reduce memory for the following lookups.
+   */
+  void NumberSet::Optimize()
+  {
+    for (auto& entry : map) {
+      entry.second.Optimize();
+    }
+  }
+
+  /**
+   * Return the (approximate) memory used in bytes
+   */
+  size_t NumberSet::GetMemory() const
+  {
+    size_t memory=sizeof(NumberSet)+
+                  map.bucket_count()*sizeof(void*)+
+                  map.size()*(sizeof(Map::value_type)+sizeof(void*));
+
+    for (const auto& entry : map) {
+      memory+=entry.second.GetMemory();
+    }
+
+    return memory;
+  }
+
   void NumberSet::Clear()
   {
     map.clear();
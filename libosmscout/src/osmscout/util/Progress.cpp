@@ -104,6 +104,56 @@ namespace osmscout {
     // no code
   }
 
+  BufferedProgress::BufferedProgress(bool outputDebug)
+  {
+    SetOutputDebug(outputDebug);
+  }
+
+  void BufferedProgress::Debug(const std::string& text)
+  {
+    messages.emplace_back(Level::debug,text);
+  }
+
+  void BufferedProgress::Info(const std::string& text)
+  {
+    messages.emplace_back(Level::info,text);
+  }
+
+  void BufferedProgress::Warning(const std::string& text)
+  {
+    messages.emplace_back(Level::warning,text);
+  }
+
+  void BufferedProgress::Error(const std::string& text)
+  {
+    messages.emplace_back(Level::error,text);
+  }
+
+  /**
+   * Pass all buffered messages to the given progress and clear the buffer
+   */
+  void BufferedProgress::Flush(Progress& progress)
+  {
+    for (const auto& message : messages) {
+      switch (message.first) {
+      case Level::debug:
+        progress.Debug(message.second);
+        break;
+      case Level::info:
+        progress.Info(message.second);
+        break;
+      case Level::warning:
+        progress.Warning(message.second);
+        break;
+      case Level::error:
+        progress.Error(message.second);
+        break;
+      }
+    }
+
+    messages.clear();
+  }
+
   void ConsoleProgress::SetStep(const std::string& step)
   {
     std::cout << "+ " << step << "..." << std::endl;
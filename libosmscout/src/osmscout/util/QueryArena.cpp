@@ -0,0 +1,121 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2019  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/util/QueryArena.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace osmscout {
+
+  QueryArena::QueryArena(size_t blockSize)
+  : blockSize(blockSize),
+    allocationCount(0),
+    allocatedBytes(0)
+  {
+    // no code
+  }
+
+  /**
+   * Return memory of the given size and alignment. Requests that do not fit
+   * into the remaining space of the current block start a new block, which
+   * is bigger than the default block size, if the request requires it.
+   */
+  void* QueryArena::Allocate(size_t size,
+                             size_t alignment)
+  {
+    std::lock_guard<std::mutex> lock(accessMutex);
+
+    if (!blocks.empty()) {
+      Block&    block=blocks.back();
+      uintptr_t base=reinterpret_cast<uintptr_t>(block.data.get());
+      uintptr_t start=(base+block.used+alignment-1)/alignment*alignment;
+
+      if (start+size<=base+block.size) {
+        block.used=start+size-base;
+        allocationCount++;
+        allocatedBytes+=size;
+
+        return reinterpret_cast<void*>(start);
+      }
+    }
+
+    Block block;
+
+    // Memory from new[] is suitably aligned for any fundamental type
+    block.size=std::max(blockSize,size);
+    block.data.reset(new char[block.size]);
+    block.used=size;
+
+    void* result=block.data.get();
+
+    blocks.push_back(std::move(block));
+    allocationCount++;
+    allocatedBytes+=size;
+
+    return result;
+  }
+
+  /**
+   * Return the number of allocations served by the arena
+   */
+  size_t QueryArena::GetAllocationCount() const
+  {
+    std::lock_guard<std::mutex> lock(accessMutex);
+
+    return allocationCount;
+  }
+
+  /**
+   * Return the sum of the sizes of all allocations served by the arena
+   */
+  size_t QueryArena::GetAllocatedBytes() const
+  {
+    std::lock_guard<std::mutex> lock(accessMutex);
+
+    return allocatedBytes;
+  }
+
+  /**
+   * Return the number of blocks, which equals the number of heap allocations
+   * done by the arena
+   */
+  size_t QueryArena::GetBlockCount() const
+  {
+    std::lock_guard<std::mutex> lock(accessMutex);
+
+    return blocks.size();
+  }
+
+  /**
+   * Return the number of bytes of all blocks
+   */
+  size_t QueryArena::GetMemoryUsage() const
+  {
+    std::lock_guard<std::mutex> lock(accessMutex);
+
+    size_t memory=0;
+
+    for (const auto& block : blocks) {
+      memory+=block.size;
+    }
+
+    return memory;
+  }
+}
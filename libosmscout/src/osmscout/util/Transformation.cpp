@@ -838,7 +838,9 @@ namespace osmscout {
                                           double optimizeErrorTolerance,
                                           TransPolygon::OutputConstraint constraint)
   {
-    std::vector<GeoCoord> coords(4);
+    std::vector<GeoCoord> coords;
+
+    coords.reserve(4);
 
     // left bottom
     coords.emplace_back(boundingBox.GetMinLat(),
@@ -29,6 +29,8 @@ zip -u -9 -du \
     "$mapDirectory/areaway.idx" \
     "$mapDirectory/areasopt.dat" \
     "$mapDirectory/waysopt.dat" \
+    "$mapDirectory/areas.box" \
+    "$mapDirectory/ways.box" \
     "$mapDirectory/location.idx" \
     "$mapDirectory/water.idx" \
     "$mapDirectory/intersections.dat" \